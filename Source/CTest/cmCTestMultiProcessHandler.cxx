@@ -11,7 +11,6 @@
 #include <cstring>
 #include <iomanip>
 #include <iostream>
-#include <list>
 #include <sstream>
 #include <stack>
 #include <unordered_map>
@@ -33,10 +32,10 @@
 #include "cmCTest.h"
 #include "cmCTestBinPacker.h"
 #include "cmCTestRunTest.h"
+#include "cmCTestScheduler.h"
 #include "cmCTestTestHandler.h"
 #include "cmDuration.h"
 #include "cmListFileCache.h"
-#include "cmRange.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmUVSignalHackRAII.h" // IWYU pragma: keep
@@ -793,58 +792,32 @@ void cmCTestMultiProcessHandler::CreateTestCostList()
 
 void cmCTestMultiProcessHandler::CreateParallelTestCostList()
 {
-  TestSet alreadySortedTests;
-
-  std::list<TestSet> priorityStack;
-  priorityStack.emplace_back();
-  TestSet& topLevel = priorityStack.back();
+  std::map<int, cmCTestSchedulerTest> schedulerTests;
 
   // In parallel test runs add previously failed tests to the front
   // of the cost list and queue other tests for further sorting
   for (auto const& t : this->Tests) {
-    if (cmContains(this->LastTestsFailed, this->Properties[t.first]->Name)) {
+    cmCTestTestHandler::cmCTestTestProperties const& p =
+      *this->Properties[t.first];
+    cmCTestSchedulerTest& schedulerTest = schedulerTests[t.first];
+    schedulerTest.Cost = p.Cost;
+    // A test that runs serially blocks all slots while it runs.
+    schedulerTest.Processors =
+      p.RunSerial ? this->ParallelLevel : this->GetProcessorsUsed(t.first);
+    schedulerTest.ResourceGroups = p.ResourceGroups.size();
+    schedulerTest.Depends = t.second;
+
+    if (cmContains(this->LastTestsFailed, p.Name)) {
       // If the test failed last time, it should be run first.
       this->SortedTests.push_back(t.first);
-      alreadySortedTests.insert(t.first);
-    } else {
-      topLevel.insert(t.first);
-    }
-  }
-
-  // In parallel test runs repeatedly move dependencies of the tests on
-  // the current dependency level to the next level until no
-  // further dependencies exist.
-  while (!priorityStack.back().empty()) {
-    TestSet& previousSet = priorityStack.back();
-    priorityStack.emplace_back();
-    TestSet& currentSet = priorityStack.back();
-
-    for (auto const& i : previousSet) {
-      TestSet const& dependencies = this->Tests[i];
-      currentSet.insert(dependencies.begin(), dependencies.end());
-    }
-
-    for (auto const& i : currentSet) {
-      previousSet.erase(i);
     }
   }
 
-  // Remove the empty dependency level
-  priorityStack.pop_back();
-
-  // Reverse iterate over the different dependency levels (deepest first).
-  // Sort tests within each level by COST and append them to the cost list.
-  for (TestSet const& currentSet : cmReverseRange(priorityStack)) {
-    TestList sortedCopy;
-    cm::append(sortedCopy, currentSet);
-    std::stable_sort(sortedCopy.begin(), sortedCopy.end(),
-                     TestComparator(this));
-
-    for (auto const& j : sortedCopy) {
-      if (!cmContains(alreadySortedTests, j)) {
-        this->SortedTests.push_back(j);
-        alreadySortedTests.insert(j);
-      }
+  // Start the tests that lead the longest chains of dependent tests
+  // first, so that no chain is left to run alone at the end.
+  for (int test : cmCTestSortByCriticalPath(schedulerTests)) {
+    if (!cmContains(this->LastTestsFailed, this->Properties[test]->Name)) {
+      this->SortedTests.push_back(test);
     }
   }
 }
@@ -0,0 +1,215 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCTestOutputBuffer.h"
+
+#include <algorithm>
+#include <ios>
+#include <utility>
+
+#include <cm/memory>
+
+#include "cmSystemTools.h"
+
+namespace {
+
+/** Number of bytes at the end of the buffer that start a UTF-8 encoded
+    character that continues beyond the buffer.  */
+std::size_t IncompleteUTF8Suffix(std::string const& buffer)
+{
+  std::size_t const size = buffer.size();
+  for (std::size_t n = 1; n <= 3 && n <= size; ++n) {
+    unsigned char const c = static_cast<unsigned char>(buffer[size - n]);
+    if ((c & 0xC0) == 0x80) {
+      // Continuation byte
+      continue;
+    }
+    std::size_t length = 1;
+    if ((c & 0xE0) == 0xC0) {
+      length = 2;
+    } else if ((c & 0xF0) == 0xE0) {
+      length = 3;
+    } else if ((c & 0xF8) == 0xF0) {
+      length = 4;
+    }
+    return length > n ? n : 0;
+  }
+  return 0;
+}
+}
+
+cmCTestOutputBuffer::~cmCTestOutputBuffer()
+{
+  this->RemoveSpillFile();
+}
+
+void cmCTestOutputBuffer::Reset(std::string spillFile, std::size_t headSize,
+                                std::size_t tailSize)
+{
+  this->RemoveSpillFile();
+  this->SpillFile = std::move(spillFile);
+  this->HeadSize = headSize;
+  this->TailSize = tailSize;
+  this->Size = 0;
+  this->Spilled = false;
+  this->Head.clear();
+  this->Tail.clear();
+  this->TailPos = 0;
+}
+
+bool cmCTestOutputBuffer::WouldSpill(std::size_t size) const
+{
+  return !this->Spilled &&
+    this->Size + size > this->HeadSize + this->TailSize;
+}
+
+bool cmCTestOutputBuffer::Append(cm::string_view data)
+{
+  bool result = true;
+  if (this->WouldSpill(data.size())) {
+    this->Spilled = true;
+    if (!this->SpillFile.empty()) {
+      this->SpillStream = cm::make_unique<cmsys::ofstream>(
+        this->SpillFile.c_str(), std::ios::out | std::ios::binary);
+      if (*this->SpillStream) {
+        this->SpillStream->write(this->Head.data(), this->Head.size());
+      }
+    }
+    // Keep the first and the last bytes of what is in memory
+    if (this->Head.size() > this->HeadSize) {
+      this->AppendTail(cm::string_view(this->Head).substr(this->HeadSize));
+      this->Head.resize(this->HeadSize);
+    }
+  }
+  this->Size += data.size();
+
+  if (!this->Spilled) {
+    this->Head.append(data.data(), data.size());
+    return true;
+  }
+
+  if (this->SpillStream) {
+    this->SpillStream->write(data.data(), data.size());
+    if (!*this->SpillStream) {
+      this->SpillStream.reset();
+      cmSystemTools::RemoveFile(this->SpillFile);
+      this->SpillFile.clear();
+      result = false;
+    }
+  } else if (!this->SpillFile.empty()) {
+    this->SpillFile.clear();
+    result = false;
+  }
+  if (this->Head.size() < this->HeadSize) {
+    std::size_t const n =
+      std::min(this->HeadSize - this->Head.size(), data.size());
+    this->Head.append(data.data(), n);
+    data = data.substr(n);
+  }
+  this->AppendTail(data);
+  return result;
+}
+
+void cmCTestOutputBuffer::AppendTail(cm::string_view data)
+{
+  if (this->TailSize == 0) {
+    return;
+  }
+  if (data.size() >= this->TailSize) {
+    this->Tail.assign(data.data() + data.size() - this->TailSize,
+                      this->TailSize);
+    this->TailPos = 0;
+    return;
+  }
+  if (this->Tail.size() < this->TailSize) {
+    std::size_t const n =
+      std::min(this->TailSize - this->Tail.size(), data.size());
+    this->Tail.append(data.data(), n);
+    data = data.substr(n);
+  }
+  while (!data.empty()) {
+    std::size_t const n =
+      std::min(this->TailSize - this->TailPos, data.size());
+    this->Tail.replace(this->TailPos, n, data.data(), n);
+    this->TailPos = (this->TailPos + n) % this->TailSize;
+    data = data.substr(n);
+  }
+}
+
+void cmCTestOutputBuffer::Close()
+{
+  if (this->SpillStream) {
+    this->SpillStream->close();
+    this->SpillStream.reset();
+  }
+}
+
+void cmCTestOutputBuffer::Flush()
+{
+  if (this->SpillStream) {
+    this->SpillStream->flush();
+  }
+}
+
+std::string cmCTestOutputBuffer::GetTail() const
+{
+  return this->Tail.substr(this->TailPos) +
+    this->Tail.substr(0, this->TailPos);
+}
+
+bool cmCTestOutputBuffer::Read(
+  std::function<void(std::string const&)> const& consumer) const
+{
+  if (!this->Spilled) {
+    consumer(this->Head);
+    return true;
+  }
+  if (this->SpillFile.empty() || this->SpillStream) {
+    return false;
+  }
+  return ReadFile(this->SpillFile, consumer);
+}
+
+bool cmCTestOutputBuffer::ReadFile(
+  std::string const& file,
+  std::function<void(std::string const&)> const& consumer)
+{
+  cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  std::string chunk;
+  std::string rest;
+  char buffer[65536];
+  while (fin.read(buffer, sizeof(buffer)) || fin.gcount() > 0) {
+    chunk = std::move(rest);
+    chunk.append(buffer, static_cast<std::size_t>(fin.gcount()));
+    std::size_t const incomplete = IncompleteUTF8Suffix(chunk);
+    rest = chunk.substr(chunk.size() - incomplete);
+    chunk.resize(chunk.size() - incomplete);
+    consumer(chunk);
+  }
+  if (!rest.empty()) {
+    consumer(rest);
+  }
+  return fin.eof();
+}
+
+std::string cmCTestOutputBuffer::ReleaseSpillFile()
+{
+  this->Close();
+  std::string file;
+  if (this->Spilled) {
+    file = std::move(this->SpillFile);
+  }
+  this->SpillFile.clear();
+  return file;
+}
+
+void cmCTestOutputBuffer::RemoveSpillFile()
+{
+  this->Close();
+  if (this->Spilled && !this->SpillFile.empty()) {
+    cmSystemTools::RemoveFile(this->SpillFile);
+  }
+  this->SpillFile.clear();
+}
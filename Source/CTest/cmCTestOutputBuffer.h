@@ -0,0 +1,100 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmCTestOutputBuffer_h
+#define cmCTestOutputBuffer_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <cm/string_view>
+
+#include "cmsys/FStream.hxx"
+
+/** \class cmCTestOutputBuffer
+ * \brief Captures the output of a test in bounded memory
+ *
+ * The output is kept in memory as long as it fits into the head and the
+ * tail size together.  Once it grows beyond that, the complete output is
+ * streamed to a spill file and only the first HeadSize and the last
+ * TailSize bytes of it are kept in memory.
+ */
+class cmCTestOutputBuffer
+{
+public:
+  cmCTestOutputBuffer() = default;
+  ~cmCTestOutputBuffer();
+
+  cmCTestOutputBuffer(cmCTestOutputBuffer const&) = delete;
+  cmCTestOutputBuffer& operator=(cmCTestOutputBuffer const&) = delete;
+
+  /** Start a new capture.  The spill file is only created when the output
+      does not fit into memory.  */
+  void Reset(std::string spillFile, std::size_t headSize,
+             std::size_t tailSize);
+
+  /** Whether appending the given number of bytes spills the output.  */
+  bool WouldSpill(std::size_t size) const;
+
+  /** Append output.  Returns false if the spill file could not be
+      written, in which case only the head and the tail are kept.  */
+  bool Append(cm::string_view data);
+
+  /** Close the spill file so that it can be read.  */
+  void Close();
+
+  /** Write buffered output to the spill file so that ReadFile() sees
+      all output appended so far.  */
+  void Flush();
+
+  /** Whether the output did not fit into memory.  */
+  bool IsSpilled() const { return this->Spilled; }
+
+  /** Total number of bytes appended.  */
+  std::size_t GetSize() const { return this->Size; }
+
+  /** The spill file, or empty if the output did not spill to a file.  */
+  std::string const& GetSpillFile() const { return this->SpillFile; }
+
+  /** The complete output if it did not spill, or its first bytes.  */
+  std::string const& GetHead() const { return this->Head; }
+
+  /** The last bytes of the output if it spilled, or empty.  */
+  std::string GetTail() const;
+
+  /** Pass the complete output to the consumer in chunks that do not split
+      UTF-8 encoded characters.  Returns false if it could not be read.  */
+  bool Read(std::function<void(std::string const&)> const& consumer) const;
+
+  /** Pass the content of an output file to the consumer like Read.  */
+  static bool ReadFile(
+    std::string const& file,
+    std::function<void(std::string const&)> const& consumer);
+
+  /** Close the spill file and hand it over to the caller, who becomes
+      responsible for removing it.  Returns an empty string if the output
+      did not spill to a file.  */
+  std::string ReleaseSpillFile();
+
+  /** Remove the spill file, if any.  */
+  void RemoveSpillFile();
+
+private:
+  void AppendTail(cm::string_view data);
+
+  std::string SpillFile;
+  std::unique_ptr<cmsys::ofstream> SpillStream;
+  std::size_t HeadSize = 0;
+  std::size_t TailSize = 0;
+  std::size_t Size = 0;
+  bool Spilled = false;
+  std::string Head;
+  // Ring buffer of the last TailSize bytes, starting at TailPos
+  std::string Tail;
+  std::size_t TailPos = 0;
+};
+
+#endif
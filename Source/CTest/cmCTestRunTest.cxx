@@ -2,6 +2,7 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmCTestRunTest.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
@@ -24,6 +25,16 @@
 #include "cmSystemTools.h"
 #include "cmWorkingDirectory.h"
 
+namespace {
+// Whether a regular expression may match differently in the complete
+// output than in any two consecutive lines of it.  Anchors match only at
+// the beginning or the end of the output, and newlines may span lines.
+bool NeedsWholeOutput(std::string const& pattern)
+{
+  return pattern.find_first_of("^$\n") != std::string::npos;
+}
+}
+
 cmCTestRunTest::cmCTestRunTest(cmCTestMultiProcessHandler& multiHandler)
   : MultiTestHandler(multiHandler)
 {
@@ -36,17 +47,62 @@ cmCTestRunTest::cmCTestRunTest(cmCTestMultiProcessHandler& multiHandler)
   this->TestResult.Properties = nullptr;
 }
 
-void cmCTestRunTest::CheckOutput(std::string const& line)
+void cmCTestRunTest::CheckOutput(std::string const& line, bool lineEnd)
 {
-  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-             this->GetIndex() << ": " << line << std::endl);
-  this->ProcessOutput += line;
-  this->ProcessOutput += "\n";
+  std::string const prefix =
+    this->PartialLine ? std::string() : cmStrCat(this->GetIndex(), ": ");
+  if (lineEnd) {
+    cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+               prefix << line << std::endl);
+  } else {
+    cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, prefix << line);
+  }
+  this->PartialLine = !lineEnd;
+
+  std::string text = line;
+  if (lineEnd) {
+    text += "\n";
+  }
+  if (text.find("CTEST_FULL_OUTPUT") != std::string::npos) {
+    this->FullOutputRequested = true;
+  }
+  if (this->OutputBuffer.WouldSpill(text.size())) {
+    // Last chance to look at the complete output in memory.
+    std::string const& head = this->OutputBuffer.GetHead();
+    this->MatchSpilledOutput(head);
+    std::string::size_type const pos =
+      head.size() < 2 ? std::string::npos : head.rfind('\n', head.size() - 2);
+    this->LastSpilledLine =
+      pos == std::string::npos ? head : head.substr(pos + 1);
+  }
+  std::string const spillFile = this->OutputBuffer.GetSpillFile();
+  if (!this->OutputBuffer.Append(text)) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "Cannot write test output to " << spillFile
+                                              << ", keeping only its "
+                                                 "beginning and end."
+                                              << std::endl);
+  }
+  if (this->OutputBuffer.IsSpilled()) {
+    // Include the previous line to find matches across a line end.
+    this->MatchSpilledOutput(this->LastSpilledLine + text);
+    this->LastSpilledLine = std::move(text);
+  }
 
   // Check for TIMEOUT_AFTER_MATCH property.
   if (!this->TestProperties->TimeoutRegularExpressions.empty()) {
+    // Reading back the spill file after every line would take quadratic
+    // time, so wait until the output doubled since the last time.
+    bool const rescan = this->OutputBuffer.IsSpilled() &&
+      this->OutputBuffer.GetSize() >= 2 * this->RescannedSize;
     for (auto& reg : this->TestProperties->TimeoutRegularExpressions) {
-      if (reg.first.find(this->ProcessOutput)) {
+      if (this->OutputBuffer.IsSpilled() && NeedsWholeOutput(reg.second)) {
+        if (!rescan) {
+          continue;
+        }
+        this->RescannedSize = this->OutputBuffer.GetSize();
+      }
+      if (this->FindInOutput(reg)) {
         cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                    this->GetIndex()
                      << ": "
@@ -65,8 +121,96 @@ void cmCTestRunTest::CheckOutput(std::string const& line)
   }
 }
 
+void cmCTestRunTest::ResetOutput()
+{
+  std::size_t const size = static_cast<std::size_t>(
+    std::max({ this->TestHandler->CustomMaximumPassedTestOutputSize,
+               this->TestHandler->CustomMaximumFailedTestOutputSize,
+               1024 }));
+  this->OutputBuffer.Reset(
+    cmStrCat(this->CTest->GetBinaryDir(), "/Testing/Temporary/TestOutput_",
+             this->Index, ".log"),
+    size, size);
+  this->SpilledMatches.clear();
+  this->LastSpilledLine.clear();
+  this->RescannedSize = 0;
+  this->FullOutputRequested = false;
+  this->PartialLine = false;
+  this->ProcessOutput.clear();
+}
+
+bool cmCTestRunTest::FindInOutput(
+  std::pair<cmsys::RegularExpression, std::string>& regex)
+{
+  if (!this->OutputBuffer.IsSpilled()) {
+    return regex.first.find(this->OutputBuffer.GetHead());
+  }
+  if (NeedsWholeOutput(regex.second)) {
+    return this->FindInSpillFile(regex.first);
+  }
+  return this->SpilledMatches.count(&regex.first) != 0;
+}
+
+bool cmCTestRunTest::FindInSpillFile(cmsys::RegularExpression& regex)
+{
+  std::string output;
+  this->OutputBuffer.Flush();
+  if (!cmCTestOutputBuffer::ReadFile(
+        this->OutputBuffer.GetSpillFile(),
+        [&output](std::string const& chunk) { output += chunk; })) {
+    // Only the beginning and the end are left.
+    output = cmStrCat(this->OutputBuffer.GetHead(), "...\n",
+                      this->OutputBuffer.GetTail());
+  }
+  return regex.find(output);
+}
+
+void cmCTestRunTest::MatchSpilledOutput(std::string const& text)
+{
+  // Output that spilled to the file is matched a line or two at a time.
+  // Expressions that need the complete output read back the spill file.
+  auto match =
+    [this, &text](
+      std::vector<std::pair<cmsys::RegularExpression, std::string>>& list) {
+      for (auto& regex : list) {
+        if (!this->SpilledMatches.count(&regex.first) &&
+            !NeedsWholeOutput(regex.second) && regex.first.find(text)) {
+          this->SpilledMatches.insert(&regex.first);
+        }
+      }
+    };
+  match(this->TestProperties->RequiredRegularExpressions);
+  match(this->TestProperties->ErrorRegularExpressions);
+  match(this->TestProperties->SkipRegularExpressions);
+  match(this->TestProperties->TimeoutRegularExpressions);
+}
+
+void cmCTestRunTest::ReadOutput(
+  std::function<void(std::string const&)> const& consumer)
+{
+  if (!this->OutputBuffer.Read(consumer)) {
+    consumer(this->ProcessOutput);
+  }
+}
+
 bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
 {
+  // Only the beginning and the end of spilled output stay in memory,
+  // except for MemCheck which parses the complete output.
+  this->OutputBuffer.Close();
+  this->ProcessOutput = this->OutputBuffer.GetHead();
+  if (this->OutputBuffer.IsSpilled()) {
+    std::string output;
+    if (this->TestHandler->MemCheck &&
+        this->OutputBuffer.Read(
+          [&output](std::string const& chunk) { output += chunk; })) {
+      this->ProcessOutput = std::move(output);
+    } else {
+      this->ProcessOutput += "...\n";
+      this->ProcessOutput += this->OutputBuffer.GetTail();
+    }
+  }
+
   this->WriteLogOutputTop(completed, total);
   std::string reason;
   bool passed = true;
@@ -84,7 +228,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
       this->FailedDependencies.empty()) {
     bool found = false;
     for (auto& pass : this->TestProperties->RequiredRegularExpressions) {
-      if (pass.first.find(this->ProcessOutput)) {
+      if (this->FindInOutput(pass)) {
         found = true;
         reason = cmStrCat("Required regular expression found. Regex=[",
                           pass.second, ']');
@@ -104,7 +248,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   if (!this->TestProperties->ErrorRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
     for (auto& fail : this->TestProperties->ErrorRegularExpressions) {
-      if (fail.first.find(this->ProcessOutput)) {
+      if (this->FindInOutput(fail)) {
         reason = cmStrCat("Error regular expression found in output. Regex=[",
                           fail.second, ']');
         forceFail = true;
@@ -115,7 +259,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   if (!this->TestProperties->SkipRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
     for (auto& skip : this->TestProperties->SkipRegularExpressions) {
-      if (skip.first.find(this->ProcessOutput)) {
+      if (this->FindInOutput(skip)) {
         reason = cmStrCat("Skip regular expression found in output. Regex=[",
                           skip.second, ']');
         forceSkip = true;
@@ -221,7 +365,10 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   }
 
   if (outputTestErrorsToConsole) {
-    cmCTestLog(this->CTest, HANDLER_OUTPUT, this->ProcessOutput << std::endl);
+    this->ReadOutput([this](std::string const& chunk) {
+      cmCTestLog(this->CTest, HANDLER_OUTPUT, chunk);
+    });
+    cmCTestLog(this->CTest, HANDLER_OUTPUT, std::endl);
   }
 
   if (this->TestHandler->LogFile) {
@@ -233,12 +380,19 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   // if this is doing MemCheck then all the output needs to be put into
   // Output since that is what is parsed by cmCTestMemCheckHandler
   if (!this->TestHandler->MemCheck && started) {
-    this->TestHandler->CleanTestOutput(
-      this->ProcessOutput,
-      static_cast<size_t>(
-        this->TestResult.Status == cmCTestTestHandler::COMPLETED
-          ? this->TestHandler->CustomMaximumPassedTestOutputSize
-          : this->TestHandler->CustomMaximumFailedTestOutputSize));
+    size_t const length = static_cast<size_t>(
+      this->TestResult.Status == cmCTestTestHandler::COMPLETED
+        ? this->TestHandler->CustomMaximumPassedTestOutputSize
+        : this->TestHandler->CustomMaximumFailedTestOutputSize);
+    if (this->OutputBuffer.IsSpilled() &&
+        (length == 0 || this->FullOutputRequested) &&
+        this->CTest->GetProduceXML()) {
+      // The XML writer reads the complete output from the spill file.
+      this->TestResult.OutputFile = this->OutputBuffer.ReleaseSpillFile();
+    }
+    if (this->TestResult.OutputFile.empty()) {
+      this->TestHandler->CleanTestOutput(this->ProcessOutput, length);
+    }
   }
   this->TestResult.Reason = reason;
   if (this->TestHandler->LogFile) {
@@ -285,7 +439,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   // record the results in TestResult
   if (started) {
     std::string compressedOutput;
-    if (!this->TestHandler->MemCheck &&
+    if (!this->TestHandler->MemCheck && this->TestResult.OutputFile.empty() &&
         this->CTest->ShouldCompressTestOutput()) {
       std::string str = this->ProcessOutput;
       if (this->CTest->CompressString(str)) {
@@ -294,8 +448,13 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
     }
     bool compress = !compressedOutput.empty() &&
       compressedOutput.length() < this->ProcessOutput.length();
-    this->TestResult.Output =
-      compress ? compressedOutput : this->ProcessOutput;
+    if (this->TestResult.OutputFile.empty()) {
+      this->TestResult.Output =
+        compress ? compressedOutput : this->ProcessOutput;
+    } else {
+      this->TestResult.Output.clear();
+      compress = false;
+    }
     this->TestResult.CompressOutput = compress;
     this->TestResult.ReturnValue = this->TestProcess->GetExitValue();
     if (!skipped) {
@@ -310,6 +469,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   if (!this->NeedsToRepeat()) {
     this->TestHandler->TestResults.push_back(this->TestResult);
   }
+  this->OutputBuffer.RemoveSpillFile();
   this->TestProcess.reset();
   return passed || skipped;
 }
@@ -412,7 +572,7 @@ void cmCTestRunTest::StartFailure(std::string const& output,
                  << this->TestProperties->Name << std::endl);
   }
 
-  this->ProcessOutput.clear();
+  this->ResetOutput();
   if (!output.empty()) {
     *this->TestHandler->LogFile << output << std::endl;
     cmCTestLog(this->CTest, ERROR_MESSAGE, output << std::endl);
@@ -484,7 +644,12 @@ bool cmCTestRunTest::StartTest(size_t completed, size_t total)
     cmCTestLog(this->CTest, HANDLER_TEST_PROGRESS_OUTPUT, testName);
   }
 
-  this->ProcessOutput.clear();
+  this->ResetOutput();
+  // The output of a previous run is not needed anymore.
+  if (!this->TestResult.OutputFile.empty()) {
+    cmSystemTools::RemoveFile(this->TestResult.OutputFile);
+    this->TestResult.OutputFile.clear();
+  }
 
   this->TestResult.Properties = this->TestProperties;
   this->TestResult.ExecutionTime = cmDuration::zero();
@@ -829,8 +994,10 @@ void cmCTestRunTest::WriteLogOutputTop(size_t completed, size_t total)
     << "Output:" << std::endl
     << "----------------------------------------------------------"
     << std::endl;
-  *this->TestHandler->LogFile << this->ProcessOutput << "<end of output>"
-                              << std::endl;
+  this->ReadOutput([this](std::string const& chunk) {
+    *this->TestHandler->LogFile << chunk;
+  });
+  *this->TestHandler->LogFile << "<end of output>" << std::endl;
 
   if (!this->CTest->GetTestProgressOutput()) {
     cmCTestLog(this->CTest, HANDLER_OUTPUT, outputStream.str());
@@ -5,16 +5,21 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <stddef.h>
 
+#include "cmsys/RegularExpression.hxx"
+
 #include "cmCTest.h"
 #include "cmCTestMultiProcessHandler.h"
+#include "cmCTestOutputBuffer.h"
 #include "cmCTestTestHandler.h"
 #include "cmDuration.h"
 #include "cmProcess.h"
@@ -62,8 +67,9 @@ public:
     return this->TestResult;
   }
 
-  // Read and store output.  Returns true if it must be called again.
-  void CheckOutput(std::string const& line);
+  // Read and store output.  The line continues in the next call if it
+  // is passed without its line end.
+  void CheckOutput(std::string const& line, bool lineEnd = true);
 
   static bool StartTest(std::unique_ptr<cmCTestRunTest> runner,
                         size_t completed, size_t total);
@@ -116,6 +122,19 @@ private:
                    std::vector<std::string>* environment,
                    std::vector<size_t>* affinity);
   void WriteLogOutputTop(size_t completed, size_t total);
+  // Start to capture the output of a new run of the test
+  void ResetOutput();
+  // Whether a regular expression matches the output of the test
+  bool FindInOutput(
+    std::pair<cmsys::RegularExpression, std::string>& regex);
+  // Record the regular expressions that match output that does not stay
+  // in memory
+  void MatchSpilledOutput(std::string const& text);
+  // Whether a regular expression matches the complete output read back
+  // from the spill file
+  bool FindInSpillFile(cmsys::RegularExpression& regex);
+  // Pass the complete output of the test to the consumer in chunks
+  void ReadOutput(std::function<void(std::string const&)> const& consumer);
   // Run post processing of the process output for MemCheck
   void MemCheckPostProcess();
 
@@ -130,6 +149,16 @@ private:
   cmCTestTestHandler* TestHandler;
   cmCTest* CTest;
   std::unique_ptr<cmProcess> TestProcess;
+  // Output of the test, spilled to a file if it does not fit into memory
+  cmCTestOutputBuffer OutputBuffer;
+  // Regular expressions that matched output which spilled to the file
+  std::set<cmsys::RegularExpression const*> SpilledMatches;
+  std::string LastSpilledLine;
+  // Output size when the spill file was last read back while the test ran
+  std::size_t RescannedSize = 0;
+  bool FullOutputRequested = false;
+  bool PartialLine = false;
+  // Output in memory once the test finished
   std::string ProcessOutput;
   // The test results
   cmCTestTestHandler::cmCTestTestResult TestResult;
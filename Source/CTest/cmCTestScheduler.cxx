@@ -0,0 +1,230 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCTestScheduler.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <queue>
+#include <utility>
+
+namespace {
+
+struct RankT
+{
+  // Cost of the longest chain of tests that starts with the test
+  double PathCost = 0;
+  // Cost of the test multiplied by its width
+  double Area = 0;
+  // Number of tests in the longest chain
+  std::size_t Depth = 0;
+};
+
+double TestCost(cmCTestSchedulerTest const& test)
+{
+  // Negative costs only order tests, they do not take less time.
+  return std::max(static_cast<double>(test.Cost), 0.0);
+}
+
+/** Map each test to the tests that depend on it.  */
+std::map<int, std::vector<int>> GetDependents(
+  std::map<int, cmCTestSchedulerTest> const& tests)
+{
+  std::map<int, std::vector<int>> dependents;
+  for (auto const& t : tests) {
+    for (int dependency : t.second.Depends) {
+      if (tests.count(dependency)) {
+        dependents[dependency].push_back(t.first);
+      }
+    }
+  }
+  return dependents;
+}
+}
+
+std::vector<int> cmCTestSortByCriticalPath(
+  std::map<int, cmCTestSchedulerTest> const& tests)
+{
+  std::map<int, std::vector<int>> dependents = GetDependents(tests);
+
+  // Rank each test after all tests that depend on it, starting with the
+  // tests that no other test depends on.
+  std::map<int, std::size_t> unranked;
+  std::vector<int> ready;
+  for (auto const& t : tests) {
+    std::size_t const count = dependents[t.first].size();
+    unranked[t.first] = count;
+    if (count == 0) {
+      ready.push_back(t.first);
+    }
+  }
+  std::map<int, RankT> ranks;
+  while (!ready.empty()) {
+    int const test = ready.back();
+    ready.pop_back();
+    cmCTestSchedulerTest const& info = tests.at(test);
+    RankT& rank = ranks[test];
+    for (int dependent : dependents[test]) {
+      RankT const& dependentRank = ranks[dependent];
+      rank.PathCost = std::max(rank.PathCost, dependentRank.PathCost);
+      rank.Depth = std::max(rank.Depth, dependentRank.Depth);
+    }
+    double const cost = TestCost(info);
+    rank.PathCost += cost;
+    rank.Depth += 1;
+    rank.Area = cost *
+      static_cast<double>(std::max(info.Processors, info.ResourceGroups));
+    for (int dependency : info.Depends) {
+      auto u = unranked.find(dependency);
+      if (u != unranked.end() && --u->second == 0) {
+        ready.push_back(dependency);
+      }
+    }
+  }
+
+  // Tests in a dependency cycle are never ranked and go last.
+  std::vector<int> order;
+  order.reserve(tests.size());
+  for (auto const& t : tests) {
+    order.push_back(t.first);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    RankT const& rankA = ranks[a];
+    RankT const& rankB = ranks[b];
+    if (rankA.PathCost != rankB.PathCost) {
+      return rankA.PathCost > rankB.PathCost;
+    }
+    if (rankA.Area != rankB.Area) {
+      return rankA.Area > rankB.Area;
+    }
+    if (rankA.Depth != rankB.Depth) {
+      return rankA.Depth > rankB.Depth;
+    }
+    return tests.at(a).Cost > tests.at(b).Cost;
+  });
+  return order;
+}
+
+double cmCTestSimulateSchedule(
+  std::map<int, cmCTestSchedulerTest> const& tests,
+  std::vector<int> const& order, std::size_t parallelLevel)
+{
+  parallelLevel = std::max(parallelLevel, std::size_t(1));
+  std::map<int, std::vector<int>> dependents = GetDependents(tests);
+
+  std::map<int, std::size_t> waiting;
+  for (auto const& t : tests) {
+    std::size_t& count = waiting[t.first];
+    for (int dependency : t.second.Depends) {
+      count += tests.count(dependency);
+    }
+  }
+  auto processorsUsed = [&](int test) {
+    return std::min(tests.at(test).Processors, parallelLevel);
+  };
+
+  std::list<int> notStarted;
+  for (int test : order) {
+    if (tests.count(test)) {
+      notStarted.push_back(test);
+    }
+  }
+  using FinishT = std::pair<double, int>;
+  std::priority_queue<FinishT, std::vector<FinishT>, std::greater<FinishT>>
+    running;
+  std::size_t freeSlots = parallelLevel;
+  double now = 0;
+  for (;;) {
+    auto i = notStarted.begin();
+    while (i != notStarted.end() && freeSlots != 0) {
+      std::size_t const processors = processorsUsed(*i);
+      if (waiting[*i] == 0 && processors <= freeSlots) {
+        freeSlots -= processors;
+        running.emplace(now + TestCost(tests.at(*i)), *i);
+        i = notStarted.erase(i);
+      } else {
+        ++i;
+      }
+    }
+    if (running.empty()) {
+      break;
+    }
+
+    // Finish all tests that end at the next point in time.
+    now = running.top().first;
+    while (!running.empty() && running.top().first == now) {
+      int const test = running.top().second;
+      running.pop();
+      freeSlots += processorsUsed(test);
+      for (int dependent : dependents[test]) {
+        --waiting[dependent];
+      }
+    }
+  }
+  return now;
+}
+
+std::map<int, std::size_t> cmCTestAssignShards(
+  std::map<int, cmCTestSchedulerTest> const& tests, std::size_t shardCount)
+{
+  shardCount = std::max(shardCount, std::size_t(1));
+
+  // Join connected tests into groups named by their lowest test index.
+  std::map<int, int> parent;
+  for (auto const& t : tests) {
+    parent[t.first] = t.first;
+  }
+  auto findGroup = [&parent](int test) {
+    int group = test;
+    while (parent[group] != group) {
+      group = parent[group];
+    }
+    while (parent[test] != group) {
+      int const next = parent[test];
+      parent[test] = group;
+      test = next;
+    }
+    return group;
+  };
+  for (auto const& t : tests) {
+    for (int dependency : t.second.Depends) {
+      if (tests.count(dependency)) {
+        int const a = findGroup(t.first);
+        int const b = findGroup(dependency);
+        parent[std::max(a, b)] = std::min(a, b);
+      }
+    }
+  }
+  std::map<int, double> groupCosts;
+  for (auto const& t : tests) {
+    groupCosts[findGroup(t.first)] += TestCost(t.second);
+  }
+
+  std::vector<std::pair<double, int>> groups;
+  groups.reserve(groupCosts.size());
+  for (auto const& g : groupCosts) {
+    groups.emplace_back(g.second, g.first);
+  }
+  std::stable_sort(groups.begin(), groups.end(),
+                   [](std::pair<double, int> const& a,
+                      std::pair<double, int> const& b) {
+                     return a.first > b.first;
+                   });
+
+  std::vector<double> shardCosts(shardCount, 0);
+  std::map<int, std::size_t> groupShards;
+  for (auto const& g : groups) {
+    auto const shard = static_cast<std::size_t>(std::distance(
+      shardCosts.begin(),
+      std::min_element(shardCosts.begin(), shardCosts.end())));
+    shardCosts[shard] += g.first;
+    groupShards[g.second] = shard;
+  }
+
+  std::map<int, std::size_t> shards;
+  for (auto const& t : tests) {
+    shards[t.first] = groupShards[findGroup(t.first)];
+  }
+  return shards;
+}
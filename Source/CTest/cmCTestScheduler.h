@@ -0,0 +1,60 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmCTestScheduler_h
+#define cmCTestScheduler_h
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <vector>
+
+/** A test as seen by the parallel test scheduler.  */
+struct cmCTestSchedulerTest
+{
+  //! Expected run time, from COST or the recorded cost data
+  float Cost = 0;
+  //! Number of ctest -j slots the test occupies while running
+  std::size_t Processors = 1;
+  //! Number of processes described by the RESOURCE_GROUPS property
+  std::size_t ResourceGroups = 0;
+  //! Tests that must finish before this one starts
+  std::set<int> Depends;
+};
+
+/**
+ * Order tests for a parallel run by the length of the longest chain of
+ * dependent tests that each of them starts, measured in cost.  A long
+ * chain then starts early instead of finishing the run on its own.
+ *
+ * Ties are broken by the cost of the test multiplied by the number of
+ * processors or resource groups it reserves, so that wide tests start
+ * while there is still room for them, then by the number of tests in
+ * the chain, then by cost, then by test index.
+ */
+std::vector<int> cmCTestSortByCriticalPath(
+  std::map<int, cmCTestSchedulerTest> const& tests);
+
+/**
+ * Simulate a parallel run that starts the tests as ctest does: whenever
+ * slots are free, it starts the first tests in the given order whose
+ * dependencies have finished and that fit into the free slots.  Returns
+ * the time at which the last test finishes.
+ */
+double cmCTestSimulateSchedule(
+  std::map<int, cmCTestSchedulerTest> const& tests,
+  std::vector<int> const& order, std::size_t parallelLevel);
+
+/**
+ * Partition tests into the given number of shards of about equal total
+ * cost.  Tests connected by dependencies in either direction are kept on
+ * the same shard.  The groups of connected tests are assigned from the
+ * most to the least expensive, each to the shard with the lowest total
+ * cost so far, ties going to the group with the lowest test index and the
+ * shard with the lowest index.  The result therefore only depends on the
+ * tests, their costs and the number of shards.  Returns the shard of
+ * each test.
+ */
+std::map<int, std::size_t> cmCTestAssignShards(
+  std::map<int, cmCTestSchedulerTest> const& tests, std::size_t shardCount);
+
+#endif
@@ -16,6 +16,7 @@
 #include <set>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 #include <cm/memory>
 
@@ -25,11 +26,14 @@
 #include <cmsys/RegularExpression.hxx>
 
 #include "cm_utf8.h"
+#include "cm_zlib.h"
 
 #include "cmAlgorithms.h"
 #include "cmCTest.h"
 #include "cmCTestMultiProcessHandler.h"
+#include "cmCTestOutputBuffer.h"
 #include "cmCTestResourceGroupsLexerHelper.h"
+#include "cmCTestScheduler.h"
 #include "cmDuration.h"
 #include "cmExecutionStatus.h"
 #include "cmGeneratedFileStream.h"
@@ -45,6 +49,59 @@
 
 namespace {
 
+/** Length of the base64 encoding of a buffer, with the end marker that
+    cmsysBase64_Encode appends after a whole number of groups.  */
+std::size_t Base64Length(std::size_t length)
+{
+  return (length + 2) / 3 * 4 + (length % 3 == 0 ? 4 : 0);
+}
+
+/** Compress a file like cmCTest::CompressString before its base64
+    encoding, reading it chunk by chunk.  */
+bool DeflateFile(std::string const& file, std::string& compressed,
+                 std::size_t& size)
+{
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  if (deflateInit(&strm, -1) != Z_OK) { // default compression level
+    return false;
+  }
+
+  bool ok = true;
+  unsigned char out[16384];
+  auto deflateChunk = [&](std::string const& chunk, int flush) {
+    strm.next_in =
+      reinterpret_cast<unsigned char*>(const_cast<char*>(chunk.data()));
+    strm.avail_in = static_cast<uInt>(chunk.size());
+    do {
+      strm.next_out = out;
+      strm.avail_out = sizeof(out);
+      if (deflate(&strm, flush) == Z_STREAM_ERROR) {
+        ok = false;
+        return;
+      }
+      compressed.append(reinterpret_cast<char*>(out),
+                        sizeof(out) - strm.avail_out);
+    } while (strm.avail_out == 0);
+  };
+
+  size = 0;
+  bool const read = cmCTestOutputBuffer::ReadFile(
+    file, [&](std::string const& chunk) {
+      size += chunk.size();
+      if (ok) {
+        deflateChunk(chunk, Z_NO_FLUSH);
+      }
+    });
+  if (ok) {
+    deflateChunk(std::string(), Z_FINISH);
+  }
+  (void)deflateEnd(&strm);
+  return read && ok;
+}
+
 class cmCTestCommand
 {
 public:
@@ -340,6 +397,8 @@ void cmCTestTestHandler::Initialize()
   TestsToRunString.clear();
   this->UseUnion = false;
   this->TestList.clear();
+  this->ShardIndex = 0;
+  this->ShardCount = 0;
 }
 
 void cmCTestTestHandler::PopulateCustomVectors(cmMakefile* mf)
@@ -451,7 +510,13 @@ int cmCTestTestHandler::ProcessHandler()
     this->LogFailedTests(failed, resultsSet);
   }
 
-  if (!this->GenerateXML()) {
+  bool const xmlGenerated = this->GenerateXML();
+  for (cmCTestTestResult const& result : this->TestResults) {
+    if (!result.OutputFile.empty()) {
+      cmSystemTools::RemoveFile(result.OutputFile);
+    }
+  }
+  if (!xmlGenerated) {
     return 1;
   }
 
@@ -545,6 +610,26 @@ bool cmCTestTestHandler::ProcessOptions()
   }
   this->SetRerunFailed(cmIsOn(this->GetOption("RerunFailed")));
 
+  const char* shardIndex = this->GetOption("ShardIndex");
+  const char* shardCount = this->GetOption("ShardCount");
+  if (shardIndex || shardCount) {
+    if (!shardIndex || !shardCount) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Both '--shard-index' and '--shard-count' must be given"
+                   << std::endl);
+      return false;
+    }
+    // cmCTest validates the values
+    cmStrToULong(shardIndex, &this->ShardIndex);
+    cmStrToULong(shardCount, &this->ShardCount);
+    if (this->ShardIndex >= this->ShardCount) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "'--shard-index' must be less than '--shard-count'"
+                   << std::endl);
+      return false;
+    }
+  }
+
   val = this->GetOption("ResourceSpecFile");
   if (val) {
     this->UseResourceSpec = true;
@@ -877,6 +962,7 @@ void cmCTestTestHandler::ComputeTestList()
   }
 
   UpdateForFixtures(finalList);
+  this->ShardTestList(finalList);
 
   // Save the total number of tests before exclusions
   this->TotalNumberOfTests = this->TestList.size();
@@ -905,6 +991,7 @@ void cmCTestTestHandler::ComputeTestListForRerunFailed()
   }
 
   UpdateForFixtures(finalList);
+  this->ShardTestList(finalList);
 
   // Save the total number of tests before exclusions
   this->TotalNumberOfTests = this->TestList.size();
@@ -1147,6 +1234,75 @@ void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
                      this->Quiet);
 }
 
+void cmCTestTestHandler::ShardTestList(ListOfTests& tests) const
+{
+  if (this->ShardCount == 0) {
+    return;
+  }
+
+  // Use the costs recorded by previous runs.  Tests without a recorded
+  // cost are assumed to take as long as an average recorded test.
+  std::map<std::string, float> recordedCosts;
+  std::string const fname = this->CTest->GetCostDataFile();
+  cmsys::ifstream fin(fname.c_str());
+  std::string line;
+  while (std::getline(fin, line) && line != "---") {
+    std::vector<std::string> parts = cmSystemTools::SplitString(line, ' ');
+    if (parts.size() < 3) {
+      break;
+    }
+    recordedCosts[parts[0]] = static_cast<float>(atof(parts[2].c_str()));
+  }
+  double totalCost = 0;
+  int recorded = 0;
+  std::map<std::string, int> indexByName;
+  for (cmCTestTestProperties const& p : tests) {
+    indexByName[p.Name] = p.Index;
+    auto cost = recordedCosts.find(p.Name);
+    if (cost != recordedCosts.end()) {
+      totalCost += cost->second;
+      ++recorded;
+    }
+  }
+  float const defaultCost =
+    recorded ? static_cast<float>(totalCost / recorded) : 1.0f;
+
+  // Fixture setup and cleanup tests are dependencies by now, so both they
+  // and the DEPENDS closure of each test stay on its shard.
+  std::map<int, cmCTestSchedulerTest> schedulerTests;
+  for (cmCTestTestProperties const& p : tests) {
+    cmCTestSchedulerTest& test = schedulerTests[p.Index];
+    auto cost = recordedCosts.find(p.Name);
+    if (p.Cost > 0) {
+      test.Cost = p.Cost;
+    } else if (cost != recordedCosts.end()) {
+      test.Cost = cost->second;
+    } else {
+      test.Cost = defaultCost;
+    }
+    for (std::string const& depend : p.Depends) {
+      auto dependency = indexByName.find(depend);
+      if (dependency != indexByName.end()) {
+        test.Depends.insert(dependency->second);
+      }
+    }
+  }
+  std::map<int, std::size_t> const shards =
+    cmCTestAssignShards(schedulerTests, this->ShardCount);
+
+  std::size_t const total = tests.size();
+  tests.erase(std::remove_if(tests.begin(), tests.end(),
+                             [&](cmCTestTestProperties const& p) {
+                               return shards.at(p.Index) != this->ShardIndex;
+                             }),
+              tests.end());
+  cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                     "Shard " << this->ShardIndex << " of "
+                              << this->ShardCount << " has " << tests.size()
+                              << " of " << total << " tests" << std::endl,
+                     this->Quiet);
+}
+
 void cmCTestTestHandler::UpdateMaxTestNameWidth()
 {
   std::string::size_type max = this->CTest->GetMaxTestNameWidth();
@@ -1431,11 +1587,15 @@ void cmCTestTestHandler::GenerateDartOutput(cmXMLWriter& xml)
     }
     xml.StartElement("Measurement");
     xml.StartElement("Value");
-    if (result.CompressOutput) {
-      xml.Attribute("encoding", "base64");
-      xml.Attribute("compression", "gzip");
+    if (!result.OutputFile.empty()) {
+      this->WriteTestOutputFile(xml, result.OutputFile);
+    } else {
+      if (result.CompressOutput) {
+        xml.Attribute("encoding", "base64");
+        xml.Attribute("compression", "gzip");
+      }
+      xml.Content(result.Output);
     }
-    xml.Content(result.Output);
     xml.EndElement(); // Value
     xml.EndElement(); // Measurement
     xml.EndElement(); // Results
@@ -1454,6 +1614,38 @@ void cmCTestTestHandler::GenerateDartOutput(cmXMLWriter& xml)
   this->CTest->EndXML(xml);
 }
 
+void cmCTestTestHandler::WriteTestOutputFile(cmXMLWriter& xml,
+                                             std::string const& file)
+{
+  if (this->CTest->ShouldCompressTestOutput()) {
+    // Only the compressed output is held in memory.
+    std::string compressed;
+    std::size_t size = 0;
+    if (DeflateFile(file, compressed, size) &&
+        Base64Length(compressed.size()) < size) {
+      xml.Attribute("encoding", "base64");
+      xml.Attribute("compression", "gzip");
+      // Encode whole groups of three bytes so that the chunks concatenate.
+      std::size_t const chunkSize = 3 * 16384;
+      std::vector<unsigned char> encoded(Base64Length(chunkSize));
+      for (std::size_t pos = 0; pos < compressed.size(); pos += chunkSize) {
+        std::size_t const length =
+          std::min(chunkSize, compressed.size() - pos);
+        bool const last = pos + length == compressed.size();
+        std::size_t const encodedLength = cmsysBase64_Encode(
+          reinterpret_cast<unsigned char const*>(compressed.data() + pos),
+          length, encoded.data(), last ? 1 : 0);
+        xml.Content(std::string(reinterpret_cast<char*>(encoded.data()),
+                                encodedLength));
+      }
+      return;
+    }
+  }
+  // Stream the output to the XML file without holding it in memory.
+  cmCTestOutputBuffer::ReadFile(
+    file, [&xml](std::string const& chunk) { xml.Content(chunk); });
+}
+
 void cmCTestTestHandler::WriteTestResultHeader(cmXMLWriter& xml,
                                                cmCTestTestResult const& result)
 {
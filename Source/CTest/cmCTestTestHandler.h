@@ -176,6 +176,8 @@ public:
     bool CompressOutput;
     std::string CompletionStatus;
     std::string Output;
+    // File with the complete output, used instead of Output if not empty
+    std::string OutputFile;
     std::string DartString;
     int TestCount;
     cmCTestTestProperties* Properties;
@@ -227,6 +229,7 @@ protected:
                       const SetOfTests& resultsSet);
   bool GenerateXML();
 
+  void WriteTestOutputFile(cmXMLWriter& xml, std::string const& file);
   void WriteTestResultHeader(cmXMLWriter& xml,
                              cmCTestTestResult const& result);
   void WriteTestResultFooter(cmXMLWriter& xml,
@@ -298,6 +301,10 @@ private:
   // tests to account for fixture setup/cleanup
   void UpdateForFixtures(ListOfTests& tests) const;
 
+  // keep only the tests of the selected shard, balanced by the recorded
+  // test costs and keeping tests that depend on each other together
+  void ShardTestList(ListOfTests& tests) const;
+
   void UpdateMaxTestNameWidth();
 
   bool GetValue(const char* tag, std::string& value, std::istream& fin);
@@ -357,6 +364,8 @@ private:
   cmCTest::Repeat RepeatMode = cmCTest::Repeat::Never;
   int RepeatCount = 1;
   bool RerunFailed;
+  unsigned long ShardIndex = 0;
+  unsigned long ShardCount = 0;
 };
 
 #endif
@@ -21,6 +21,8 @@
 #endif
 
 #define CM_PROCESS_BUF_SIZE 65536
+// Longest partial line to keep before passing it on without a line end
+#define CM_PROCESS_MAX_PARTIAL_LINE (1024 * 1024)
 
 cmProcess::cmProcess(std::unique_ptr<cmCTestRunTest> runner)
   : Runner(std::move(runner))
@@ -194,6 +196,26 @@ bool cmProcess::Buffer::GetLine(std::string& line)
   return false;
 }
 
+bool cmProcess::Buffer::GetPartial(std::string& text, size_type maxSize)
+{
+  // Keep short partial lines until their end arrives.
+  if (this->First != 0 || this->size() <= maxSize) {
+    return false;
+  }
+  // Keep carriage returns that may precede the line end.
+  size_type length = this->size();
+  while (length && (*this)[length - 1] == '\r') {
+    length--;
+  }
+  if (!length) {
+    return false;
+  }
+  text.assign(this->data(), length);
+  this->erase(this->begin(), this->begin() + length);
+  this->Last = this->size();
+  return true;
+}
+
 bool cmProcess::Buffer::GetLast(std::string& line)
 {
   // Return the partial last line, if any.
@@ -226,6 +248,11 @@ void cmProcess::OnRead(ssize_t nread, const uv_buf_t* buf)
       line.clear();
     }
 
+    // Do not hold an endless line in memory.
+    if (this->Output.GetPartial(line, CM_PROCESS_MAX_PARTIAL_LINE)) {
+      this->Runner->CheckOutput(line, false);
+    }
+
     return;
   }
 
@@ -122,6 +122,7 @@ private:
     {
     }
     bool GetLine(std::string& line);
+    bool GetPartial(std::string& text, size_type maxSize);
     bool GetLast(std::string& line);
   };
   Buffer Output;
@@ -0,0 +1,133 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmBinaryCache.h"
+
+#include <ios>
+#include <iterator>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmGeneratedFileStream.h"
+
+namespace cmBinaryCache {
+
+bool ReadFile(std::string const& fileName, cm::string_view magic,
+              std::string& data)
+{
+  data.clear();
+  {
+    cmsys::ifstream fin(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!fin) {
+      return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(fin),
+                std::istreambuf_iterator<char>());
+  }
+  if (data.compare(0, magic.size(), magic.data(), magic.size()) != 0) {
+    data.clear();
+    return false;
+  }
+  data.erase(0, magic.size());
+  return true;
+}
+
+bool WriteFile(std::string const& fileName, cm::string_view magic,
+               std::string const& data)
+{
+  cmGeneratedFileStream fout;
+  fout.Open(fileName, true, true);
+  if (!fout) {
+    return false;
+  }
+  fout.write(magic.data(), static_cast<std::streamsize>(magic.size()));
+  fout.write(data.data(), static_cast<std::streamsize>(data.size()));
+  return fout.Close();
+}
+
+Reader::Reader(std::string const& data)
+  : Cur(data.data())
+  , End(data.data() + data.size())
+{
+}
+
+bool Reader::ReadUInt(std::uint32_t& value)
+{
+  if (this->End - this->Cur < 4) {
+    return false;
+  }
+  value = 0;
+  for (int i = 0; i < 4; ++i) {
+    value |= static_cast<std::uint32_t>(
+               static_cast<unsigned char>(*this->Cur++))
+      << (8 * i);
+  }
+  return true;
+}
+
+bool Reader::ReadTime(long long& value)
+{
+  std::uint32_t low;
+  std::uint32_t high;
+  if (!this->ReadUInt(low) || !this->ReadUInt(high)) {
+    return false;
+  }
+  value =
+    static_cast<long long>((static_cast<std::uint64_t>(high) << 32) | low);
+  return true;
+}
+
+bool Reader::ReadString(std::string& value)
+{
+  std::uint32_t size;
+  if (!this->ReadUInt(size) ||
+      static_cast<std::uint32_t>(this->End - this->Cur) < size) {
+    return false;
+  }
+  value.assign(this->Cur, size);
+  this->Cur += size;
+  return true;
+}
+
+bool Reader::ReadStrings(std::vector<std::string>& values)
+{
+  std::uint32_t size;
+  if (!this->ReadUInt(size)) {
+    return false;
+  }
+  values.resize(size);
+  for (std::string& value : values) {
+    if (!this->ReadString(value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void WriteUInt(std::string& out, std::uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+void WriteTime(std::string& out, long long value)
+{
+  auto const bits = static_cast<std::uint64_t>(value);
+  WriteUInt(out, static_cast<std::uint32_t>(bits & 0xffffffff));
+  WriteUInt(out, static_cast<std::uint32_t>(bits >> 32));
+}
+
+void WriteString(std::string& out, std::string const& value)
+{
+  WriteUInt(out, static_cast<std::uint32_t>(value.size()));
+  out += value;
+}
+
+void WriteStrings(std::string& out, std::vector<std::string> const& values)
+{
+  WriteUInt(out, static_cast<std::uint32_t>(values.size()));
+  for (std::string const& value : values) {
+    WriteString(out, value);
+  }
+}
+}
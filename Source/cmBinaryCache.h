@@ -0,0 +1,54 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmBinaryCache_h
+#define cmBinaryCache_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cm/string_view>
+
+/** Helpers for cache files of length-prefixed binary values.
+ *
+ * A cache file starts with a magic string that names its layout and
+ * version.  Integers are stored as little-endian 32-bit values, times as
+ * two of them, and strings as their length followed by their bytes.
+ */
+namespace cmBinaryCache {
+
+/** Read a cache file and return its content after the magic string.
+    Returns false if the file cannot be read or starts differently.  */
+bool ReadFile(std::string const& fileName, cm::string_view magic,
+              std::string& data);
+
+/** Replace a cache file by the magic string followed by the data.  */
+bool WriteFile(std::string const& fileName, cm::string_view magic,
+               std::string const& data);
+
+/** Reader of the values appended to a string by the Write functions.
+    Each Read function returns false when the data is truncated.  */
+class Reader
+{
+public:
+  Reader(std::string const& data);
+
+  bool ReadUInt(std::uint32_t& value);
+  bool ReadTime(long long& value);
+  bool ReadString(std::string& value);
+  bool ReadStrings(std::vector<std::string>& values);
+
+private:
+  const char* Cur;
+  const char* End;
+};
+
+void WriteUInt(std::string& out, std::uint32_t value);
+void WriteTime(std::string& out, long long value);
+void WriteString(std::string& out, std::string const& value);
+void WriteStrings(std::string& out, std::vector<std::string> const& values);
+}
+
+#endif
@@ -44,6 +44,7 @@ bool cmCMakeHostSystemInformationCommand(std::vector<std::string> const& args,
     status.SetError("missing QUERY specification");
     return false;
   }
+  status.GetMakefile().MarkGenerateFingerprintIncomplete();
 
   cmsys::SystemInformation info;
   info.RunCPUCheck();
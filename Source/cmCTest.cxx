@@ -2154,6 +2154,39 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     this->GetTestHandler()->SetPersistentOption("RerunFailed", "true");
     this->GetMemCheckHandler()->SetPersistentOption("RerunFailed", "true");
   }
+
+  if (this->CheckArgument(arg, "--shard-index")) {
+    if (i >= args.size() - 1) {
+      errormsg = "'--shard-index' requires an argument";
+      return false;
+    }
+    i++;
+    unsigned long index;
+    if (!cmStrToULong(args[i], &index)) {
+      errormsg = "'--shard-index' given invalid value '" + args[i] + "'";
+      return false;
+    }
+    this->GetTestHandler()->SetPersistentOption("ShardIndex",
+                                                args[i].c_str());
+    this->GetMemCheckHandler()->SetPersistentOption("ShardIndex",
+                                                    args[i].c_str());
+  }
+  if (this->CheckArgument(arg, "--shard-count")) {
+    if (i >= args.size() - 1) {
+      errormsg = "'--shard-count' requires an argument";
+      return false;
+    }
+    i++;
+    unsigned long count;
+    if (!cmStrToULong(args[i], &count) || count == 0) {
+      errormsg = "'--shard-count' given invalid value '" + args[i] + "'";
+      return false;
+    }
+    this->GetTestHandler()->SetPersistentOption("ShardCount",
+                                                args[i].c_str());
+    this->GetMemCheckHandler()->SetPersistentOption("ShardCount",
+                                                    args[i].c_str());
+  }
   return true;
 }
 
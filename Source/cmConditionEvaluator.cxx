@@ -2,13 +2,18 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmConditionEvaluator.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
+#include <initializer_list>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
 
+#include <cm/memory>
+
 #include <cmext/algorithm>
 
 #include "cmsys/RegularExpression.hxx"
@@ -56,6 +61,410 @@ static std::string const keyVERSION_GREATER_EQUAL = "VERSION_GREATER_EQUAL";
 static std::string const keyVERSION_LESS = "VERSION_LESS";
 static std::string const keyVERSION_LESS_EQUAL = "VERSION_LESS_EQUAL";
 
+enum class cmConditionCache::Keyword
+{
+  None,
+  AND,
+  COMMAND,
+  DEFINED,
+  EQUAL,
+  EXISTS,
+  GREATER,
+  GREATER_EQUAL,
+  IN_LIST,
+  IS_ABSOLUTE,
+  IS_DIRECTORY,
+  IS_NEWER_THAN,
+  IS_SYMLINK,
+  LESS,
+  LESS_EQUAL,
+  MATCHES,
+  NOT,
+  OR,
+  ParenL,
+  ParenR,
+  POLICY,
+  STREQUAL,
+  STRGREATER,
+  STRGREATER_EQUAL,
+  STRLESS,
+  STRLESS_EQUAL,
+  TARGET,
+  TEST,
+  VERSION_EQUAL,
+  VERSION_GREATER,
+  VERSION_GREATER_EQUAL,
+  VERSION_LESS,
+  VERSION_LESS_EQUAL
+};
+
+using Keyword = cmConditionCache::Keyword;
+
+static Keyword LookupKeyword(std::string const& value)
+{
+  static std::unordered_map<std::string, Keyword> const keywords = {
+    { keyAND, Keyword::AND },
+    { keyCOMMAND, Keyword::COMMAND },
+    { keyDEFINED, Keyword::DEFINED },
+    { keyEQUAL, Keyword::EQUAL },
+    { keyEXISTS, Keyword::EXISTS },
+    { keyGREATER, Keyword::GREATER },
+    { keyGREATER_EQUAL, Keyword::GREATER_EQUAL },
+    { keyIN_LIST, Keyword::IN_LIST },
+    { keyIS_ABSOLUTE, Keyword::IS_ABSOLUTE },
+    { keyIS_DIRECTORY, Keyword::IS_DIRECTORY },
+    { keyIS_NEWER_THAN, Keyword::IS_NEWER_THAN },
+    { keyIS_SYMLINK, Keyword::IS_SYMLINK },
+    { keyLESS, Keyword::LESS },
+    { keyLESS_EQUAL, Keyword::LESS_EQUAL },
+    { keyMATCHES, Keyword::MATCHES },
+    { keyNOT, Keyword::NOT },
+    { keyOR, Keyword::OR },
+    { keyParenL, Keyword::ParenL },
+    { keyParenR, Keyword::ParenR },
+    { keyPOLICY, Keyword::POLICY },
+    { keySTREQUAL, Keyword::STREQUAL },
+    { keySTRGREATER, Keyword::STRGREATER },
+    { keySTRGREATER_EQUAL, Keyword::STRGREATER_EQUAL },
+    { keySTRLESS, Keyword::STRLESS },
+    { keySTRLESS_EQUAL, Keyword::STRLESS_EQUAL },
+    { keyTARGET, Keyword::TARGET },
+    { keyTEST, Keyword::TEST },
+    { keyVERSION_EQUAL, Keyword::VERSION_EQUAL },
+    { keyVERSION_GREATER, Keyword::VERSION_GREATER },
+    { keyVERSION_GREATER_EQUAL, Keyword::VERSION_GREATER_EQUAL },
+    { keyVERSION_LESS, Keyword::VERSION_LESS },
+    { keyVERSION_LESS_EQUAL, Keyword::VERSION_LESS_EQUAL },
+  };
+  auto i = keywords.find(value);
+  return i != keywords.end() ? i->second : Keyword::None;
+}
+
+//=========================================================================
+// A compiled condition.  It records the reductions that HandleLevel0
+// through HandleLevel4 perform for a given shape of arguments.  Each
+// reduction reads the values of the arguments at given positions and
+// stores its result at the position of its first argument, like the
+// reductions of the argument list do.  The AND and OR reductions come
+// last and form a tree that is evaluated with short-circuiting.
+struct cmConditionCache::Program
+{
+  enum class StepType
+  {
+    Group,
+    Predicate,
+    Matches,
+    False,
+    BinaryOp,
+    Not
+  };
+
+  struct Step
+  {
+    StepType Type;
+    Keyword Op;
+    std::size_t Slot;
+    std::size_t Operand;
+    std::unique_ptr<Program> Group;
+  };
+
+  // An AND or OR reduction.  Operands refer to another node if they
+  // are not negative and to the position ~operand otherwise.
+  struct Node
+  {
+    Keyword Op;
+    long Lhs;
+    long Rhs;
+  };
+
+  struct Token
+  {
+    std::size_t Slot;
+    Keyword Kw;
+  };
+  using TokenList = std::list<Token>;
+
+  static std::unique_ptr<Program> Compile(TokenList tokens,
+                                          bool policy57New,
+                                          bool policy64New);
+
+  bool CompileLevel0(TokenList& tokens, bool policy57New, bool policy64New);
+  void CompileLevel1(TokenList& tokens, bool policy64New);
+  void CompileLevel2(TokenList& tokens, bool policy57New);
+  void CompileLevel3(TokenList& tokens);
+  void CompileLevel4(TokenList& tokens);
+
+  void AddStep(StepType type, Keyword op, std::size_t slot,
+               std::size_t operand)
+  {
+    this->Steps.push_back({ type, op, slot, operand, nullptr });
+  }
+
+  // Whether the condition has no arguments at all.
+  bool Empty = false;
+  std::vector<Step> Steps;
+  std::vector<Node> Nodes;
+  // The position of the argument left after all reductions and the
+  // node that produced it, if any.
+  std::size_t Result = 0;
+  long ResultNode = -1;
+};
+
+cmConditionCache::cmConditionCache() = default;
+
+cmConditionCache::~cmConditionCache() = default;
+
+namespace {
+using TokenList = cmConditionCache::Program::TokenList;
+
+// Mirror cmConditionEvaluator::IncrementArguments.
+void IncrementTokens(TokenList& tokens, TokenList::iterator& argP1,
+                     TokenList::iterator& argP2)
+{
+  if (argP1 != tokens.end()) {
+    argP1++;
+    argP2 = argP1;
+    if (argP1 != tokens.end()) {
+      argP2++;
+    }
+  }
+}
+
+// Mirror cmConditionEvaluator::HandlePredicate.
+void ReducePredicate(TokenList& tokens, TokenList::iterator& arg,
+                     TokenList::iterator& argP1, TokenList::iterator& argP2,
+                     int& reducible)
+{
+  // The result is a quoted "0" or "1", which is never a keyword.
+  arg->Kw = Keyword::None;
+  tokens.erase(argP1);
+  argP1 = arg;
+  IncrementTokens(tokens, argP1, argP2);
+  reducible = 1;
+}
+
+// Mirror cmConditionEvaluator::HandleBinaryOp.
+void ReduceBinaryOp(TokenList& tokens, TokenList::iterator& arg,
+                    TokenList::iterator& argP1, TokenList::iterator& argP2,
+                    int& reducible)
+{
+  arg->Kw = Keyword::None;
+  tokens.erase(argP2);
+  tokens.erase(argP1);
+  argP1 = arg;
+  IncrementTokens(tokens, argP1, argP2);
+  reducible = 1;
+}
+
+bool IsOneOf(Keyword kw, std::initializer_list<Keyword> keywords)
+{
+  return std::find(keywords.begin(), keywords.end(), kw) != keywords.end();
+}
+}
+
+std::unique_ptr<cmConditionCache::Program> cmConditionCache::Program::Compile(
+  TokenList tokens, bool policy57New, bool policy64New)
+{
+  auto program = cm::make_unique<Program>();
+  if (tokens.empty()) {
+    program->Empty = true;
+    return program;
+  }
+  // Conditions with syntax errors are left to the argument reduction,
+  // which reports them.
+  if (!program->CompileLevel0(tokens, policy57New, policy64New)) {
+    return nullptr;
+  }
+  program->CompileLevel1(tokens, policy64New);
+  program->CompileLevel2(tokens, policy57New);
+  program->CompileLevel3(tokens);
+  program->CompileLevel4(tokens);
+  if (tokens.size() != 1) {
+    return nullptr;
+  }
+  program->Result = tokens.front().Slot;
+  return program;
+}
+
+bool cmConditionCache::Program::CompileLevel0(TokenList& tokens,
+                                              bool policy57New,
+                                              bool policy64New)
+{
+  auto arg = tokens.begin();
+  while (arg != tokens.end()) {
+    if (arg->Kw == Keyword::ParenL) {
+      auto argClose = arg;
+      argClose++;
+      unsigned int depth = 1;
+      while (argClose != tokens.end() && depth) {
+        if (argClose->Kw == Keyword::ParenL) {
+          depth++;
+        }
+        if (argClose->Kw == Keyword::ParenR) {
+          depth--;
+        }
+        argClose++;
+      }
+      if (depth) {
+        return false;
+      }
+      auto argP1 = arg;
+      argP1++;
+      TokenList group(argP1, argClose);
+      group.pop_back();
+      std::unique_ptr<Program> program =
+        Compile(std::move(group), policy57New, policy64New);
+      if (!program) {
+        return false;
+      }
+      this->AddStep(StepType::Group, Keyword::None, arg->Slot, 0);
+      this->Steps.back().Group = std::move(program);
+      arg->Kw = Keyword::None;
+      tokens.erase(argP1, argClose);
+    }
+    ++arg;
+  }
+  return true;
+}
+
+void cmConditionCache::Program::CompileLevel1(TokenList& tokens,
+                                              bool policy64New)
+{
+  int reducible;
+  do {
+    reducible = 0;
+    auto arg = tokens.begin();
+    TokenList::iterator argP1;
+    TokenList::iterator argP2;
+    while (arg != tokens.end()) {
+      argP1 = arg;
+      IncrementTokens(tokens, argP1, argP2);
+      for (Keyword kw :
+           { Keyword::EXISTS, Keyword::IS_DIRECTORY, Keyword::IS_SYMLINK,
+             Keyword::IS_ABSOLUTE, Keyword::COMMAND, Keyword::POLICY,
+             Keyword::TARGET, Keyword::TEST, Keyword::DEFINED }) {
+        if (kw == Keyword::TEST && !policy64New) {
+          continue;
+        }
+        if (arg->Kw == kw && argP1 != tokens.end()) {
+          this->AddStep(StepType::Predicate, kw, arg->Slot, argP1->Slot);
+          ReducePredicate(tokens, arg, argP1, argP2, reducible);
+        }
+      }
+      ++arg;
+    }
+  } while (reducible);
+}
+
+void cmConditionCache::Program::CompileLevel2(TokenList& tokens,
+                                              bool policy57New)
+{
+  int reducible;
+  do {
+    reducible = 0;
+    auto arg = tokens.begin();
+    TokenList::iterator argP1;
+    TokenList::iterator argP2;
+    while (arg != tokens.end()) {
+      argP1 = arg;
+      IncrementTokens(tokens, argP1, argP2);
+      if (argP1 != tokens.end() && argP2 != tokens.end() &&
+          argP1->Kw == Keyword::MATCHES) {
+        this->AddStep(StepType::Matches, Keyword::MATCHES, arg->Slot,
+                      argP2->Slot);
+        ReduceBinaryOp(tokens, arg, argP1, argP2, reducible);
+      }
+
+      if (argP1 != tokens.end() && arg->Kw == Keyword::MATCHES) {
+        this->AddStep(StepType::False, Keyword::MATCHES, arg->Slot, 0);
+        ReducePredicate(tokens, arg, argP1, argP2, reducible);
+      }
+
+      for (auto const& ops :
+           { std::initializer_list<Keyword>{
+               Keyword::LESS, Keyword::LESS_EQUAL, Keyword::GREATER,
+               Keyword::GREATER_EQUAL, Keyword::EQUAL },
+             std::initializer_list<Keyword>{
+               Keyword::STRLESS, Keyword::STRLESS_EQUAL, Keyword::STRGREATER,
+               Keyword::STRGREATER_EQUAL, Keyword::STREQUAL },
+             std::initializer_list<Keyword>{
+               Keyword::VERSION_LESS, Keyword::VERSION_LESS_EQUAL,
+               Keyword::VERSION_GREATER, Keyword::VERSION_GREATER_EQUAL,
+               Keyword::VERSION_EQUAL },
+             std::initializer_list<Keyword>{ Keyword::IS_NEWER_THAN },
+             std::initializer_list<Keyword>{ Keyword::IN_LIST } }) {
+        if (argP1 != tokens.end() && argP2 != tokens.end() &&
+            IsOneOf(argP1->Kw, ops)) {
+          if (argP1->Kw == Keyword::IN_LIST && !policy57New) {
+            continue;
+          }
+          this->AddStep(StepType::BinaryOp, argP1->Kw, arg->Slot,
+                        argP2->Slot);
+          ReduceBinaryOp(tokens, arg, argP1, argP2, reducible);
+        }
+      }
+
+      ++arg;
+    }
+  } while (reducible);
+}
+
+void cmConditionCache::Program::CompileLevel3(TokenList& tokens)
+{
+  int reducible;
+  do {
+    reducible = 0;
+    auto arg = tokens.begin();
+    TokenList::iterator argP1;
+    TokenList::iterator argP2;
+    while (arg != tokens.end()) {
+      argP1 = arg;
+      IncrementTokens(tokens, argP1, argP2);
+      if (argP1 != tokens.end() && arg->Kw == Keyword::NOT) {
+        this->AddStep(StepType::Not, Keyword::NOT, arg->Slot, argP1->Slot);
+        ReducePredicate(tokens, arg, argP1, argP2, reducible);
+      }
+      ++arg;
+    }
+  } while (reducible);
+}
+
+void cmConditionCache::Program::CompileLevel4(TokenList& tokens)
+{
+  // The node that last stored its result at each position.
+  std::unordered_map<std::size_t, long> nodes;
+  auto operand = [&nodes](std::size_t slot) -> long {
+    auto i = nodes.find(slot);
+    return i != nodes.end() ? i->second : ~static_cast<long>(slot);
+  };
+
+  int reducible;
+  do {
+    reducible = 0;
+    auto arg = tokens.begin();
+    TokenList::iterator argP1;
+    TokenList::iterator argP2;
+    while (arg != tokens.end()) {
+      argP1 = arg;
+      IncrementTokens(tokens, argP1, argP2);
+      for (Keyword kw : { Keyword::AND, Keyword::OR }) {
+        if (argP1 != tokens.end() && argP1->Kw == kw &&
+            argP2 != tokens.end()) {
+          this->Nodes.push_back(
+            { kw, operand(arg->Slot), operand(argP2->Slot) });
+          nodes[arg->Slot] = static_cast<long>(this->Nodes.size() - 1);
+          ReduceBinaryOp(tokens, arg, argP1, argP2, reducible);
+        }
+      }
+      ++arg;
+    }
+  } while (reducible);
+
+  if (tokens.size() == 1) {
+    this->ResultNode = operand(tokens.front().Slot);
+  }
+}
+
 cmConditionEvaluator::cmConditionEvaluator(cmMakefile& makefile,
                                            cmListFileContext context,
                                            cmListFileBacktrace bt)
@@ -96,6 +505,15 @@ bool cmConditionEvaluator::IsTrue(
     return false;
   }
 
+  // replay the compiled form of this condition, if it has one
+  if (cmConditionCache* cache =
+        this->Makefile.GetCMakeInstance()->GetConditionCache()) {
+    if (Program const* program = this->GetProgram(*cache, args)) {
+      std::vector<cmExpandedCommandArgument> values(args);
+      return this->RunProgram(*program, values, errorString, status);
+    }
+  }
+
   // store the reduced args in this vector
   cmArgumentList newArgs(args.begin(), args.end());
 
@@ -134,6 +552,305 @@ bool cmConditionEvaluator::IsTrue(
                                                   status, true);
 }
 
+//=========================================================================
+cmConditionEvaluator::Program const* cmConditionEvaluator::GetProgram(
+  cmConditionCache& cache,
+  std::vector<cmExpandedCommandArgument> const& args) const
+{
+  // Policies that are not set issue warnings from the reductions, so
+  // those conditions are always reduced directly.
+  auto isSet = [](cmPolicies::PolicyStatus status) {
+    return status == cmPolicies::OLD || status == cmPolicies::NEW;
+  };
+  if (!isSet(this->Policy12Status) || !isSet(this->Policy54Status) ||
+      !isSet(this->Policy57Status) || !isSet(this->Policy64Status)) {
+    return nullptr;
+  }
+  bool const policy54New = this->Policy54Status == cmPolicies::NEW;
+  bool const policy57New = this->Policy57Status == cmPolicies::NEW;
+  bool const policy64New = this->Policy64Status == cmPolicies::NEW;
+
+  Program::TokenList tokens;
+  std::string shape;
+  shape.reserve(args.size() + 1);
+  shape += static_cast<char>('0' + (policy57New ? 1 : 0) +
+                             (policy64New ? 2 : 0));
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    Keyword kw = Keyword::None;
+    if (!policy54New || !args[i].WasQuoted()) {
+      kw = LookupKeyword(args[i].GetValue());
+    }
+    tokens.push_back({ i, kw });
+    shape += static_cast<char>('A' + static_cast<int>(kw));
+  }
+
+  auto i = cache.Programs.find(shape);
+  if (i == cache.Programs.end()) {
+    i = cache.Programs
+          .emplace(std::move(shape),
+                   Program::Compile(std::move(tokens), policy57New,
+                                    policy64New))
+          .first;
+  }
+  return i->second.get();
+}
+
+//=========================================================================
+bool cmConditionEvaluator::RunProgram(
+  Program const& program, std::vector<cmExpandedCommandArgument>& values,
+  std::string& errorString, MessageType& status)
+{
+  errorString.clear();
+
+  if (program.Empty) {
+    return false;
+  }
+
+  auto store = [&values](std::size_t slot, bool value) {
+    values[slot] = cmExpandedCommandArgument(value ? "1" : "0", true);
+  };
+
+  for (Program::Step const& step : program.Steps) {
+    cmExpandedCommandArgument const& arg = values[step.Slot];
+    cmExpandedCommandArgument const& operand = values[step.Operand];
+    switch (step.Type) {
+      case Program::StepType::Group:
+        store(step.Slot,
+              this->RunProgram(*step.Group, values, errorString, status));
+        break;
+      case Program::StepType::Predicate:
+        store(step.Slot, this->EvaluatePredicate(step.Op, operand));
+        break;
+      case Program::StepType::Matches: {
+        bool result;
+        if (!this->EvaluateMatches(arg, operand, result, errorString,
+                                   status)) {
+          return false;
+        }
+        store(step.Slot, result);
+      } break;
+      case Program::StepType::False:
+        store(step.Slot, false);
+        break;
+      case Program::StepType::BinaryOp:
+        store(step.Slot, this->EvaluateBinaryOp(step.Op, arg, operand));
+        break;
+      case Program::StepType::Not:
+        store(step.Slot,
+              !this->GetBooleanValueWithAutoDereference(values[step.Operand],
+                                                        errorString, status));
+        break;
+    }
+  }
+
+  if (program.ResultNode < 0) {
+    return this->GetBooleanValueWithAutoDereference(
+      values[program.Result], errorString, status, true);
+  }
+
+  // Evaluate the AND and OR reductions, skipping the operands that
+  // cannot change their result.
+  std::function<bool(long)> evaluate = [&](long operand) -> bool {
+    if (operand < 0) {
+      return this->GetBooleanValueWithAutoDereference(
+        values[static_cast<std::size_t>(~operand)], errorString, status);
+    }
+    Program::Node const& node = program.Nodes[operand];
+    bool const lhs = evaluate(node.Lhs);
+    if (node.Op == Keyword::AND ? !lhs : lhs) {
+      return lhs;
+    }
+    return evaluate(node.Rhs);
+  };
+  return evaluate(program.ResultNode);
+}
+
+//=========================================================================
+bool cmConditionEvaluator::EvaluatePredicate(
+  Keyword keyword, cmExpandedCommandArgument const& arg) const
+{
+  switch (keyword) {
+    // does a file exist
+    case Keyword::EXISTS:
+      return cmSystemTools::FileExists(arg.c_str());
+    // does a directory with this name exist
+    case Keyword::IS_DIRECTORY:
+      return cmSystemTools::FileIsDirectory(arg.c_str());
+    // does a symlink with this name exist
+    case Keyword::IS_SYMLINK:
+      return cmSystemTools::FileIsSymlink(arg.c_str());
+    // is the given path an absolute path ?
+    case Keyword::IS_ABSOLUTE:
+      return cmSystemTools::FileIsFullPath(arg.c_str());
+    // does a command exist
+    case Keyword::COMMAND:
+      return this->Makefile.GetState()->GetCommand(arg.c_str()) != nullptr;
+    // does a policy exist
+    case Keyword::POLICY: {
+      cmPolicies::PolicyID pid;
+      return cmPolicies::GetPolicyID(arg.c_str(), pid);
+    }
+    // does a target exist
+    case Keyword::TARGET:
+      return this->Makefile.FindTargetToUse(arg.GetValue()) != nullptr;
+    // does a test exist
+    case Keyword::TEST: {
+      const cmTest* haveTest = this->Makefile.GetTest(arg.c_str());
+      return haveTest != nullptr;
+    }
+    // is a variable defined
+    case Keyword::DEFINED: {
+      std::string const& value = arg.GetValue();
+      size_t len = value.size();
+      if (len > 4 && value.substr(0, 4) == "ENV{" && value[len - 1] == '}') {
+        std::string env = value.substr(4, len - 5);
+        return cmSystemTools::HasEnv(env);
+      }
+      if (len > 6 && value.substr(0, 6) == "CACHE{" &&
+          value[len - 1] == '}') {
+        std::string cache = value.substr(6, len - 7);
+        return this->Makefile.GetState()->GetCacheEntryValue(cache) !=
+          nullptr;
+      }
+      return this->Makefile.IsDefinitionSet(value);
+    }
+    default:
+      return false;
+  }
+}
+
+//=========================================================================
+bool cmConditionEvaluator::EvaluateMatches(
+  cmExpandedCommandArgument const& arg,
+  cmExpandedCommandArgument const& regex, bool& result,
+  std::string& errorString, MessageType& status)
+{
+  std::string def_buf;
+  const char* def = this->GetVariableOrString(arg);
+  if (def != arg.c_str() // yes, we compare the pointer value
+      && cmHasLiteralPrefix(arg.GetValue(), "CMAKE_MATCH_")) {
+    // The string to match is owned by our match result variables.
+    // Move it to our own buffer before clearing them.
+    def_buf = def;
+    def = def_buf.c_str();
+  }
+  const char* rex = regex.c_str();
+  this->Makefile.ClearMatches();
+  cmsys::RegularExpression regEntry;
+  if (!regEntry.compile(rex)) {
+    std::ostringstream error;
+    error << "Regular expression \"" << rex << "\" cannot compile";
+    errorString = error.str();
+    status = MessageType::FATAL_ERROR;
+    return false;
+  }
+  result = regEntry.find(def);
+  if (result) {
+    this->Makefile.StoreMatches(regEntry);
+  }
+  return true;
+}
+
+//=========================================================================
+bool cmConditionEvaluator::EvaluateBinaryOp(
+  Keyword keyword, cmExpandedCommandArgument const& lhsArg,
+  cmExpandedCommandArgument const& rhsArg) const
+{
+  switch (keyword) {
+    case Keyword::LESS:
+    case Keyword::LESS_EQUAL:
+    case Keyword::GREATER:
+    case Keyword::GREATER_EQUAL:
+    case Keyword::EQUAL: {
+      const char* def = this->GetVariableOrString(lhsArg);
+      const char* def2 = this->GetVariableOrString(rhsArg);
+      double lhs;
+      double rhs;
+      if (sscanf(def, "%lg", &lhs) != 1 || sscanf(def2, "%lg", &rhs) != 1) {
+        return false;
+      }
+      switch (keyword) {
+        case Keyword::LESS:
+          return lhs < rhs;
+        case Keyword::LESS_EQUAL:
+          return lhs <= rhs;
+        case Keyword::GREATER:
+          return lhs > rhs;
+        case Keyword::GREATER_EQUAL:
+          return lhs >= rhs;
+        default:
+          return lhs == rhs;
+      }
+    }
+    case Keyword::STRLESS:
+    case Keyword::STRLESS_EQUAL:
+    case Keyword::STRGREATER:
+    case Keyword::STRGREATER_EQUAL:
+    case Keyword::STREQUAL: {
+      const char* def = this->GetVariableOrString(lhsArg);
+      const char* def2 = this->GetVariableOrString(rhsArg);
+      int val = strcmp(def, def2);
+      switch (keyword) {
+        case Keyword::STRLESS:
+          return val < 0;
+        case Keyword::STRLESS_EQUAL:
+          return val <= 0;
+        case Keyword::STRGREATER:
+          return val > 0;
+        case Keyword::STRGREATER_EQUAL:
+          return val >= 0;
+        default: // strequal
+          return val == 0;
+      }
+    }
+    case Keyword::VERSION_LESS:
+    case Keyword::VERSION_LESS_EQUAL:
+    case Keyword::VERSION_GREATER:
+    case Keyword::VERSION_GREATER_EQUAL:
+    case Keyword::VERSION_EQUAL: {
+      const char* def = this->GetVariableOrString(lhsArg);
+      const char* def2 = this->GetVariableOrString(rhsArg);
+      cmSystemTools::CompareOp op;
+      switch (keyword) {
+        case Keyword::VERSION_LESS:
+          op = cmSystemTools::OP_LESS;
+          break;
+        case Keyword::VERSION_LESS_EQUAL:
+          op = cmSystemTools::OP_LESS_EQUAL;
+          break;
+        case Keyword::VERSION_GREATER:
+          op = cmSystemTools::OP_GREATER;
+          break;
+        case Keyword::VERSION_GREATER_EQUAL:
+          op = cmSystemTools::OP_GREATER_EQUAL;
+          break;
+        default: // version_equal
+          op = cmSystemTools::OP_EQUAL;
+          break;
+      }
+      return cmSystemTools::VersionCompare(op, def, def2);
+    }
+    // is file A newer than file B
+    case Keyword::IS_NEWER_THAN: {
+      int fileIsNewer = 0;
+      bool success = cmSystemTools::FileTimeCompare(
+        lhsArg.GetValue(), rhsArg.GetValue(), &fileIsNewer);
+      return !success || fileIsNewer == 1 || fileIsNewer == 0;
+    }
+    case Keyword::IN_LIST: {
+      const char* def = this->GetVariableOrString(lhsArg);
+      const char* def2 = this->Makefile.GetDefinition(rhsArg.GetValue());
+      if (!def2) {
+        return false;
+      }
+      std::vector<std::string> list = cmExpandedList(def2, true);
+      return cmContains(list, def);
+    }
+    default:
+      return false;
+  }
+}
+
 //=========================================================================
 const char* cmConditionEvaluator::GetDefinitionIfUnquoted(
   cmExpandedCommandArgument const& argument) const
@@ -433,81 +1150,38 @@ bool cmConditionEvaluator::HandleLevel1(cmArgumentList& newArgs, std::string&,
     while (arg != newArgs.end()) {
       argP1 = arg;
       this->IncrementArguments(newArgs, argP1, argP2);
-      // does a file exist
-      if (this->IsKeyword(keyEXISTS, *arg) && argP1 != newArgs.end()) {
-        this->HandlePredicate(cmSystemTools::FileExists(argP1->c_str()),
-                              reducible, arg, newArgs, argP1, argP2);
-      }
-      // does a directory with this name exist
-      if (this->IsKeyword(keyIS_DIRECTORY, *arg) && argP1 != newArgs.end()) {
-        this->HandlePredicate(cmSystemTools::FileIsDirectory(argP1->c_str()),
-                              reducible, arg, newArgs, argP1, argP2);
-      }
-      // does a symlink with this name exist
-      if (this->IsKeyword(keyIS_SYMLINK, *arg) && argP1 != newArgs.end()) {
-        this->HandlePredicate(cmSystemTools::FileIsSymlink(argP1->c_str()),
-                              reducible, arg, newArgs, argP1, argP2);
-      }
-      // is the given path an absolute path ?
-      if (this->IsKeyword(keyIS_ABSOLUTE, *arg) && argP1 != newArgs.end()) {
-        this->HandlePredicate(cmSystemTools::FileIsFullPath(argP1->c_str()),
-                              reducible, arg, newArgs, argP1, argP2);
-      }
-      // does a command exist
-      if (this->IsKeyword(keyCOMMAND, *arg) && argP1 != newArgs.end()) {
-        cmState::Command command =
-          this->Makefile.GetState()->GetCommand(argP1->c_str());
-        this->HandlePredicate(command != nullptr, reducible, arg, newArgs,
-                              argP1, argP2);
-      }
-      // does a policy exist
-      if (this->IsKeyword(keyPOLICY, *arg) && argP1 != newArgs.end()) {
-        cmPolicies::PolicyID pid;
-        this->HandlePredicate(cmPolicies::GetPolicyID(argP1->c_str(), pid),
-                              reducible, arg, newArgs, argP1, argP2);
-      }
-      // does a target exist
-      if (this->IsKeyword(keyTARGET, *arg) && argP1 != newArgs.end()) {
-        this->HandlePredicate(
-          this->Makefile.FindTargetToUse(argP1->GetValue()) != nullptr,
-          reducible, arg, newArgs, argP1, argP2);
-      }
-      // does a test exist
-      if (this->Policy64Status != cmPolicies::OLD &&
-          this->Policy64Status != cmPolicies::WARN) {
-        if (this->IsKeyword(keyTEST, *arg) && argP1 != newArgs.end()) {
-          const cmTest* haveTest = this->Makefile.GetTest(argP1->c_str());
-          this->HandlePredicate(haveTest != nullptr, reducible, arg, newArgs,
-                                argP1, argP2);
+      for (auto const& predicate :
+           { std::make_pair(&keyEXISTS, Keyword::EXISTS),
+             std::make_pair(&keyIS_DIRECTORY, Keyword::IS_DIRECTORY),
+             std::make_pair(&keyIS_SYMLINK, Keyword::IS_SYMLINK),
+             std::make_pair(&keyIS_ABSOLUTE, Keyword::IS_ABSOLUTE),
+             std::make_pair(&keyCOMMAND, Keyword::COMMAND),
+             std::make_pair(&keyPOLICY, Keyword::POLICY),
+             std::make_pair(&keyTARGET, Keyword::TARGET),
+             std::make_pair(&keyTEST, Keyword::TEST),
+             std::make_pair(&keyDEFINED, Keyword::DEFINED) }) {
+        // does a test exist
+        if (predicate.second == Keyword::TEST &&
+            (this->Policy64Status == cmPolicies::OLD ||
+             this->Policy64Status == cmPolicies::WARN)) {
+          if (this->Policy64Status == cmPolicies::WARN &&
+              this->IsKeyword(keyTEST, *arg)) {
+            std::ostringstream e;
+            e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0064) << "\n";
+            e << "TEST will be interpreted as an operator "
+                 "when the policy is set to NEW.  "
+                 "Since the policy is not set the OLD behavior will be used.";
+
+            this->Makefile.IssueMessage(MessageType::AUTHOR_WARNING, e.str());
+          }
+          continue;
         }
-      } else if (this->Policy64Status == cmPolicies::WARN &&
-                 this->IsKeyword(keyTEST, *arg)) {
-        std::ostringstream e;
-        e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0064) << "\n";
-        e << "TEST will be interpreted as an operator "
-             "when the policy is set to NEW.  "
-             "Since the policy is not set the OLD behavior will be used.";
-
-        this->Makefile.IssueMessage(MessageType::AUTHOR_WARNING, e.str());
-      }
-      // is a variable defined
-      if (this->IsKeyword(keyDEFINED, *arg) && argP1 != newArgs.end()) {
-        size_t argP1len = argP1->GetValue().size();
-        bool bdef = false;
-        if (argP1len > 4 && argP1->GetValue().substr(0, 4) == "ENV{" &&
-            argP1->GetValue().operator[](argP1len - 1) == '}') {
-          std::string env = argP1->GetValue().substr(4, argP1len - 5);
-          bdef = cmSystemTools::HasEnv(env);
-        } else if (argP1len > 6 &&
-                   argP1->GetValue().substr(0, 6) == "CACHE{" &&
-                   argP1->GetValue().operator[](argP1len - 1) == '}') {
-          std::string cache = argP1->GetValue().substr(6, argP1len - 7);
-          bdef =
-            this->Makefile.GetState()->GetCacheEntryValue(cache) != nullptr;
-        } else {
-          bdef = this->Makefile.IsDefinitionSet(argP1->GetValue());
+        if (this->IsKeyword(*predicate.first, *arg) &&
+            argP1 != newArgs.end()) {
+          this->HandlePredicate(
+            this->EvaluatePredicate(predicate.second, *argP1), reducible, arg,
+            newArgs, argP1, argP2);
         }
-        this->HandlePredicate(bdef, reducible, arg, newArgs, argP1, argP2);
       }
       ++arg;
     }
@@ -522,9 +1196,6 @@ bool cmConditionEvaluator::HandleLevel2(cmArgumentList& newArgs,
                                         MessageType& status)
 {
   int reducible;
-  std::string def_buf;
-  const char* def;
-  const char* def2;
   do {
     reducible = 0;
     auto arg = newArgs.begin();
@@ -535,35 +1206,12 @@ bool cmConditionEvaluator::HandleLevel2(cmArgumentList& newArgs,
       this->IncrementArguments(newArgs, argP1, argP2);
       if (argP1 != newArgs.end() && argP2 != newArgs.end() &&
           IsKeyword(keyMATCHES, *argP1)) {
-        def = this->GetVariableOrString(*arg);
-        if (def != arg->c_str() // yes, we compare the pointer value
-            && cmHasLiteralPrefix(arg->GetValue(), "CMAKE_MATCH_")) {
-          // The string to match is owned by our match result variables.
-          // Move it to our own buffer before clearing them.
-          def_buf = def;
-          def = def_buf.c_str();
-        }
-        const char* rex = argP2->c_str();
-        this->Makefile.ClearMatches();
-        cmsys::RegularExpression regEntry;
-        if (!regEntry.compile(rex)) {
-          std::ostringstream error;
-          error << "Regular expression \"" << rex << "\" cannot compile";
-          errorString = error.str();
-          status = MessageType::FATAL_ERROR;
+        bool result;
+        if (!this->EvaluateMatches(*arg, *argP2, result, errorString,
+                                   status)) {
           return false;
         }
-        if (regEntry.find(def)) {
-          this->Makefile.StoreMatches(regEntry);
-          *arg = cmExpandedCommandArgument("1", true);
-        } else {
-          *arg = cmExpandedCommandArgument("0", true);
-        }
-        newArgs.erase(argP2);
-        newArgs.erase(argP1);
-        argP1 = arg;
-        this->IncrementArguments(newArgs, argP1, argP2);
-        reducible = 1;
+        this->HandleBinaryOp(result, reducible, arg, newArgs, argP1, argP2);
       }
 
       if (argP1 != newArgs.end() && this->IsKeyword(keyMATCHES, *arg)) {
@@ -574,118 +1222,57 @@ bool cmConditionEvaluator::HandleLevel2(cmArgumentList& newArgs,
         reducible = 1;
       }
 
-      if (argP1 != newArgs.end() && argP2 != newArgs.end() &&
-          (this->IsKeyword(keyLESS, *argP1) ||
-           this->IsKeyword(keyLESS_EQUAL, *argP1) ||
-           this->IsKeyword(keyGREATER, *argP1) ||
-           this->IsKeyword(keyGREATER_EQUAL, *argP1) ||
-           this->IsKeyword(keyEQUAL, *argP1))) {
-        def = this->GetVariableOrString(*arg);
-        def2 = this->GetVariableOrString(*argP2);
-        double lhs;
-        double rhs;
-        bool result;
-        if (sscanf(def, "%lg", &lhs) != 1 || sscanf(def2, "%lg", &rhs) != 1) {
-          result = false;
-        } else if (*(argP1) == keyLESS) {
-          result = (lhs < rhs);
-        } else if (*(argP1) == keyLESS_EQUAL) {
-          result = (lhs <= rhs);
-        } else if (*(argP1) == keyGREATER) {
-          result = (lhs > rhs);
-        } else if (*(argP1) == keyGREATER_EQUAL) {
-          result = (lhs >= rhs);
-        } else {
-          result = (lhs == rhs);
+      using Operator = std::pair<std::string const*, Keyword>;
+      for (auto const& ops :
+           { std::initializer_list<Operator>{
+               { &keyLESS, Keyword::LESS },
+               { &keyLESS_EQUAL, Keyword::LESS_EQUAL },
+               { &keyGREATER, Keyword::GREATER },
+               { &keyGREATER_EQUAL, Keyword::GREATER_EQUAL },
+               { &keyEQUAL, Keyword::EQUAL } },
+             std::initializer_list<Operator>{
+               { &keySTRLESS, Keyword::STRLESS },
+               { &keySTRLESS_EQUAL, Keyword::STRLESS_EQUAL },
+               { &keySTRGREATER, Keyword::STRGREATER },
+               { &keySTRGREATER_EQUAL, Keyword::STRGREATER_EQUAL },
+               { &keySTREQUAL, Keyword::STREQUAL } },
+             std::initializer_list<Operator>{
+               { &keyVERSION_LESS, Keyword::VERSION_LESS },
+               { &keyVERSION_LESS_EQUAL, Keyword::VERSION_LESS_EQUAL },
+               { &keyVERSION_GREATER, Keyword::VERSION_GREATER },
+               { &keyVERSION_GREATER_EQUAL, Keyword::VERSION_GREATER_EQUAL },
+               { &keyVERSION_EQUAL, Keyword::VERSION_EQUAL } },
+             // is file A newer than file B
+             std::initializer_list<Operator>{
+               { &keyIS_NEWER_THAN, Keyword::IS_NEWER_THAN } },
+             std::initializer_list<Operator>{
+               { &keyIN_LIST, Keyword::IN_LIST } } }) {
+        if (argP1 == newArgs.end() || argP2 == newArgs.end()) {
+          continue;
         }
-        this->HandleBinaryOp(result, reducible, arg, newArgs, argP1, argP2);
-      }
-
-      if (argP1 != newArgs.end() && argP2 != newArgs.end() &&
-          (this->IsKeyword(keySTRLESS, *argP1) ||
-           this->IsKeyword(keySTRLESS_EQUAL, *argP1) ||
-           this->IsKeyword(keySTRGREATER, *argP1) ||
-           this->IsKeyword(keySTRGREATER_EQUAL, *argP1) ||
-           this->IsKeyword(keySTREQUAL, *argP1))) {
-        def = this->GetVariableOrString(*arg);
-        def2 = this->GetVariableOrString(*argP2);
-        int val = strcmp(def, def2);
-        bool result;
-        if (*(argP1) == keySTRLESS) {
-          result = (val < 0);
-        } else if (*(argP1) == keySTRLESS_EQUAL) {
-          result = (val <= 0);
-        } else if (*(argP1) == keySTRGREATER) {
-          result = (val > 0);
-        } else if (*(argP1) == keySTRGREATER_EQUAL) {
-          result = (val >= 0);
-        } else // strequal
-        {
-          result = (val == 0);
+        auto op = std::find_if(ops.begin(), ops.end(),
+                               [this, &argP1](Operator const& o) {
+                                 return this->IsKeyword(*o.first, *argP1);
+                               });
+        if (op == ops.end()) {
+          continue;
         }
-        this->HandleBinaryOp(result, reducible, arg, newArgs, argP1, argP2);
-      }
+        if (op->second == Keyword::IN_LIST &&
+            (this->Policy57Status == cmPolicies::OLD ||
+             this->Policy57Status == cmPolicies::WARN)) {
+          if (this->Policy57Status == cmPolicies::WARN) {
+            std::ostringstream e;
+            e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0057) << "\n";
+            e << "IN_LIST will be interpreted as an operator "
+                 "when the policy is set to NEW.  "
+                 "Since the policy is not set the OLD behavior will be used.";
 
-      if (argP1 != newArgs.end() && argP2 != newArgs.end() &&
-          (this->IsKeyword(keyVERSION_LESS, *argP1) ||
-           this->IsKeyword(keyVERSION_LESS_EQUAL, *argP1) ||
-           this->IsKeyword(keyVERSION_GREATER, *argP1) ||
-           this->IsKeyword(keyVERSION_GREATER_EQUAL, *argP1) ||
-           this->IsKeyword(keyVERSION_EQUAL, *argP1))) {
-        def = this->GetVariableOrString(*arg);
-        def2 = this->GetVariableOrString(*argP2);
-        cmSystemTools::CompareOp op;
-        if (*argP1 == keyVERSION_LESS) {
-          op = cmSystemTools::OP_LESS;
-        } else if (*argP1 == keyVERSION_LESS_EQUAL) {
-          op = cmSystemTools::OP_LESS_EQUAL;
-        } else if (*argP1 == keyVERSION_GREATER) {
-          op = cmSystemTools::OP_GREATER;
-        } else if (*argP1 == keyVERSION_GREATER_EQUAL) {
-          op = cmSystemTools::OP_GREATER_EQUAL;
-        } else { // version_equal
-          op = cmSystemTools::OP_EQUAL;
-        }
-        bool result = cmSystemTools::VersionCompare(op, def, def2);
-        this->HandleBinaryOp(result, reducible, arg, newArgs, argP1, argP2);
-      }
-
-      // is file A newer than file B
-      if (argP1 != newArgs.end() && argP2 != newArgs.end() &&
-          this->IsKeyword(keyIS_NEWER_THAN, *argP1)) {
-        int fileIsNewer = 0;
-        bool success = cmSystemTools::FileTimeCompare(
-          arg->GetValue(), (argP2)->GetValue(), &fileIsNewer);
-        this->HandleBinaryOp(
-          (!success || fileIsNewer == 1 || fileIsNewer == 0), reducible, arg,
-          newArgs, argP1, argP2);
-      }
-
-      if (argP1 != newArgs.end() && argP2 != newArgs.end() &&
-          this->IsKeyword(keyIN_LIST, *argP1)) {
-        if (this->Policy57Status != cmPolicies::OLD &&
-            this->Policy57Status != cmPolicies::WARN) {
-          bool result = false;
-
-          def = this->GetVariableOrString(*arg);
-          def2 = this->Makefile.GetDefinition(argP2->GetValue());
-
-          if (def2) {
-            std::vector<std::string> list = cmExpandedList(def2, true);
-
-            result = cmContains(list, def);
+            this->Makefile.IssueMessage(MessageType::AUTHOR_WARNING, e.str());
           }
-
-          this->HandleBinaryOp(result, reducible, arg, newArgs, argP1, argP2);
-        } else if (this->Policy57Status == cmPolicies::WARN) {
-          std::ostringstream e;
-          e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0057) << "\n";
-          e << "IN_LIST will be interpreted as an operator "
-               "when the policy is set to NEW.  "
-               "Since the policy is not set the OLD behavior will be used.";
-
-          this->Makefile.IssueMessage(MessageType::AUTHOR_WARNING, e.str());
+          continue;
         }
+        this->HandleBinaryOp(this->EvaluateBinaryOp(op->second, *arg, *argP2),
+                             reducible, arg, newArgs, argP1, argP2);
       }
 
       ++arg;
@@ -6,7 +6,9 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <list>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "cmExpandedCommandArgument.h"
@@ -16,6 +18,35 @@
 
 class cmMakefile;
 
+/** \class cmConditionCache
+ * \brief Compiled forms of the conditions of if(), elseif() and while().
+ *
+ * Which arguments of a condition are operators depends only on the
+ * expanded arguments that are keywords and on a few policies.  A
+ * condition is compiled once for each such shape into the sequence of
+ * reductions that cmConditionEvaluator would perform, which later
+ * evaluations of the same shape replay without searching the arguments.
+ */
+class cmConditionCache
+{
+public:
+  cmConditionCache();
+  ~cmConditionCache();
+
+  cmConditionCache(cmConditionCache const&) = delete;
+  cmConditionCache& operator=(cmConditionCache const&) = delete;
+
+  enum class Keyword;
+  struct Program;
+
+private:
+  friend class cmConditionEvaluator;
+
+  // Indexed by the shape of the condition.  Shapes that cannot be
+  // compiled map to nullptr.
+  std::unordered_map<std::string, std::unique_ptr<Program>> Programs;
+};
+
 class cmConditionEvaluator
 {
 public:
@@ -31,6 +62,28 @@ public:
               std::string& errorString, MessageType& status);
 
 private:
+  using Program = cmConditionCache::Program;
+
+  // Find or compile the program for the shape of the given arguments.
+  Program const* GetProgram(
+    cmConditionCache& cache,
+    std::vector<cmExpandedCommandArgument> const& args) const;
+
+  bool RunProgram(Program const& program,
+                  std::vector<cmExpandedCommandArgument>& values,
+                  std::string& errorString, MessageType& status);
+
+  bool EvaluatePredicate(cmConditionCache::Keyword keyword,
+                         cmExpandedCommandArgument const& arg) const;
+
+  bool EvaluateMatches(cmExpandedCommandArgument const& arg,
+                       cmExpandedCommandArgument const& regex, bool& result,
+                       std::string& errorString, MessageType& status);
+
+  bool EvaluateBinaryOp(cmConditionCache::Keyword keyword,
+                        cmExpandedCommandArgument const& lhs,
+                        cmExpandedCommandArgument const& rhs) const;
+
   // Filter the given variable definition based on policy CMP0054.
   const char* GetDefinitionIfUnquoted(
     const cmExpandedCommandArgument& argument) const;
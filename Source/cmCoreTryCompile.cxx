@@ -9,6 +9,7 @@
 #include <utility>
 
 #include "cmsys/Directory.hxx"
+#include "cmsys/FStream.hxx"
 
 #include "cm_static_string_view.hxx"
 
@@ -25,6 +26,15 @@
 #include "cmVersion.h"
 #include "cmake.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <iterator>
+
+#  include <cm/string_view>
+
+#  include "cmCryptoHash.h"
+#  include "cmTryCompileResultCache.h"
+#endif
+
 static std::string const kCMAKE_C_COMPILER_EXTERNAL_TOOLCHAIN =
   "CMAKE_C_COMPILER_EXTERNAL_TOOLCHAIN";
 static std::string const kCMAKE_C_COMPILER_TARGET = "CMAKE_C_COMPILER_TARGET";
@@ -81,6 +91,73 @@ static void writeProperty(FILE* fout, std::string const& targetName,
           cmOutputConverter::EscapeForCMake(value).c_str());
 }
 
+#if !defined(CMAKE_BOOTSTRAP)
+/* Compute the key of a try_compile project in the result cache.  Returns
+   an empty string if an input could not be read.  */
+static std::string computeResultCacheKey(
+  cmMakefile* mf, std::string const& binDir, std::string const& targetName,
+  std::vector<std::string> const& files,
+  std::vector<std::string> const& cmakeFlags)
+{
+  // The build tree and the random target name differ between otherwise
+  // identical projects.
+  std::string const& homeOut = mf->GetHomeOutputDirectory();
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  hasher.Initialize();
+  auto append = [&](std::string value) {
+    cmSystemTools::ReplaceString(value, binDir, "<BINARY_DIR>");
+    cmSystemTools::ReplaceString(value, homeOut, "<HOME_OUTPUT_DIR>");
+    cmSystemTools::ReplaceString(value, targetName, "<TARGET_NAME>");
+    hasher.Append(value);
+    hasher.Append(cm::string_view("", 1));
+  };
+  auto appendFile = [&](std::string const& file) -> bool {
+    cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+    if (!fin) {
+      return false;
+    }
+    append(file);
+    append(std::string(std::istreambuf_iterator<char>(fin),
+                       std::istreambuf_iterator<char>()));
+    return true;
+  };
+
+  append(cmVersion::GetCMakeVersion());
+  append(mf->GetGlobalGenerator()->GetName());
+  for (const char* var :
+       { "CMAKE_GENERATOR_PLATFORM", "CMAKE_GENERATOR_TOOLSET",
+         "CMAKE_TRY_COMPILE_CONFIGURATION",
+         "CMAKE_TRY_COMPILE_TARGET_TYPE" }) {
+    append(mf->GetSafeDefinition(var));
+  }
+  for (std::string const& flag : cmakeFlags) {
+    append(flag);
+  }
+  for (std::string const& file : files) {
+    if (!appendFile(file)) {
+      return std::string();
+    }
+  }
+
+  // Fingerprint the toolchain by the platform information files the
+  // try_compile project loads and by the compilers themselves.
+  std::string const infoDir = mf->GetSafeDefinition("CMAKE_PLATFORM_INFO_DIR");
+  appendFile(infoDir + "/CMakeSystem.cmake");
+  std::vector<std::string> langs;
+  mf->GetGlobalGenerator()->GetEnabledLanguages(langs);
+  for (std::string const& lang : langs) {
+    appendFile(cmStrCat(infoDir, "/CMake", lang, "Compiler.cmake"));
+    std::string const compiler =
+      mf->GetSafeDefinition(cmStrCat("CMAKE_", lang, "_COMPILER"));
+    append(compiler);
+    append(std::to_string(cmSystemTools::FileLength(compiler)));
+    append(std::to_string(cmSystemTools::ModifiedTime(compiler)));
+  }
+
+  return hasher.FinalizeHex();
+}
+#endif
+
 std::string cmCoreTryCompile::LookupStdVar(std::string const& var,
                                            bool warnCMP0067)
 {
@@ -969,14 +1046,52 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
     }
   }
 
+#if !defined(CMAKE_BOOTSTRAP)
+  // Results of projects that are only built may be shared between build
+  // trees.  Projects whose output files are used must be built.
+  cmTryCompileResultCache* resultCache = nullptr;
+  std::string resultCacheKey;
+  if (this->SrcFileSignature && !isTryRun && copyFile.empty() &&
+      !this->Makefile->GetCMakeInstance()->GetDebugTryCompile()) {
+    resultCache =
+      this->Makefile->GetCMakeInstance()->GetTryCompileResultCache();
+  }
+  if (resultCache) {
+    std::vector<std::string> files = sources;
+    files.push_back(outFileName);
+    std::string const targetsFile =
+      cmStrCat(this->BinaryDirectory, '/', targetName, "Targets.cmake");
+    if (cmSystemTools::FileExists(targetsFile)) {
+      files.push_back(targetsFile);
+    }
+    resultCacheKey = computeResultCacheKey(
+      this->Makefile, this->BinaryDirectory, targetName, files, cmakeFlags);
+    if (resultCacheKey.empty()) {
+      resultCache = nullptr;
+    }
+  }
+#endif
+
   bool erroroc = cmSystemTools::GetErrorOccuredFlag();
   cmSystemTools::ResetErrorOccuredFlag();
   std::string output;
-  // actually do the try compile now that everything is setup
-  int res = this->Makefile->TryCompile(
-    sourceDirectory, this->BinaryDirectory, projectName, targetName,
-    this->SrcFileSignature, cmake::NO_BUILD_PARALLEL_LEVEL, &cmakeFlags,
-    output);
+  int res = 0;
+  bool cached = false;
+#if !defined(CMAKE_BOOTSTRAP)
+  cached = resultCache && resultCache->Lookup(resultCacheKey, res, output);
+#endif
+  if (!cached) {
+    // actually do the try compile now that everything is setup
+    res = this->Makefile->TryCompile(
+      sourceDirectory, this->BinaryDirectory, projectName, targetName,
+      this->SrcFileSignature, cmake::NO_BUILD_PARALLEL_LEVEL, &cmakeFlags,
+      output);
+#if !defined(CMAKE_BOOTSTRAP)
+    if (resultCache && !cmSystemTools::GetErrorOccuredFlag()) {
+      resultCache->Store(resultCacheKey, res, output);
+    }
+#endif
+  }
   if (erroroc) {
     cmSystemTools::SetErrorOccured();
   }
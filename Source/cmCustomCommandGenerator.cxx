@@ -2,7 +2,9 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmCustomCommandGenerator.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <iterator>
 #include <memory>
 #include <utility>
 
@@ -14,10 +16,15 @@
 #include "cmGeneratorTarget.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
+#include "cmRange.h"
 #include "cmStateTypes.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include "cmCryptoHash.h"
+#endif
+
 namespace {
 void AppendPaths(const std::vector<std::string>& inputs,
                  cmGeneratorExpression const& ge, cmLocalGenerator* lg,
@@ -37,6 +44,60 @@ void AppendPaths(const std::vector<std::string>& inputs,
     cm::append(output, result);
   }
 }
+
+#if !defined(CMAKE_BOOTSTRAP)
+// Whether a command line runs a "cmake -E" tool that only acts on its
+// arguments and so can run in a "cmake -E batch" process with others.
+bool IsBatchableToolCommand(cmCustomCommandLine const& cmdline,
+                            bool oldStyle)
+{
+  static char const* const tools[] = {
+    "copy",     "copy_directory", "copy_if_different", "create_symlink",
+    "echo",     "echo_append",    "make_directory",    "remove",
+    "remove_directory", "rename", "rm",                "touch",
+    "touch_nocreate"
+  };
+  if (cmdline.size() < 3 || cmdline[1] != "-E" ||
+      cmdline[0] != cmSystemTools::GetCMakeCommand() ||
+      std::find(std::begin(tools), std::end(tools), cmdline[2]) ==
+        std::end(tools)) {
+    return false;
+  }
+  // Arguments are passed verbatim by the batch file, so the command must
+  // not rely on the build tool or shell to expand them.
+  char const* const special =
+    oldStyle ? "$%\r\n\"'\\`<>|&;()*?[]~#!^" : "$%\r\n";
+  return std::none_of(cmdline.begin() + 2, cmdline.end(),
+                      [special](std::string const& arg) {
+                        return arg.find_first_of(special) != std::string::npos;
+                      });
+}
+
+// Return the content of a batch file running the arguments following
+// "-E" of the given command lines.
+std::string BatchFileContent(cmCustomCommandLines::const_iterator first,
+                             cmCustomCommandLines::const_iterator last)
+{
+  std::string content = "# Commands run by \"cmake -E batch\".\n";
+  for (; first != last; ++first) {
+    char const* sep = "";
+    for (std::string const& arg : cmMakeRange(*first).advance(2)) {
+      content += sep;
+      content += '"';
+      for (char c : arg) {
+        if (c == '"' || c == '\\') {
+          content += '\\';
+        }
+        content += c;
+      }
+      content += '"';
+      sep = " ";
+    }
+    content += '\n';
+  }
+  return content;
+}
+#endif
 }
 
 cmCustomCommandGenerator::cmCustomCommandGenerator(cmCustomCommand const& cc,
@@ -74,6 +135,12 @@ cmCustomCommandGenerator::cmCustomCommandGenerator(cmCustomCommand const& cc,
     this->CommandLines.push_back(std::move(argv));
   }
 
+#if !defined(CMAKE_BOOTSTRAP)
+  if (this->LG->GetMakefile()->IsOn("CMAKE_BATCH_TOOL_COMMANDS")) {
+    this->BatchToolCommands();
+  }
+#endif
+
   AppendPaths(cc.GetByproducts(), ge, this->LG, this->Config,
               this->Byproducts);
   AppendPaths(cc.GetDepends(), ge, this->LG, this->Config, this->Depends);
@@ -96,7 +163,59 @@ cmCustomCommandGenerator::cmCustomCommandGenerator(cmCustomCommand const& cc,
 
 unsigned int cmCustomCommandGenerator::GetNumberOfCommands() const
 {
-  return static_cast<unsigned int>(this->CC.GetCommandLines().size());
+  return static_cast<unsigned int>(this->CommandLines.size());
+}
+
+#if !defined(CMAKE_BOOTSTRAP)
+void cmCustomCommandGenerator::BatchToolCommands()
+{
+  // Replace each run of consecutive tool commands by one command that
+  // runs them all from a batch file.
+  cmCustomCommandLines lines;
+  auto const end = this->CommandLines.cend();
+  for (auto i = this->CommandLines.cbegin(); i != end;) {
+    auto j = i;
+    while (j != end && IsBatchableToolCommand(*j, this->OldStyle)) {
+      ++j;
+    }
+    if (j - i > 1) {
+      // Name the file by its content so that a changed command line
+      // still changes the rule.
+      std::string content = BatchFileContent(i, j);
+      std::string file =
+        cmStrCat(this->LG->GetMakefile()->GetHomeOutputDirectory(),
+                 "/CMakeFiles/batch/",
+                 cmCryptoHash(cmCryptoHash::AlgoMD5).HashString(content),
+                 ".txt");
+      lines.push_back(cmMakeCommandLine(
+        { cmSystemTools::GetCMakeCommand(), "-E", "batch", file }));
+      this->BatchFiles.emplace(std::move(file), std::move(content));
+      i = j;
+    } else {
+      lines.push_back(*i);
+      ++i;
+    }
+  }
+  if (lines.size() != this->CommandLines.size()) {
+    this->CommandLines = std::move(lines);
+    this->EmulatorsWithArguments.resize(this->CommandLines.size());
+  }
+}
+#endif
+
+std::map<std::string, std::string> const&
+cmCustomCommandGenerator::GetBatchFiles() const
+{
+  return this->BatchFiles;
+}
+
+bool cmCustomCommandGenerator::IsBatchCommand(unsigned int c) const
+{
+  cmCustomCommandLine const& commandLine = this->CommandLines[c];
+  return commandLine.size() == 4 && commandLine[1] == "-E" &&
+    commandLine[2] == "batch" &&
+    commandLine[0] == cmSystemTools::GetCMakeCommand() &&
+    this->GetCrossCompilingEmulator(c).empty();
 }
 
 void cmCustomCommandGenerator::FillEmulatorsWithArguments()
@@ -5,6 +5,7 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -25,7 +26,9 @@ class cmCustomCommandGenerator
   std::vector<std::string> Byproducts;
   std::vector<std::string> Depends;
   std::string WorkingDirectory;
+  std::map<std::string, std::string> BatchFiles;
 
+  void BatchToolCommands();
   void FillEmulatorsWithArguments();
   std::vector<std::string> GetCrossCompilingEmulator(unsigned int c) const;
   const char* GetArgv0Location(unsigned int c) const;
@@ -37,9 +40,18 @@ public:
   cmCustomCommandGenerator& operator=(const cmCustomCommandGenerator&) =
     delete;
   cmCustomCommand const& GetCC() const { return this->CC; }
+  std::string const& GetConfig() const { return this->Config; }
   unsigned int GetNumberOfCommands() const;
   std::string GetCommand(unsigned int c) const;
   void AppendArguments(unsigned int c, std::string& cmd) const;
+
+  /** Whether command c runs "cmake -E batch" on a file and no other
+      tool, so that a tool command may be appended to run before it.  */
+  bool IsBatchCommand(unsigned int c) const;
+
+  /** The content of the batch files run by the commands, by file name.
+      Generators write them with the rules running the commands.  */
+  std::map<std::string, std::string> const& GetBatchFiles() const;
   const char* GetComment() const;
   std::string GetWorkingDirectory() const;
   std::vector<std::string> const& GetOutputs() const;
@@ -28,10 +28,17 @@ cmDefinitions::Def const& cmDefinitions::GetInternal(const std::string& key,
   if (it == end) {
     return cmDefinitions::NoDef;
   }
+  if (!raise) {
+    auto ci = begin->Cache.find(cm::String::borrow(key));
+    if (ci != begin->Cache.end()) {
+      return ci->second;
+    }
+  }
   Def const& def = cmDefinitions::GetInternal(key, it, end, raise);
   if (!raise) {
-    return def;
+    return begin->Cache.emplace(key, def).first->second;
   }
+  begin->Cache.erase(cm::String::borrow(key));
   return begin->Map.emplace(key, def).first->second;
 }
 
@@ -102,11 +109,13 @@ std::vector<std::string> cmDefinitions::ClosureKeys(StackIter begin,
 void cmDefinitions::Set(const std::string& key, cm::string_view value)
 {
   this->Map[key] = Def(value);
+  this->Cache.erase(cm::String::borrow(key));
 }
 
 void cmDefinitions::Unset(const std::string& key)
 {
   this->Map[key] = Def();
+  this->Cache.erase(cm::String::borrow(key));
 }
 
 std::vector<std::string> cmDefinitions::UnusedKeys() const
@@ -21,6 +21,12 @@
  * This stores the state of variable definitions (set or unset) for
  * one scope.  Sets are always local.  Gets search parent scopes
  * transitively and save results locally.
+ *
+ * Results found in parent scopes are kept in a lookup cache separate
+ * from the local definitions so that repeated reads from deep call
+ * stacks need not walk every scope again.  A parent scope changes
+ * only through a Raise from its child, which localizes the value
+ * first, so cached results stay valid for the lifetime of a scope.
  */
 class cmDefinitions
 {
@@ -68,6 +74,9 @@ private:
 
   std::unordered_map<cm::String, Def> Map;
 
+  /** Definitions (or their absence) found in parent scopes.  */
+  std::unordered_map<cm::String, Def> Cache;
+
   static Def const& GetInternal(const std::string& key, StackIter begin,
                                 StackIter end, bool raise);
 };
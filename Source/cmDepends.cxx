@@ -44,6 +44,7 @@ bool cmDepends::Write(std::ostream& makeDepends, std::ostream& internalDepends)
       dependencies[obj].insert(src);
     }
   }
+  this->PrepareDependencies(dependencies);
   for (auto const& d : dependencies) {
     // Write the dependencies for this pair.
     if (!this->WriteDependencies(d.second, d.first, makeDepends,
@@ -55,6 +56,11 @@ bool cmDepends::Write(std::ostream& makeDepends, std::ostream& internalDepends)
   return this->Finalize(makeDepends, internalDepends);
 }
 
+void cmDepends::PrepareDependencies(
+  std::map<std::string, std::set<std::string>> const& /*unused*/)
+{
+}
+
 bool cmDepends::Finalize(std::ostream& /*unused*/, std::ostream& /*unused*/)
 {
   return true;
@@ -164,6 +170,8 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
     // * if the depender exists and is older than the dependee.
     // * if the depender does not exist, but the dependee is newer than the
     //   depends file
+    // When dependencies are updated after the build, the depender is
+    // always newer, so the dependee is compared with the depends file.
     bool regenerate = false;
     bool dependeeExists = this->FileTimeCache->Load(dependee, dependeeTime);
     if (!dependeeExists) {
@@ -177,7 +185,7 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
             << depender << "\"." << std::endl;
         cmSystemTools::Stdout(msg.str());
       }
-    } else if (dependerExists) {
+    } else if (dependerExists && !this->AfterBuild) {
       // The dependee and depender both exist.  Compare file times.
       if (dependerTime.Older(dependeeTime)) {
         // The depender is older than the dependee.
@@ -192,8 +200,8 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
         }
       }
     } else {
-      // The dependee exists, but the depender doesn't. Regenerate if the
-      // internalDepends file is older than the dependee.
+      // The dependee exists, but the depender doesn't or is newer anyway.
+      // Regenerate if the internalDepends file is older than the dependee.
       if (internalDependsTime.Older(dependeeTime)) {
         // The depends-file is older than the dependee.
         regenerate = true;
@@ -220,8 +228,9 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
         currentDependencies = nullptr;
       }
 
-      // Remove the depender to be sure it is rebuilt.
-      if (dependerExists) {
+      // Remove the depender to be sure it is rebuilt.  After the build
+      // it is already up to date.
+      if (dependerExists && !this->AfterBuild) {
         cmSystemTools::RemoveFile(depender);
         this->FileTimeCache->Remove(depender);
         dependerExists = false;
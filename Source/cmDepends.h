@@ -72,6 +72,11 @@ public:
   /** Set the file comparison object */
   void SetFileTimeCache(cmFileTimeCache* fc) { this->FileTimeCache = fc; }
 
+  /** Set whether dependencies are updated after the dependers are built
+      instead of before.  Check then compares the dependees with the
+      time of the last update instead of with the dependers.  */
+  void SetAfterBuild(bool afterBuild) { this->AfterBuild = afterBuild; }
+
 protected:
   // Write dependencies for the target file to the given stream.
   // Return true for success and false for failure.
@@ -80,6 +85,11 @@ protected:
                                  std::ostream& makeDepends,
                                  std::ostream& internalDepends);
 
+  // Prepare to write the dependencies of the given object files, which
+  // are mapped to their sources.
+  virtual void PrepareDependencies(
+    std::map<std::string, std::set<std::string>> const& dependencies);
+
   // Check dependencies for the target file in the given stream.
   // Return false if dependencies must be regenerated and true
   // otherwise.
@@ -96,6 +106,7 @@ protected:
 
   // Flag for verbose output.
   bool Verbose = false;
+  bool AfterBuild = false;
   cmFileTimeCache* FileTimeCache = nullptr;
 
   std::string Language;
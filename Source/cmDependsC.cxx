@@ -2,6 +2,10 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmDependsC.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <queue>
 #include <utility>
 
 #include "cmsys/FStream.hxx"
@@ -12,9 +16,20 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include <thread>
+
+#  include <cm/algorithm>
+
+#  include "cmCryptoHash.h"
+#  include "cmWorkerPool.h"
+#endif
+
 #define INCLUDE_REGEX_LINE                                                    \
   "^[ \t]*[#%][ \t]*(include|import)[ \t]*[<\"]([^\">]+)([\">])"
 
+#define INCLUDE_CACHE_VERSION_MARKER "#IncludeCacheVersion: "
+#define INCLUDE_CACHE_VERSION "2"
 #define INCLUDE_REGEX_LINE_MARKER "#IncludeRegexLine: "
 #define INCLUDE_REGEX_SCAN_MARKER "#IncludeRegexScan: "
 #define INCLUDE_REGEX_COMPLAIN_MARKER "#IncludeRegexComplain: "
@@ -58,10 +73,26 @@ cmDependsC::cmDependsC(cmLocalGenerator* lg, const std::string& targetDir,
 
   this->SetupTransforms();
 
-  this->CacheFileName =
-    cmStrCat(this->TargetDirectory, '/', lang, ".includecache");
+  this->CacheFileName = this->TargetDirectory;
+#ifndef CMAKE_BOOTSTRAP
+  // The include lines of a file do not depend on the target including
+  // it, so all targets scanning with the same rules share one cache.
+  {
+    cmCryptoHash md5(cmCryptoHash::AlgoMD5);
+    std::string const rulesHash = md5.HashString(this->GetCacheHeader());
+    this->CacheFileName =
+      cmStrCat(this->LocalGenerator->GetBinaryDirectory(),
+               "/CMakeFiles/CMakeIncludeCache");
+    cmSystemTools::MakeDirectory(this->CacheFileName);
+    this->CacheFileName = cmStrCat(this->CacheFileName, '/', lang, '-',
+                                   rulesHash.substr(0, 8));
+  }
+#else
+  this->CacheFileName = cmStrCat(this->CacheFileName, '/', lang);
+#endif
+  this->CacheFileName += ".includecache";
 
-  this->ReadCacheFile();
+  this->ReadCacheFile(this->FileCache);
 }
 
 cmDependsC::~cmDependsC()
@@ -69,6 +100,147 @@ cmDependsC::~cmDependsC()
   this->WriteCacheFile();
 }
 
+#ifndef CMAKE_BOOTSTRAP
+namespace {
+class ScanFileJob : public cmWorkerPool::JobT
+{
+public:
+  ScanFileJob(cmDependsC const& scanner,
+              std::vector<cmDependsC::ScanRegex>& regex,
+              std::string const& fullName, cmDependsC::cmIncludeLines& lines,
+              char& scanned)
+    : Scanner(scanner)
+    , Regex(regex)
+    , FullName(fullName)
+    , Lines(lines)
+    , Scanned(scanned)
+  {
+  }
+
+  void Process() override
+  {
+    this->Scanned = this->Scanner.ScanFile(this->FullName, this->Lines,
+                                           this->Regex[this->WorkerIndex()])
+      ? 1
+      : 0;
+  }
+
+private:
+  cmDependsC const& Scanner;
+  std::vector<cmDependsC::ScanRegex>& Regex;
+  std::string const& FullName;
+  cmDependsC::cmIncludeLines& Lines;
+  char& Scanned;
+};
+
+class ScanFilesDoneJob : public cmWorkerPool::JobFenceT
+{
+public:
+  void Process() override { this->Pool()->Abort(); }
+};
+}
+#endif
+
+void cmDependsC::PrepareDependencies(
+  std::map<std::string, std::set<std::string>> const& dependencies)
+{
+#ifndef CMAKE_BOOTSTRAP
+  // Collect the sources of all objects whose dependencies must be
+  // scanned.  The walks in WriteDependencies are sequential, so scan
+  // the files they will reach ahead of them, one level of includes at
+  // a time, on a pool of threads.  The walks then find every file in
+  // the cache.
+  std::string const binDir = this->LocalGenerator->GetBinaryDirectory();
+  std::set<std::string> found;
+  std::vector<std::string> level;
+  for (auto const& d : dependencies) {
+    if (this->ValidDeps != nullptr &&
+        this->ValidDeps->count(
+          this->LocalGenerator->MaybeConvertToRelativePath(binDir, d.first))) {
+      continue;
+    }
+    for (std::string const& src : d.second) {
+      if (found.insert(src).second && this->FileExists(src)) {
+        level.push_back(src);
+      }
+    }
+  }
+
+  std::set<std::string> resolved;
+  while (!level.empty()) {
+    std::vector<std::string> unscanned;
+    for (std::string const& fullName : level) {
+      if (this->GetCachedIncludeLines(fullName) == nullptr) {
+        unscanned.push_back(fullName);
+      }
+    }
+    this->ScanFiles(unscanned);
+
+    std::vector<std::string> next;
+    for (std::string const& fullName : level) {
+      auto const fileIt = this->FileCache.find(fullName);
+      if (fileIt == this->FileCache.end()) {
+        continue;
+      }
+      for (UnscannedEntry const& inc : fileIt->second.UnscannedEntries) {
+        if (!resolved.insert(cmStrCat(inc.FileName, '\n', inc.QuotedLocation))
+               .second) {
+          continue;
+        }
+        std::string incName = this->FindIncludedFile(inc);
+        if (!incName.empty() && found.insert(incName).second) {
+          next.push_back(std::move(incName));
+        }
+      }
+    }
+    level = std::move(next);
+  }
+#else
+  static_cast<void>(dependencies);
+#endif
+}
+
+void cmDependsC::ScanFiles(std::vector<std::string> const& fullNames)
+{
+  std::vector<cmIncludeLines> lines(fullNames.size());
+  std::vector<char> scanned(fullNames.size(), 0);
+
+#ifndef CMAKE_BOOTSTRAP
+  unsigned int const threads = std::min(
+    cm::clamp(std::thread::hardware_concurrency(), 1u, 4u),
+    static_cast<unsigned int>(fullNames.size()));
+  if (threads > 1) {
+    std::vector<ScanRegex> regex(threads,
+                                 ScanRegex{ this->IncludeRegexLine,
+                                            this->IncludeRegexScan,
+                                            this->IncludeRegexTransform });
+    cmWorkerPool pool;
+    pool.SetThreadCount(threads);
+    for (std::size_t i = 0; i != fullNames.size(); ++i) {
+      pool.EmplaceJob<ScanFileJob>(*this, regex, fullNames[i], lines[i],
+                                   scanned[i]);
+    }
+    pool.EmplaceJob<ScanFilesDoneJob>();
+    pool.Process();
+  } else
+#endif
+  {
+    ScanRegex regex{ this->IncludeRegexLine, this->IncludeRegexScan,
+                     this->IncludeRegexTransform };
+    for (std::size_t i = 0; i != fullNames.size(); ++i) {
+      scanned[i] = this->ScanFile(fullNames[i], lines[i], regex) ? 1 : 0;
+    }
+  }
+
+  for (std::size_t i = 0; i != fullNames.size(); ++i) {
+    if (scanned[i]) {
+      lines[i].Checked = true;
+      this->FileCache[fullNames[i]] = std::move(lines[i]);
+      this->FileCacheModified = true;
+    }
+  }
+}
+
 bool cmDependsC::WriteDependencies(const std::set<std::string>& sources,
                                    const std::string& obj,
                                    std::ostream& makeDepends,
@@ -106,53 +278,30 @@ bool cmDependsC::WriteDependencies(const std::set<std::string>& sources,
   if (!haveDeps) {
     // Walk the dependency graph starting with the source file.
     int srcFiles = static_cast<int>(sources.size());
-    this->Encountered.clear();
+    std::set<std::string> encountered;
+    std::queue<UnscannedEntry> unscanned;
 
     for (std::string const& src : sources) {
       UnscannedEntry root;
       root.FileName = src;
-      this->Unscanned.push(root);
-      this->Encountered.insert(src);
+      unscanned.push(root);
+      encountered.insert(src);
     }
 
     std::set<std::string> scanned;
-    while (!this->Unscanned.empty()) {
+    while (!unscanned.empty()) {
       // Get the next file to scan.
-      UnscannedEntry current = this->Unscanned.front();
-      this->Unscanned.pop();
+      UnscannedEntry current = unscanned.front();
+      unscanned.pop();
 
       // If not a full path, find the file in the include path.
       std::string fullName;
       if ((srcFiles > 0) || cmSystemTools::FileIsFullPath(current.FileName)) {
-        if (cmSystemTools::FileExists(current.FileName, true)) {
+        if (this->FileExists(current.FileName)) {
           fullName = current.FileName;
         }
-      } else if (!current.QuotedLocation.empty() &&
-                 cmSystemTools::FileExists(current.QuotedLocation, true)) {
-        // The include statement producing this entry was a double-quote
-        // include and the included file is present in the directory of
-        // the source containing the include statement.
-        fullName = current.QuotedLocation;
       } else {
-        auto headerLocationIt =
-          this->HeaderLocationCache.find(current.FileName);
-        if (headerLocationIt != this->HeaderLocationCache.end()) {
-          fullName = headerLocationIt->second;
-        } else {
-          for (std::string const& iPath : this->IncludePath) {
-            // Construct the name of the file as if it were in the current
-            // include directory.  Avoid using a leading "./".
-            std::string tmpPath =
-              cmSystemTools::CollapseFullPath(current.FileName, iPath);
-
-            // Look for the file in this location.
-            if (cmSystemTools::FileExists(tmpPath, true)) {
-              fullName = tmpPath;
-              this->HeaderLocationCache[current.FileName] = std::move(tmpPath);
-              break;
-            }
-          }
-        }
+        fullName = this->FindIncludedFile(current);
       }
 
       // Complain if the file cannot be found and matches the complain
@@ -168,36 +317,19 @@ bool cmDependsC::WriteDependencies(const std::set<std::string>& sources,
         // Record scanned files.
         scanned.insert(fullName);
 
-        // Check whether this file is already in the cache
-        auto fileIt = this->FileCache.find(fullName);
-        if (fileIt != this->FileCache.end()) {
-          fileIt->second.Used = true;
+        // Check whether this file is already in the cache.  Try to
+        // scan it if not, and just leave it out if we cannot read it.
+        cmIncludeLines const* lines = this->GetCachedIncludeLines(fullName);
+        if (lines == nullptr) {
+          this->ScanFiles(std::vector<std::string>(1, fullName));
+          lines = this->GetCachedIncludeLines(fullName);
+        }
+        if (lines != nullptr) {
+          // Add this file as a dependency.
           dependencies.insert(fullName);
-          for (UnscannedEntry const& inc : fileIt->second.UnscannedEntries) {
-            if (this->Encountered.find(inc.FileName) ==
-                this->Encountered.end()) {
-              this->Encountered.insert(inc.FileName);
-              this->Unscanned.push(inc);
-            }
-          }
-        } else {
-
-          // Try to scan the file.  Just leave it out if we cannot find
-          // it.
-          cmsys::ifstream fin(fullName.c_str());
-          if (fin) {
-            cmsys::FStream::BOM bom = cmsys::FStream::ReadBOM(fin);
-            if (bom == cmsys::FStream::BOM_None ||
-                bom == cmsys::FStream::BOM_UTF8) {
-              // Add this file as a dependency.
-              dependencies.insert(fullName);
-
-              // Scan this file for new dependencies.  Pass the directory
-              // containing the file to handle double-quote includes.
-              std::string dir = cmSystemTools::GetFilenamePath(fullName);
-              this->Scan(fin, dir, fullName);
-            } else {
-              // Skip file with encoding we do not implement.
+          for (UnscannedEntry const& inc : lines->UnscannedEntries) {
+            if (encountered.insert(inc.FileName).second) {
+              unscanned.push(inc);
             }
           }
         }
@@ -212,76 +344,150 @@ bool cmDependsC::WriteDependencies(const std::set<std::string>& sources,
   // convert the dependencies to paths relative to the home output
   // directory.  We must do the same here.
   std::string obj_m = cmSystemTools::ConvertToOutputPath(obj_i);
-  internalDepends << obj_i << std::endl;
+  internalDepends << obj_i << '\n';
 
   for (std::string const& dep : dependencies) {
-    makeDepends << obj_m << ": "
-                << cmSystemTools::ConvertToOutputPath(
+    // Most headers are dependencies of many objects, so convert each
+    // one only once.
+    auto outputPathIt = this->OutputPaths.find(dep);
+    if (outputPathIt == this->OutputPaths.end()) {
+      outputPathIt =
+        this->OutputPaths
+          .emplace(dep,
+                   cmSystemTools::ConvertToOutputPath(
                      this->LocalGenerator->MaybeConvertToRelativePath(binDir,
-                                                                      dep))
-                << std::endl;
-    internalDepends << " " << dep << std::endl;
+                                                                      dep)))
+          .first;
+    }
+    makeDepends << obj_m << ": " << outputPathIt->second << '\n';
+    internalDepends << " " << dep << '\n';
   }
-  makeDepends << std::endl;
-
+  makeDepends << '\n';
   return true;
 }
 
-void cmDependsC::ReadCacheFile()
+std::string cmDependsC::FindIncludedFile(UnscannedEntry const& entry)
+{
+  if (cmSystemTools::FileIsFullPath(entry.FileName)) {
+    if (this->FileExists(entry.FileName)) {
+      return entry.FileName;
+    }
+    return std::string();
+  }
+  if (!entry.QuotedLocation.empty() &&
+      this->FileExists(entry.QuotedLocation)) {
+    // The include statement producing this entry was a double-quote
+    // include and the included file is present in the directory of
+    // the source containing the include statement.
+    return entry.QuotedLocation;
+  }
+  auto headerLocationIt = this->HeaderLocationCache.find(entry.FileName);
+  if (headerLocationIt != this->HeaderLocationCache.end()) {
+    return headerLocationIt->second;
+  }
+  for (std::string const& iPath : this->IncludePath) {
+    // Construct the name of the file as if it were in the current
+    // include directory.  Avoid using a leading "./".
+    std::string tmpPath =
+      cmSystemTools::CollapseFullPath(entry.FileName, iPath);
+
+    // Look for the file in this location.
+    if (this->FileExists(tmpPath)) {
+      this->HeaderLocationCache[entry.FileName] = tmpPath;
+      return tmpPath;
+    }
+  }
+  return std::string();
+}
+
+bool cmDependsC::FileExists(std::string const& fullName)
+{
+  // The walks of all objects look for the same files.
+  auto existsIt = this->FileExistsCache.find(fullName);
+  if (existsIt == this->FileExistsCache.end()) {
+    existsIt = this->FileExistsCache
+                 .emplace(fullName, cmSystemTools::FileExists(fullName, true))
+                 .first;
+  }
+  return existsIt->second;
+}
+
+cmDependsC::cmIncludeLines const* cmDependsC::GetCachedIncludeLines(
+  std::string const& fullName)
+{
+  auto const fileIt = this->FileCache.find(fullName);
+  if (fileIt == this->FileCache.end()) {
+    return nullptr;
+  }
+  cmIncludeLines& lines = fileIt->second;
+  if (!lines.Checked) {
+    // Entries read from the cache file are valid only if the file has
+    // not been modified since it was scanned.
+    cmFileTime fileTime;
+    if (!fileTime.Load(fullName) || fileTime.GetNS() != lines.Time) {
+      this->FileCache.erase(fileIt);
+      this->Invalidated.insert(fullName);
+      this->FileCacheModified = true;
+      return nullptr;
+    }
+    lines.Checked = true;
+  }
+  return &lines;
+}
+
+std::string cmDependsC::GetCacheHeader() const
+{
+  return cmStrCat(INCLUDE_CACHE_VERSION_MARKER, INCLUDE_CACHE_VERSION, '\n',
+                  this->IncludeRegexLineString, '\n',
+                  this->IncludeRegexScanString, '\n',
+                  this->IncludeRegexComplainString, '\n',
+                  this->IncludeRegexTransformString, '\n');
+}
+
+bool cmDependsC::ReadCacheFile(FileCacheType& cache) const
 {
   if (this->CacheFileName.empty()) {
-    return;
+    return false;
   }
   cmsys::ifstream fin(this->CacheFileName.c_str());
   if (!fin) {
-    return;
+    return false;
   }
 
+  // The cache is usable only if it was written with the same rules.
   std::string line;
+  std::string header;
+  while (cmSystemTools::GetLineFromStream(fin, line) && !line.empty()) {
+    header += line;
+    header += '\n';
+  }
+  if (header != this->GetCacheHeader()) {
+    return false;
+  }
+
+  // Each entry is the name of a scanned file, its modification time
+  // and pairs of lines naming each included file and its location
+  // relative to the including file, terminated by an empty line.
   cmIncludeLines* cacheEntry = nullptr;
   bool haveFileName = false;
-
-  cmFileTime cacheFileTime;
-  bool const cacheFileTimeGood = cacheFileTime.Load(this->CacheFileName);
+  bool haveTime = false;
+  std::string fileName;
   while (cmSystemTools::GetLineFromStream(fin, line)) {
     if (line.empty()) {
       cacheEntry = nullptr;
       haveFileName = false;
+      haveTime = false;
       continue;
     }
-    // the first line after an empty line is the name of the parsed file
     if (!haveFileName) {
       haveFileName = true;
-
-      cmFileTime fileTime;
-      bool const res = cacheFileTimeGood && fileTime.Load(line);
-      bool const newer = res && cacheFileTime.Newer(fileTime);
-
-      if (res && newer) // cache is newer than the parsed file
-      {
-        cacheEntry = &this->FileCache[line];
-      }
-      // file doesn't exist, check that the regular expressions
-      // haven't changed
-      else if (!res) {
-        if (line.find(INCLUDE_REGEX_LINE_MARKER) == 0) {
-          if (line != this->IncludeRegexLineString) {
-            return;
-          }
-        } else if (line.find(INCLUDE_REGEX_SCAN_MARKER) == 0) {
-          if (line != this->IncludeRegexScanString) {
-            return;
-          }
-        } else if (line.find(INCLUDE_REGEX_COMPLAIN_MARKER) == 0) {
-          if (line != this->IncludeRegexComplainString) {
-            return;
-          }
-        } else if (line.find(INCLUDE_REGEX_TRANSFORM_MARKER) == 0) {
-          if (line != this->IncludeRegexTransformString) {
-            return;
-          }
-        }
-      }
+      fileName = line;
+    } else if (!haveTime) {
+      haveTime = true;
+      cacheEntry = &cache[fileName];
+      cacheEntry->UnscannedEntries.clear();
+      cacheEntry->Time = std::strtoll(line.c_str(), nullptr, 10);
+      cacheEntry->Checked = false;
     } else if (cacheEntry != nullptr) {
       UnscannedEntry entry;
       entry.FileName = line;
@@ -293,61 +499,142 @@ void cmDependsC::ReadCacheFile()
       }
     }
   }
+  return true;
 }
 
-void cmDependsC::WriteCacheFile() const
+void cmDependsC::WriteCacheFile()
 {
-  if (this->CacheFileName.empty()) {
+  if (this->CacheFileName.empty() || !this->FileCacheModified) {
     return;
   }
-  cmsys::ofstream cacheOut(this->CacheFileName.c_str());
-  if (!cacheOut) {
-    return;
+
+  // Other targets may have updated the shared cache file since we read
+  // it.  Keep their entries for files we have not looked at.
+  {
+    FileCacheType onDisk;
+    this->ReadCacheFile(onDisk);
+    for (auto& fileIt : onDisk) {
+      if (!this->Invalidated.count(fileIt.first)) {
+        this->FileCache.emplace(fileIt.first, std::move(fileIt.second));
+      }
+    }
+  }
+
+  // Drop entries of files that were deleted or renamed so that the
+  // shared cache does not grow forever.  Files looked at in this run
+  // are known to exist.
+  for (auto fileIt = this->FileCache.begin();
+       fileIt != this->FileCache.end();) {
+    if (!fileIt->second.Checked && !this->FileExists(fileIt->first)) {
+      fileIt = this->FileCache.erase(fileIt);
+    } else {
+      ++fileIt;
+    }
   }
 
-  cacheOut << this->IncludeRegexLineString << "\n\n";
-  cacheOut << this->IncludeRegexScanString << "\n\n";
-  cacheOut << this->IncludeRegexComplainString << "\n\n";
-  cacheOut << this->IncludeRegexTransformString << "\n\n";
+  // Write to a file of our own and move it into place so that
+  // concurrent scanners never see a partially written cache.
+  std::string const tmpName =
+    cmStrCat(this->CacheFileName, '.', cmSystemTools::RandomSeed(), ".tmp");
+  {
+    cmsys::ofstream cacheOut(tmpName.c_str());
+    if (!cacheOut) {
+      return;
+    }
 
-  for (auto const& fileIt : this->FileCache) {
-    if (fileIt.second.Used) {
-      cacheOut << fileIt.first << std::endl;
+    cacheOut << this->GetCacheHeader() << '\n';
 
+    for (auto const& fileIt : this->FileCache) {
+      cacheOut << fileIt.first << '\n' << fileIt.second.Time << '\n';
       for (UnscannedEntry const& inc : fileIt.second.UnscannedEntries) {
-        cacheOut << inc.FileName << std::endl;
+        cacheOut << inc.FileName << '\n';
         if (inc.QuotedLocation.empty()) {
-          cacheOut << "-" << std::endl;
+          cacheOut << "-\n";
         } else {
-          cacheOut << inc.QuotedLocation << std::endl;
+          cacheOut << inc.QuotedLocation << '\n';
         }
       }
-      cacheOut << std::endl;
+      cacheOut << '\n';
     }
+    if (!cacheOut) {
+      cacheOut.close();
+      cmSystemTools::RemoveFile(tmpName);
+      return;
+    }
+  }
+  if (!cmSystemTools::RenameFile(tmpName, this->CacheFileName)) {
+    cmSystemTools::RemoveFile(tmpName);
   }
 }
 
-void cmDependsC::Scan(std::istream& is, const std::string& directory,
-                      const std::string& fullName)
+bool cmDependsC::ScanFile(std::string const& fullName, cmIncludeLines& lines,
+                          ScanRegex& regex) const
 {
-  cmIncludeLines& newCacheEntry = this->FileCache[fullName];
-  newCacheEntry.Used = true;
+  cmsys::ifstream fin(fullName.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  cmsys::FStream::BOM bom = cmsys::FStream::ReadBOM(fin);
+  if (bom != cmsys::FStream::BOM_None && bom != cmsys::FStream::BOM_UTF8) {
+    // Skip file with encoding we do not implement.
+    return false;
+  }
+  cmFileTime fileTime;
+  if (fileTime.Load(fullName)) {
+    lines.Time = fileTime.GetNS();
+  }
+
+  // Read the whole file at once.  Most of its lines cannot be include
+  // directives, so look at the first character of each before matching
+  // the regular expressions.
+  std::string content;
+  {
+    std::istream::pos_type const begin = fin.tellg();
+    fin.seekg(0, std::ios::end);
+    std::istream::pos_type const end = fin.tellg();
+    fin.seekg(begin);
+    if (begin != std::istream::pos_type(-1) && end > begin) {
+      content.resize(static_cast<std::size_t>(end - begin));
+      fin.read(&content[0], static_cast<std::streamsize>(content.size()));
+      content.resize(static_cast<std::size_t>(fin.gcount()));
+    }
+  }
+
+  // Pass the directory containing the file to handle double-quote
+  // includes.
+  std::string const directory = cmSystemTools::GetFilenamePath(fullName);
 
-  // Read one line at a time.
   std::string line;
-  while (cmSystemTools::GetLineFromStream(is, line)) {
+  std::string::size_type pos = 0;
+  while (pos < content.size()) {
+    std::string::size_type end = content.find('\n', pos);
+    if (end == std::string::npos) {
+      end = content.size();
+    }
+    std::string::size_type first = content.find_first_not_of(" \t", pos);
+    bool const directive = first < end &&
+      (content[first] == '#' || content[first] == '%');
+    std::string::size_type const lineEnd =
+      (end > pos && content[end - 1] == '\r') ? end - 1 : end;
+    std::string::size_type const lineBegin = pos;
+    pos = end + 1;
+    if (!directive) {
+      continue;
+    }
+    line.assign(content, lineBegin, lineEnd - lineBegin);
+
     // Transform the line content first.
     if (!this->TransformRules.empty()) {
-      this->TransformLine(line);
+      this->TransformLine(line, regex);
     }
 
     // Match include directives.
-    if (this->IncludeRegexLine.find(line)) {
+    if (regex.Line.find(line)) {
       // Get the file being included.
       UnscannedEntry entry;
-      entry.FileName = this->IncludeRegexLine.match(2);
+      entry.FileName = regex.Line.match(2);
       cmSystemTools::ConvertToUnixSlashes(entry.FileName);
-      if (this->IncludeRegexLine.match(3) == "\"" &&
+      if (regex.Line.match(3) == "\"" &&
           !cmSystemTools::FileIsFullPath(entry.FileName)) {
         // This was a double-quoted include with a relative path.  We
         // must check for the file in the directory containing the
@@ -356,26 +643,22 @@ void cmDependsC::Scan(std::istream& is, const std::string& directory,
           cmSystemTools::CollapseFullPath(entry.FileName, directory);
       }
 
-      // Queue the file if it has not yet been encountered and it
-      // matches the regular expression for recursive scanning.  Note
-      // that this check does not account for the possibility of two
-      // headers with the same name in different directories when one
-      // is included by double-quotes and the other by angle brackets.
-      // It also does not work properly if two header files with the same
-      // name exist in different directories, and both are included from a
-      // file their own directory by simply using "filename.h" (#12619)
-      // This kind of problem will be fixed when a more
-      // preprocessor-like implementation of this scanner is created.
-      if (this->IncludeRegexScan.find(entry.FileName)) {
-        newCacheEntry.UnscannedEntries.push_back(entry);
-        if (this->Encountered.find(entry.FileName) ==
-            this->Encountered.end()) {
-          this->Encountered.insert(entry.FileName);
-          this->Unscanned.push(entry);
-        }
+      // Queue the file if it matches the regular expression for
+      // recursive scanning.  Note that the walk does not account for
+      // the possibility of two headers with the same name in different
+      // directories when one is included by double-quotes and the
+      // other by angle brackets.  It also does not work properly if two
+      // header files with the same name exist in different directories,
+      // and both are included from a file their own directory by simply
+      // using "filename.h" (#12619) This kind of problem will be fixed
+      // when a more preprocessor-like implementation of this scanner is
+      // created.
+      if (regex.Scan.find(entry.FileName)) {
+        lines.UnscannedEntries.push_back(std::move(entry));
       }
     }
   }
+  return true;
 }
 
 void cmDependsC::SetupTransforms()
@@ -429,20 +712,20 @@ void cmDependsC::ParseTransform(std::string const& xform)
   this->TransformRules[name] = value;
 }
 
-void cmDependsC::TransformLine(std::string& line)
+void cmDependsC::TransformLine(std::string& line, ScanRegex& regex) const
 {
   // Check for a transform rule match.  Return if none.
-  if (!this->IncludeRegexTransform.find(line)) {
+  if (!regex.Transform.find(line)) {
     return;
   }
-  auto tri = this->TransformRules.find(this->IncludeRegexTransform.match(3));
+  auto tri = this->TransformRules.find(regex.Transform.match(3));
   if (tri == this->TransformRules.end()) {
     return;
   }
 
   // Construct the transformed line.
-  std::string newline = this->IncludeRegexTransform.match(1);
-  std::string arg = this->IncludeRegexTransform.match(4);
+  std::string newline = regex.Transform.match(1);
+  std::string arg = regex.Transform.match(4);
   for (char c : tri->second) {
     if (c == '%') {
       newline += arg;
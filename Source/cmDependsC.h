@@ -7,7 +7,6 @@
 
 #include <iosfwd>
 #include <map>
-#include <queue>
 #include <set>
 #include <string>
 #include <vector>
@@ -38,14 +37,13 @@ public:
 
 protected:
   // Implement writing/checking methods required by superclass.
+  void PrepareDependencies(
+    std::map<std::string, std::set<std::string>> const& dependencies)
+    override;
   bool WriteDependencies(const std::set<std::string>& sources,
                          const std::string& obj, std::ostream& makeDepends,
                          std::ostream& internalDepends) override;
 
-  // Method to scan a single file.
-  void Scan(std::istream& is, const std::string& directory,
-            const std::string& fullName);
-
   // Regular expression to identify C preprocessor include directives.
   cmsys::RegularExpression IncludeRegexLine;
 
@@ -64,7 +62,6 @@ protected:
   TransformRulesType TransformRules;
   void SetupTransforms();
   void ParseTransform(std::string const& xform);
-  void TransformLine(std::string& line);
 
 public:
   // Data structures for dependency graph walk.
@@ -77,21 +74,58 @@ public:
   struct cmIncludeLines
   {
     std::vector<UnscannedEntry> UnscannedEntries;
-    bool Used = false;
+    // Modification time of the file when it was scanned.
+    long long Time = 0;
+    bool Checked = false;
   };
 
+  // The regular expressions used to scan a file.  Files scanned
+  // concurrently each need their own copy.
+  struct ScanRegex
+  {
+    cmsys::RegularExpression Line;
+    cmsys::RegularExpression Scan;
+    cmsys::RegularExpression Transform;
+  };
+
+  // Method to scan a single file.  Returns false if the file cannot
+  // be read or has an encoding we do not implement.
+  bool ScanFile(std::string const& fullName, cmIncludeLines& lines,
+                ScanRegex& regex) const;
+
 protected:
+  void TransformLine(std::string& line, ScanRegex& regex) const;
+
+  // Find the full path to a file included from another one.
+  std::string FindIncludedFile(UnscannedEntry const& entry);
+
+  // Check whether a file exists, looking at the file system only once
+  // for each file.
+  bool FileExists(std::string const& fullName);
+
+  // Get the cached include lines of a file, or nullptr if the file has
+  // not been scanned or has changed since.
+  cmIncludeLines const* GetCachedIncludeLines(std::string const& fullName);
+
+  // Scan the given files, concurrently where possible, and store their
+  // include lines in the cache.
+  void ScanFiles(std::vector<std::string> const& fullNames);
+
   const DependencyMap* ValidDeps = nullptr;
-  std::set<std::string> Encountered;
-  std::queue<UnscannedEntry> Unscanned;
 
-  std::map<std::string, cmIncludeLines> FileCache;
+  using FileCacheType = std::map<std::string, cmIncludeLines>;
+  FileCacheType FileCache;
+  std::set<std::string> Invalidated;
+  bool FileCacheModified = false;
   std::map<std::string, std::string> HeaderLocationCache;
+  std::map<std::string, std::string> OutputPaths;
+  std::map<std::string, bool> FileExistsCache;
 
   std::string CacheFileName;
 
-  void WriteCacheFile() const;
-  void ReadCacheFile();
+  std::string GetCacheHeader() const;
+  void WriteCacheFile();
+  bool ReadCacheFile(FileCacheType& cache) const;
 };
 
 #endif
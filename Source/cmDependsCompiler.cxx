@@ -0,0 +1,129 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmDependsCompiler.h"
+
+#include <set>
+#include <sstream>
+#include <utility>
+
+#include "cmFileTimeCache.h"
+#include "cmGccDepfileReader.h"
+#include "cmGccDepfileReaderTypes.h"
+#include "cmGeneratedFileStream.h"
+#include "cmLocalGenerator.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+cmDependsCompiler::cmDependsCompiler(cmLocalGenerator* lg,
+                                     std::string targetDir)
+  : LocalGenerator(lg)
+  , TargetDirectory(std::move(targetDir))
+  , DependFile(cmStrCat(this->TargetDirectory, "/compiler_depend.make"))
+  , TimestampFile(cmStrCat(this->TargetDirectory, "/compiler_depend.ts"))
+{
+}
+
+bool cmDependsCompiler::NeedsUpdate(
+  std::vector<std::string> const& objectDepfiles) const
+{
+  if (!cmSystemTools::FileExists(this->TimestampFile)) {
+    return true;
+  }
+  for (auto i = objectDepfiles.begin();
+       i != objectDepfiles.end() && (i + 1) != objectDepfiles.end(); i += 2) {
+    std::string const& depfile = *(i + 1);
+    int result;
+    if (cmSystemTools::FileExists(depfile) &&
+        (!this->FileTimeCache->Compare(this->TimestampFile, depfile,
+                                       &result) ||
+         result < 0)) {
+      if (this->Verbose) {
+        std::ostringstream msg;
+        msg << "Dependee \"" << depfile << "\" is newer than depender \""
+            << this->TimestampFile << "\"." << std::endl;
+        cmSystemTools::Stdout(msg.str());
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cmDependsCompiler::Update(std::vector<std::string> const& objectDepfiles)
+{
+  // Paths in the depfiles are relative to the directory in which the
+  // compiler ran.  Makefile rules written by the original local generator
+  // for this directory convert the paths to be relative to the home
+  // output directory.  We must do the same here.
+  std::string const& binDir = this->LocalGenerator->GetBinaryDirectory();
+  std::string const& workDir =
+    this->LocalGenerator->GetCurrentBinaryDirectory();
+  auto convert = [this, &binDir, &workDir](std::string const& path) {
+    std::string const full = cmSystemTools::CollapseFullPath(path, workDir);
+    return cmSystemTools::ConvertToOutputPath(
+      this->LocalGenerator->MaybeConvertToRelativePath(binDir, full));
+  };
+
+  // Write the make dependencies.  This should be copy-if-different
+  // because the make tool may try to reload it needlessly otherwise.
+  cmGeneratedFileStream makeDepends(this->DependFile);
+  makeDepends.SetCopyIfDifferent(true);
+  if (!makeDepends) {
+    return false;
+  }
+  makeDepends << "# CMAKE generated file: DO NOT EDIT!\n"
+              << "# Generated from the compiler depfiles of the target.\n\n";
+
+  std::set<std::string> dependees;
+  for (auto i = objectDepfiles.begin();
+       i != objectDepfiles.end() && (i + 1) != objectDepfiles.end(); i += 2) {
+    std::string const& depfile = *(i + 1);
+    if (!cmSystemTools::FileExists(depfile)) {
+      // The object has not been compiled yet.
+      continue;
+    }
+    std::string const obj_m = convert(*i);
+    for (cmGccStyleDependency const& dep : cmReadGccDepfile(depfile.c_str())) {
+      for (std::string const& path : dep.paths) {
+        std::string const path_m = convert(path);
+        makeDepends << obj_m << ": " << path_m << '\n';
+        dependees.insert(path_m);
+      }
+    }
+    makeDepends << '\n';
+  }
+
+  // A dependency that no longer exists must not stop the build before
+  // its dependents are compiled again and drop it.
+  makeDepends << "\n# Dependencies that may have been removed:\n";
+  for (std::string const& dependee : dependees) {
+    makeDepends << dependee << ":\n";
+  }
+  makeDepends.Close();
+
+  // Record when the depfiles were merged.
+  cmGeneratedFileStream timestamp(this->TimestampFile);
+  timestamp << "# CMAKE generated file: DO NOT EDIT!\n"
+            << "# Timestamp file for compiler generated dependencies "
+               "management.\n";
+  return static_cast<bool>(timestamp);
+}
+
+void cmDependsCompiler::Clear()
+{
+  // Print verbose output.
+  if (this->Verbose) {
+    std::ostringstream msg;
+    msg << "Clearing dependencies in \"" << this->DependFile << "\"."
+        << std::endl;
+    cmSystemTools::Stdout(msg.str());
+  }
+
+  // Write an empty dependency file and force the depfiles to be merged
+  // again.
+  cmGeneratedFileStream depFileStream(this->DependFile);
+  depFileStream << "# Empty compiler generated dependencies file\n"
+                << "# This may be replaced when dependencies are built."
+                << std::endl;
+  cmSystemTools::RemoveFile(this->TimestampFile);
+}
@@ -0,0 +1,59 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmDependsCompiler_h
+#define cmDependsCompiler_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+class cmFileTimeCache;
+class cmLocalGenerator;
+
+/** \class cmDependsCompiler
+ * \brief Merge dependencies written by the compiler.
+ *
+ * Compilers that support it write the dependencies of each object file
+ * to a depfile while compiling it.  This class collects the depfiles of
+ * a target into the compiler_depend.make file included by the target's
+ * build.make, so that the dependencies of a source need not be scanned
+ * by CMake.  The merge is redone only when a depfile is newer than the
+ * compiler_depend.ts file of the target.
+ */
+class cmDependsCompiler
+{
+public:
+  cmDependsCompiler(cmLocalGenerator* lg, std::string targetDir);
+
+  cmDependsCompiler(cmDependsCompiler const&) = delete;
+  cmDependsCompiler& operator=(cmDependsCompiler const&) = delete;
+
+  /** should this be verbose in its output */
+  void SetVerbose(bool verb) { this->Verbose = verb; }
+
+  /** Set the file comparison object */
+  void SetFileTimeCache(cmFileTimeCache* fc) { this->FileTimeCache = fc; }
+
+  /** Check whether any of the given depfiles changed since they were
+      last merged.  The list holds pairs of an object file and its
+      depfile, both as full paths.  */
+  bool NeedsUpdate(std::vector<std::string> const& objectDepfiles) const;
+
+  /** Merge the given depfiles.  Returns false if the result cannot be
+      written.  */
+  bool Update(std::vector<std::string> const& objectDepfiles);
+
+  /** Clear the merged dependencies of the target.  */
+  void Clear();
+
+private:
+  cmLocalGenerator* LocalGenerator;
+  std::string TargetDirectory;
+  std::string DependFile;
+  std::string TimestampFile;
+  cmFileTimeCache* FileTimeCache = nullptr;
+  bool Verbose = false;
+};
+
+#endif
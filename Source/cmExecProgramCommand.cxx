@@ -7,6 +7,7 @@
 #include "cmsys/Process.h"
 
 #include "cmExecutionStatus.h"
+#include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
 #include "cmProcessOutput.h"
 #include "cmStringAlgorithms.h"
@@ -28,6 +29,7 @@ bool cmExecProgramCommand(std::vector<std::string> const& args,
     status.SetError("called with incorrect number of arguments");
     return false;
   }
+  status.GetMakefile().MarkGenerateFingerprintIncomplete();
   std::string arguments;
   bool doingargs = false;
   int count = 0;
@@ -97,6 +99,7 @@ bool cmExecProgramCommand(std::vector<std::string> const& args,
   if (!result) {
     retVal = -1;
   }
+  status.GetMakefile().GetGlobalGenerator()->InvalidateFindDirectoryContent();
 
   if (!output_variable.empty()) {
     std::string::size_type first = output.find_first_not_of(" \n\t\r");
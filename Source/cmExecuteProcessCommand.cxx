@@ -17,6 +17,7 @@
 
 #include "cmArgumentParser.h"
 #include "cmExecutionStatus.h"
+#include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
 #include "cmProcessOutput.h"
@@ -43,6 +44,7 @@ bool cmExecuteProcessCommand(std::vector<std::string> const& args,
     status.SetError("called with incorrect number of arguments");
     return false;
   }
+  status.GetMakefile().MarkGenerateFingerprintIncomplete();
 
   struct Arguments
   {
@@ -279,6 +281,7 @@ bool cmExecuteProcessCommand(std::vector<std::string> const& args,
 
   // All output has been read.  Wait for the process to exit.
   cmsysProcess_WaitForExit(cp, nullptr);
+  status.GetMakefile().GetGlobalGenerator()->InvalidateFindDirectoryContent();
   processOutput.DecodeText(tempOutput, tempOutput);
   processOutput.DecodeText(tempError, tempError);
 
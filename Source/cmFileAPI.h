@@ -28,6 +28,9 @@ public:
   /** Write fileapi replies to disk.  */
   void WriteReplies();
 
+  /** Whether any query was found by ReadQueries().  */
+  bool HasQueries() const { return this->QueryExists; }
+
   /** Get the "cmake" instance with which this was constructed.  */
   cmake* GetCMakeInstance() const { return this->CMakeInstance; }
 
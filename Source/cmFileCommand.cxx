@@ -3157,5 +3157,34 @@ bool cmFileCommand(std::vector<std::string> const& args,
     { "ARCHIVE_EXTRACT"_s, HandleArchiveExtractCommand },
   };
 
-  return subcommand(args[0], args, status);
+  bool const result = subcommand(args[0], args, status);
+
+  // Let the find commands see what the project changed outside of its
+  // source and build trees.
+  static std::set<std::string> const modifying{
+    "WRITE",       "APPEND",         "DOWNLOAD",        "MAKE_DIRECTORY",
+    "RENAME",      "REMOVE",         "REMOVE_RECURSE",  "COPY",
+    "INSTALL",     "TOUCH",          "LOCK",            "CREATE_LINK",
+    "CONFIGURE",   "ARCHIVE_CREATE", "ARCHIVE_EXTRACT",
+  };
+  if (modifying.count(args[0])) {
+    cmGlobalGenerator* gg = status.GetMakefile().GetGlobalGenerator();
+    for (std::string const& arg : cmMakeRange(args).advance(1)) {
+      gg->InvalidateFindDirectoryContent(arg);
+    }
+  }
+
+  // Values read from files are not part of the generate fingerprint.
+  static std::set<std::string> const reading{
+    "DOWNLOAD", "READ",         "MD5",          "SHA1",
+    "SHA224",   "SHA256",       "SHA384",       "SHA512",
+    "SHA3_224", "SHA3_256",     "SHA3_384",     "SHA3_512",
+    "STRINGS",  "GLOB",         "GLOB_RECURSE", "DIFFERENT",
+    "READ_ELF", "RPATH_CHECK",  "TIMESTAMP",    "SIZE",
+    "LOCK",     "READ_SYMLINK", "GET_RUNTIME_DEPENDENCIES",
+  };
+  if (reading.count(args[0])) {
+    status.GetMakefile().MarkGenerateFingerprintIncomplete();
+  }
+  return result;
 }
@@ -10,6 +10,7 @@
 #include <cmext/algorithm>
 
 #include "cmExecutionStatus.h"
+#include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
 #include "cmStringAlgorithms.h"
@@ -190,6 +191,11 @@ void cmFindCommon::SelectDefaultSearchModes()
   }
 }
 
+bool cmFindCommon::PathMayExist(std::string const& path) const
+{
+  return this->Makefile->GetGlobalGenerator()->FindPathMayExist(path);
+}
+
 void cmFindCommon::RerootPaths(std::vector<std::string>& paths)
 {
 #if 0
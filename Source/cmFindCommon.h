@@ -99,6 +99,10 @@ protected:
   /** Compute the current default search modes based on global variables.  */
   void SelectDefaultSearchModes();
 
+  /** Check whether a path may exist before probing the disk for it.
+      Returns false only for paths that certainly do not exist.  */
+  bool PathMayExist(std::string const& path) const;
+
   /** The `InitialPass` functions of the child classes should set
       this->DebugMode to the result of this.  */
   bool ComputeIfDebugModeWanted();
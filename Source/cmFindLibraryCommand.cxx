@@ -132,11 +132,13 @@ void cmFindLibraryCommand::AddArchitecturePath(
   if (pos != std::string::npos) {
     // Check for "lib".
     std::string lib = dir.substr(0, pos + 3);
-    bool use_lib = cmSystemTools::FileIsDirectory(lib);
+    bool use_lib =
+      this->PathMayExist(lib) && cmSystemTools::FileIsDirectory(lib);
 
     // Check for "lib<suffix>" and use it first.
     std::string libX = lib + suffix;
-    bool use_libX = cmSystemTools::FileIsDirectory(libX);
+    bool use_libX =
+      this->PathMayExist(libX) && cmSystemTools::FileIsDirectory(libX);
 
     // Avoid copies of the same directory due to symlinks.
     if (use_libX && use_lib && cmLibDirsLinked(libX, lib)) {
@@ -156,11 +158,13 @@ void cmFindLibraryCommand::AddArchitecturePath(
 
   if (fresh) {
     // Check for the original unchanged path.
-    bool use_dir = cmSystemTools::FileIsDirectory(dir);
+    bool use_dir =
+      this->PathMayExist(dir) && cmSystemTools::FileIsDirectory(dir);
 
     // Check for <dir><suffix>/ and use it first.
     std::string dirX = dir + suffix;
-    bool use_dirX = cmSystemTools::FileIsDirectory(dirX);
+    bool use_dirX =
+      this->PathMayExist(dirX) && cmSystemTools::FileIsDirectory(dirX);
 
     // Avoid copies of the same directory due to symlinks.
     if (use_dirX && use_dir && cmLibDirsLinked(dirX, dir)) {
@@ -404,7 +408,8 @@ bool cmFindLibraryHelper::CheckDirectoryForName(std::string const& path,
   if (name.TryRaw) {
     this->TestPath = cmStrCat(path, name.Raw);
 
-    const bool exists = cmSystemTools::FileExists(this->TestPath, true);
+    const bool exists = this->GG->FindPathMayExist(this->TestPath) &&
+      cmSystemTools::FileExists(this->TestPath, true);
     if (!exists) {
       this->DebugLibraryFailed(name.Raw, path);
     } else {
@@ -424,7 +429,8 @@ bool cmFindLibraryHelper::CheckDirectoryForName(std::string const& path,
   // Search for a file matching the library name regex.
   std::string dir = path;
   cmSystemTools::ConvertToUnixSlashes(dir);
-  std::set<std::string> const& files = this->GG->GetDirectoryContent(dir);
+  std::set<std::string> const& files =
+    this->GG->GetFindDirectoryContent(dir);
   for (std::string const& origName : files) {
 #if defined(_WIN32) || defined(__APPLE__)
     std::string testName = cmSystemTools::LowerCase(origName);
@@ -21,6 +21,7 @@
 #include "cmsys/String.h"
 
 #include "cmAlgorithms.h"
+#include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
 #include "cmPolicies.h"
@@ -1659,7 +1660,8 @@ bool cmFindPackageCommand::FindConfigFile(std::string const& dir,
     if (this->DebugMode) {
       this->DebugBuffer = cmStrCat(this->DebugBuffer, "  ", file, "\n");
     }
-    if (cmSystemTools::FileExists(file, true) && this->CheckVersion(file)) {
+    if (this->PathMayExist(file) && cmSystemTools::FileExists(file, true) &&
+        this->CheckVersion(file)) {
       // Allow resolving symlinks when the config file is found through a link
       if (this->UseRealPath) {
         file = cmSystemTools::GetRealPath(file);
@@ -1682,14 +1684,16 @@ bool cmFindPackageCommand::CheckVersion(std::string const& config_file)
 
   // Look for foo-config-version.cmake
   std::string version_file = cmStrCat(version_file_base, "-version.cmake");
-  if (!haveResult && cmSystemTools::FileExists(version_file, true)) {
+  if (!haveResult && this->PathMayExist(version_file) &&
+      cmSystemTools::FileExists(version_file, true)) {
     result = this->CheckVersionFile(version_file, version);
     haveResult = true;
   }
 
   // Look for fooConfigVersion.cmake
   version_file = cmStrCat(version_file_base, "Version.cmake");
-  if (!haveResult && cmSystemTools::FileExists(version_file, true)) {
+  if (!haveResult && this->PathMayExist(version_file) &&
+      cmSystemTools::FileExists(version_file, true)) {
     result = this->CheckVersionFile(version_file, version);
     haveResult = true;
   }
@@ -1824,6 +1828,8 @@ public:
 
 protected:
   bool Consider(std::string const& fullPath, cmFileList& listing);
+  std::set<std::string> const& GetDirectoryContent(std::string const& dir,
+                                                   cmFileList& listing);
 
 private:
   bool Search(cmFileList&);
@@ -1858,6 +1864,8 @@ public:
 
 private:
   virtual bool Visit(std::string const& fullPath) = 0;
+  virtual std::set<std::string> const& GetDirectoryContent(
+    std::string const& dir) = 0;
   friend class cmFileListGeneratorBase;
   std::unique_ptr<cmFileListGeneratorBase> First;
   cmFileListGeneratorBase* Last = nullptr;
@@ -1880,6 +1888,12 @@ private:
     }
     return this->FPC->CheckDirectory(fullPath);
   }
+  std::set<std::string> const& GetDirectoryContent(
+    std::string const& dir) override
+  {
+    return this->FPC->Makefile->GetGlobalGenerator()->GetFindDirectoryContent(
+      dir);
+  }
   cmFindPackageCommand* FPC;
   bool UseSuffixes;
 };
@@ -1905,6 +1919,12 @@ bool cmFileListGeneratorBase::Consider(std::string const& fullPath,
   return listing.Visit(fullPath + "/");
 }
 
+std::set<std::string> const& cmFileListGeneratorBase::GetDirectoryContent(
+  std::string const& dir, cmFileList& listing)
+{
+  return listing.GetDirectoryContent(dir);
+}
+
 class cmFileListGeneratorFixed : public cmFileListGeneratorBase
 {
 public:
@@ -1997,16 +2017,13 @@ private:
   {
     // Construct a list of matches.
     std::vector<std::string> matches;
-    cmsys::Directory d;
-    d.Load(parent);
-    for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i) {
-      const char* fname = d.GetFile(i);
-      if (strcmp(fname, ".") == 0 || strcmp(fname, "..") == 0) {
-        continue;
-      }
+    std::set<std::string> const& content =
+      this->GetDirectoryContent(parent, lister);
+    for (std::string const& fname : content) {
       for (std::string const& n : this->Names) {
-        if (cmsysString_strncasecmp(fname, n.c_str(), n.length()) == 0) {
-          matches.emplace_back(fname);
+        if (cmsysString_strncasecmp(fname.c_str(), n.c_str(), n.length()) ==
+            0) {
+          matches.push_back(fname);
         }
       }
     }
@@ -2055,17 +2072,13 @@ private:
   {
     // Construct a list of matches.
     std::vector<std::string> matches;
-    cmsys::Directory d;
-    d.Load(parent);
-    for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i) {
-      const char* fname = d.GetFile(i);
-      if (strcmp(fname, ".") == 0 || strcmp(fname, "..") == 0) {
-        continue;
-      }
+    std::set<std::string> const& content =
+      this->GetDirectoryContent(parent, lister);
+    for (std::string const& fname : content) {
       for (std::string name : this->Names) {
         name += this->Extension;
-        if (cmsysString_strcasecmp(fname, name.c_str()) == 0) {
-          matches.emplace_back(fname);
+        if (cmsysString_strcasecmp(fname.c_str(), name.c_str()) == 0) {
+          matches.push_back(fname);
         }
       }
     }
@@ -2104,17 +2117,19 @@ private:
   {
     // Look for matching files.
     std::vector<std::string> matches;
-    cmsys::Directory d;
-    d.Load(parent);
-    for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i) {
-      const char* fname = d.GetFile(i);
-      if (strcmp(fname, ".") == 0 || strcmp(fname, "..") == 0) {
-        continue;
+    std::set<std::string> const& content =
+      this->GetDirectoryContent(parent, lister);
+    for (std::string const& fname : content) {
+      if (cmsysString_strcasecmp(fname.c_str(), this->String.c_str()) == 0) {
+        matches.push_back(fname);
       }
-      if (cmsysString_strcasecmp(fname, this->String.c_str()) == 0) {
-        if (this->Consider(parent + fname, lister)) {
-          return true;
-        }
+    }
+
+    // Consider the matches only after the loop because loading package
+    // version files may discard the directory content.
+    for (std::string const& i : matches) {
+      if (this->Consider(parent + i, lister)) {
+        return true;
       }
     }
     return false;
@@ -2172,7 +2187,8 @@ bool cmFindPackageCommand::SearchPrefix(std::string const& prefix_in)
   assert(!prefix_in.empty() && prefix_in.back() == '/');
 
   // Skip this if the prefix does not exist.
-  if (!cmSystemTools::FileIsDirectory(prefix_in)) {
+  if (!this->PathMayExist(prefix_in) ||
+      !cmSystemTools::FileIsDirectory(prefix_in)) {
     return false;
   }
 
@@ -103,7 +103,8 @@ std::string cmFindPathCommand::FindHeaderInFramework(std::string const& file,
     if (!frameWorkName.empty()) {
       std::string fpath = cmStrCat(dir, frameWorkName, ".framework");
       std::string intPath = cmStrCat(fpath, "/Headers/", fileName);
-      if (cmSystemTools::FileExists(intPath)) {
+      if (this->PathMayExist(intPath) &&
+          cmSystemTools::FileExists(intPath)) {
         if (this->IncludeFileInPath) {
           return intPath;
         }
@@ -134,7 +135,8 @@ std::string cmFindPathCommand::FindNormalHeader(cmFindBaseDebugState& debug)
   for (std::string const& n : this->Names) {
     for (std::string const& sp : this->SearchPaths) {
       tryPath = cmStrCat(sp, n);
-      if (cmSystemTools::FileExists(tryPath)) {
+      if (this->PathMayExist(tryPath) &&
+          cmSystemTools::FileExists(tryPath)) {
         debug.FoundAt(tryPath);
         if (this->IncludeFileInPath) {
           return tryPath;
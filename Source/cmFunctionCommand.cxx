@@ -2,6 +2,7 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmFunctionCommand.h"
 
+#include <memory>
 #include <utility>
 
 #include <cm/memory>
@@ -32,6 +33,22 @@ std::string const CMAKE_CURRENT_FUNCTION_LIST_DIR =
 std::string const CMAKE_CURRENT_FUNCTION_LIST_LINE =
   "CMAKE_CURRENT_FUNCTION_LIST_LINE";
 
+// A function body compiled once when the function is defined
+struct cmFunctionBody
+{
+  struct Statement
+  {
+    cmListFileFunction Function;
+    mutable cmMakefile::ResolvedCommand Command;
+  };
+
+  std::vector<std::string> Args;
+  std::vector<Statement> Statements;
+  cmPolicies::PolicyMap Policies;
+  std::string FilePath;
+  long Line;
+};
+
 // define the class for function commands
 class cmFunctionHelperCommand
 {
@@ -43,11 +60,8 @@ public:
   bool operator()(std::vector<cmListFileArgument> const& args,
                   cmExecutionStatus& inStatus) const;
 
-  std::vector<std::string> Args;
-  std::vector<cmListFileFunction> Functions;
-  cmPolicies::PolicyMap Policies;
-  std::string FilePath;
-  long Line;
+  // Shared by all copies of the command so that looking it up is cheap.
+  std::shared_ptr<cmFunctionBody const> Body;
 };
 
 bool cmFunctionHelperCommand::operator()(
@@ -55,6 +69,7 @@ bool cmFunctionHelperCommand::operator()(
   cmExecutionStatus& inStatus) const
 {
   cmMakefile& makefile = inStatus.GetMakefile();
+  cmFunctionBody const& body = *this->Body;
 
   // Expand the argument list to the function.
   std::vector<std::string> expandedArgs;
@@ -62,16 +77,16 @@ bool cmFunctionHelperCommand::operator()(
 
   // make sure the number of arguments passed is at least the number
   // required by the signature
-  if (expandedArgs.size() < this->Args.size() - 1) {
+  if (expandedArgs.size() < body.Args.size() - 1) {
     auto const errorMsg = cmStrCat(
       "Function invoked with incorrect arguments for function named: ",
-      this->Args.front());
+      body.Args.front());
     inStatus.SetError(errorMsg);
     return false;
   }
 
-  cmMakefile::FunctionPushPop functionScope(&makefile, this->FilePath,
-                                            this->Policies);
+  cmMakefile::FunctionPushPop functionScope(&makefile, body.FilePath,
+                                            body.Policies);
 
   // set the value of argc
   makefile.AddDefinition(ARGC, std::to_string(expandedArgs.size()));
@@ -85,35 +100,37 @@ bool cmFunctionHelperCommand::operator()(
   }
 
   // define the formal arguments
-  for (auto j = 1u; j < this->Args.size(); ++j) {
-    makefile.AddDefinition(this->Args[j], expandedArgs[j - 1]);
+  for (auto j = 1u; j < body.Args.size(); ++j) {
+    makefile.AddDefinition(body.Args[j], expandedArgs[j - 1]);
   }
 
   // define ARGV and ARGN
   auto const argvDef = cmJoin(expandedArgs, ";");
-  auto const eit = expandedArgs.begin() + (this->Args.size() - 1);
+  auto const eit = expandedArgs.begin() + (body.Args.size() - 1);
   auto const argnDef = cmJoin(cmMakeRange(eit, expandedArgs.end()), ";");
   makefile.AddDefinition(ARGV, argvDef);
   makefile.MarkVariableAsUsed(ARGV);
   makefile.AddDefinition(ARGN, argnDef);
   makefile.MarkVariableAsUsed(ARGN);
 
-  makefile.AddDefinition(CMAKE_CURRENT_FUNCTION, this->Args.front());
+  makefile.AddDefinition(CMAKE_CURRENT_FUNCTION, body.Args.front());
   makefile.MarkVariableAsUsed(CMAKE_CURRENT_FUNCTION);
-  makefile.AddDefinition(CMAKE_CURRENT_FUNCTION_LIST_FILE, this->FilePath);
+  makefile.AddDefinition(CMAKE_CURRENT_FUNCTION_LIST_FILE, body.FilePath);
   makefile.MarkVariableAsUsed(CMAKE_CURRENT_FUNCTION_LIST_FILE);
   makefile.AddDefinition(CMAKE_CURRENT_FUNCTION_LIST_DIR,
-                         cmSystemTools::GetFilenamePath(this->FilePath));
+                         cmSystemTools::GetFilenamePath(body.FilePath));
   makefile.MarkVariableAsUsed(CMAKE_CURRENT_FUNCTION_LIST_DIR);
   makefile.AddDefinition(CMAKE_CURRENT_FUNCTION_LIST_LINE,
-                         std::to_string(this->Line));
+                         std::to_string(body.Line));
   makefile.MarkVariableAsUsed(CMAKE_CURRENT_FUNCTION_LIST_LINE);
 
   // Invoke all the functions that were collected in the block.
   // for each function
-  for (cmListFileFunction const& func : this->Functions) {
+  for (cmFunctionBody::Statement const& statement : body.Statements) {
     cmExecutionStatus status(makefile);
-    if (!makefile.ExecuteCommand(func, status) || status.GetNestedError()) {
+    if (!makefile.ExecuteCommand(statement.Function, status,
+                                 &statement.Command) ||
+        status.GetNestedError()) {
       // The error message should have already included the call stack
       // so we do not need to report an error here.
       functionScope.Quiet();
@@ -159,12 +176,17 @@ bool cmFunctionFunctionBlocker::Replay(
 {
   cmMakefile& mf = status.GetMakefile();
   // create a new command and add it to cmake
+  auto body = std::make_shared<cmFunctionBody>();
+  body->Args = this->Args;
+  body->Statements.reserve(functions.size());
+  for (cmListFileFunction& function : functions) {
+    body->Statements.push_back({ std::move(function), {} });
+  }
+  body->FilePath = this->GetStartingContext().FilePath;
+  body->Line = this->GetStartingContext().Line;
+  mf.RecordPolicies(body->Policies);
   cmFunctionHelperCommand f;
-  f.Args = this->Args;
-  f.Functions = std::move(functions);
-  f.FilePath = this->GetStartingContext().FilePath;
-  f.Line = this->GetStartingContext().Line;
-  mf.RecordPolicies(f.Policies);
+  f.Body = std::move(body);
   mf.GetState()->AddScriptedCommand(this->Args.front(), std::move(f));
   return true;
 }
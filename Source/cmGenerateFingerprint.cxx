@@ -0,0 +1,90 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmGenerateFingerprint.h"
+
+#include <utility>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmGeneratedFileStream.h"
+#include "cmSystemTools.h"
+
+cmGenerateFingerprint::cmGenerateFingerprint(std::string stampFile)
+  : StampFile(std::move(stampFile))
+  , Hasher(cmCryptoHash::AlgoMD5)
+{
+  this->Hasher.Initialize();
+}
+
+void cmGenerateFingerprint::Append(cm::string_view data)
+{
+  if (!this->Hash.empty()) {
+    return;
+  }
+  // Terminate each piece so that different splits of the same bytes
+  // give different fingerprints.
+  this->Hasher.Append(data);
+  this->Hasher.Append(cm::string_view("", 1));
+}
+
+void cmGenerateFingerprint::Finalize()
+{
+  if (this->Hash.empty()) {
+    this->Hash = this->Hasher.FinalizeHex();
+  }
+}
+
+bool cmGenerateFingerprint::Matches()
+{
+  this->RewrittenFiles.clear();
+
+  cmsys::ifstream fin(this->StampFile.c_str());
+  std::string line;
+  if (this->Incomplete || !fin ||
+      !cmSystemTools::GetLineFromStream(fin, line) || this->Hash.empty() ||
+      line != this->Hash) {
+    return false;
+  }
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    // Each line holds a kind character, a space and a file path.
+    if (line.size() < 3 || line[1] != ' ') {
+      return false;
+    }
+    std::string path = line.substr(2);
+    if (!cmSystemTools::FileExists(path, true)) {
+      return false;
+    }
+    if (line[0] == 'R') {
+      this->RewrittenFiles.emplace_back(std::move(path));
+    }
+  }
+  return true;
+}
+
+void cmGenerateFingerprint::TouchRewrittenFiles() const
+{
+  for (std::string const& file : this->RewrittenFiles) {
+    cmSystemTools::Touch(file, false);
+  }
+}
+
+bool cmGenerateFingerprint::Save(
+  std::map<std::string, bool> const& files) const
+{
+  if (this->Hash.empty()) {
+    return false;
+  }
+  // An incomplete fingerprint never matches, but its stamp file tells
+  // the next configure step to compute a fingerprint again.
+  cmGeneratedFileStream fout(this->StampFile);
+  fout << (this->Incomplete ? std::string("-") : this->Hash) << "\n";
+  for (auto const& file : files) {
+    fout << (file.second ? "R " : "C ") << file.first << "\n";
+  }
+  return fout.Close();
+}
+
+void cmGenerateFingerprint::Discard() const
+{
+  cmSystemTools::RemoveFile(this->StampFile);
+}
@@ -0,0 +1,80 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmGenerateFingerprint_h
+#define cmGenerateFingerprint_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <cm/string_view>
+
+#include "cmCryptoHash.h"
+
+/** \class cmGenerateFingerprint
+ * \brief Fingerprint of the configured state that a generate step reads.
+ *
+ * The fingerprint is computed from everything a configure step does:
+ * the name and the expanded arguments of every command executed, and
+ * the cache entries at the end.  After a successful generate step it is
+ * saved to a stamp file together with the list of files the generate
+ * step wrote.  A later configure step with the same fingerprint
+ * produces the same build system, so the generate step can be skipped
+ * as long as the files it wrote still exist.
+ *
+ * Values that commands read from outside the list files, such as file
+ * contents or the output of processes, do not show up in the arguments
+ * of the commands executed.  Configure steps that read such values
+ * mark the fingerprint incomplete and never skip the generate step.
+ */
+class cmGenerateFingerprint
+{
+public:
+  cmGenerateFingerprint(std::string stampFile);
+
+  cmGenerateFingerprint(cmGenerateFingerprint const&) = delete;
+  cmGenerateFingerprint& operator=(cmGenerateFingerprint const&) = delete;
+
+  /** Add data describing the configured state.  Ignored after
+      Finalize().  */
+  void Append(cm::string_view data);
+
+  /** Note that the configured state depends on values the fingerprint
+      does not capture.  */
+  void MarkIncomplete() { this->Incomplete = true; }
+
+  /** Whether MarkIncomplete() was called.  */
+  bool IsIncomplete() const { return this->Incomplete; }
+
+  /** Finish computing the fingerprint.  */
+  void Finalize();
+
+  /** Check whether the stamp file was saved for the same fingerprint and
+      all files listed in it still exist.  Never true if incomplete.  */
+  bool Matches();
+
+  /** Update the modification time of the files that the generate step
+      saved in the stamp file rewrites on every run.  Call only after
+      Matches() returned true.  */
+  void TouchRewrittenFiles() const;
+
+  /** Save the fingerprint and the files written by a generate step,
+      mapped to whether they are rewritten on every run.  An incomplete
+      fingerprint is saved as one that matches nothing.  */
+  bool Save(std::map<std::string, bool> const& files) const;
+
+  /** Remove the stamp file so that no later run skips generation until
+      Save() is called again.  */
+  void Discard() const;
+
+private:
+  std::string StampFile;
+  cmCryptoHash Hasher;
+  std::string Hash;
+  std::vector<std::string> RewrittenFiles;
+  bool Incomplete = false;
+};
+
+#endif
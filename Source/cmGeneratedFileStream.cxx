@@ -2,7 +2,9 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmGeneratedFileStream.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <utility>
 
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
@@ -12,6 +14,11 @@
 #  include "cm_zlib.h"
 #endif
 
+namespace {
+std::vector<cmGeneratedFileStream::Replacement>* DeferredReplacements;
+std::map<std::string, bool>* WrittenFiles;
+}
+
 cmGeneratedFileStream::cmGeneratedFileStream(Encoding encoding)
 {
 #ifndef CMAKE_BOOTSTRAP
@@ -127,6 +134,18 @@ void cmGeneratedFileStreamBase::Open(std::string const& name)
 #endif
 
   // Make sure the temporary file that will be used is not present.
+  // If it belongs to a deferred replacement of the same file the new
+  // content supersedes it.
+  if (DeferredReplacements && cmSystemTools::FileExists(this->TempName)) {
+    std::string const& tempName = this->TempName;
+    DeferredReplacements->erase(
+      std::remove_if(DeferredReplacements->begin(),
+                     DeferredReplacements->end(),
+                     [&tempName](cmGeneratedFileStream::Replacement const& r) {
+                       return r.TempName == tempName;
+                     }),
+      DeferredReplacements->end());
+  }
   cmSystemTools::RemoveFile(this->TempName);
 
   std::string dir = cmSystemTools::GetFilenamePath(this->TempName);
@@ -142,6 +161,21 @@ bool cmGeneratedFileStreamBase::Close()
     resname += ".gz";
   }
 
+  if (WrittenFiles && !this->Name.empty() && this->Okay) {
+    (*WrittenFiles)[resname] = !this->CopyIfDifferent;
+  }
+
+  // Let the owner of the deferred replacements replace the destination
+  // file later.  The temporary file is handed over to it.
+  if (DeferredReplacements && !this->Name.empty() && this->Okay &&
+      !this->Compress) {
+    DeferredReplacements->push_back(cmGeneratedFileStream::Replacement{
+      std::move(this->TempName), std::move(resname), this->CopyIfDifferent });
+    this->TempName.clear();
+    this->Name.clear();
+    return true;
+  }
+
   // Only consider replacing the destination file if no error
   // occurred.
   if (!this->Name.empty() && this->Okay &&
@@ -215,3 +249,25 @@ void cmGeneratedFileStream::SetName(const std::string& fname)
 {
   this->Name = fname;
 }
+
+bool cmGeneratedFileStream::Replacement::Replace() const
+{
+  bool okay = true;
+  if (!this->CopyIfDifferent ||
+      cmSystemTools::FilesDiffer(this->TempName, this->Name)) {
+    okay = cmSystemTools::RenameFile(this->TempName, this->Name);
+  }
+  cmSystemTools::RemoveFile(this->TempName);
+  return okay;
+}
+
+void cmGeneratedFileStream::SetDeferredReplacements(
+  std::vector<Replacement>* list)
+{
+  DeferredReplacements = list;
+}
+
+void cmGeneratedFileStream::SetWrittenFiles(std::map<std::string, bool>* files)
+{
+  WrittenFiles = files;
+}
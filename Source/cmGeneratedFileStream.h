@@ -5,7 +5,9 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "cmsys/FStream.hxx"
 
@@ -138,6 +140,35 @@ public:
    * the output file to be changed during the use of cmGeneratedFileStream.
    */
   void SetName(const std::string& fname);
+  /**
+   * Replacement of a destination file by a closed temporary file.
+   */
+  struct Replacement
+  {
+    std::string TempName;
+    std::string Name;
+    bool CopyIfDifferent;
+
+    /** Replace the destination file and remove the temporary file.
+        Returns false if the destination needed to be replaced but
+        could not be.  */
+    bool Replace() const;
+  };
+
+  /**
+   * Set a list to which streams closed from now on append their
+   * pending replacement instead of performing it.  The caller must
+   * perform all replacements after resetting the list to nullptr.
+   * Close() returns true for deferred streams.  Compressed files
+   * are never deferred.
+   */
+  static void SetDeferredReplacements(std::vector<Replacement>* list);
+
+  /**
+   * Set a map to which streams closed from now on add their destination
+   * file, mapped to whether copy-if-different was off for it.
+   */
+  static void SetWrittenFiles(std::map<std::string, bool>* files);
 };
 
 #endif
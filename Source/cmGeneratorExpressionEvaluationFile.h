@@ -30,6 +30,8 @@ public:
 
   std::vector<std::string> GetFiles() const { return this->Files; }
 
+  bool GetInputIsContent() const { return this->InputIsContent; }
+
   void CreateOutputFile(cmLocalGenerator* lg, std::string const& config);
 
 private:
@@ -36,6 +36,7 @@
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
+#include "cmMessenger.h"
 #include "cmPropertyMap.h"
 #include "cmRange.h"
 #include "cmSourceFile.h"
@@ -253,6 +254,60 @@ std::vector<EvaluatedTargetPropertyEntry> EvaluateTargetPropertyEntries(
 }
 }
 
+class cmGeneratorTarget::UsageRequirementsCacheEntry
+{
+public:
+  UsageRequirementsCacheEntry(cmGeneratorTarget const* tgt,
+                              cm::string_view prop, std::string const& config,
+                              std::string const& lang)
+    : Cache(tgt->UsageRequirementsCache)
+    , State(tgt->GlobalGenerator->GetUsageRequirementsCache())
+    , Messenger(*tgt->GetGlobalGenerator()->GetCMakeInstance()->GetMessenger())
+  {
+    if (!this->State.Enabled) {
+      return;
+    }
+    if (this->Cache.Epoch != this->State.Epoch) {
+      this->Cache.Values.clear();
+      this->Cache.Epoch = this->State.Epoch;
+    }
+    this->Key = cmStrCat(prop, '@', config, '@', lang);
+    this->MessageCount = this->Messenger.GetDisplayedMessageCount();
+  }
+
+  std::vector<BT<std::string>> const* Find() const
+  {
+    if (!this->State.Enabled) {
+      return nullptr;
+    }
+    auto i = this->Cache.Values.find(this->Key);
+    if (i == this->Cache.Values.end()) {
+      ++this->State.Misses;
+      return nullptr;
+    }
+    ++this->State.Hits;
+    return &i->second;
+  }
+
+  std::vector<BT<std::string>> Store(std::vector<BT<std::string>> values)
+  {
+    // Evaluations that produced diagnostics are not stored so that they
+    // are issued again exactly as often as without the cache.
+    if (this->State.Enabled && this->Cache.Epoch == this->State.Epoch &&
+        this->MessageCount == this->Messenger.GetDisplayedMessageCount()) {
+      this->Cache.Values[this->Key] = values;
+    }
+    return values;
+  }
+
+private:
+  UsageRequirementsCacheType& Cache;
+  cmGlobalGenerator::UsageRequirementsCacheState& State;
+  cmMessenger const& Messenger;
+  std::string Key;
+  unsigned long long MessageCount = 0;
+};
+
 cmGeneratorTarget::cmGeneratorTarget(cmTarget* t, cmLocalGenerator* lg)
   : Target(t)
   , FortranModuleDirectoryCreated(false)
@@ -683,6 +738,7 @@ const char* cmGeneratorTarget::GetFileSuffixInternal(
 
 void cmGeneratorTarget::ClearSourcesCache()
 {
+  this->GlobalGenerator->InvalidateUsageRequirementsCache();
   this->KindedSourcesMap.clear();
   this->LinkImplementationLanguageIsContextDependent = true;
   this->Objects.clear();
@@ -714,6 +770,7 @@ void cmGeneratorTarget::AddTracedSources(std::vector<std::string> const& srcs)
 void cmGeneratorTarget::AddIncludeDirectory(const std::string& src,
                                             bool before)
 {
+  this->GlobalGenerator->InvalidateUsageRequirementsCache();
   this->Target->InsertInclude(src, this->Makefile->GetBacktrace(), before);
   this->IncludeDirectoriesEntries.insert(
     before ? this->IncludeDirectoriesEntries.begin()
@@ -3233,6 +3290,12 @@ void processIncludeDirectories(
 std::vector<BT<std::string>> cmGeneratorTarget::GetIncludeDirectories(
   const std::string& config, const std::string& lang) const
 {
+  UsageRequirementsCacheEntry cached(this, "INCLUDE_DIRECTORIES", config,
+                                     lang);
+  if (std::vector<BT<std::string>> const* values = cached.Find()) {
+    return *values;
+  }
+
   std::vector<BT<std::string>> includes;
   std::unordered_set<std::string> uniqueIncludes;
 
@@ -3288,7 +3351,7 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetIncludeDirectories(
   processIncludeDirectories(this, entries, includes, uniqueIncludes,
                             debugIncludes);
 
-  return includes;
+  return cached.Store(std::move(includes));
 }
 
 enum class OptionsParse
@@ -3348,6 +3411,12 @@ void cmGeneratorTarget::GetCompileOptions(std::vector<std::string>& result,
 std::vector<BT<std::string>> cmGeneratorTarget::GetCompileOptions(
   std::string const& config, std::string const& language) const
 {
+  UsageRequirementsCacheEntry cached(this, "COMPILE_OPTIONS", config,
+                                     language);
+  if (std::vector<BT<std::string>> const* values = cached.Find()) {
+    return *values;
+  }
+
   std::vector<BT<std::string>> result;
   std::unordered_set<std::string> uniqueOptions;
 
@@ -3378,7 +3447,7 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetCompileOptions(
   processOptions(this, entries, result, uniqueOptions, debugOptions,
                  "compile options", OptionsParse::Shell);
 
-  return result;
+  return cached.Store(std::move(result));
 }
 
 void cmGeneratorTarget::GetCompileFeatures(std::vector<std::string>& result,
@@ -3394,6 +3463,12 @@ void cmGeneratorTarget::GetCompileFeatures(std::vector<std::string>& result,
 std::vector<BT<std::string>> cmGeneratorTarget::GetCompileFeatures(
   std::string const& config) const
 {
+  UsageRequirementsCacheEntry cached(this, "COMPILE_FEATURES", config,
+                                     std::string());
+  if (std::vector<BT<std::string>> const* values = cached.Find()) {
+    return *values;
+  }
+
   std::vector<BT<std::string>> result;
   std::unordered_set<std::string> uniqueFeatures;
 
@@ -3424,7 +3499,7 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetCompileFeatures(
   processOptions(this, entries, result, uniqueFeatures, debugFeatures,
                  "compile features", OptionsParse::None);
 
-  return result;
+  return cached.Store(std::move(result));
 }
 
 void cmGeneratorTarget::GetCompileDefinitions(
@@ -3442,6 +3517,12 @@ void cmGeneratorTarget::GetCompileDefinitions(
 std::vector<BT<std::string>> cmGeneratorTarget::GetCompileDefinitions(
   std::string const& config, std::string const& language) const
 {
+  UsageRequirementsCacheEntry cached(this, "COMPILE_DEFINITIONS", config,
+                                     language);
+  if (std::vector<BT<std::string>> const* values = cached.Find()) {
+    return *values;
+  }
+
   std::vector<BT<std::string>> list;
   std::unordered_set<std::string> uniqueOptions;
 
@@ -3498,12 +3579,18 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetCompileDefinitions(
   processOptions(this, entries, list, uniqueOptions, debugDefines,
                  "compile definitions", OptionsParse::None);
 
-  return list;
+  return cached.Store(std::move(list));
 }
 
 std::vector<BT<std::string>> cmGeneratorTarget::GetPrecompileHeaders(
   const std::string& config, const std::string& language) const
 {
+  UsageRequirementsCacheEntry cached(this, "PRECOMPILE_HEADERS", config,
+                                     language);
+  if (std::vector<BT<std::string>> const* values = cached.Find()) {
+    return *values;
+  }
+
   std::unordered_set<std::string> uniqueOptions;
 
   cmGeneratorExpressionDAGChecker dagChecker(this, "PRECOMPILE_HEADERS",
@@ -3535,7 +3622,7 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetPrecompileHeaders(
   processOptions(this, entries, list, uniqueOptions, debugDefines,
                  "precompile headers", OptionsParse::None);
 
-  return list;
+  return cached.Store(std::move(list));
 }
 
 std::string cmGeneratorTarget::GetPchHeader(const std::string& config,
@@ -4102,6 +4189,12 @@ void cmGeneratorTarget::GetLinkDirectories(std::vector<std::string>& result,
 std::vector<BT<std::string>> cmGeneratorTarget::GetLinkDirectories(
   std::string const& config, std::string const& language) const
 {
+  UsageRequirementsCacheEntry cached(this, "LINK_DIRECTORIES", config,
+                                     language);
+  if (std::vector<BT<std::string>> const* values = cached.Find()) {
+    return *values;
+  }
+
   std::vector<BT<std::string>> result;
   std::unordered_set<std::string> uniqueDirectories;
 
@@ -4133,7 +4226,7 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetLinkDirectories(
   processLinkDirectories(this, entries, result, uniqueDirectories,
                          debugDirectories);
 
-  return result;
+  return cached.Store(std::move(result));
 }
 
 void cmGeneratorTarget::GetLinkDepends(std::vector<std::string>& result,
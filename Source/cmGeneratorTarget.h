@@ -902,6 +902,16 @@ private:
     std::string SharedDeps;
   };
 
+  // Cache evaluated usage requirements keyed by property, config and
+  // language.  See cmGlobalGenerator::GetUsageRequirementsCache.
+  class UsageRequirementsCacheEntry;
+  struct UsageRequirementsCacheType
+  {
+    unsigned long Epoch = 0;
+    std::unordered_map<std::string, std::vector<BT<std::string>>> Values;
+  };
+  mutable UsageRequirementsCacheType UsageRequirementsCache;
+
   using ImportInfoMapType = std::map<std::string, ImportInfo>;
   mutable ImportInfoMapType ImportInfoMap;
   void ComputeImportInfo(std::string const& desired_config,
@@ -110,6 +110,7 @@ bool cmGetFilenameComponentCommand(std::vector<std::string> const& args,
     if (args[2] == "REALPATH") {
       // Resolve symlinks if possible
       result = cmSystemTools::GetRealPath(result);
+      status.GetMakefile().MarkGenerateFingerprintIncomplete();
     }
   } else {
     std::string err = "unknown component " + args[2];
@@ -401,6 +401,7 @@ void cmGhsMultiTargetGenerator::WriteCustomCommandsHelper(
     this->LocalGenerator->ConvertToOutputFormat(dir, cmOutputConverter::SHELL);
   cmdLines.push_back(std::move(cdCmd));
 
+  this->GetGlobalGenerator()->WriteBatchFiles(ccg);
   for (unsigned int c = 0; c < ccg.GetNumberOfCommands(); ++c) {
     // Build the command line in a single string.
     std::string cmd = ccg.GetCommand(c);
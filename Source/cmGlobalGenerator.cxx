@@ -11,6 +11,7 @@
 #include <initializer_list>
 #include <iterator>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 #include <cm/memory>
@@ -26,6 +27,7 @@
 #include "cmCPackPropertiesGenerator.h"
 #include "cmComputeTargetDepends.h"
 #include "cmCustomCommand.h"
+#include "cmCustomCommandGenerator.h"
 #include "cmCustomCommandLines.h"
 #include "cmDuration.h"
 #include "cmExportBuildFileGenerator.h"
@@ -56,6 +58,7 @@
 
 #  include "cmCryptoHash.h"
 #  include "cmQtAutoGenGlobalInitializer.h"
+#  include "cmWorkerPool.h"
 #endif
 
 #if defined(_MSC_VER) && _MSC_VER >= 1800
@@ -122,6 +125,57 @@ cmGlobalGenerator::~cmGlobalGenerator()
 }
 
 #if !defined(CMAKE_BOOTSTRAP)
+namespace {
+class ReplaceGeneratedFileJob : public cmWorkerPool::JobT
+{
+public:
+  ReplaceGeneratedFileJob(cmGeneratedFileStream::Replacement const& r,
+                          char& failed)
+    : Replacement(r)
+    , Failed(failed)
+  {
+  }
+
+  void Process() override
+  {
+    this->Failed = this->Replacement.Replace() ? 0 : 1;
+  }
+
+private:
+  cmGeneratedFileStream::Replacement const& Replacement;
+  // Each job owns a distinct element, so no lock is needed.
+  char& Failed;
+};
+
+class ReplaceGeneratedFilesDoneJob : public cmWorkerPool::JobFenceT
+{
+public:
+  void Process() override { this->Pool()->Abort(); }
+};
+
+void ReplaceGeneratedFiles(
+  std::vector<cmGeneratedFileStream::Replacement> const& replacements,
+  unsigned int threads)
+{
+  std::vector<char> failed(replacements.size(), 0);
+  cmWorkerPool pool;
+  pool.SetThreadCount(threads);
+  for (std::size_t i = 0; i < replacements.size(); ++i) {
+    pool.EmplaceJob<ReplaceGeneratedFileJob>(replacements[i], failed[i]);
+  }
+  pool.EmplaceJob<ReplaceGeneratedFilesDoneJob>();
+  pool.Process();
+
+  // Report the failures from this thread once the pool has drained.
+  for (std::size_t i = 0; i < replacements.size(); ++i) {
+    if (failed[i]) {
+      cmSystemTools::Error(cmStrCat("Could not replace generated file \"",
+                                    replacements[i].Name, "\"."));
+    }
+  }
+}
+}
+
 Json::Value cmGlobalGenerator::GetJson() const
 {
   Json::Value generator = Json::objectValue;
@@ -131,6 +185,28 @@ Json::Value cmGlobalGenerator::GetJson() const
 }
 #endif
 
+namespace {
+// Reuse evaluated target usage requirements until the end of the scope.
+class UsageRequirementsCacheScope
+{
+public:
+  UsageRequirementsCacheScope(
+    cmGlobalGenerator::UsageRequirementsCacheState& state)
+    : State(state)
+  {
+    this->State.Enabled = true;
+  }
+  ~UsageRequirementsCacheScope() { this->State.Enabled = false; }
+
+  UsageRequirementsCacheScope(UsageRequirementsCacheScope const&) = delete;
+  UsageRequirementsCacheScope& operator=(UsageRequirementsCacheScope const&) =
+    delete;
+
+private:
+  cmGlobalGenerator::UsageRequirementsCacheState& State;
+};
+}
+
 bool cmGlobalGenerator::SetGeneratorInstance(std::string const& i,
                                              cmMakefile* mf)
 {
@@ -1504,6 +1580,23 @@ void cmGlobalGenerator::Generate()
 
   this->CMakeInstance->UpdateProgress("Generating", 0.1f);
 
+  // Targets do not change while the generated files are written, so
+  // usage requirements evaluated for one file can be reused by others.
+  UsageRequirementsCacheScope usageRequirementsCacheScope(
+    this->UsageRequirementsCache);
+
+#if !defined(CMAKE_BOOTSTRAP)
+  // The local generators write their files one after another.  Comparing
+  // them to and replacing the previous versions can be done concurrently
+  // afterwards.  The content of each file does not depend on this.
+  std::vector<cmGeneratedFileStream::Replacement> replacements;
+  unsigned int const parallelLevel =
+    this->SupportsParallelGenerate() ? this->GetParallelGenerateLevel() : 1;
+  if (parallelLevel > 1) {
+    cmGeneratedFileStream::SetDeferredReplacements(&replacements);
+  }
+#endif
+
   // Generate project files
   for (unsigned int i = 0; i < this->LocalGenerators.size(); ++i) {
     this->SetCurrentMakefile(this->LocalGenerators[i]->GetMakefile());
@@ -1521,6 +1614,13 @@ void cmGlobalGenerator::Generate()
   }
   this->SetCurrentMakefile(nullptr);
 
+#if !defined(CMAKE_BOOTSTRAP)
+  if (parallelLevel > 1) {
+    cmGeneratedFileStream::SetDeferredReplacements(nullptr);
+    ReplaceGeneratedFiles(replacements, parallelLevel);
+  }
+#endif
+
   if (!this->GenerateCPackPropertiesFile()) {
     this->GetCMakeInstance()->IssueMessage(
       MessageType::FATAL_ERROR, "Could not write CPack properties file.");
@@ -1538,6 +1638,8 @@ void cmGlobalGenerator::Generate()
   // Update rule hashes.
   this->CheckRuleHashes();
 
+  this->RemoveUnusedBatchFiles();
+
   this->WriteSummary();
 
   if (this->ExtraGenerator) {
@@ -1756,7 +1858,9 @@ void cmGlobalGenerator::ClearGeneratorMembers()
   this->LocalGeneratorSearchIndex.clear();
   this->ProjectMap.clear();
   this->RuleHashes.clear();
+  this->BatchFiles.clear();
   this->DirectoryContentMap.clear();
+  this->FindDirectoryContentMap.clear();
   this->BinaryDirectories.clear();
 }
 
@@ -2863,6 +2967,34 @@ void cmGlobalGenerator::AddTargetDepends(cmGeneratorTarget const* target,
   }
 }
 
+namespace {
+bool LoadDirectoryContent(std::string const& dir,
+                          std::set<std::string>& content)
+{
+  cmsys::Directory d;
+  if (!d.Load(dir)) {
+    return false;
+  }
+  unsigned long n = d.GetNumberOfFiles();
+  for (unsigned long i = 0; i < n; ++i) {
+    const char* f = d.GetFile(i);
+    if (strcmp(f, ".") != 0 && strcmp(f, "..") != 0) {
+      content.insert(f);
+    }
+  }
+  return true;
+}
+
+// Remove trailing slashes except from a root directory like "/" or "C:/".
+void StripTrailingSlashes(std::string& path)
+{
+  while (path.size() > 1 && path.back() == '/' &&
+         !(path.size() == 3 && path[1] == ':')) {
+    path.pop_back();
+  }
+}
+}
+
 void cmGlobalGenerator::AddToManifest(std::string const& f)
 {
   // Add to the content listing for the file's directory.
@@ -2884,22 +3016,97 @@ std::set<std::string> const& cmGlobalGenerator::GetDirectoryContent(
       dc.All = dc.Generated;
 
       // Load the directory content from disk.
-      cmsys::Directory d;
-      if (d.Load(dir)) {
-        unsigned long n = d.GetNumberOfFiles();
-        for (unsigned long i = 0; i < n; ++i) {
-          const char* f = d.GetFile(i);
-          if (strcmp(f, ".") != 0 && strcmp(f, "..") != 0) {
-            dc.All.insert(f);
-          }
-        }
-      }
+      LoadDirectoryContent(dir, dc.All);
       dc.LastDiskTime = mt;
     }
   }
   return dc.All;
 }
 
+std::set<std::string> const& cmGlobalGenerator::GetFindDirectoryContent(
+  std::string dir)
+{
+  StripTrailingSlashes(dir);
+  if (this->IsInProjectTree(dir)) {
+    // The project may write here at any time.
+    return this->GetDirectoryContent(dir);
+  }
+  return this->LoadFindDirectoryContent(dir).All;
+}
+
+bool cmGlobalGenerator::FindPathMayExist(std::string path)
+{
+  StripTrailingSlashes(path);
+  if (!cmSystemTools::FileIsFullPath(path) || this->IsInProjectTree(path)) {
+    return true;
+  }
+  std::string const name = cmSystemTools::GetFilenameName(path);
+  std::string const dir = cmSystemTools::GetFilenamePath(path);
+  if (name.empty() || name == "." || name == ".." || dir.empty() ||
+      dir == path || this->IsInProjectTree(dir)) {
+    return true;
+  }
+
+  FindDirectoryContent const& dc = this->LoadFindDirectoryContent(dir);
+  if (!dc.Listed || dc.All.count(name)) {
+    return true;
+  }
+#if defined(_WIN32) || defined(__APPLE__)
+  // The file system may be case-insensitive.
+  return dc.Lower.count(cmSystemTools::LowerCase(name)) != 0;
+#else
+  return false;
+#endif
+}
+
+void cmGlobalGenerator::InvalidateFindDirectoryContent(std::string const& path)
+{
+  if (cmSystemTools::FileIsFullPath(path) && !this->IsInProjectTree(path)) {
+    this->InvalidateFindDirectoryContent();
+  }
+}
+
+void cmGlobalGenerator::InvalidateFindDirectoryContent()
+{
+  ++this->FindDirectoryContentEpoch;
+}
+
+cmGlobalGenerator::FindDirectoryContent&
+cmGlobalGenerator::LoadFindDirectoryContent(std::string const& dir)
+{
+  // References to elements of the map stay valid while the recursion
+  // below adds the parent directories.
+  FindDirectoryContent& dc = this->FindDirectoryContentMap[dir];
+  if (dc.Epoch != this->FindDirectoryContentEpoch) {
+    dc.Epoch = this->FindDirectoryContentEpoch;
+    dc.All.clear();
+    dc.Listed = LoadDirectoryContent(dir, dc.All);
+    if (!dc.Listed) {
+      // A directory missing from the listing of its parent does not
+      // exist and so has no content.  Otherwise it cannot be read.
+      dc.Listed = !this->FindPathMayExist(dir);
+    }
+#if defined(_WIN32) || defined(__APPLE__)
+    dc.Lower.clear();
+    for (std::string const& f : dc.All) {
+      dc.Lower.insert(cmSystemTools::LowerCase(f));
+    }
+#endif
+  }
+  return dc;
+}
+
+bool cmGlobalGenerator::IsInProjectTree(std::string const& path) const
+{
+  auto isIn = [&path](std::string const& tree) {
+    return !tree.empty() &&
+      (cmSystemTools::ComparePath(path, tree) ||
+       cmSystemTools::IsSubDirectory(path, tree));
+  };
+  return isIn(this->CMakeInstance->GetHomeDirectory()) ||
+    isIn(this->CMakeInstance->GetHomeOutputDirectory());
+}
+
 void cmGlobalGenerator::AddRuleHash(const std::vector<std::string>& outputs,
                                     std::string const& content)
 {
@@ -3008,6 +3215,36 @@ void cmGlobalGenerator::WriteRuleHashes(std::string const& pfile)
   }
 }
 
+void cmGlobalGenerator::WriteBatchFiles(cmCustomCommandGenerator const& ccg)
+{
+  for (auto const& batchFile : ccg.GetBatchFiles()) {
+    // Several rules may run the same batch file.
+    if (this->BatchFiles.insert(batchFile.first).second) {
+      cmGeneratedFileStream fout(batchFile.first);
+      fout.SetCopyIfDifferent(true);
+      fout << batchFile.second;
+    }
+  }
+}
+
+void cmGlobalGenerator::RemoveUnusedBatchFiles()
+{
+  // Batch files are named by their content, so those of changed or
+  // removed custom commands would otherwise stay forever.
+  std::string const dir = cmStrCat(
+    this->GetCMakeInstance()->GetHomeOutputDirectory(), "/CMakeFiles/batch");
+  cmsys::Directory d;
+  if (!d.Load(dir)) {
+    return;
+  }
+  for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i) {
+    std::string const file = cmStrCat(dir, '/', d.GetFile(i));
+    if (cmHasLiteralSuffix(file, ".txt") && !this->BatchFiles.count(file)) {
+      cmSystemTools::RemoveFile(file);
+    }
+  }
+}
+
 void cmGlobalGenerator::WriteSummary()
 {
   // Record all target directories in a central location.
@@ -3172,6 +3409,28 @@ const std::string& cmGlobalGenerator::GetRealPath(const std::string& dir)
   return i->second;
 }
 
+unsigned int cmGlobalGenerator::GetParallelGenerateLevel() const
+{
+  std::string level;
+  if (!cmSystemTools::GetEnv("CMAKE_GENERATE_PARALLEL_LEVEL", level) ||
+      level.empty()) {
+    return 1;
+  }
+  unsigned long threads = 0;
+  if (!cmStrToULong(level, &threads) || threads == 0) {
+    this->GetCMakeInstance()->IssueMessage(
+      MessageType::WARNING,
+      cmStrCat("The CMAKE_GENERATE_PARALLEL_LEVEL environment variable "
+               "value \"",
+               level, "\" is not a positive integer.  Ignoring it."));
+    return 1;
+  }
+  // More threads than the host runs at once only add contention.
+  unsigned long const maxThreads =
+    std::max(std::thread::hardware_concurrency(), 1u);
+  return static_cast<unsigned int>(std::min(threads, maxThreads));
+}
+
 void cmGlobalGenerator::ProcessEvaluationFiles()
 {
   std::vector<std::string> generatedFiles;
@@ -35,6 +35,7 @@
 
 #define CMAKE_DIRECTORY_ID_SEP "::@"
 
+class cmCustomCommandGenerator;
 class cmDirectoryId;
 class cmExportBuildFileGenerator;
 class cmExternalMakefileProjectGenerator;
@@ -365,6 +366,27 @@ public:
   std::set<std::string> const& GetDirectoryContent(std::string const& dir,
                                                    bool needDisk = true);
 
+  /** Get the content of a directory for the find commands.  Listings of
+      directories outside the source and build trees are loaded from disk
+      once and then reused until InvalidateFindDirectoryContent() is
+      called.  Listings inside the trees behave as GetDirectoryContent().
+  */
+  std::set<std::string> const& GetFindDirectoryContent(std::string dir);
+
+  /** Check whether a path may exist using the directory content cached
+      for the find commands.  Returns false only if the path certainly
+      does not exist, so a true result must still be checked on disk.  */
+  bool FindPathMayExist(std::string path);
+
+  /** Tell the find commands that the project may have modified the given
+      path.  Cached listings are discarded unless the path is inside the
+      source or build tree.  */
+  void InvalidateFindDirectoryContent(std::string const& path);
+
+  /** Discard all directory listings cached for the find commands, e.g.
+      after running a process with unknown side effects.  */
+  void InvalidateFindDirectoryContent();
+
   void IndexTarget(cmTarget* t);
   void IndexGeneratorTarget(cmGeneratorTarget* gt);
 
@@ -413,6 +435,15 @@ public:
   void AddRuleHash(const std::vector<std::string>& outputs,
                    std::string const& content);
 
+  /** Write the batch files run by the commands of a custom command.
+      Batch files not written during a generate step are removed at its
+      end.  */
+  void WriteBatchFiles(cmCustomCommandGenerator const& ccg);
+  std::set<std::string> const& GetBatchFiles() const
+  {
+    return this->BatchFiles;
+  }
+
   /** Return whether the given binary directory is unused.  */
   bool BinaryDirectoryIsNew(const std::string& dir)
   {
@@ -459,10 +490,23 @@ public:
   virtual bool SupportsCrossConfigs() const { return false; }
   virtual bool SupportsDefaultConfigs() const { return false; }
 
+  /** Return whether the files written by the local generators may be
+      replaced concurrently after all of them have been generated.  */
+  virtual bool SupportsParallelGenerate() const { return false; }
+
+  /** Return whether the generate step may be skipped when the configured
+      state did not change since the last one.  */
+  virtual bool SupportsSkippingGenerate() const { return false; }
+
   static std::string EscapeJSON(const std::string& s);
 
   void ProcessEvaluationFiles();
 
+  /** Number of threads to use for replacing the files written by the
+      local generators, from the CMAKE_GENERATE_PARALLEL_LEVEL
+      environment variable, at most the hardware concurrency.  */
+  unsigned int GetParallelGenerateLevel() const;
+
   std::map<std::string, cmExportBuildFileGenerator*>& GetBuildExportSets()
   {
     return this->BuildExportSets;
@@ -494,6 +538,27 @@ public:
     return this->ConfigureDoneCMP0026AndCMP0024;
   }
 
+  /** State of the memoization of evaluated target usage requirements.
+      Values are only reused while Generate() runs, and any change to a
+      target bumps the epoch to drop everything stored so far.  */
+  struct UsageRequirementsCacheState
+  {
+    bool Enabled = false;
+    unsigned long Epoch = 0;
+    unsigned long long Hits = 0;
+    unsigned long long Misses = 0;
+  };
+
+  UsageRequirementsCacheState& GetUsageRequirementsCache() const
+  {
+    return this->UsageRequirementsCache;
+  }
+
+  void InvalidateUsageRequirementsCache() const
+  {
+    ++this->UsageRequirementsCache.Epoch;
+  }
+
   std::string MakeSilentFlag;
 
   int RecursionDepth;
@@ -634,6 +699,10 @@ private:
   void CheckRuleHashes(std::string const& pfile, std::string const& home);
   void WriteRuleHashes(std::string const& pfile);
 
+  // Batch files written during the generate step.
+  std::set<std::string> BatchFiles;
+  void RemoveUnusedBatchFiles();
+
   void WriteSummary();
   void WriteSummary(cmGeneratorTarget* target);
   void FinalizeTargetCompileInfo();
@@ -688,6 +757,23 @@ private:
   };
   std::map<std::string, DirectoryContent> DirectoryContentMap;
 
+  // Cache directory content for the find commands.
+  struct FindDirectoryContent
+  {
+    unsigned long Epoch = 0;
+    // False if the directory exists but could not be listed.
+    bool Listed = false;
+    std::set<std::string> All;
+#if defined(_WIN32) || defined(__APPLE__)
+    std::set<std::string> Lower;
+#endif
+  };
+  std::unordered_map<std::string, FindDirectoryContent>
+    FindDirectoryContentMap;
+  unsigned long FindDirectoryContentEpoch = 1;
+  FindDirectoryContent& LoadFindDirectoryContent(std::string const& dir);
+  bool IsInProjectTree(std::string const& path) const;
+
   // Set of binary directories on disk.
   std::set<std::string> BinaryDirectories;
 
@@ -714,6 +800,7 @@ protected:
   bool ToolSupportsColor;
   bool InstallTargetEnabled;
   bool ConfigureDoneCMP0026AndCMP0024;
+  mutable UsageRequirementsCacheState UsageRequirementsCache;
 };
 
 #endif
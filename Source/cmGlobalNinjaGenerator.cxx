@@ -4,9 +4,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <cstdio>
 #include <iterator>
 #include <sstream>
+#include <thread>
 
 #include <cm/memory>
 #include <cmext/algorithm>
@@ -19,7 +21,9 @@
 #include "cm_jsoncpp_writer.h"
 
 #include "cmAlgorithms.h"
+#include "cmBinaryCache.h"
 #include "cmDocumentationEntry.h"
+#include "cmFileTime.h"
 #include "cmFortranParser.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorExpressionEvaluationFile.h"
@@ -43,6 +47,7 @@
 #include "cmTarget.h"
 #include "cmTargetDepend.h"
 #include "cmVersion.h"
+#include "cmWorkerPool.h"
 #include "cmake.h"
 
 const char* cmGlobalNinjaGenerator::NINJA_BUILD_FILE = "build.ninja";
@@ -418,6 +423,14 @@ void cmGlobalNinjaGenerator::WriteInclude(std::ostream& os,
   os << "include " << filename << "\n";
 }
 
+void cmGlobalNinjaGenerator::WriteSubninja(std::ostream& os,
+                                           const std::string& filename,
+                                           const std::string& comment)
+{
+  cmGlobalNinjaGenerator::WriteComment(os, comment);
+  os << "subninja " << filename << "\n";
+}
+
 void cmGlobalNinjaGenerator::WriteDefault(std::ostream& os,
                                           const cmNinjaDeps& targets,
                                           const std::string& comment)
@@ -504,6 +517,13 @@ void cmGlobalNinjaGenerator::Generate()
   this->TargetAll = this->NinjaOutputPath("all");
   this->CMakeCacheFile = this->NinjaOutputPath("CMakeCache.txt");
 
+  // Fragments that are not rewritten must not make the re-run edge dirty,
+  // which needs a restat of the manifest.
+  this->TargetFragments = this->SupportsManifestRestat() &&
+    this->LocalGenerators[0]->GetMakefile()->IsOn(
+      "CMAKE_NINJA_TARGET_FRAGMENTS");
+  this->FragmentFiles.clear();
+
   this->PolicyCMP0058 =
     this->LocalGenerators[0]->GetMakefile()->GetPolicyStatus(
       cmPolicies::CMP0058);
@@ -532,6 +552,10 @@ void cmGlobalNinjaGenerator::Generate()
   this->CloseRulesFileStream();
   this->CloseBuildFileStreams();
 
+  if (!cmSystemTools::GetErrorOccuredFlag()) {
+    this->RemoveStaleFragments();
+  }
+
 #ifdef _WIN32
   // The ninja tools will not be able to update metadata on Windows
   // when we are re-generating inside an existing 'ninja' invocation
@@ -890,6 +914,53 @@ bool cmGlobalNinjaGenerator::OpenFileStream(
   return true;
 }
 
+bool cmGlobalNinjaGenerator::OpenFragmentFileStream(
+  std::unique_ptr<cmGeneratedFileStream>& stream, const std::string& path)
+{
+  cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(path));
+  stream = cm::make_unique<cmGeneratedFileStream>(path, false,
+                                                  this->GetMakefileEncoding());
+  if (!(*stream)) {
+    // An error message is generated by the constructor if it cannot
+    // open the file.
+    return false;
+  }
+  stream->SetCopyIfDifferent(true);
+  this->FragmentFiles.insert(path);
+
+  // Write the do not edit header.
+  this->WriteDisclaimer(*stream);
+
+  return true;
+}
+
+void cmGlobalNinjaGenerator::RemoveStaleFragments()
+{
+  // Fragments of removed targets or configurations would otherwise stay,
+  // so the fragments written by the last generate step are recorded.
+  std::string const listFile =
+    cmStrCat(this->GetCMakeInstance()->GetHomeOutputDirectory(),
+             "/CMakeFiles/TargetFragments.txt");
+  {
+    cmsys::ifstream fin(listFile.c_str());
+    std::string path;
+    while (cmSystemTools::GetLineFromStream(fin, path)) {
+      if (!path.empty() && !this->FragmentFiles.count(path)) {
+        cmSystemTools::RemoveFile(path);
+      }
+    }
+  }
+  if (this->FragmentFiles.empty()) {
+    cmSystemTools::RemoveFile(listFile);
+    return;
+  }
+  cmGeneratedFileStream fout(listFile);
+  fout.SetCopyIfDifferent(true);
+  for (std::string const& path : this->FragmentFiles) {
+    fout << path << '\n';
+  }
+}
+
 cm::optional<std::set<std::string>> cmGlobalNinjaGenerator::ListSubsetWithAll(
   const std::set<std::string>& all, const std::set<std::string>& defaults,
   const std::vector<std::string>& items)
@@ -1593,6 +1664,12 @@ void cmGlobalNinjaGenerator::WriteTargetRebuildManifest(std::ostream& os)
   cmNinjaBuild reBuild("RERUN_CMAKE");
   reBuild.Comment = "Re-run CMake if any of its inputs changed.";
   this->AddRebuildManifestOutputs(reBuild.Outputs);
+  for (std::string const& file : this->GetBatchFiles()) {
+    reBuild.ImplicitOuts.push_back(this->ConvertToNinjaPath(file));
+  }
+  for (std::string const& file : this->FragmentFiles) {
+    reBuild.ImplicitOuts.push_back(this->ConvertToNinjaPath(file));
+  }
 
   for (const auto& localGen : this->LocalGenerators) {
     for (std::string const& fi : localGen->GetMakefile()->GetListFiles()) {
@@ -1661,6 +1738,12 @@ void cmGlobalNinjaGenerator::WriteTargetRebuildManifest(std::ostream& os)
                                            msg.str());
   }
 
+  // A fragment that is not rewritten keeps its timestamp, so the edge
+  // would otherwise stay dirty after CMake re-ran.
+  if (!this->FragmentFiles.empty()) {
+    reBuild.Variables["restat"] = "1";
+  }
+
   std::sort(reBuild.ImplicitDeps.begin(), reBuild.ImplicitDeps.end());
   reBuild.ImplicitDeps.erase(
     std::unique(reBuild.ImplicitDeps.begin(), reBuild.ImplicitDeps.end()),
@@ -2003,6 +2086,23 @@ Compilation of source files within a target is split into the following steps:
    it provides and/or requires.  The "ddi" file is an implicit output
    because it should not appear in "$out" but is generated by the rule.
 
+   If CMAKE_NINJA_BATCH_SCAN is enabled, the preprocessing statements do
+   not run the scanner.  One build statement scans all of the target's
+   preprocessed sources instead, on multiple threads:
+
+    rule Fortran_SCAN
+      command = cmake -E cmake_ninja_depends \
+                  --tdi=FortranDependInfo.json --lang=Fortran --batch
+      restat = 1
+
+    build src1.f90.o.ddi src2.f90.o.ddi: Fortran_SCAN src1.f90-pp.f90 \
+      src2.f90-pp.f90
+
+   The sources and the files to write for them are listed in the
+   "scan-sources" of ``FortranDependInfo.json``.  A source is scanned
+   again only if its depfile is older than its preprocessed output, and
+   "ddi" files whose content does not change are not replaced.
+
 2. Consolidate the per-source module dependencies saved in the "ddi"
    files from all sources to produce a ninja "dyndep" file, ``Fortran.dd``.
 
@@ -2019,6 +2119,8 @@ Compilation of source files within a target is split into the following steps:
    is placed in the ``Fortran.dd`` file for ninja to load later.  It also
    writes the expected location of modules provided by this target into
    ``FortranModules.json`` for use by dependent targets.
+   The content of the "ddi" files is kept in ``FortranDyndepCache.bin``
+   so that the next run re-reads only the "ddi" files that changed.
 
 3. Compile all sources after loading dynamically discovered dependencies
    of the compilation build statements from their ``dyndep`` bindings.
@@ -2058,8 +2160,35 @@ struct cmSourceInfo
   std::set<std::string> Includes;
 };
 
-static std::unique_ptr<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
-  std::string const& arg_tdi, std::string const& arg_pp);
+// Settings of the Fortran dependency scanner from the target depend info.
+struct cmFortranScanSettings
+{
+  cmFortranCompiler Compiler;
+  std::vector<std::string> Includes;
+};
+
+// A preprocessed source to scan and the files to write for it.
+struct cmDependsScanRequest
+{
+  std::string PP;
+  std::string Dep;
+  std::string Obj;
+  std::string DDI;
+};
+
+static bool cmcmd_cmake_ninja_depends_read_tdi(std::string const& arg_tdi,
+                                               Json::Value& tdi);
+
+static void cmcmd_cmake_ninja_depends_fortran_settings(
+  Json::Value const& tdi, cmFortranScanSettings& settings);
+
+static bool cmcmd_cmake_ninja_depends_scan(
+  cmFortranScanSettings const& settings, cmDependsScanRequest const& request,
+  bool batch, std::string& error);
+
+static int cmcmd_cmake_ninja_depends_batch(
+  std::string const& arg_tdi, Json::Value const& tdi,
+  cmFortranScanSettings const& settings);
 
 int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
                               std::vector<std::string>::const_iterator argEnd)
@@ -2070,6 +2199,7 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
   std::string arg_obj;
   std::string arg_ddi;
   std::string arg_lang;
+  bool arg_batch = false;
   for (std::string const& arg : cmMakeRange(argBeg, argEnd)) {
     if (cmHasLiteralPrefix(arg, "--tdi=")) {
       arg_tdi = arg.substr(6);
@@ -2083,6 +2213,8 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
       arg_ddi = arg.substr(6);
     } else if (cmHasLiteralPrefix(arg, "--lang=")) {
       arg_lang = arg.substr(7);
+    } else if (arg == "--batch") {
+      arg_batch = true;
     } else {
       cmSystemTools::Error(
         cmStrCat("-E cmake_ninja_depends unknown argument: ", arg));
@@ -2093,53 +2225,133 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
     cmSystemTools::Error("-E cmake_ninja_depends requires value for --tdi=");
     return 1;
   }
-  if (arg_pp.empty()) {
-    cmSystemTools::Error("-E cmake_ninja_depends requires value for --pp=");
-    return 1;
-  }
-  if (arg_dep.empty()) {
-    cmSystemTools::Error("-E cmake_ninja_depends requires value for --dep=");
-    return 1;
-  }
-  if (arg_obj.empty()) {
-    cmSystemTools::Error("-E cmake_ninja_depends requires value for --obj=");
-    return 1;
-  }
-  if (arg_ddi.empty()) {
-    cmSystemTools::Error("-E cmake_ninja_depends requires value for --ddi=");
-    return 1;
+  if (!arg_batch) {
+    if (arg_pp.empty()) {
+      cmSystemTools::Error("-E cmake_ninja_depends requires value for --pp=");
+      return 1;
+    }
+    if (arg_dep.empty()) {
+      cmSystemTools::Error(
+        "-E cmake_ninja_depends requires value for --dep=");
+      return 1;
+    }
+    if (arg_obj.empty()) {
+      cmSystemTools::Error(
+        "-E cmake_ninja_depends requires value for --obj=");
+      return 1;
+    }
+    if (arg_ddi.empty()) {
+      cmSystemTools::Error(
+        "-E cmake_ninja_depends requires value for --ddi=");
+      return 1;
+    }
   }
   if (arg_lang.empty()) {
     cmSystemTools::Error("-E cmake_ninja_depends requires value for --lang=");
     return 1;
   }
-
-  std::unique_ptr<cmSourceInfo> info;
-  if (arg_lang == "Fortran") {
-    info = cmcmd_cmake_ninja_depends_fortran(arg_tdi, arg_pp);
-  } else {
+  if (arg_lang != "Fortran") {
     cmSystemTools::Error(
       cmStrCat("-E cmake_ninja_depends does not understand the ", arg_lang,
                " language"));
     return 1;
   }
 
-  if (!info) {
-    // The error message is already expected to have been output.
+  Json::Value tdi;
+  if (!cmcmd_cmake_ninja_depends_read_tdi(arg_tdi, tdi)) {
     return 1;
   }
+  cmFortranScanSettings settings;
+  cmcmd_cmake_ninja_depends_fortran_settings(tdi, settings);
 
-  {
-    cmGeneratedFileStream depfile(arg_dep);
-    depfile << cmSystemTools::ConvertToUnixOutputPath(arg_pp) << ":";
-    for (std::string const& include : info->Includes) {
-      depfile << " \\\n " << cmSystemTools::ConvertToUnixOutputPath(include);
+  if (arg_batch) {
+    return cmcmd_cmake_ninja_depends_batch(arg_tdi, tdi, settings);
+  }
+
+  std::string error;
+  if (!cmcmd_cmake_ninja_depends_scan(
+        settings, cmDependsScanRequest{ arg_pp, arg_dep, arg_obj, arg_ddi },
+        false, error)) {
+    cmSystemTools::Error(error);
+    return 1;
+  }
+  return 0;
+}
+
+bool cmcmd_cmake_ninja_depends_read_tdi(std::string const& arg_tdi,
+                                        Json::Value& tdi)
+{
+  cmsys::ifstream tdif(arg_tdi.c_str(), std::ios::in | std::ios::binary);
+  Json::Reader reader;
+  if (!reader.parse(tdif, tdi, false)) {
+    cmSystemTools::Error(cmStrCat("-E cmake_ninja_depends failed to parse ",
+                                  arg_tdi,
+                                  reader.getFormattedErrorMessages()));
+    return false;
+  }
+  return true;
+}
+
+void cmcmd_cmake_ninja_depends_fortran_settings(
+  Json::Value const& tdi, cmFortranScanSettings& settings)
+{
+  Json::Value const& tdi_include_dirs = tdi["include-dirs"];
+  if (tdi_include_dirs.isArray()) {
+    for (auto const& tdi_include_dir : tdi_include_dirs) {
+      settings.Includes.push_back(tdi_include_dir.asString());
     }
-    depfile << "\n";
+  }
+
+  Json::Value const& tdi_compiler_id = tdi["compiler-id"];
+  settings.Compiler.Id = tdi_compiler_id.asString();
+
+  Json::Value const& tdi_submodule_sep = tdi["submodule-sep"];
+  settings.Compiler.SModSep = tdi_submodule_sep.asString();
+
+  Json::Value const& tdi_submodule_ext = tdi["submodule-ext"];
+  settings.Compiler.SModExt = tdi_submodule_ext.asString();
+}
+
+static std::unique_ptr<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
+  cmFortranScanSettings const& settings, std::string const& arg_pp,
+  std::string& error)
+{
+  cmFortranSourceInfo finfo;
+  std::set<std::string> defines;
+  cmFortranParser parser(settings.Compiler, settings.Includes, defines,
+                         finfo);
+  if (!cmFortranParser_FilePush(&parser, arg_pp.c_str())) {
+    error = cmStrCat("-E cmake_ninja_depends failed to open ", arg_pp);
+    return nullptr;
+  }
+  if (cmFortran_yyparse(parser.Scanner) != 0) {
+    // Failed to parse the file.
+    error = cmStrCat("-E cmake_ninja_depends failed to parse ", arg_pp);
+    if (!parser.Error.empty()) {
+      error = cmStrCat(error, ": ", parser.Error);
+    }
+    return nullptr;
+  }
+
+  auto info = cm::make_unique<cmSourceInfo>();
+  info->Provides = finfo.Provides;
+  info->Requires = finfo.Requires;
+  info->Includes = finfo.Includes;
+  return info;
+}
+
+bool cmcmd_cmake_ninja_depends_scan(cmFortranScanSettings const& settings,
+                                    cmDependsScanRequest const& request,
+                                    bool batch, std::string& error)
+{
+  std::unique_ptr<cmSourceInfo> info =
+    cmcmd_cmake_ninja_depends_fortran(settings, request.PP, error);
+  if (!info) {
+    return false;
   }
 
   Json::Value ddi(Json::objectValue);
-  ddi["object"] = arg_obj;
+  ddi["object"] = request.Obj;
 
   Json::Value& ddi_provides = ddi["provides"] = Json::arrayValue;
   for (std::string const& provide : info->Provides) {
@@ -2153,70 +2365,115 @@ int cmcmd_cmake_ninja_depends(std::vector<std::string>::const_iterator argBeg,
     }
   }
 
-  cmGeneratedFileStream ddif(arg_ddi);
-  ddif << ddi;
-  if (!ddif) {
-    cmSystemTools::Error(
-      cmStrCat("-E cmake_ninja_depends failed to write ", arg_ddi));
-    return 1;
+  {
+    cmGeneratedFileStream ddif(request.DDI);
+    // A batch scan is a restat build statement.  Keep unchanged ddi files
+    // so that the dyndep file is not collated again.
+    ddif.SetCopyIfDifferent(batch);
+    ddif << ddi;
+    if (!ddif) {
+      error =
+        cmStrCat("-E cmake_ninja_depends failed to write ", request.DDI);
+      return false;
+    }
   }
-  return 0;
+
+  // The depfile is written last.  A batch scan considers a source
+  // up to date if its depfile is newer than the preprocessed source.
+  cmGeneratedFileStream depfile(request.Dep);
+  depfile << cmSystemTools::ConvertToUnixOutputPath(request.PP) << ":";
+  for (std::string const& include : info->Includes) {
+    depfile << " \\\n " << cmSystemTools::ConvertToUnixOutputPath(include);
+  }
+  depfile << "\n";
+  if (!depfile) {
+    error = cmStrCat("-E cmake_ninja_depends failed to write ", request.Dep);
+    return false;
+  }
+  return true;
 }
 
-std::unique_ptr<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
-  std::string const& arg_tdi, std::string const& arg_pp)
+namespace {
+class cmDependsScanJob : public cmWorkerPool::JobT
 {
-  cmFortranCompiler fc;
-  std::vector<std::string> includes;
+public:
+  cmDependsScanJob(cmFortranScanSettings const& settings,
+                   cmDependsScanRequest const& request, std::string& error)
+    : Settings(settings)
+    , Request(request)
+    , Error(error)
   {
-    Json::Value tdio;
-    Json::Value const& tdi = tdio;
-    {
-      cmsys::ifstream tdif(arg_tdi.c_str(), std::ios::in | std::ios::binary);
-      Json::Reader reader;
-      if (!reader.parse(tdif, tdio, false)) {
-        cmSystemTools::Error(
-          cmStrCat("-E cmake_ninja_depends failed to parse ", arg_tdi,
-                   reader.getFormattedErrorMessages()));
-        return nullptr;
-      }
-    }
+  }
 
-    Json::Value const& tdi_include_dirs = tdi["include-dirs"];
-    if (tdi_include_dirs.isArray()) {
-      for (auto const& tdi_include_dir : tdi_include_dirs) {
-        includes.push_back(tdi_include_dir.asString());
-      }
-    }
+  void Process() override
+  {
+    cmcmd_cmake_ninja_depends_scan(this->Settings, this->Request, true,
+                                   this->Error);
+  }
 
-    Json::Value const& tdi_compiler_id = tdi["compiler-id"];
-    fc.Id = tdi_compiler_id.asString();
+private:
+  cmFortranScanSettings const& Settings;
+  cmDependsScanRequest const& Request;
+  std::string& Error;
+};
 
-    Json::Value const& tdi_submodule_sep = tdi["submodule-sep"];
-    fc.SModSep = tdi_submodule_sep.asString();
+class cmDependsScanDoneJob : public cmWorkerPool::JobFenceT
+{
+public:
+  void Process() override { this->Pool()->Abort(); }
+};
+}
 
-    Json::Value const& tdi_submodule_ext = tdi["submodule-ext"];
-    fc.SModExt = tdi_submodule_ext.asString();
+int cmcmd_cmake_ninja_depends_batch(std::string const& arg_tdi,
+                                    Json::Value const& tdi,
+                                    cmFortranScanSettings const& settings)
+{
+  // Rescan only the sources that were preprocessed again since their
+  // depfile was written, or all of them if the settings changed.
+  cmFileTime tdiTime;
+  tdiTime.Load(arg_tdi);
+  std::vector<cmDependsScanRequest> requests;
+  for (Json::Value const& source : tdi["scan-sources"]) {
+    cmDependsScanRequest request{ source["pp"].asString(),
+                                  source["dep"].asString(),
+                                  source["obj"].asString(),
+                                  source["ddi"].asString() };
+    cmFileTime ppTime;
+    cmFileTime depTime;
+    if (ppTime.Load(request.PP) && depTime.Load(request.Dep) &&
+        ppTime.Older(depTime) && tdiTime.Older(depTime) &&
+        cmSystemTools::FileExists(request.DDI)) {
+      continue;
+    }
+    requests.push_back(std::move(request));
   }
 
-  cmFortranSourceInfo finfo;
-  std::set<std::string> defines;
-  cmFortranParser parser(fc, includes, defines, finfo);
-  if (!cmFortranParser_FilePush(&parser, arg_pp.c_str())) {
-    cmSystemTools::Error(
-      cmStrCat("-E cmake_ninja_depends failed to open ", arg_pp));
-    return nullptr;
-  }
-  if (cmFortran_yyparse(parser.Scanner) != 0) {
-    // Failed to parse the file.
-    return nullptr;
+  std::vector<std::string> errors(requests.size());
+  unsigned int const threads =
+    std::min(std::max(std::thread::hardware_concurrency(), 1u),
+             static_cast<unsigned int>(requests.size()));
+  if (threads > 1) {
+    cmWorkerPool pool;
+    pool.SetThreadCount(threads);
+    for (std::size_t i = 0; i != requests.size(); ++i) {
+      pool.EmplaceJob<cmDependsScanJob>(settings, requests[i], errors[i]);
+    }
+    pool.EmplaceJob<cmDependsScanDoneJob>();
+    pool.Process();
+  } else {
+    for (std::size_t i = 0; i != requests.size(); ++i) {
+      cmcmd_cmake_ninja_depends_scan(settings, requests[i], true, errors[i]);
+    }
   }
 
-  auto info = cm::make_unique<cmSourceInfo>();
-  info->Provides = finfo.Provides;
-  info->Requires = finfo.Requires;
-  info->Includes = finfo.Includes;
-  return info;
+  int result = 0;
+  for (std::string const& error : errors) {
+    if (!error.empty()) {
+      cmSystemTools::Error(error);
+      result = 1;
+    }
+  }
+  return result;
 }
 
 struct cmDyndepObjectInfo
@@ -2226,6 +2483,123 @@ struct cmDyndepObjectInfo
   std::vector<std::string> Requires;
 };
 
+namespace {
+
+// Bump the version whenever the layout of the serialized data changes.
+const char DyndepCacheMagic[] = "CMakeNinjaDyndepCache\n1\n";
+
+/** The contents of the ddi files that a dyndep file was collated from,
+    so that the next collation re-reads only the ddi files that changed.  */
+class cmDyndepCache
+{
+public:
+  cmDyndepCache(std::string file)
+    : File(std::move(file))
+  {
+  }
+
+  void Load();
+  bool Save();
+
+  bool Lookup(std::string const& ddi, cmFileTime const& ddiTime,
+              cmDyndepObjectInfo& info);
+  void Store(std::string const& ddi, cmFileTime const& ddiTime,
+             cmDyndepObjectInfo const& info);
+
+private:
+  struct Entry
+  {
+    cmFileTime::NSC Time = 0;
+    cmDyndepObjectInfo Info;
+    bool Used = false;
+  };
+
+  std::string File;
+  std::map<std::string, Entry> Entries;
+  bool Modified = false;
+};
+
+void cmDyndepCache::Load()
+{
+  cmFileTime cacheTime;
+  std::string data;
+  if (!cacheTime.Load(this->File) ||
+      !cmBinaryCache::ReadFile(this->File, DyndepCacheMagic, data)) {
+    return;
+  }
+
+  cmBinaryCache::Reader reader(data);
+  std::uint32_t nentries;
+  if (!reader.ReadUInt(nentries)) {
+    return;
+  }
+  for (std::uint32_t i = 0; i < nentries; ++i) {
+    std::string ddi;
+    Entry entry;
+    if (!reader.ReadString(ddi) || !reader.ReadTime(entry.Time) ||
+        !reader.ReadString(entry.Info.Object) ||
+        !reader.ReadStrings(entry.Info.Provides) ||
+        !reader.ReadStrings(entry.Info.Requires)) {
+      // The file is truncated or corrupt.  Keep what we read so far.
+      break;
+    }
+    // A ddi file that was modified in the same second as the cache was
+    // written may have changed again without a new modification time.
+    if (cacheTime.GetNS() - entry.Time < cmFileTime::NsPerS) {
+      continue;
+    }
+    this->Entries.emplace(std::move(ddi), std::move(entry));
+  }
+}
+
+bool cmDyndepCache::Save()
+{
+  std::uint32_t nentries = 0;
+  std::string entries;
+  for (auto const& e : this->Entries) {
+    if (!e.second.Used) {
+      this->Modified = true;
+      continue;
+    }
+    ++nentries;
+    cmBinaryCache::WriteString(entries, e.first);
+    cmBinaryCache::WriteTime(entries, e.second.Time);
+    cmBinaryCache::WriteString(entries, e.second.Info.Object);
+    cmBinaryCache::WriteStrings(entries, e.second.Info.Provides);
+    cmBinaryCache::WriteStrings(entries, e.second.Info.Requires);
+  }
+  if (!this->Modified) {
+    return true;
+  }
+  std::string data;
+  cmBinaryCache::WriteUInt(data, nentries);
+  data += entries;
+  return cmBinaryCache::WriteFile(this->File, DyndepCacheMagic, data);
+}
+
+bool cmDyndepCache::Lookup(std::string const& ddi, cmFileTime const& ddiTime,
+                           cmDyndepObjectInfo& info)
+{
+  auto i = this->Entries.find(ddi);
+  if (i == this->Entries.end() || i->second.Time != ddiTime.GetNS()) {
+    return false;
+  }
+  i->second.Used = true;
+  info = i->second.Info;
+  return true;
+}
+
+void cmDyndepCache::Store(std::string const& ddi, cmFileTime const& ddiTime,
+                          cmDyndepObjectInfo const& info)
+{
+  Entry& entry = this->Entries[ddi];
+  entry.Time = ddiTime.GetNS();
+  entry.Info = info;
+  entry.Used = true;
+  this->Modified = true;
+}
+}
+
 bool cmGlobalNinjaGenerator::WriteDyndepFile(
   std::string const& dir_top_src, std::string const& dir_top_bld,
   std::string const& dir_cur_src, std::string const& dir_cur_bld,
@@ -2247,8 +2621,23 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
     this->LocalGenerators.push_back(std::move(lgd));
   }
 
+  // Load the ddi files that changed since the last collation.
+  cmDyndepCache cache(cmStrCat(cmSystemTools::GetFilenamePath(arg_dd), '/',
+                               arg_lang, "DyndepCache.bin"));
+  cache.Load();
+
   std::vector<cmDyndepObjectInfo> objects;
   for (std::string const& arg_ddi : arg_ddis) {
+    cmFileTime ddiTime;
+    bool const haveTime = ddiTime.Load(arg_ddi);
+    if (haveTime) {
+      cmDyndepObjectInfo info;
+      if (cache.Lookup(arg_ddi, ddiTime, info)) {
+        objects.push_back(std::move(info));
+        continue;
+      }
+    }
+
     // Load the ddi file and compute the module file paths it provides.
     Json::Value ddio;
     Json::Value const& ddi = ddio;
@@ -2275,6 +2664,9 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
         info.Requires.push_back(ddi_require.asString());
       }
     }
+    if (haveTime) {
+      cache.Store(arg_ddi, ddiTime, info);
+    }
     objects.push_back(std::move(info));
   }
 
@@ -2348,6 +2740,9 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
   cmGeneratedFileStream tmf(target_mods_file);
   tmf << tm;
 
+  // The cache only saves time, so failing to write it is not an error.
+  cache.Save();
+
   return true;
 }
 
@@ -144,6 +144,13 @@ public:
   static void WriteInclude(std::ostream& os, const std::string& filename,
                            const std::string& comment = "");
 
+  /**
+   * Write a subninja statement loading @a filename in its own scope with
+   * an optional @a comment to the @a os stream.
+   */
+  static void WriteSubninja(std::ostream& os, const std::string& filename,
+                            const std::string& comment = "");
+
   /**
    * Write a default target statement specifying @a targets as
    * the default targets.
@@ -212,6 +219,8 @@ public:
   const char* GetCleanTargetName() const override { return "clean"; }
 
   bool SupportsCustomCommandDepfile() const override { return true; }
+  bool SupportsParallelGenerate() const override { return true; }
+  bool SupportsSkippingGenerate() const override { return true; }
 
   virtual cmGeneratedFileStream* GetImplFileStream(
     const std::string& /*config*/) const
@@ -240,6 +249,18 @@ public:
     return this->RulesFileStream.get();
   }
 
+  /**
+   * Open a stream for the build file fragment at the full @a path.  A
+   * fragment is replaced only if its content changed, so fragments that
+   * are generated the same way keep their timestamps.
+   */
+  bool OpenFragmentFileStream(std::unique_ptr<cmGeneratedFileStream>& stream,
+                              const std::string& path);
+
+  /// Whether the build statements of targets go to per-target fragments,
+  /// as requested by CMAKE_NINJA_TARGET_FRAGMENTS.
+  bool UseTargetFragments() const { return this->TargetFragments; }
+
   std::string const& ConvertToNinjaPath(const std::string& path) const;
 
   struct MapToNinjaPathImpl
@@ -532,11 +553,15 @@ private:
 
 private:
   void InitOutputPathPrefix();
+  void RemoveStaleFragments();
 
   std::string OutputPathPrefix;
   std::string TargetAll;
   std::string CMakeCacheFile;
 
+  bool TargetFragments = false;
+  std::set<std::string> FragmentFiles;
+
   struct ByConfig
   {
     std::set<std::string> AdditionalCleanFiles;
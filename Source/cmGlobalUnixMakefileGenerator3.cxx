@@ -3,6 +3,7 @@
 #include "cmGlobalUnixMakefileGenerator3.h"
 
 #include <algorithm>
+#include <cctype>
 #include <functional>
 #include <sstream>
 #include <utility>
@@ -19,6 +20,7 @@
 #include "cmLocalUnixMakefileGenerator3.h"
 #include "cmMakefile.h"
 #include "cmMakefileTargetGenerator.h"
+#include "cmMessageType.h"
 #include "cmOutputConverter.h"
 #include "cmState.h"
 #include "cmStateDirectory.h"
@@ -127,6 +129,12 @@ void cmGlobalUnixMakefileGenerator3::Configure()
 
 void cmGlobalUnixMakefileGenerator3::Generate()
 {
+  // The layout must be known before the target rules are written.
+  this->FlatMakefiles = this->CheckFlatMakefiles();
+  this->TargetVariablePrefixes.clear();
+  this->UsedVariablePrefixes.clear();
+  this->FlatRuleOutputs.clear();
+
   // first do superclass method
   this->cmGlobalGenerator::Generate();
 
@@ -164,6 +172,58 @@ void cmGlobalUnixMakefileGenerator3::Generate()
   }
 }
 
+bool cmGlobalUnixMakefileGenerator3::CheckFlatMakefiles()
+{
+  if (!this->GlobalSettingIsOn("CMAKE_FLAT_MAKEFILES")) {
+    return false;
+  }
+  if (!this->AllowFlatMakefiles()) {
+    this->GetCMakeInstance()->IssueMessage(
+      MessageType::WARNING,
+      cmStrCat("CMAKE_FLAT_MAKEFILES is not supported by the ",
+               this->GetName(), " generator."));
+    return false;
+  }
+  // The order of Fortran sources depends on the modules found by the
+  // dependency scanner, which runs too late in a single make process.
+  if (this->GetLanguageEnabled("Fortran")) {
+    this->GetCMakeInstance()->IssueMessage(
+      MessageType::WARNING,
+      "CMAKE_FLAT_MAKEFILES is not supported for projects using Fortran.  "
+      "Recursive makefiles are generated instead.");
+    return false;
+  }
+  return true;
+}
+
+std::string const& cmGlobalUnixMakefileGenerator3::GetTargetVariablePrefix(
+  cmGeneratorTarget const* gt)
+{
+  auto i = this->TargetVariablePrefixes.find(gt);
+  if (i != this->TargetVariablePrefixes.end()) {
+    return i->second;
+  }
+
+  // Use the target name, made unique over all directories.
+  std::string name = gt->GetName();
+  for (char& c : name) {
+    if (!isalnum(static_cast<unsigned char>(c))) {
+      c = '_';
+    }
+  }
+  std::string prefix = cmStrCat(name, '_');
+  for (int n = 1; !this->UsedVariablePrefixes.insert(prefix).second; ++n) {
+    prefix = cmStrCat(name, n, '_');
+  }
+  return this->TargetVariablePrefixes[gt] = std::move(prefix);
+}
+
+bool cmGlobalUnixMakefileGenerator3::ClaimFlatRuleOutput(
+  std::string const& output)
+{
+  return this->FlatRuleOutputs.insert(output).second;
+}
+
 void cmGlobalUnixMakefileGenerator3::AddCXXCompileCommand(
   const std::string& sourceFile, const std::string& workingDirectory,
   const std::string& compileCommand)
@@ -236,6 +296,10 @@ void cmGlobalUnixMakefileGenerator3::WriteMainMakefile2()
   // Write out the "special" stuff
   lg.WriteSpecialTargetsTop(makefileStream);
 
+  if (this->FlatMakefiles) {
+    this->WriteFlatProgressRules(makefileStream, lg);
+  }
+
   // Write the directory level rules.
   for (auto const& it : this->ComputeDirectoryTargets()) {
     this->WriteDirectoryRules2(makefileStream, it.second);
@@ -252,6 +316,78 @@ void cmGlobalUnixMakefileGenerator3::WriteMainMakefile2()
   lg.WriteSpecialTargetsBottom(makefileStream);
 }
 
+void cmGlobalUnixMakefileGenerator3::WriteFlatProgressRules(
+  std::ostream& ruleFileStream, cmLocalUnixMakefileGenerator3& lg)
+{
+  // Count the progress marks of each goal given to this makefile by the
+  // directory and target rules.
+  std::map<std::string, size_t> goalMarks;
+  auto addGoal = [&goalMarks](std::string const& goal, size_t marks) {
+    // Skip goals that cannot be part of a variable name.
+    if (marks > 0 && goal.find_first_of(" \t:=#$") == std::string::npos) {
+      goalMarks[goal] = marks;
+    }
+  };
+  std::string const& binDir = lg.GetBinaryDirectory();
+  for (const auto& localGen : this->LocalGenerators) {
+    auto& tlg =
+      cm::static_reference_cast<cmLocalUnixMakefileGenerator3>(localGen);
+    addGoal(tlg.MaybeConvertToRelativePath(
+              binDir, cmStrCat(tlg.GetCurrentBinaryDirectory(), "/all")),
+            this->CountProgressMarksInAll(tlg));
+    for (const auto& gtarget : tlg.GetGeneratorTargets()) {
+      if (this->ProgressMap.count(gtarget.get())) {
+        std::set<cmGeneratorTarget const*> emitted;
+        addGoal(cmStrCat(tlg.GetRelativeTargetDirectory(gtarget.get()),
+                         "/all"),
+                this->CountProgressMarksInTarget(gtarget.get(), emitted));
+      }
+    }
+  }
+
+  lg.WriteDivider(ruleFileStream);
+  ruleFileStream
+    << "# Progress reporting.  All rules run in this make process, so it\n"
+    << "# tracks the progress marks of the finished rules itself.\n\n";
+
+  std::set<size_t> totals;
+  for (auto const& gm : goalMarks) {
+    ruleFileStream << "CMAKE_PROGRESS_TOTAL_" << gm.first << " = "
+                   << gm.second << "\n";
+    totals.insert(gm.second);
+  }
+  ruleFileStream << "\n";
+
+  // The percentage printed after each number of finished marks.  Spaces
+  // are written as underscores to keep each entry one word.
+  for (size_t total : totals) {
+    ruleFileStream << "CMAKE_PROGRESS_PERCENT_" << total << " =";
+    for (size_t done = 0; done <= total; ++done) {
+      std::string percent = std::to_string(done * 100 / total);
+      ruleFileStream << " [" << std::string(3 - percent.size(), '_')
+                     << percent << "%]_";
+    }
+    ruleFileStream << "\n";
+  }
+  ruleFileStream << "\n";
+
+  /* clang-format off */
+  ruleFileStream
+    << "CMAKE_PROGRESS_TOTAL := "
+       "$(CMAKE_PROGRESS_TOTAL_$(firstword $(MAKECMDGOALS) all))\n"
+    << "CMAKE_PROGRESS_PERCENT := "
+       "$(CMAKE_PROGRESS_PERCENT_$(CMAKE_PROGRESS_TOTAL))\n"
+    << "CMAKE_PROGRESS_DONE :=\n\n"
+    << "# Record the given progress marks as finished and expand to the\n"
+    << "# percentage of finished marks.\n"
+    << "CMAKE_PROGRESS_REPORT = $(if $(CMAKE_PROGRESS_PERCENT),"
+       "$(eval CMAKE_PROGRESS_DONE := $(sort $(CMAKE_PROGRESS_DONE) $1))"
+       "$(subst _, ,$(or "
+       "$(word $(words x $(CMAKE_PROGRESS_DONE)),$(CMAKE_PROGRESS_PERCENT)),"
+       "[100%]_)))\n\n";
+  /* clang-format on */
+}
+
 void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
 {
   if (this->GlobalSettingIsOn("CMAKE_SUPPRESS_REGENERATION")) {
@@ -362,6 +498,10 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
                       << localGen->MaybeConvertToRelativePath(binDir, tmpStr)
                       << "\"\n";
     }
+    for (std::string const& file : this->GetBatchFiles()) {
+      cmakefileStream << "  \"" << lg.MaybeConvertToRelativePath(binDir, file)
+                      << "\"\n";
+    }
     cmakefileStream << "  )\n\n";
   }
 
@@ -573,10 +713,18 @@ void cmGlobalUnixMakefileGenerator3::WriteConvenienceRules(
         ruleFileStream << "# Target rules for targets named " << name
                        << "\n\n";
 
-        // Write the rule.
+        // Write the rule.  The flat Makefile2 has no rule named after
+        // the target because the name may also be a file built by it.
         commands.clear();
         std::string tmp = "CMakeFiles/Makefile2";
-        commands.push_back(lg.GetRecursiveMakeCall(tmp, name));
+        if (this->FlatMakefiles) {
+          commands.push_back(lg.GetRecursiveMakeCall(
+            tmp,
+            cmStrCat(lg.GetRelativeTargetDirectory(gtarget.get()),
+                     "/rule")));
+        } else {
+          commands.push_back(lg.GetRecursiveMakeCall(tmp, name));
+        }
         depends.clear();
         if (regenerate) {
           depends.emplace_back("cmake_check_build_system");
@@ -649,17 +797,27 @@ void cmGlobalUnixMakefileGenerator3::WriteConvenienceRules2(
       ruleFileStream << "# Target rules for target " << localName << "\n\n";
 
       commands.clear();
-      makeTargetName = cmStrCat(localName, "/depend");
-      commands.push_back(
-        lg.GetRecursiveMakeCall(makefileName, makeTargetName));
+      depends.clear();
+      if (this->FlatMakefiles) {
+        // Make reads the rules of the target itself.  Its dependencies
+        // are updated after it is built, for use by the next build.
+        ruleFileStream << "# Include the build rules of the target.\n"
+                       << this->IncludeDirective << " "
+                       << cmSystemTools::ConvertToOutputPath(makefileName)
+                       << "\n\n";
+        depends.push_back(cmStrCat(localName, "/depend"));
+      } else {
+        makeTargetName = cmStrCat(localName, "/depend");
+        commands.push_back(
+          lg.GetRecursiveMakeCall(makefileName, makeTargetName));
 
-      makeTargetName = cmStrCat(localName, "/build");
-      commands.push_back(
-        lg.GetRecursiveMakeCall(makefileName, makeTargetName));
+        makeTargetName = cmStrCat(localName, "/build");
+        commands.push_back(
+          lg.GetRecursiveMakeCall(makefileName, makeTargetName));
+      }
 
       // Write the rule.
       localName += "/all";
-      depends.clear();
 
       cmLocalUnixMakefileGenerator3::EchoProgress progress;
       progress.Dir = cmStrCat(lg.GetBinaryDirectory(), "/CMakeFiles");
@@ -668,7 +826,7 @@ void cmGlobalUnixMakefileGenerator3::WriteConvenienceRules2(
         const char* sep = "";
         for (unsigned long progFile : this->ProgressMap[gtarget.get()].Marks) {
           progressArg << sep << progFile;
-          sep = ",";
+          sep = this->FlatMakefiles ? " " : ",";
         }
         progress.Arg = progressArg.str();
       }
@@ -689,6 +847,19 @@ void cmGlobalUnixMakefileGenerator3::WriteConvenienceRules2(
       lg.WriteMakeRule(ruleFileStream, "All Build rule for target.", localName,
                        depends, commands, true);
 
+      if (this->FlatMakefiles) {
+        // Run the rules of the target after those of its dependencies.
+        depends.clear();
+        this->AppendGlobalTargetDepends(depends, gtarget.get());
+        if (!depends.empty()) {
+          commands.clear();
+          lg.WriteMakeRule(
+            ruleFileStream, "Order rule for target.",
+            cmStrCat(lg.GetRelativeTargetDirectory(gtarget.get()), "/order"),
+            depends, commands, false);
+        }
+      }
+
       // Write the rule.
       commands.clear();
 
@@ -727,6 +898,13 @@ void cmGlobalUnixMakefileGenerator3::WriteConvenienceRules2(
                        "Build rule for subdir invocation for target.",
                        localName, depends, commands, true);
 
+      // The included build.make already has the remaining rules.  A
+      // target with the canonical name would clash with files of the
+      // same name.
+      if (this->FlatMakefiles) {
+        continue;
+      }
+
       // Add a target with the canonical name (no prefix, suffix or path).
       commands.clear();
       depends.clear();
@@ -832,6 +1010,9 @@ void cmGlobalUnixMakefileGenerator3::RecordTargetProgress(
   TargetProgress& tp = this->ProgressMap[tg->GetGeneratorTarget()];
   tp.NumberOfActions = tg->GetNumberOfProgressActions();
   tp.VariableFile = tg->GetProgressFileNameFull();
+  if (this->FlatMakefiles) {
+    tp.VariablePrefix = this->GetTargetVariablePrefix(tg->GetGeneratorTarget());
+  }
 }
 
 void cmGlobalUnixMakefileGenerator3::TargetProgress::WriteProgressVariables(
@@ -839,7 +1020,7 @@ void cmGlobalUnixMakefileGenerator3::TargetProgress::WriteProgressVariables(
 {
   cmGeneratedFileStream fout(this->VariableFile);
   for (unsigned long i = 1; i <= this->NumberOfActions; ++i) {
-    fout << "CMAKE_PROGRESS_" << i << " = ";
+    fout << this->VariablePrefix << "CMAKE_PROGRESS_" << i << " = ";
     if (total <= 100) {
       unsigned long num = i + current;
       fout << num;
@@ -157,8 +157,29 @@ public:
   /** Does the make tool tolerate .DELETE_ON_ERROR? */
   virtual bool AllowDeleteOnError() const { return true; }
 
+  /** Can the make tool run the whole build in one make process?  This
+      needs GNU make features such as order-only prerequisites.  */
+  virtual bool AllowFlatMakefiles() const { return true; }
+
+  /** Are all build rules included by Makefile2 instead of being run
+      by one recursive make call per target?  */
+  bool UseFlatMakefiles() const { return this->FlatMakefiles; }
+
+  /** Get the prefix of the make variables of a target.  The build.make
+      files of all targets are read by one make process in the flat
+      layout, so their variables must not collide.  */
+  std::string const& GetTargetVariablePrefix(cmGeneratorTarget const* gt);
+
+  /** Record that a target writes the rule for a custom command output.
+      Returns false if another target already wrote it.  Make must see
+      each rule only once in the flat layout.  */
+  bool ClaimFlatRuleOutput(std::string const& output);
+
   bool IsIPOSupported() const override { return true; }
 
+  bool SupportsParallelGenerate() const override { return true; }
+  bool SupportsSkippingGenerate() const override { return true; }
+
   void ComputeTargetObjectDirectory(cmGeneratorTarget* gt) const override;
 
   std::string IncludeDirective;
@@ -170,6 +191,10 @@ protected:
   void WriteMainMakefile2();
   void WriteMainCMakefile();
 
+  bool CheckFlatMakefiles();
+  void WriteFlatProgressRules(std::ostream& ruleFileStream,
+                              cmLocalUnixMakefileGenerator3& lg);
+
   void WriteConvenienceRules2(std::ostream& ruleFileStream,
                               cmLocalUnixMakefileGenerator3&);
 
@@ -227,6 +252,7 @@ protected:
   {
     unsigned long NumberOfActions = 0;
     std::string VariableFile;
+    std::string VariablePrefix;
     std::vector<unsigned long> Marks;
     void WriteProgressVariables(unsigned long total, unsigned long& current);
   };
@@ -241,6 +267,11 @@ protected:
 
   std::unique_ptr<cmGeneratedFileStream> CommandDatabase;
 
+  bool FlatMakefiles = false;
+  std::map<cmGeneratorTarget const*, std::string> TargetVariablePrefixes;
+  std::set<std::string> UsedVariablePrefixes;
+  std::set<std::string> FlatRuleOutputs;
+
 private:
   const char* GetBuildIgnoreErrorsFlag() const override { return "-i"; }
   std::string GetEditCacheCommand() const override;
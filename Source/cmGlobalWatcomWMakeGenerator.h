@@ -50,6 +50,7 @@ public:
 
   bool AllowNotParallel() const override { return false; }
   bool AllowDeleteOnError() const override { return false; }
+  bool AllowFlatMakefiles() const override { return false; }
 
 protected:
   std::vector<GeneratedMakeCommand> GenerateBuildCommand(
@@ -1725,6 +1725,7 @@ void cmGlobalXCodeGenerator::CreateCustomRulesMakefile(
       }
 
       // Add each command line to the set of commands.
+      this->WriteBatchFiles(ccg);
       for (unsigned int c = 0; c < ccg.GetNumberOfCommands(); ++c) {
         // Build the command line in a single string.
         std::string cmd2 = ccg.GetCommand(c);
@@ -0,0 +1,118 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmListFileArgumentTemplate.h"
+
+#include <cctype>
+#include <cstddef>
+#include <utility>
+
+namespace {
+
+bool IsNameChar(char c)
+{
+  return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '/' ||
+    c == '.' || c == '+' || c == '-';
+}
+
+// Whether a '$' followed by the text at the given position would be
+// rejected as an unsupported "$name{}" reference.
+bool IsNamedCurly(std::string const& value, std::size_t pos)
+{
+  std::size_t const start = pos;
+  while (pos < value.size() && IsNameChar(value[pos])) {
+    ++pos;
+  }
+  return pos > start && pos < value.size() && value[pos] == '{';
+}
+}
+
+cmListFileArgumentTemplate::cmListFileArgumentTemplate(
+  std::string const& value)
+{
+  this->Usable = this->Split(value);
+  if (!this->Usable) {
+    this->Segments.clear();
+  }
+  this->Literal = this->Usable &&
+    (this->Segments.empty() ||
+     (this->Segments.size() == 1 &&
+      this->Segments[0].Type == SegmentType::Literal));
+}
+
+bool cmListFileArgumentTemplate::Split(std::string const& value)
+{
+  // This follows cmMakefile::ExpandVariablesInStringNew for a normal
+  // argument: escapes are processed and '@' is not special.
+  std::string text;
+  std::size_t const size = value.size();
+  std::size_t i = 0;
+  while (i < size) {
+    char const c = value[i];
+    char const next = i + 1 < size ? value[i + 1] : '\0';
+    if (c == '$') {
+      SegmentType type = SegmentType::Variable;
+      std::size_t start = 0;
+      if (next == '{') {
+        start = i + 2;
+      } else if (value.compare(i + 1, 4, "ENV{") == 0) {
+        type = SegmentType::Environment;
+        start = i + 5;
+      } else if (value.compare(i + 1, 6, "CACHE{") == 0) {
+        type = SegmentType::Cache;
+        start = i + 7;
+      } else if (next != '<' && IsNamedCurly(value, i + 1)) {
+        return false;
+      }
+      if (start == 0) {
+        text += c;
+        ++i;
+        continue;
+      }
+      // Only references to a plain name can be split.
+      std::size_t end = start;
+      while (end < size && IsNameChar(value[end])) {
+        ++end;
+      }
+      if (end == size || value[end] != '}') {
+        return false;
+      }
+      std::string name = value.substr(start, end - start);
+      // The expansion of this variable depends on the line it is on.
+      if (type == SegmentType::Variable && name == "CMAKE_CURRENT_LIST_LINE") {
+        return false;
+      }
+      if (!text.empty()) {
+        this->Segments.push_back({ SegmentType::Literal, std::move(text) });
+        text.clear();
+      }
+      this->Segments.push_back({ type, std::move(name) });
+      i = end + 1;
+    } else if (c == '\\') {
+      if (next == 't') {
+        text += '\t';
+      } else if (next == 'n') {
+        text += '\n';
+      } else if (next == 'r') {
+        text += '\r';
+      } else if (next == ';') {
+        // Handled in list expansion; keep the backslash.
+        text += "\\;";
+      } else if (next == '\0' || isalnum(static_cast<unsigned char>(next))) {
+        return false;
+      } else {
+        text += next;
+      }
+      i += 2;
+    } else if (c == '\0') {
+      // The general expansion stops at an embedded null character.
+      return false;
+    } else {
+      text += c;
+      ++i;
+    }
+  }
+  if (!text.empty()) {
+    this->Segments.push_back({ SegmentType::Literal, std::move(text) });
+  }
+  return true;
+}
@@ -0,0 +1,63 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmListFileArgumentTemplate_h
+#define cmListFileArgumentTemplate_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+/** \class cmListFileArgumentTemplate
+ * \brief A list file argument split into literal text and references.
+ *
+ * Expanding an argument with the CMP0053 NEW rules scans its value for
+ * escapes and ${}, $ENV{} and $CACHE{} references.  A template holds the
+ * result of that scan so that an argument executed many times, such as
+ * one in a loop or function body, is scanned only once.  Expansion then
+ * appends the literal segments and the values of the referenced
+ * variables.
+ *
+ * Only values whose references are all simple can be split.  Nested
+ * references, invalid escapes and other syntax errors leave the template
+ * unusable, and the caller falls back to the general expansion, which
+ * also reports the errors.
+ */
+class cmListFileArgumentTemplate
+{
+public:
+  enum class SegmentType
+  {
+    Literal,
+    Variable,
+    Environment,
+    Cache
+  };
+
+  struct Segment
+  {
+    SegmentType Type;
+    std::string Text;
+  };
+
+  /** Split the given argument value.  */
+  explicit cmListFileArgumentTemplate(std::string const& value);
+
+  /** Whether the value could be split.  */
+  bool IsUsable() const { return this->Usable; }
+
+  /** Whether the value contains no references at all.  Its expansion
+      is then the text of its only segment, if any.  */
+  bool IsLiteral() const { return this->Literal; }
+
+  std::vector<Segment> const& GetSegments() const { return this->Segments; }
+
+private:
+  bool Split(std::string const& value);
+
+  std::vector<Segment> Segments;
+  bool Usable = false;
+  bool Literal = false;
+};
+
+#endif
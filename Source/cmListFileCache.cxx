@@ -15,6 +15,10 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmListFileParseCache.h"
+#endif
+
 cmCommandContext::cmCommandName& cmCommandContext::cmCommandName::operator=(
   std::string const& name)
 {
@@ -44,6 +48,7 @@ struct cmListFileParser
   const char* FileName;
   cmListFileLexer* Lexer;
   cmListFileFunction Function;
+  bool Diagnosed = false;
   enum
   {
     SeparationOkay,
@@ -69,12 +74,18 @@ cmListFileParser::~cmListFileParser()
 
 void cmListFileParser::IssueFileOpenError(const std::string& text) const
 {
+  if (!this->Messenger) {
+    return;
+  }
   this->Messenger->IssueMessage(MessageType::FATAL_ERROR, text,
                                 this->Backtrace);
 }
 
 void cmListFileParser::IssueError(const std::string& text) const
 {
+  if (!this->Messenger) {
+    return;
+  }
   cmListFileContext lfc;
   lfc.FilePath = this->FileName;
   lfc.Line = cmListFileLexer_GetCurrentLine(this->Lexer);
@@ -166,21 +177,45 @@ bool cmListFileParser::Parse()
 }
 
 bool cmListFile::ParseFile(const char* filename, cmMessenger* messenger,
-                           cmListFileBacktrace const& lfbt)
+                           cmListFileBacktrace const& lfbt,
+                           cmListFileParseCache* cache)
 {
   if (!cmSystemTools::FileExists(filename) ||
       cmSystemTools::FileIsDirectory(filename)) {
     return false;
   }
 
+#ifndef CMAKE_BOOTSTRAP
+  std::string cacheKey;
+  if (cache) {
+    cacheKey = cmListFileParseCache::ComputeKey(filename);
+    if (!cacheKey.empty() && cache->Lookup(cacheKey, this->Functions)) {
+      return true;
+    }
+  }
+#else
+  static_cast<void>(cache);
+#endif
+
   bool parseError = false;
+  bool diagnosed = false;
 
   {
     cmListFileParser parser(this, lfbt, messenger);
     parseError = !parser.ParseFile(filename);
+    diagnosed = parser.Diagnosed;
   }
 
-  return !parseError;
+#ifndef CMAKE_BOOTSTRAP
+  // A cache hit replays no diagnostics, so store only clean parses.
+  if (cache && !cacheKey.empty() && !parseError && !diagnosed) {
+    cache->Store(cacheKey, this->Functions);
+  }
+#endif
+
+  // Without a messenger the caller cannot report diagnostics, so only a
+  // clean parse counts as success.
+  return !parseError && (messenger || !diagnosed);
 }
 
 bool cmListFile::ParseString(const char* str, const char* virtual_filename,
@@ -282,6 +317,9 @@ bool cmListFileParser::ParseFunction(const char* name, long line)
     }
   }
 
+  if (!this->Messenger) {
+    return false;
+  }
   std::ostringstream error;
   cmListFileContext lfc;
   lfc.FilePath = this->FileName;
@@ -303,6 +341,10 @@ bool cmListFileParser::AddArgument(cmListFileLexer_Token* token,
   }
   bool isError = (this->Separation == SeparationError ||
                   delim == cmListFileArgument::Bracket);
+  this->Diagnosed = true;
+  if (!this->Messenger) {
+    return !isError;
+  }
   std::ostringstream m;
   cmListFileContext lfc;
   lfc.FilePath = this->FileName;
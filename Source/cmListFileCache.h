@@ -21,6 +21,8 @@
  * cmake list files.
  */
 
+class cmListFileArgumentTemplate;
+class cmListFileParseCache;
 class cmMessenger;
 
 struct cmCommandContext
@@ -65,6 +67,8 @@ struct cmListFileArgument
   std::string Value;
   Delimiter Delim = Unquoted;
   long Line = 0;
+  // The value split for variable expansion, created on first use.
+  mutable std::shared_ptr<cmListFileArgumentTemplate const> Template;
 };
 
 class cmListFileContext
@@ -181,8 +185,12 @@ std::vector<BT<std::string>> ExpandListWithBacktrace(
 
 struct cmListFile
 {
+  /** Parse the given file.  Without a messenger no diagnostics are
+      reported and any diagnostic fails the parse; this mode does not
+      touch global state and may be used from any thread.  */
   bool ParseFile(const char* path, cmMessenger* messenger,
-                 cmListFileBacktrace const& lfbt);
+                 cmListFileBacktrace const& lfbt,
+                 cmListFileParseCache* cache = nullptr);
 
   bool ParseString(const char* str, const char* virtual_filename,
                    cmMessenger* messenger, cmListFileBacktrace const& lfbt);
@@ -0,0 +1,194 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmListFileParseCache.h"
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include "cmBinaryCache.h"
+#include "cmCryptoHash.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+// Bump the version whenever the layout of the serialized data changes.
+const char cacheMagic[] = "CMakeListFileParseCache\n1\n";
+
+bool ReadFunction(cmBinaryCache::Reader& reader,
+                  cmListFileFunction& function)
+{
+  std::string name;
+  std::uint32_t line;
+  std::uint32_t nargs;
+  if (!reader.ReadString(name) || !reader.ReadUInt(line) ||
+      !reader.ReadUInt(nargs)) {
+    return false;
+  }
+  function.Name = name;
+  function.Line = static_cast<long>(line);
+  function.Arguments.reserve(nargs);
+  for (std::uint32_t i = 0; i < nargs; ++i) {
+    std::string value;
+    std::uint32_t delim;
+    std::uint32_t argLine;
+    if (!reader.ReadString(value) || !reader.ReadUInt(delim) ||
+        !reader.ReadUInt(argLine) || delim > cmListFileArgument::Bracket) {
+      return false;
+    }
+    function.Arguments.emplace_back(
+      std::move(value), static_cast<cmListFileArgument::Delimiter>(delim),
+      static_cast<long>(argLine));
+  }
+  return true;
+}
+
+void WriteFunction(std::string& out, cmListFileFunction const& function)
+{
+  cmBinaryCache::WriteString(out, function.Name.Original);
+  cmBinaryCache::WriteUInt(out, static_cast<std::uint32_t>(function.Line));
+  cmBinaryCache::WriteUInt(
+    out, static_cast<std::uint32_t>(function.Arguments.size()));
+  for (cmListFileArgument const& arg : function.Arguments) {
+    cmBinaryCache::WriteString(out, arg.Value);
+    cmBinaryCache::WriteUInt(out, static_cast<std::uint32_t>(arg.Delim));
+    cmBinaryCache::WriteUInt(out, static_cast<std::uint32_t>(arg.Line));
+  }
+}
+}
+
+cmListFileParseCache::cmListFileParseCache(std::string cacheFile)
+  : CacheFile(std::move(cacheFile))
+{
+}
+
+void cmListFileParseCache::Load()
+{
+  this->Entries.clear();
+  this->Modified = false;
+
+  std::string data;
+  if (!cmBinaryCache::ReadFile(this->CacheFile, cacheMagic, data)) {
+    return;
+  }
+
+  cmBinaryCache::Reader reader(data);
+  std::uint32_t nentries;
+  if (!reader.ReadUInt(nentries)) {
+    return;
+  }
+  for (std::uint32_t i = 0; i < nentries; ++i) {
+    std::string key;
+    std::uint32_t nfunctions;
+    if (!reader.ReadString(key) || !reader.ReadUInt(nfunctions)) {
+      break;
+    }
+    Entry entry;
+    entry.Functions.resize(nfunctions);
+    bool ok = true;
+    for (cmListFileFunction& function : entry.Functions) {
+      if (!ReadFunction(reader, function)) {
+        ok = false;
+        break;
+      }
+    }
+    if (!ok) {
+      // The file is truncated or corrupt.  Keep what we read so far.
+      break;
+    }
+    this->Entries.emplace(std::move(key), std::move(entry));
+  }
+}
+
+bool cmListFileParseCache::Save()
+{
+  std::uint32_t nentries = 0;
+  std::string entries;
+  for (auto const& e : this->Entries) {
+    if (!e.second.Used) {
+      this->Modified = true;
+      continue;
+    }
+    ++nentries;
+    cmBinaryCache::WriteString(entries, e.first);
+    cmBinaryCache::WriteUInt(
+      entries, static_cast<std::uint32_t>(e.second.Functions.size()));
+    for (cmListFileFunction const& function : e.second.Functions) {
+      WriteFunction(entries, function);
+    }
+  }
+  if (!this->Modified) {
+    return true;
+  }
+  std::string data;
+  cmBinaryCache::WriteUInt(data, nentries);
+  data += entries;
+
+  cmSystemTools::MakeDirectory(
+    cmSystemTools::GetFilenamePath(this->CacheFile));
+  if (!cmBinaryCache::WriteFile(this->CacheFile, cacheMagic, data)) {
+    return false;
+  }
+  this->Modified = false;
+  return true;
+}
+
+std::string cmListFileParseCache::ComputeKey(std::string const& fileName)
+{
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  return hasher.HashFile(fileName);
+}
+
+bool cmListFileParseCache::Lookup(std::string const& key,
+                                  std::vector<cmListFileFunction>& functions)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  auto i = this->Entries.find(key);
+  if (i == this->Entries.end()) {
+    ++this->Misses;
+    return false;
+  }
+  ++this->Hits;
+  i->second.Used = true;
+  functions = i->second.Functions;
+  return true;
+}
+
+void cmListFileParseCache::Store(
+  std::string const& key, std::vector<cmListFileFunction> const& functions)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  Entry& entry = this->Entries[key];
+  entry.Functions = functions;
+  entry.Used = true;
+  this->Modified = true;
+}
+
+bool cmListFileParseCache::Peek(
+  std::string const& key, std::vector<cmListFileFunction>& functions) const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  auto i = this->Entries.find(key);
+  if (i == this->Entries.end()) {
+    return false;
+  }
+  functions = i->second.Functions;
+  return true;
+}
+
+void cmListFileParseCache::Record(
+  std::string const& key, std::vector<cmListFileFunction> const& functions)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  auto i = this->Entries.find(key);
+  if (i != this->Entries.end()) {
+    ++this->Hits;
+    i->second.Used = true;
+    return;
+  }
+  ++this->Misses;
+  Entry& entry = this->Entries[key];
+  entry.Functions = functions;
+  entry.Used = true;
+  this->Modified = true;
+}
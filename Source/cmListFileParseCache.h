@@ -0,0 +1,82 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmListFileParseCache_h
+#define cmListFileParseCache_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cmListFileCache.h"
+
+/** \class cmListFileParseCache
+ * \brief Persistent cache of parsed list files.
+ *
+ * cmListFileParseCache maps the content hash of a list file to the
+ * functions its parse produced.  The cache is loaded from the build
+ * tree before configuration and saved after it, so list files whose
+ * bytes did not change since the last run need not be parsed again.
+ * Only entries used during a run are saved, which keeps the file from
+ * accumulating stale content.
+ *
+ * Lookup(), Store(), Peek() and Record() may be called concurrently.
+ */
+class cmListFileParseCache
+{
+public:
+  cmListFileParseCache(std::string cacheFile);
+
+  cmListFileParseCache(cmListFileParseCache const&) = delete;
+  cmListFileParseCache& operator=(cmListFileParseCache const&) = delete;
+
+  /** Read the cache file.  A missing or unreadable file is ignored.  */
+  void Load();
+
+  /** Write all entries used since Load() back to the cache file.  */
+  bool Save();
+
+  /** Compute the key for the given list file.  Returns an empty string
+      if the file could not be read.  */
+  static std::string ComputeKey(std::string const& fileName);
+
+  /** Look up the functions for a key and count a hit or a miss.  */
+  bool Lookup(std::string const& key,
+              std::vector<cmListFileFunction>& functions);
+
+  /** Record the functions parsed for a key.  */
+  void Store(std::string const& key,
+             std::vector<cmListFileFunction> const& functions);
+
+  /** Look up the functions for a key without counting the lookup or
+      marking the entry as used.  */
+  bool Peek(std::string const& key,
+            std::vector<cmListFileFunction>& functions) const;
+
+  /** Count a hit and mark the entry as used if the key is known, or
+      count a miss and store the functions otherwise.  This accounts for
+      a parse result obtained without a call to Lookup().  */
+  void Record(std::string const& key,
+              std::vector<cmListFileFunction> const& functions);
+
+  unsigned long long GetHits() const { return this->Hits; }
+  unsigned long long GetMisses() const { return this->Misses; }
+
+private:
+  struct Entry
+  {
+    std::vector<cmListFileFunction> Functions;
+    bool Used = false;
+  };
+
+  std::string CacheFile;
+  mutable std::mutex Mutex;
+  std::unordered_map<std::string, Entry> Entries;
+  bool Modified = false;
+  unsigned long long Hits = 0;
+  unsigned long long Misses = 0;
+};
+
+#endif
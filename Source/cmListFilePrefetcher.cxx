@@ -0,0 +1,209 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmListFilePrefetcher.h"
+
+#include <utility>
+
+#include "cmListFileParseCache.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+// Whether an argument means the same before and after variable
+// expansion.  Unquoted arguments containing a ';' expand to a list.
+bool IsLiteral(cmListFileArgument const& arg)
+{
+  if (arg.Value.empty()) {
+    return false;
+  }
+  if (arg.Delim == cmListFileArgument::Bracket) {
+    return true;
+  }
+  return arg.Value.find_first_of(
+           arg.Delim == cmListFileArgument::Unquoted ? "$\\;" : "$\\") ==
+    std::string::npos;
+}
+}
+
+cmListFilePrefetcher::cmListFilePrefetcher(cmListFileParseCache* cache,
+                                           unsigned int threads)
+  : Cache(cache)
+{
+  this->Threads.reserve(threads);
+  for (unsigned int i = 0; i < threads; ++i) {
+    this->Threads.emplace_back(&cmListFilePrefetcher::Work, this);
+  }
+}
+
+cmListFilePrefetcher::~cmListFilePrefetcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Stopping = true;
+  }
+  this->Condition.notify_all();
+  for (std::thread& thread : this->Threads) {
+    thread.join();
+  }
+}
+
+void cmListFilePrefetcher::CollectJobs(
+  std::vector<cmListFileFunction> const& functions,
+  std::string const& sourceDir, std::vector<Job>& jobs)
+{
+  for (cmListFileFunction const& function : functions) {
+    if (function.Arguments.empty() || !IsLiteral(function.Arguments[0])) {
+      continue;
+    }
+    std::string const& arg = function.Arguments[0].Value;
+    if (function.Name.Lower == "add_subdirectory") {
+      std::string dir = cmSystemTools::CollapseFullPath(arg, sourceDir);
+      std::string file = cmStrCat(dir, "/CMakeLists.txt");
+      jobs.push_back({ std::move(file), std::move(dir) });
+    } else if (function.Name.Lower == "include") {
+      // Other names may refer to modules, which are looked up in the
+      // CMAKE_MODULE_PATH of the including directory.
+      if (cmSystemTools::FileIsFullPath(arg) ||
+          cmHasLiteralSuffix(arg, ".cmake")) {
+        jobs.push_back(
+          { cmSystemTools::CollapseFullPath(arg, sourceDir), sourceDir });
+      }
+    }
+  }
+}
+
+void cmListFilePrefetcher::Scan(
+  std::vector<cmListFileFunction> const& functions,
+  std::string const& sourceDir)
+{
+  std::vector<Job> jobs;
+  CollectJobs(functions, sourceDir, jobs);
+  if (jobs.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    for (Job& job : jobs) {
+      if (this->Entries.emplace(job.FileName, Entry()).second) {
+        this->Queue.push_back(std::move(job));
+      }
+    }
+  }
+  this->Condition.notify_all();
+}
+
+bool cmListFilePrefetcher::Take(std::string const& fileName,
+                                cmListFile& listFile)
+{
+  Entry taken;
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    auto i = this->Entries.find(fileName);
+    if (i == this->Entries.end() || i->second.State == Status::Taken) {
+      return false;
+    }
+    Entry& entry = i->second;
+    this->Condition.wait(
+      lock, [&entry] { return entry.State != Status::Parsing; });
+    taken = std::move(entry);
+    entry = Entry();
+    entry.State = Status::Taken;
+  }
+
+  // The main thread may have written the file since it was read.
+  cmFileTime time;
+  if (taken.State != Status::Parsed || !time.Load(fileName) ||
+      time.Differ(taken.Time) ||
+      cmSystemTools::FileLength(fileName) != taken.Length) {
+    ++this->Misses;
+    return false;
+  }
+
+  if (this->Cache && !taken.CacheKey.empty()) {
+    this->Cache->Record(taken.CacheKey, taken.Functions);
+  }
+  listFile.Functions = std::move(taken.Functions);
+  ++this->Hits;
+  return true;
+}
+
+void cmListFilePrefetcher::Wait()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->Condition.wait(
+    lock, [this] { return this->Queue.empty() && this->Active == 0; });
+}
+
+void cmListFilePrefetcher::Work()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  for (;;) {
+    this->Condition.wait(
+      lock, [this] { return this->Stopping || !this->Queue.empty(); });
+    if (this->Stopping) {
+      return;
+    }
+    Job job = std::move(this->Queue.front());
+    this->Queue.pop_front();
+    Entry& entry = this->Entries[job.FileName];
+    if (entry.State != Status::Queued) {
+      continue;
+    }
+    entry.State = Status::Parsing;
+    ++this->Active;
+    lock.unlock();
+
+    Entry parsed;
+    std::vector<Job> jobs;
+    if (this->Parse(job, parsed)) {
+      parsed.State = Status::Parsed;
+      CollectJobs(parsed.Functions, job.SourceDir, jobs);
+    } else {
+      parsed.State = Status::Failed;
+    }
+
+    lock.lock();
+    --this->Active;
+    entry = std::move(parsed);
+    // Queue the files named by this one ahead of the others so that
+    // prefetching follows the order in which the files are executed.
+    auto pos = this->Queue.begin();
+    for (Job& child : jobs) {
+      if (this->Entries.emplace(child.FileName, Entry()).second) {
+        pos = this->Queue.insert(pos, std::move(child));
+        ++pos;
+      }
+    }
+    this->Condition.notify_all();
+  }
+}
+
+bool cmListFilePrefetcher::Parse(Job const& job, Entry& entry) const
+{
+  if (!entry.Time.Load(job.FileName)) {
+    return false;
+  }
+  entry.Length = cmSystemTools::FileLength(job.FileName);
+
+  cmListFile listFile;
+  if (this->Cache) {
+    entry.CacheKey = cmListFileParseCache::ComputeKey(job.FileName);
+  }
+  if (entry.CacheKey.empty() ||
+      !this->Cache->Peek(entry.CacheKey, listFile.Functions)) {
+    if (!listFile.ParseFile(job.FileName.c_str(), nullptr,
+                            cmListFileBacktrace())) {
+      return false;
+    }
+  }
+
+  // Discard the result if the file changed while it was read.
+  cmFileTime time;
+  if (!time.Load(job.FileName) || time.Differ(entry.Time) ||
+      cmSystemTools::FileLength(job.FileName) != entry.Length) {
+    return false;
+  }
+  entry.Functions = std::move(listFile.Functions);
+  return true;
+}
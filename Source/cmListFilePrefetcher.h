@@ -0,0 +1,103 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmListFilePrefetcher_h
+#define cmListFilePrefetcher_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "cmFileTime.h"
+#include "cmListFileCache.h"
+
+class cmListFileParseCache;
+
+/** \class cmListFilePrefetcher
+ * \brief Parse list files on worker threads before they are needed.
+ *
+ * Parsing a list file depends only on its content.  cmListFilePrefetcher
+ * looks for add_subdirectory() and include() calls with literal arguments
+ * in parsed list files and parses the files they name on worker threads
+ * while the configure step executes the current file.  Execution stays on
+ * the main thread: it takes a prefetched result only if the file did not
+ * change since it was read, and parses the file itself otherwise.
+ *
+ * Parses that would report a diagnostic are discarded so that the main
+ * thread parses the file again and reports it in the usual way.
+ */
+class cmListFilePrefetcher
+{
+public:
+  cmListFilePrefetcher(cmListFileParseCache* cache, unsigned int threads);
+  ~cmListFilePrefetcher();
+
+  cmListFilePrefetcher(cmListFilePrefetcher const&) = delete;
+  cmListFilePrefetcher& operator=(cmListFilePrefetcher const&) = delete;
+
+  /** Queue the list files named literally by add_subdirectory() and
+      include() calls among the given functions.  Relative paths are
+      interpreted with respect to the given source directory.  */
+  void Scan(std::vector<cmListFileFunction> const& functions,
+            std::string const& sourceDir);
+
+  /** Take the prefetched parse of a file, waiting for it if it is being
+      parsed.  Returns false if the file was not prefetched, could not be
+      parsed cleanly, or changed since it was read.  */
+  bool Take(std::string const& fileName, cmListFile& listFile);
+
+  /** Block until all queued files have been parsed.  */
+  void Wait();
+
+  unsigned long long GetHits() const { return this->Hits; }
+  unsigned long long GetMisses() const { return this->Misses; }
+
+private:
+  enum class Status
+  {
+    Queued,
+    Parsing,
+    Parsed,
+    Failed,
+    Taken
+  };
+
+  struct Job
+  {
+    std::string FileName;
+    std::string SourceDir;
+  };
+
+  struct Entry
+  {
+    Status State = Status::Queued;
+    cmFileTime Time;
+    unsigned long Length = 0;
+    std::string CacheKey;
+    std::vector<cmListFileFunction> Functions;
+  };
+
+  static void CollectJobs(std::vector<cmListFileFunction> const& functions,
+                          std::string const& sourceDir,
+                          std::vector<Job>& jobs);
+  void Work();
+  bool Parse(Job const& job, Entry& entry) const;
+
+  cmListFileParseCache* Cache;
+  std::mutex Mutex;
+  std::condition_variable Condition;
+  std::deque<Job> Queue;
+  std::unordered_map<std::string, Entry> Entries;
+  std::vector<std::thread> Threads;
+  unsigned int Active = 0;
+  bool Stopping = false;
+  unsigned long long Hits = 0;
+  unsigned long long Misses = 0;
+};
+
+#endif
@@ -497,6 +497,13 @@ void cmLocalNinjaGenerator::AppendCustomCommandLines(
 
   std::string launcher = this->MakeCustomLauncher(ccg);
 
+  // The batch files are cleaned with the build tree.  A missing one makes
+  // CMake re-run to write it again.
+  gg->WriteBatchFiles(ccg);
+  for (auto const& batchFile : ccg.GetBatchFiles()) {
+    gg->AddAdditionalCleanFile(batchFile.first, ccg.GetConfig());
+  }
+
   for (unsigned i = 0; i != ccg.GetNumberOfCommands(); ++i) {
     cmdLines.push_back(launcher +
                        this->ConvertToOutputFormat(
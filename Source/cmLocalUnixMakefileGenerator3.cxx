@@ -44,6 +44,7 @@
 // C/C++ scanner is needed for bootstrapping CMake.
 #include "cmDependsC.h"
 #ifndef CMAKE_BOOTSTRAP
+#  include "cmDependsCompiler.h"
 #  include "cmDependsFortran.h"
 #  include "cmDependsJava.h"
 #endif
@@ -79,6 +80,49 @@ private:
   }
 };
 
+// Write a recipe line that lets make print a line of text itself
+// instead of starting a process.  Returns false if the text cannot be
+// passed to the $(info) function.
+static bool cmMakeInfoCommand(std::string& cmd, std::string const& prefix,
+                              std::string const& text)
+{
+  // The function call ends at the first unbalanced closing delimiter,
+  // and a trailing backslash would continue the recipe line.
+  int parens = 0;
+  int braces = 0;
+  bool parensOk = true;
+  bool bracesOk = true;
+  for (char c : text) {
+    if (c == '(') {
+      ++parens;
+    } else if (c == ')') {
+      parensOk = parensOk && --parens >= 0;
+    } else if (c == '{') {
+      ++braces;
+    } else if (c == '}') {
+      bracesOk = bracesOk && --braces >= 0;
+    }
+  }
+  if (!text.empty() && text.back() == '\\') {
+    return false;
+  }
+  char open;
+  char close;
+  if (parensOk && parens == 0) {
+    open = '(';
+    close = ')';
+  } else if (bracesOk && braces == 0) {
+    open = '{';
+    close = '}';
+  } else {
+    return false;
+  }
+  std::string escaped = text;
+  cmSystemTools::ReplaceString(escaped, "$", "$$");
+  cmd = cmStrCat("@$", open, "info ", prefix, escaped, close);
+  return true;
+}
+
 // Helper function used below.
 static std::string cmSplitExtension(std::string const& in, std::string& base)
 {
@@ -903,7 +947,7 @@ void cmLocalUnixMakefileGenerator3::AppendCustomCommands(
 void cmLocalUnixMakefileGenerator3::AppendCustomCommand(
   std::vector<std::string>& commands, cmCustomCommandGenerator const& ccg,
   cmGeneratorTarget* target, std::string const& relative, bool echo_comment,
-  std::ostream* content)
+  std::ostream* content, std::string const& batchTool)
 {
   // Optionally create a command to display the custom command's
   // comment text.  This is used for pre-build, pre-link, and
@@ -931,6 +975,7 @@ void cmLocalUnixMakefileGenerator3::AppendCustomCommand(
     this->CreateRulePlaceholderExpander());
 
   // Add each command line to the set of commands.
+  this->GlobalGenerator->WriteBatchFiles(ccg);
   std::vector<std::string> commands1;
   std::string currentBinDir = this->GetCurrentBinaryDirectory();
   for (unsigned int c = 0; c < ccg.GetNumberOfCommands(); ++c) {
@@ -1007,6 +1052,11 @@ void cmLocalUnixMakefileGenerator3::AppendCustomCommand(
         // Rule content does not include the launcher.
         *content << (cmd.c_str() + launcher.size());
       }
+      if (c == 0 && !batchTool.empty() && ccg.IsBatchCommand(c)) {
+        // Let the batch process run the given tool command first.
+        cmd += " ";
+        cmd += batchTool;
+      }
       if (this->BorlandMakeCurlyHack) {
         // Borland Make has a very strange bug.  If the first curly
         // brace anywhere in the command string is a left curly, it
@@ -1141,6 +1191,32 @@ void cmLocalUnixMakefileGenerator3::AppendDirectoryCleanCommand(
   }
 }
 
+void cmLocalUnixMakefileGenerator3::WriteOrderOnlyRule(
+  std::ostream& os, const char* comment,
+  std::vector<std::string> const& targets,
+  std::vector<std::string> const& orders)
+{
+  if (targets.empty() || orders.empty()) {
+    return;
+  }
+  if (comment) {
+    os << "# " << comment << "\n";
+  }
+  std::string const& binDir = this->GetBinaryDirectory();
+  std::ostringstream orderRules;
+  for (std::string const& order : orders) {
+    orderRules << ' '
+               << cmMakeSafe(cmSystemTools::ConvertToOutputPath(
+                    this->MaybeConvertToRelativePath(binDir, order)));
+  }
+  for (std::string const& target : targets) {
+    os << cmMakeSafe(cmSystemTools::ConvertToOutputPath(
+            this->MaybeConvertToRelativePath(binDir, target)))
+       << ": |" << orderRules.str() << "\n";
+  }
+  os << "\n";
+}
+
 void cmLocalUnixMakefileGenerator3::AppendEcho(
   std::vector<std::string>& commands, std::string const& text, EchoColor color,
   EchoProgress const* progress)
@@ -1171,7 +1247,19 @@ void cmLocalUnixMakefileGenerator3::AppendEcho(
     }
   }
 
-  // Echo one line at a time.
+  // The flat makefiles report progress from make itself.
+  bool const makeInfo = progress &&
+    static_cast<cmGlobalUnixMakefileGenerator3*>(this->GlobalGenerator)
+      ->UseFlatMakefiles();
+  std::string makeInfoProgress;
+  if (makeInfo) {
+    makeInfoProgress =
+      cmStrCat("$(call CMAKE_PROGRESS_REPORT,", progress->Arg, ')');
+  }
+
+  // Echo one line at a time.  Once cmake is used to echo a line, the
+  // following lines are printed by the same process.
+  bool colorEcho = false;
   std::string line;
   line.reserve(200);
   for (const char* c = text.c_str();; ++c) {
@@ -1180,7 +1268,13 @@ void cmLocalUnixMakefileGenerator3::AppendEcho(
       if (*c != '\0' || !line.empty()) {
         // Add a command to echo this line.
         std::string cmd;
-        if (color_name.empty() && !progress) {
+        if (colorEcho) {
+          commands.back() += " ";
+          commands.back() += this->EscapeForShell(line);
+        } else if (makeInfo &&
+                   cmMakeInfoCommand(cmd, makeInfoProgress, line)) {
+          // Print the line from make.
+        } else if (color_name.empty() && !progress) {
           // Use the native echo command.
           cmd = cmStrCat("@echo ", this->EscapeForShell(line, false, true));
         } else {
@@ -1199,8 +1293,11 @@ void cmLocalUnixMakefileGenerator3::AppendEcho(
             cmd += " ";
           }
           cmd += this->EscapeForShell(line);
+          colorEcho = true;
+        }
+        if (!cmd.empty()) {
+          commands.push_back(std::move(cmd));
         }
-        commands.push_back(std::move(cmd));
       }
 
       // Reset the line to empty.
@@ -1208,6 +1305,7 @@ void cmLocalUnixMakefileGenerator3::AppendEcho(
 
       // Progress appears only on first line.
       progress = nullptr;
+      makeInfoProgress.clear();
 
       // Terminate on end-of-string.
       if (*c == '\0') {
@@ -1315,14 +1413,32 @@ bool cmLocalUnixMakefileGenerator3::UpdateDependencies(
   std::string const targetDir = cmSystemTools::GetFilenamePath(tgtInfo);
   std::string const internalDependFile = targetDir + "/depend.internal";
   std::string const dependFile = targetDir + "/depend.make";
+  cmFileTimeCache* ftc =
+    this->GlobalGenerator->GetCMakeInstance()->GetFileTimeCache();
+
+#ifndef CMAKE_BOOTSTRAP
+  // Merge the dependencies written by the compiler for the objects
+  // compiled since the last merge.
+  if (const char* depfiles =
+        this->Makefile->GetDefinition("CMAKE_DEPENDS_DEPENDENCY_FILES")) {
+    std::vector<std::string> const objectDepfiles = cmExpandedList(depfiles);
+    cmDependsCompiler depender(this, targetDir);
+    depender.SetVerbose(verbose);
+    depender.SetFileTimeCache(ftc);
+    if (depender.NeedsUpdate(objectDepfiles)) {
+      this->ReadDirectoryInformation();
+      if (!depender.Update(objectDepfiles)) {
+        return false;
+      }
+    }
+  }
+#endif
 
   // If the target DependInfo.cmake file has changed since the last
   // time dependencies were scanned then force rescanning.  This may
   // happen when a new source file is added and CMake regenerates the
   // project but no other sources were touched.
   bool needRescanDependInfo = false;
-  cmFileTimeCache* ftc =
-    this->GlobalGenerator->GetCMakeInstance()->GetFileTimeCache();
   {
     int result;
     if (!ftc->Compare(internalDependFile, tgtInfo, &result) || result < 0) {
@@ -1366,6 +1482,8 @@ bool cmLocalUnixMakefileGenerator3::UpdateDependencies(
     cmDependsC checker;
     checker.SetVerbose(verbose);
     checker.SetFileTimeCache(ftc);
+    checker.SetAfterBuild(
+      this->Makefile->IsOn("CMAKE_DEPENDS_AFTER_BUILD"));
     // cmDependsC::Check() fills the vector validDependencies() with the
     // dependencies for those files where they are still valid, i.e. neither
     // the files themselves nor any files they depend on have changed.
@@ -1381,14 +1499,21 @@ bool cmLocalUnixMakefileGenerator3::UpdateDependencies(
   }
 
   if (needRescanDependInfo || needRescanDirInfo || needRescanDependencies) {
-    // The dependencies must be regenerated.
-    std::string targetName = cmSystemTools::GetFilenameName(targetDir);
-    targetName = targetName.substr(0, targetName.length() - 4);
-    std::string message =
-      cmStrCat("Scanning dependencies of target ", targetName);
-    cmSystemTools::MakefileColorEcho(cmsysTerminal_Color_ForegroundMagenta |
-                                       cmsysTerminal_Color_ForegroundBold,
-                                     message.c_str(), true, color);
+    // The dependencies must be regenerated.  There is nothing to scan
+    // if the compiler writes the dependencies of all sources.
+    const char* langs =
+      this->Makefile->GetDefinition("CMAKE_DEPENDS_LANGUAGES");
+    if ((langs && *langs) ||
+        !this->Makefile->GetDefinition("CMAKE_DEPENDS_DEPENDENCY_FILES")) {
+      std::string targetName = cmSystemTools::GetFilenameName(targetDir);
+      targetName = targetName.substr(0, targetName.length() - 4);
+      std::string message =
+        cmStrCat("Scanning dependencies of target ", targetName);
+      cmSystemTools::MakefileColorEcho(
+        cmsysTerminal_Color_ForegroundMagenta |
+          cmsysTerminal_Color_ForegroundBold,
+        message.c_str(), true, color);
+    }
 
     return this->ScanDependencies(targetDir, dependFile, internalDependFile,
                                   validDependencies);
@@ -1402,42 +1527,7 @@ bool cmLocalUnixMakefileGenerator3::ScanDependencies(
   std::string const& targetDir, std::string const& dependFile,
   std::string const& internalDependFile, cmDepends::DependencyMap& validDeps)
 {
-  // Read the directory information file.
-  cmMakefile* mf = this->Makefile;
-  bool haveDirectoryInfo = false;
-  {
-    std::string dirInfoFile =
-      cmStrCat(this->GetCurrentBinaryDirectory(),
-               "/CMakeFiles/CMakeDirectoryInformation.cmake");
-    if (mf->ReadListFile(dirInfoFile) &&
-        !cmSystemTools::GetErrorOccuredFlag()) {
-      haveDirectoryInfo = true;
-    }
-  }
-
-  // Lookup useful directory information.
-  if (haveDirectoryInfo) {
-    // Test whether we need to force Unix paths.
-    if (const char* force = mf->GetDefinition("CMAKE_FORCE_UNIX_PATHS")) {
-      if (!cmIsOff(force)) {
-        cmSystemTools::SetForceUnixPaths(true);
-      }
-    }
-
-    // Setup relative path top directories.
-    if (const char* relativePathTopSource =
-          mf->GetDefinition("CMAKE_RELATIVE_PATH_TOP_SOURCE")) {
-      this->StateSnapshot.GetDirectory().SetRelativePathTopSource(
-        relativePathTopSource);
-    }
-    if (const char* relativePathTopBinary =
-          mf->GetDefinition("CMAKE_RELATIVE_PATH_TOP_BINARY")) {
-      this->StateSnapshot.GetDirectory().SetRelativePathTopBinary(
-        relativePathTopBinary);
-    }
-  } else {
-    cmSystemTools::Error("Directory Information file not found");
-  }
+  this->ReadDirectoryInformation();
 
   // Open the make depends file.  This should be copy-if-different
   // because the make tool may try to reload it needlessly otherwise.
@@ -1461,6 +1551,7 @@ bool cmLocalUnixMakefileGenerator3::ScanDependencies(
   this->WriteDisclaimer(internalRuleFileStream);
 
   // for each language we need to scan, scan it
+  cmMakefile* mf = this->Makefile;
   std::vector<std::string> langs =
     cmExpandedList(mf->GetSafeDefinition("CMAKE_DEPENDS_LANGUAGES"));
   for (std::string const& lang : langs) {
@@ -1495,6 +1586,51 @@ bool cmLocalUnixMakefileGenerator3::ScanDependencies(
   return true;
 }
 
+void cmLocalUnixMakefileGenerator3::ReadDirectoryInformation()
+{
+  if (this->DirectoryInformationRead) {
+    return;
+  }
+  this->DirectoryInformationRead = true;
+
+  // Read the directory information file.
+  cmMakefile* mf = this->Makefile;
+  bool haveDirectoryInfo = false;
+  {
+    std::string dirInfoFile =
+      cmStrCat(this->GetCurrentBinaryDirectory(),
+               "/CMakeFiles/CMakeDirectoryInformation.cmake");
+    if (mf->ReadListFile(dirInfoFile) &&
+        !cmSystemTools::GetErrorOccuredFlag()) {
+      haveDirectoryInfo = true;
+    }
+  }
+
+  // Lookup useful directory information.
+  if (haveDirectoryInfo) {
+    // Test whether we need to force Unix paths.
+    if (const char* force = mf->GetDefinition("CMAKE_FORCE_UNIX_PATHS")) {
+      if (!cmIsOff(force)) {
+        cmSystemTools::SetForceUnixPaths(true);
+      }
+    }
+
+    // Setup relative path top directories.
+    if (const char* relativePathTopSource =
+          mf->GetDefinition("CMAKE_RELATIVE_PATH_TOP_SOURCE")) {
+      this->StateSnapshot.GetDirectory().SetRelativePathTopSource(
+        relativePathTopSource);
+    }
+    if (const char* relativePathTopBinary =
+          mf->GetDefinition("CMAKE_RELATIVE_PATH_TOP_BINARY")) {
+      this->StateSnapshot.GetDirectory().SetRelativePathTopBinary(
+        relativePathTopBinary);
+    }
+  } else {
+    cmSystemTools::Error("Directory Information file not found");
+  }
+}
+
 void cmLocalUnixMakefileGenerator3::CheckMultipleOutputs(bool verbose)
 {
   cmMakefile* mf = this->Makefile;
@@ -1748,6 +1884,13 @@ void cmLocalUnixMakefileGenerator3::ClearDependencies(cmMakefile* mf,
     // regeneration.
     std::string internalDependFile = dir + "/depend.internal";
     cmSystemTools::RemoveFile(internalDependFile);
+
+#ifndef CMAKE_BOOTSTRAP
+    // Clear the dependencies merged from compiler depfiles.
+    cmDependsCompiler compilerClearer(this, dir);
+    compilerClearer.SetVerbose(verbose);
+    compilerClearer.Clear();
+#endif
   }
 }
 
@@ -1815,6 +1958,21 @@ void cmLocalUnixMakefileGenerator3::WriteDependLanguageInfo(
   }
   cmakefileStream << "  )\n";
 
+  // list the depfiles written by the compiler
+  CompilerDependFileMap const& compilerDepends =
+    this->GetCompilerDepends(target);
+  if (!compilerDepends.empty()) {
+    cmakefileStream
+      << "# The object files and depfiles for dependencies written by "
+         "the compiler:\n";
+    cmakefileStream << "set(CMAKE_DEPENDS_DEPENDENCY_FILES\n";
+    for (auto const& compilerDepend : compilerDepends) {
+      cmakefileStream << "  \"" << compilerDepend.first << "\" \""
+                      << compilerDepend.second << "\"\n";
+    }
+    cmakefileStream << "  )\n";
+  }
+
   // now list the files for each language
   cmakefileStream
     << "# The set of files for implicit dependencies of each language:\n";
@@ -2078,6 +2236,19 @@ void cmLocalUnixMakefileGenerator3::AddImplicitDepends(
   this->ImplicitDepends[tgt->GetName()][lang][obj].push_back(src);
 }
 
+cmLocalUnixMakefileGenerator3::CompilerDependFileMap const&
+cmLocalUnixMakefileGenerator3::GetCompilerDepends(const cmGeneratorTarget* tgt)
+{
+  return this->CompilerDepends[tgt->GetName()];
+}
+
+void cmLocalUnixMakefileGenerator3::AddCompilerDepends(
+  const cmGeneratorTarget* tgt, const std::string& obj,
+  const std::string& depfile)
+{
+  this->CompilerDepends[tgt->GetName()][obj] = depfile;
+}
+
 void cmLocalUnixMakefileGenerator3::CreateCDCommand(
   std::vector<std::string>& commands, std::string const& tgtDir,
   std::string const& relDir)
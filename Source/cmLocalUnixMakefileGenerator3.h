@@ -53,6 +53,11 @@ public:
                      const std::vector<std::string>& commands, bool symbolic,
                      bool in_help = false);
 
+  // Write rules that build the targets after order-only prerequisites
+  void WriteOrderOnlyRule(std::ostream& os, const char* comment,
+                          std::vector<std::string> const& targets,
+                          std::vector<std::string> const& orders);
+
   // write the main variables used by the makefiles
   void WriteMakeVariables(std::ostream& makefileStream);
 
@@ -164,6 +169,15 @@ public:
                           const std::string& lang, const std::string& obj,
                           const std::string& src);
 
+  // Object files whose dependencies are written by the compiler.  The
+  // key of the map is the object and the value is its depfile.
+  using CompilerDependFileMap = std::map<std::string, std::string>;
+  CompilerDependFileMap const& GetCompilerDepends(
+    cmGeneratorTarget const* tgt);
+
+  void AddCompilerDepends(cmGeneratorTarget const* tgt, const std::string& obj,
+                          const std::string& depfile);
+
   // write the target rules for the local Makefile into the stream
   void WriteLocalAllRules(std::ostream& ruleFileStream);
 
@@ -225,7 +239,8 @@ protected:
                            cmGeneratorTarget* target,
                            std::string const& relative,
                            bool echo_comment = false,
-                           std::ostream* content = nullptr);
+                           std::ostream* content = nullptr,
+                           std::string const& batchTool = std::string());
   void AppendCleanCommand(std::vector<std::string>& commands,
                           const std::set<std::string>& files,
                           cmGeneratorTarget* target,
@@ -237,6 +252,7 @@ protected:
                         std::string const& dependFile,
                         std::string const& internalDependFile,
                         cmDepends::DependencyMap& validDeps);
+  void ReadDirectoryInformation();
   void CheckMultipleOutputs(bool verbose);
 
 private:
@@ -249,6 +265,8 @@ private:
   friend class cmGlobalUnixMakefileGenerator3;
 
   ImplicitDependTargetMap ImplicitDepends;
+  std::map<std::string, CompilerDependFileMap> CompilerDepends;
+  bool DirectoryInformationRead = false;
 
   std::string HomeRelativeOutputPath;
 
@@ -183,6 +183,7 @@ std::string cmLocalVisualStudioGenerator::ConstructScript(
   }
 
   // Write each command on a single line.
+  this->GlobalGenerator->WriteBatchFiles(ccg);
   for (unsigned int c = 0; c < ccg.GetNumberOfCommands(); ++c) {
     // Add this command line.
     std::string cmd = ccg.GetCommand(c);
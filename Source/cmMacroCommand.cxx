@@ -2,7 +2,11 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmMacroCommand.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdio>
+#include <memory>
+#include <string>
 #include <utility>
 
 #include <cm/memory>
@@ -23,6 +27,161 @@
 
 namespace {
 
+// A macro body compiled once when the macro is defined.  Each argument
+// records where it references the macro parameters, so that a call
+// substitutes them without searching the argument text.
+struct cmMacroBody
+{
+  enum class ParameterType
+  {
+    Formal,
+    Argc,
+    Argn,
+    Argv,
+    ArgvIndex
+  };
+
+  // A "${name}" reference to a parameter in an argument value.
+  struct Reference
+  {
+    std::string::size_type Begin;
+    std::string::size_type End;
+    ParameterType Type;
+    unsigned int Index;
+  };
+
+  struct Argument
+  {
+    std::vector<Reference> References;
+    // Whether substituted values could form new references, as in
+    // "${${name}}".  Such arguments are substituted textually.
+    bool Textual = false;
+  };
+
+  struct Statement
+  {
+    cmListFileFunction Function;
+    // Empty if no argument references a parameter.
+    std::vector<Argument> Arguments;
+    mutable cmMakefile::ResolvedCommand Command;
+  };
+
+  void Compile(std::vector<cmListFileFunction> functions);
+  bool CompileArgument(std::string const& value, Argument& argument) const;
+  bool FindParameter(std::string const& name, Reference& reference) const;
+
+  std::vector<std::string> Args;
+  // The "${name}" of each formal parameter.
+  std::vector<std::string> Variables;
+  std::vector<Statement> Statements;
+  cmPolicies::PolicyMap Policies;
+  std::string FilePath;
+};
+
+void cmMacroBody::Compile(std::vector<cmListFileFunction> functions)
+{
+  this->Variables.reserve(this->Args.size() - 1);
+  for (unsigned int j = 1; j < this->Args.size(); ++j) {
+    this->Variables.push_back("${" + this->Args[j] + "}");
+  }
+
+  // Names that could be part of a reference themselves are left to the
+  // textual substitution.
+  bool const textual = std::any_of(
+    this->Args.begin() + 1, this->Args.end(), [](std::string const& arg) {
+      return arg.find_first_of("${}") != std::string::npos;
+    });
+
+  this->Statements.reserve(functions.size());
+  for (cmListFileFunction& function : functions) {
+    Statement statement;
+    std::vector<Argument> arguments(function.Arguments.size());
+    bool referenced = false;
+    for (std::size_t i = 0; i < arguments.size(); ++i) {
+      cmListFileArgument const& arg = function.Arguments[i];
+      if (arg.Delim == cmListFileArgument::Bracket ||
+          arg.Value.find("${") == std::string::npos) {
+        continue;
+      }
+      if (textual || !this->CompileArgument(arg.Value, arguments[i])) {
+        arguments[i].References.clear();
+        arguments[i].Textual = true;
+      }
+      referenced = referenced || arguments[i].Textual ||
+        !arguments[i].References.empty();
+    }
+    statement.Function = std::move(function);
+    if (referenced) {
+      statement.Arguments = std::move(arguments);
+    }
+    this->Statements.push_back(std::move(statement));
+  }
+}
+
+bool cmMacroBody::CompileArgument(std::string const& value,
+                                  Argument& argument) const
+{
+  std::string::size_type pos = value.find("${");
+  while (pos != std::string::npos) {
+    std::string::size_type const close = value.find('}', pos + 2);
+    if (close == std::string::npos) {
+      break;
+    }
+    std::string const name = value.substr(pos + 2, close - pos - 2);
+    if (name.find("${") != std::string::npos) {
+      return false;
+    }
+    Reference reference;
+    if (this->FindParameter(name, reference)) {
+      reference.Begin = pos;
+      reference.End = close + 1;
+      argument.References.push_back(reference);
+      pos = value.find("${", close + 1);
+    } else {
+      pos = value.find("${", pos + 2);
+    }
+  }
+  return true;
+}
+
+bool cmMacroBody::FindParameter(std::string const& name,
+                                Reference& reference) const
+{
+  // The textual substitution replaces formal parameters first.
+  for (unsigned int j = 1; j < this->Args.size(); ++j) {
+    if (name == this->Args[j]) {
+      reference.Type = ParameterType::Formal;
+      reference.Index = j - 1;
+      return true;
+    }
+  }
+  if (name == "ARGC") {
+    reference.Type = ParameterType::Argc;
+    return true;
+  }
+  if (name == "ARGN") {
+    reference.Type = ParameterType::Argn;
+    return true;
+  }
+  if (name == "ARGV") {
+    reference.Type = ParameterType::Argv;
+    return true;
+  }
+  // Only the names printed by "ARGV%u" are replaced.
+  if (!cmHasLiteralPrefix(name, "ARGV")) {
+    return false;
+  }
+  std::string const index = name.substr(4);
+  if (index.empty() || index.size() > 9 ||
+      (index.size() > 1 && index[0] == '0') ||
+      index.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  reference.Type = ParameterType::ArgvIndex;
+  reference.Index = static_cast<unsigned int>(std::stoul(index));
+  return true;
+}
+
 // define the class for macro commands
 class cmMacroHelperCommand
 {
@@ -34,10 +193,8 @@ public:
   bool operator()(std::vector<cmListFileArgument> const& args,
                   cmExecutionStatus& inStatus) const;
 
-  std::vector<std::string> Args;
-  std::vector<cmListFileFunction> Functions;
-  cmPolicies::PolicyMap Policies;
-  std::string FilePath;
+  // Shared by all copies of the command so that looking it up is cheap.
+  std::shared_ptr<cmMacroBody const> Body;
 };
 
 bool cmMacroHelperCommand::operator()(
@@ -45,6 +202,7 @@ bool cmMacroHelperCommand::operator()(
   cmExecutionStatus& inStatus) const
 {
   cmMakefile& makefile = inStatus.GetMakefile();
+  cmMacroBody const& body = *this->Body;
 
   // Expand the argument list to the macro.
   std::vector<std::string> expandedArgs;
@@ -52,75 +210,122 @@ bool cmMacroHelperCommand::operator()(
 
   // make sure the number of arguments passed is at least the number
   // required by the signature
-  if (expandedArgs.size() < this->Args.size() - 1) {
+  if (expandedArgs.size() < body.Args.size() - 1) {
     std::string errorMsg =
       cmStrCat("Macro invoked with incorrect arguments for macro named: ",
-               this->Args[0]);
+               body.Args[0]);
     inStatus.SetError(errorMsg);
     return false;
   }
 
-  cmMakefile::MacroPushPop macroScope(&makefile, this->FilePath,
-                                      this->Policies);
+  cmMakefile::MacroPushPop macroScope(&makefile, body.FilePath,
+                                      body.Policies);
 
   // set the value of argc
   std::string argcDef = std::to_string(expandedArgs.size());
 
-  auto eit = expandedArgs.begin() + (this->Args.size() - 1);
+  auto eit = expandedArgs.begin() + (body.Args.size() - 1);
   std::string expandedArgn = cmJoin(cmMakeRange(eit, expandedArgs.end()), ";");
   std::string expandedArgv = cmJoin(expandedArgs, ";");
-  std::vector<std::string> variables;
-  variables.reserve(this->Args.size() - 1);
-  for (unsigned int j = 1; j < this->Args.size(); ++j) {
-    variables.push_back("${" + this->Args[j] + "}");
-  }
+
+  // Values that could form new references with the text around them
+  // need the textual substitution, which replaces those too.
+  bool const textual = std::any_of(
+    expandedArgs.begin(), expandedArgs.end(), [](std::string const& arg) {
+      return arg.find_first_of("${}") != std::string::npos;
+    });
   std::vector<std::string> argVs;
-  argVs.reserve(expandedArgs.size());
-  char argvName[60];
-  for (unsigned int j = 0; j < expandedArgs.size(); ++j) {
-    sprintf(argvName, "${ARGV%u}", j);
-    argVs.emplace_back(argvName);
-  }
+
   // Invoke all the functions that were collected in the block.
   cmListFileFunction newLFF;
   // for each function
-  for (cmListFileFunction const& func : this->Functions) {
-    // Replace the formal arguments and then invoke the command.
-    newLFF.Arguments.clear();
-    newLFF.Arguments.reserve(func.Arguments.size());
-    newLFF.Name = func.Name;
-    newLFF.Line = func.Line;
-
-    // for each argument of the current function
-    for (cmListFileArgument const& k : func.Arguments) {
-      cmListFileArgument arg;
-      arg.Value = k.Value;
-      if (k.Delim != cmListFileArgument::Bracket) {
-        // replace formal arguments
-        for (unsigned int j = 0; j < variables.size(); ++j) {
-          cmSystemTools::ReplaceString(arg.Value, variables[j],
-                                       expandedArgs[j]);
+  for (cmMacroBody::Statement const& statement : body.Statements) {
+    cmListFileFunction const* lff = &statement.Function;
+    if (!statement.Arguments.empty()) {
+      cmListFileFunction const& func = statement.Function;
+      // Replace the formal arguments and then invoke the command.
+      newLFF.Arguments.clear();
+      newLFF.Arguments.reserve(func.Arguments.size());
+      newLFF.Name = func.Name;
+      newLFF.Line = func.Line;
+
+      // for each argument of the current function
+      for (std::size_t i = 0; i < func.Arguments.size(); ++i) {
+        cmListFileArgument const& k = func.Arguments[i];
+        cmMacroBody::Argument const& compiled = statement.Arguments[i];
+        if (!compiled.Textual && compiled.References.empty()) {
+          // The argument is used as written.
+          newLFF.Arguments.push_back(k);
+          continue;
         }
-        // replace argc
-        cmSystemTools::ReplaceString(arg.Value, "${ARGC}", argcDef);
+        cmListFileArgument arg;
+        if (compiled.Textual || textual) {
+          arg.Value = k.Value;
+          // replace formal arguments
+          for (unsigned int j = 0; j < body.Variables.size(); ++j) {
+            cmSystemTools::ReplaceString(arg.Value, body.Variables[j],
+                                         expandedArgs[j]);
+          }
+          // replace argc
+          cmSystemTools::ReplaceString(arg.Value, "${ARGC}", argcDef);
 
-        cmSystemTools::ReplaceString(arg.Value, "${ARGN}", expandedArgn);
-        cmSystemTools::ReplaceString(arg.Value, "${ARGV}", expandedArgv);
+          cmSystemTools::ReplaceString(arg.Value, "${ARGN}", expandedArgn);
+          cmSystemTools::ReplaceString(arg.Value, "${ARGV}", expandedArgv);
 
-        // if the current argument of the current function has ${ARGV in it
-        // then try replacing ARGV values
-        if (arg.Value.find("${ARGV") != std::string::npos) {
-          for (unsigned int t = 0; t < expandedArgs.size(); ++t) {
-            cmSystemTools::ReplaceString(arg.Value, argVs[t], expandedArgs[t]);
+          // if the current argument of the current function has ${ARGV in
+          // it then try replacing ARGV values
+          if (arg.Value.find("${ARGV") != std::string::npos) {
+            if (argVs.empty()) {
+              argVs.reserve(expandedArgs.size());
+              char argvName[60];
+              for (unsigned int j = 0; j < expandedArgs.size(); ++j) {
+                sprintf(argvName, "${ARGV%u}", j);
+                argVs.emplace_back(argvName);
+              }
+            }
+            for (unsigned int t = 0; t < expandedArgs.size(); ++t) {
+              cmSystemTools::ReplaceString(arg.Value, argVs[t],
+                                           expandedArgs[t]);
+            }
+          }
+        } else {
+          std::string::size_type last = 0;
+          for (cmMacroBody::Reference const& ref : compiled.References) {
+            arg.Value.append(k.Value, last, ref.Begin - last);
+            switch (ref.Type) {
+              case cmMacroBody::ParameterType::Formal:
+                arg.Value += expandedArgs[ref.Index];
+                break;
+              case cmMacroBody::ParameterType::Argc:
+                arg.Value += argcDef;
+                break;
+              case cmMacroBody::ParameterType::Argn:
+                arg.Value += expandedArgn;
+                break;
+              case cmMacroBody::ParameterType::Argv:
+                arg.Value += expandedArgv;
+                break;
+              case cmMacroBody::ParameterType::ArgvIndex:
+                if (ref.Index < expandedArgs.size()) {
+                  arg.Value += expandedArgs[ref.Index];
+                } else {
+                  arg.Value.append(k.Value, ref.Begin, ref.End - ref.Begin);
+                }
+                break;
+            }
+            last = ref.End;
           }
+          arg.Value.append(k.Value, last, std::string::npos);
         }
+        arg.Delim = k.Delim;
+        arg.Line = k.Line;
+        newLFF.Arguments.push_back(std::move(arg));
       }
-      arg.Delim = k.Delim;
-      arg.Line = k.Line;
-      newLFF.Arguments.push_back(std::move(arg));
+      lff = &newLFF;
     }
     cmExecutionStatus status(makefile);
-    if (!makefile.ExecuteCommand(newLFF, status) || status.GetNestedError()) {
+    if (!makefile.ExecuteCommand(*lff, status, &statement.Command) ||
+        status.GetNestedError()) {
       // The error message should have already included the call stack
       // so we do not need to report an error here.
       macroScope.Quiet();
@@ -169,11 +374,13 @@ bool cmMacroFunctionBlocker::Replay(std::vector<cmListFileFunction> functions,
   cmMakefile& mf = status.GetMakefile();
   mf.AppendProperty("MACROS", this->Args[0]);
   // create a new command and add it to cmake
+  auto body = std::make_shared<cmMacroBody>();
+  body->Args = this->Args;
+  body->Compile(std::move(functions));
+  body->FilePath = this->GetStartingContext().FilePath;
+  mf.RecordPolicies(body->Policies);
   cmMacroHelperCommand f;
-  f.Args = this->Args;
-  f.Functions = std::move(functions);
-  f.FilePath = this->GetStartingContext().FilePath;
-  mf.RecordPolicies(f.Policies);
+  f.Body = std::move(body);
   mf.GetState()->AddScriptedCommand(this->Args[0], std::move(f));
   return true;
 }
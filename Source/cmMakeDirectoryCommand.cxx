@@ -3,6 +3,7 @@
 #include "cmMakeDirectoryCommand.h"
 
 #include "cmExecutionStatus.h"
+#include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
 #include "cmSystemTools.h"
 
@@ -22,5 +23,7 @@ bool cmMakeDirectoryCommand(std::vector<std::string> const& args,
     return false;
   }
   cmSystemTools::MakeDirectory(args[0]);
+  status.GetMakefile().GetGlobalGenerator()->InvalidateFindDirectoryContent(
+    args[0]);
   return true;
 }
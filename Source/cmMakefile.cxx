@@ -41,6 +41,7 @@
 #include "cmGlobalGenerator.h"
 #include "cmInstallGenerator.h" // IWYU pragma: keep
 #include "cmInstallSubdirectoryGenerator.h"
+#include "cmListFileArgumentTemplate.h"
 #include "cmListFileCache.h"
 #include "cmLocalGenerator.h"
 #include "cmMessageType.h"
@@ -61,6 +62,8 @@
 #include "cmake.h"
 
 #ifndef CMAKE_BOOTSTRAP
+#  include "cmGenerateFingerprint.h"
+#  include "cmListFilePrefetcher.h"
 #  include "cmMakefileProfilingData.h"
 #  include "cmVariableWatch.h"
 #endif
@@ -416,7 +419,8 @@ void cmMakefile::OnExecuteCommand(std::function<void()> callback)
 }
 
 bool cmMakefile::ExecuteCommand(const cmListFileFunction& lff,
-                                cmExecutionStatus& status)
+                                cmExecutionStatus& status,
+                                ResolvedCommand* resolved)
 {
   bool result = true;
 
@@ -426,6 +430,8 @@ bool cmMakefile::ExecuteCommand(const cmListFileFunction& lff,
     return result;
   }
 
+  this->AppendToGenerateFingerprint(lff.Name.Lower);
+
   if (this->ExecuteCommandCallback) {
     this->ExecuteCommandCallback();
   }
@@ -453,8 +459,23 @@ bool cmMakefile::ExecuteCommand(const cmListFileFunction& lff,
   }
 
   // Lookup the command prototype.
-  if (cmState::Command command =
-        this->GetState()->GetCommandByExactName(lff.Name.Lower)) {
+  cmState::Command command;
+  if (resolved) {
+    unsigned long const generation =
+      this->GetState()->GetCommandsGeneration();
+    if (resolved->Generation != generation) {
+      resolved->Command =
+        this->GetState()->FindCommandByExactName(lff.Name.Lower);
+      resolved->Generation = generation;
+    }
+    // Copy the command since executing it may change the resolution.
+    if (resolved->Command) {
+      command = *resolved->Command;
+    }
+  } else {
+    command = this->GetState()->GetCommandByExactName(lff.Name.Lower);
+  }
+  if (command) {
     // Decide whether to invoke the command.
     if (!cmSystemTools::GetFatalErrorOccured()) {
       // if trace is enabled, print out invoke information
@@ -619,6 +640,30 @@ void cmMakefile::IncludeScope::EnforceCMP0011()
   }
 }
 
+bool cmMakefile::ParseListFile(cmListFile& listFile,
+                               std::string const& filename)
+{
+  cmListFileParseCache* cache = nullptr;
+#ifndef CMAKE_BOOTSTRAP
+  cache = this->GetCMakeInstance()->GetListFileParseCache();
+  cmListFilePrefetcher* prefetcher =
+    this->GetCMakeInstance()->GetListFilePrefetcher();
+  if (prefetcher && prefetcher->Take(filename, listFile)) {
+    return true;
+  }
+#endif
+  if (!listFile.ParseFile(filename.c_str(), this->GetMessenger(),
+                          this->Backtrace, cache)) {
+    return false;
+  }
+#ifndef CMAKE_BOOTSTRAP
+  if (prefetcher) {
+    prefetcher->Scan(listFile.Functions, this->GetCurrentSourceDirectory());
+  }
+#endif
+  return true;
+}
+
 bool cmMakefile::ReadDependentFile(const std::string& filename,
                                    bool noPolicyScope)
 {
@@ -631,8 +676,7 @@ bool cmMakefile::ReadDependentFile(const std::string& filename,
   IncludeScope incScope(this, filenametoread, noPolicyScope);
 
   cmListFile listFile;
-  if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!this->ParseListFile(listFile, filenametoread)) {
     return false;
   }
 
@@ -685,8 +729,7 @@ bool cmMakefile::ReadListFile(const std::string& filename)
   ListFileScope scope(this, filenametoread);
 
   cmListFile listFile;
-  if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!this->ParseListFile(listFile, filenametoread)) {
     return false;
   }
 
@@ -1604,8 +1647,7 @@ void cmMakefile::Configure()
   this->AddDefinition("CMAKE_PARENT_LIST_FILE", currentStart);
 
   cmListFile listFile;
-  if (!listFile.ParseFile(currentStart.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!this->ParseListFile(listFile, currentStart)) {
     return;
   }
   if (this->IsRootMakefile()) {
@@ -3376,6 +3418,85 @@ std::string cmMakefile::GetExecutionFilePath() const
   return this->StateSnapshot.GetExecutionListFile();
 }
 
+void cmMakefile::AppendToGenerateFingerprint(std::string const& value) const
+{
+#if !defined(CMAKE_BOOTSTRAP)
+  if (cmGenerateFingerprint* fingerprint =
+        this->GetCMakeInstance()->GetGenerateFingerprint()) {
+    fingerprint->Append(value);
+  }
+#else
+  static_cast<void>(value);
+#endif
+}
+
+void cmMakefile::MarkGenerateFingerprintIncomplete() const
+{
+#if !defined(CMAKE_BOOTSTRAP)
+  if (cmGenerateFingerprint* fingerprint =
+        this->GetCMakeInstance()->GetGenerateFingerprint()) {
+    fingerprint->MarkIncomplete();
+  }
+#endif
+}
+
+void cmMakefile::ExpandArgumentValue(cmListFileArgument const& arg,
+                                     std::string& value, const char* filename,
+                                     bool newRules) const
+{
+  if (newRules && !arg.Template) {
+    arg.Template = std::make_shared<cmListFileArgumentTemplate>(arg.Value);
+  }
+  if (!newRules || !arg.Template->IsUsable()) {
+    value = arg.Value;
+    this->ExpandVariablesInString(value, false, false, false, filename,
+                                  arg.Line, false, false);
+    return;
+  }
+
+  auto const& segments = arg.Template->GetSegments();
+  if (arg.Template->IsLiteral()) {
+    if (segments.empty()) {
+      value.clear();
+    } else {
+      value = segments.front().Text;
+    }
+    return;
+  }
+
+  // This matches ExpandVariablesInStringNew for the references that a
+  // template can hold.
+  value.clear();
+  std::string svalue;
+  for (cmListFileArgumentTemplate::Segment const& segment : segments) {
+    const char* def = nullptr;
+    switch (segment.Type) {
+      case cmListFileArgumentTemplate::SegmentType::Literal:
+        value += segment.Text;
+        continue;
+      case cmListFileArgumentTemplate::SegmentType::Variable:
+        def = this->GetDefinition(segment.Text);
+        break;
+      case cmListFileArgumentTemplate::SegmentType::Environment:
+        if (cmSystemTools::GetEnv(segment.Text, svalue)) {
+          def = svalue.c_str();
+        }
+        break;
+      case cmListFileArgumentTemplate::SegmentType::Cache:
+        if (cmProp cached =
+              this->GetState()->GetCacheEntryValue(segment.Text)) {
+          def = cached->c_str();
+        }
+        break;
+    }
+    if (def) {
+      value += def;
+    } else {
+      this->MaybeWarnUninitialized(segment.Text, filename);
+    }
+  }
+}
+
 bool cmMakefile::ExpandArguments(std::vector<cmListFileArgument> const& inArgs,
                                  std::vector<std::string>& outArgs,
                                  const char* filename) const
@@ -3384,18 +3505,22 @@ bool cmMakefile::ExpandArguments(std::vector<cmListFileArgument> const& inArgs,
   if (!filename) {
     filename = efp.c_str();
   }
+  cmPolicies::PolicyStatus const cmp0053 =
+    this->GetPolicyStatus(cmPolicies::CMP0053);
+  bool const newRules =
+    cmp0053 != cmPolicies::OLD && cmp0053 != cmPolicies::WARN;
   std::string value;
   outArgs.reserve(inArgs.size());
   for (cmListFileArgument const& i : inArgs) {
     // No expansion in a bracket argument.
     if (i.Delim == cmListFileArgument::Bracket) {
       outArgs.push_back(i.Value);
+      this->AppendToGenerateFingerprint(i.Value);
       continue;
     }
     // Expand the variables in the argument.
-    value = i.Value;
-    this->ExpandVariablesInString(value, false, false, false, filename, i.Line,
-                                  false, false);
+    this->ExpandArgumentValue(i, value, filename, newRules);
+    this->AppendToGenerateFingerprint(value);
 
     // If the argument is quoted, it should be one argument.
     // Otherwise, it may be a list of arguments.
@@ -3416,18 +3541,22 @@ bool cmMakefile::ExpandArguments(
   if (!filename) {
     filename = efp.c_str();
   }
+  cmPolicies::PolicyStatus const cmp0053 =
+    this->GetPolicyStatus(cmPolicies::CMP0053);
+  bool const newRules =
+    cmp0053 != cmPolicies::OLD && cmp0053 != cmPolicies::WARN;
   std::string value;
   outArgs.reserve(inArgs.size());
   for (cmListFileArgument const& i : inArgs) {
     // No expansion in a bracket argument.
     if (i.Delim == cmListFileArgument::Bracket) {
       outArgs.emplace_back(i.Value, true);
+      this->AppendToGenerateFingerprint(i.Value);
       continue;
     }
     // Expand the variables in the argument.
-    value = i.Value;
-    this->ExpandVariablesInString(value, false, false, false, filename, i.Line,
-                                  false, false);
+    this->ExpandArgumentValue(i, value, filename, newRules);
+    this->AppendToGenerateFingerprint(value);
 
     // If the argument is quoted, it should be one argument.
     // Otherwise, it may be a list of arguments.
@@ -4004,6 +4133,7 @@ int cmMakefile::ConfigureFile(const std::string& infile,
   // when we finalize the configuration we will remove all
   // output files that now don't exist.
   this->AddCMakeOutputFile(soutfile);
+  this->GetGlobalGenerator()->InvalidateFindDirectoryContent(soutfile);
 
   mode_t perm = 0;
   cmSystemTools::GetPermissions(sinfile, perm);
@@ -689,12 +689,27 @@ public:
    */
   void OnExecuteCommand(std::function<void()> callback);
 
+  /**
+   * The command a list file function resolved to.  Bodies that execute
+   * the same functions many times keep one per function so that the
+   * command is looked up again only when the set of commands changed.
+   * It points to the command owned by the cmState instead of holding a
+   * copy, so that a function calling itself does not own its own body.
+   */
+  struct ResolvedCommand
+  {
+    std::function<bool(std::vector<cmListFileArgument> const&,
+                       cmExecutionStatus&)> const* Command = nullptr;
+    unsigned long Generation = 0;
+  };
+
   /**
    * Execute a single CMake command.  Returns true if the command
    * succeeded or false if it failed.
    */
   bool ExecuteCommand(const cmListFileFunction& lff,
-                      cmExecutionStatus& status);
+                      cmExecutionStatus& status,
+                      ResolvedCommand* resolved = nullptr);
 
   //! Enable support for named language, if nil then all languages are
   /// enabled.
@@ -726,6 +741,18 @@ public:
                        std::vector<cmExpandedCommandArgument>& outArgs,
                        const char* filename = nullptr) const;
 
+  /**
+   * Add a value read by the configure step to the fingerprint used to
+   * decide whether the generate step may be skipped.
+   */
+  void AppendToGenerateFingerprint(std::string const& value) const;
+
+  /**
+   * Note that the configure step read a value from outside the list files,
+   * so that the generate step is not skipped.
+   */
+  void MarkGenerateFingerprintIncomplete() const;
+
   /**
    * Get the instance
    */
@@ -1041,6 +1068,8 @@ private:
   void ReadListFile(cmListFile const& listFile,
                     const std::string& filenametoread);
 
+  bool ParseListFile(cmListFile& listFile, std::string const& filename);
+
   bool ParseDefineFlag(std::string const& definition, bool remove);
 
   bool EnforceUniqueDir(const std::string& srcPath,
@@ -1106,6 +1135,10 @@ private:
                                          bool escapeQuotes, bool noEscapes,
                                          bool atOnly, const char* filename,
                                          long line, bool replaceAt) const;
+  // Expand a non-bracket list file argument.  With the CMP0053 NEW rules
+  // this uses the argument's template when it has a usable one.
+  void ExpandArgumentValue(cmListFileArgument const& arg, std::string& value,
+                           const char* filename, bool newRules) const;
 
   bool ValidateCustomCommand(const cmCustomCommandLines& commandLines) const;
 
@@ -2,6 +2,8 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #ifndef cmMakefileProfilingData_h
 #define cmMakefileProfilingData_h
+#include <chrono>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -21,6 +23,12 @@ public:
   ~cmMakefileProfilingData() noexcept;
   void StartEntry(const cmListFileFunction& lff, cmListFileContext const& lfc);
   void StopEntry();
+  void Counter(std::string const& name,
+               std::map<std::string, unsigned long long> const& values);
+  void CompleteEntry(std::string const& name, std::string const& category,
+                     std::chrono::steady_clock::time_point start,
+                     std::chrono::steady_clock::duration duration,
+                     unsigned int threadId);
 
 private:
   cmsys::ofstream ProfileStream;
@@ -50,6 +50,10 @@ cmMakefileTargetGenerator::cmMakefileTargetGenerator(cmGeneratorTarget* target)
         cm->GetState()->GetGlobalProperty("RULE_MESSAGES")) {
     this->NoRuleMessages = cmIsOff(ruleStatus);
   }
+  if (this->GlobalGenerator->UseFlatMakefiles()) {
+    this->VariablePrefix =
+      this->GlobalGenerator->GetTargetVariablePrefix(target);
+  }
   MacOSXContentGenerator = cm::make_unique<MacOSXContentGeneratorType>(this);
 }
 
@@ -211,6 +215,7 @@ void cmMakefileTargetGenerator::WriteTargetBuildRules()
           this->LocalGenerator->MaybeConvertToRelativePath(currentBinDir,
                                                            byproduct));
       }
+      this->AddBatchFilesToCleanFiles(ccg);
     }
   }
 
@@ -233,6 +238,7 @@ void cmMakefileTargetGenerator::WriteTargetBuildRules()
           this->LocalGenerator->MaybeConvertToRelativePath(currentBinDir,
                                                            byproduct));
       }
+      this->AddBatchFilesToCleanFiles(beg);
     }
   }
   std::vector<cmSourceFile const*> headerSources;
@@ -304,6 +310,32 @@ void cmMakefileTargetGenerator::WriteCommonCodeRules()
                   << std::endl;
   }
 
+  if (this->Makefile->IsOn("CMAKE_DEPENDS_USE_COMPILER")) {
+    // Include the dependencies written by the compiler.
+    std::string compilerDependFileNameFull =
+      cmStrCat(this->TargetBuildDirectoryFull, "/compiler_depend.make");
+    *this->BuildFileStream
+      << "# Include any dependencies generated by the compiler for this "
+         "target.\n"
+      << this->GlobalGenerator->IncludeDirective << " " << root
+      << cmSystemTools::ConvertToOutputPath(
+           this->LocalGenerator->MaybeConvertToRelativePath(
+             this->LocalGenerator->GetBinaryDirectory(),
+             compilerDependFileNameFull))
+      << "\n\n";
+
+    // make sure the compiler depend file exists
+    if (!cmSystemTools::FileExists(compilerDependFileNameFull)) {
+      cmGeneratedFileStream depFileStream(
+        compilerDependFileNameFull, false,
+        this->GlobalGenerator->GetMakefileEncoding());
+      depFileStream << "# Empty compiler generated dependencies file for "
+                    << this->GeneratorTarget->GetName() << ".\n"
+                    << "# This may be replaced when dependencies are built."
+                    << std::endl;
+    }
+  }
+
   // Open the flags file.  This should be copy-if-different because the
   // rules may depend on this file itself.
   this->FlagFileNameFull =
@@ -350,9 +382,12 @@ void cmMakefileTargetGenerator::WriteTargetLanguageFlags()
     cmSystemTools::ReplaceString(flags, "#", "\\#");
     cmSystemTools::ReplaceString(defines, "#", "\\#");
     cmSystemTools::ReplaceString(includes, "#", "\\#");
-    *this->FlagFileStream << language << "_FLAGS = " << flags << "\n\n";
-    *this->FlagFileStream << language << "_DEFINES = " << defines << "\n\n";
-    *this->FlagFileStream << language << "_INCLUDES = " << includes << "\n\n";
+    *this->FlagFileStream << this->VariablePrefix << language
+                          << "_FLAGS = " << flags << "\n\n";
+    *this->FlagFileStream << this->VariablePrefix << language
+                          << "_DEFINES = " << defines << "\n\n";
+    *this->FlagFileStream << this->VariablePrefix << language
+                          << "_INCLUDES = " << includes << "\n\n";
   }
 }
 
@@ -401,6 +436,21 @@ void cmMakefileTargetGenerator::MacOSXContentGeneratorType::operator()(
   this->Generator->ExtraFiles.insert(output);
 }
 
+bool cmMakefileTargetGenerator::UseCompilerDepfile(
+  std::string const& lang) const
+{
+  // Fortran dependencies include modules, which only the scanner knows.
+  if (lang == "Fortran" ||
+      !this->Makefile->IsOn("CMAKE_DEPENDS_USE_COMPILER")) {
+    return false;
+  }
+  std::string const& format = this->Makefile->GetSafeDefinition(
+    cmStrCat("CMAKE_", lang, "_DEPFILE_FORMAT"));
+  return format == "gcc" &&
+    !this->Makefile->GetSafeDefinition(cmStrCat("CMAKE_DEPFILE_FLAGS_", lang))
+       .empty();
+}
+
 void cmMakefileTargetGenerator::WriteObjectRuleFiles(
   cmSourceFile const& source)
 {
@@ -450,8 +500,16 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
   objFullPath = cmSystemTools::CollapseFullPath(objFullPath);
   std::string srcFullPath =
     cmSystemTools::CollapseFullPath(source.GetFullPath());
-  this->LocalGenerator->AddImplicitDepends(this->GeneratorTarget, lang,
-                                           objFullPath, srcFullPath);
+  bool const compilerDepfile = this->UseCompilerDepfile(lang);
+  if (compilerDepfile) {
+    // The compiler writes the dependencies next to the object file.
+    this->LocalGenerator->AddCompilerDepends(this->GeneratorTarget,
+                                             objFullPath, objFullPath + ".d");
+    this->CleanFiles.insert(obj + ".d");
+  } else {
+    this->LocalGenerator->AddImplicitDepends(this->GeneratorTarget, lang,
+                                             objFullPath, srcFullPath);
+  }
 
   this->LocalGenerator->AppendRuleDepend(depends,
                                          this->FlagFileNameFull.c_str());
@@ -474,8 +532,10 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
     if (source.GetFullPath() != pchSource) {
       depends.push_back(this->GeneratorTarget->GetPchFile(config, lang));
     }
-    this->LocalGenerator->AddImplicitDepends(this->GeneratorTarget, lang,
-                                             objFullPath, pchHeader);
+    if (!compilerDepfile) {
+      this->LocalGenerator->AddImplicitDepends(this->GeneratorTarget, lang,
+                                               objFullPath, pchHeader);
+    }
   }
 
   std::string relativeObj =
@@ -486,7 +546,8 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
   std::string flags;
 
   // Add language-specific flags.
-  std::string langFlags = cmStrCat("$(", lang, "_FLAGS)");
+  std::string langFlags =
+    cmStrCat("$(", this->VariablePrefix, lang, "_FLAGS)");
   this->LocalGenerator->AppendFlags(flags, langFlags);
 
   cmGeneratorExpressionInterpreter genexInterpreter(
@@ -662,7 +723,8 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
   vars.ObjectFileDir = objectFileDir.c_str();
   vars.Flags = flags.c_str();
 
-  std::string definesString = cmStrCat("$(", lang, "_DEFINES)");
+  std::string definesString =
+    cmStrCat("$(", this->VariablePrefix, lang, "_DEFINES)");
 
   this->LocalGenerator->JoinDefines(defines, definesString, lang);
 
@@ -670,8 +732,8 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
 
   std::string includesString = this->LocalGenerator->GetIncludeFlags(
     includes, this->GeneratorTarget, lang, true, false, config);
-  this->LocalGenerator->AppendFlags(includesString,
-                                    "$(" + lang + "_INCLUDES)");
+  this->LocalGenerator->AppendFlags(
+    includesString, cmStrCat("$(", this->VariablePrefix, lang, "_INCLUDES)"));
   vars.Includes = includesString.c_str();
 
   // At the moment, it is assumed that C, C++, Fortran, and CUDA have both
@@ -720,11 +782,13 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
         this->LocalGenerator->GetCurrentBinaryDirectory());
       compileCommand.replace(compileCommand.find(langFlags), langFlags.size(),
                              this->GetFlags(lang, this->GetConfigName()));
-      std::string langDefines = std::string("$(") + lang + "_DEFINES)";
+      std::string langDefines =
+        cmStrCat("$(", this->VariablePrefix, lang, "_DEFINES)");
       compileCommand.replace(compileCommand.find(langDefines),
                              langDefines.size(),
                              this->GetDefines(lang, this->GetConfigName()));
-      std::string langIncludes = std::string("$(") + lang + "_INCLUDES)";
+      std::string langIncludes =
+        cmStrCat("$(", this->VariablePrefix, lang, "_INCLUDES)");
       compileCommand.replace(compileCommand.find(langIncludes),
                              langIncludes.size(),
                              this->GetIncludes(lang, this->GetConfigName()));
@@ -831,12 +895,30 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
       }
     }
 
+    // Have the compiler write the dependencies of the object.
+    std::string compileFlags = flags;
+    if (compilerDepfile) {
+      std::string depfileFlags = this->Makefile->GetSafeDefinition(
+        cmStrCat("CMAKE_DEPFILE_FLAGS_", lang));
+      cmSystemTools::ReplaceString(
+        depfileFlags, "<DEPFILE>",
+        this->LocalGenerator->ConvertToOutputFormat(
+          obj + ".d", cmOutputConverter::SHELL));
+      cmSystemTools::ReplaceString(depfileFlags, "<OBJECT>", shellObj);
+      cmSystemTools::ReplaceString(depfileFlags, "<CMAKE_C_COMPILER>",
+                                   this->Makefile->GetSafeDefinition(
+                                     "CMAKE_C_COMPILER"));
+      this->LocalGenerator->AppendFlags(compileFlags, depfileFlags);
+    }
+    vars.Flags = compileFlags.c_str();
+
     // Expand placeholders in the commands.
     for (std::string& compileCommand : compileCommands) {
       compileCommand = cmStrCat(launcher, compileCommand);
       rulePlaceholderExpander->ExpandRuleVariables(this->LocalGenerator,
                                                    compileCommand, vars);
     }
+    vars.Flags = flags.c_str();
 
     // Change the command working directory to the local build tree.
     this->LocalGenerator->CreateCDCommand(
@@ -1006,6 +1088,9 @@ bool cmMakefileTargetGenerator::WriteMakeRule(
   // We always attach the actual commands to the first output.
   this->LocalGenerator->WriteMakeRule(os, comment, outputs[0], depends,
                                       commands, symbolic, in_help);
+  if (this->GlobalGenerator->UseFlatMakefiles()) {
+    this->OrderedOutputs.insert(outputs[0]);
+  }
 
   // For single outputs, we are done.
   if (outputs.size() == 1) {
@@ -1049,6 +1134,9 @@ bool cmMakefileTargetGenerator::WriteMakeRule(
 
 void cmMakefileTargetGenerator::WriteTargetDependRules()
 {
+  // All rules of the target have been written.
+  this->WriteTargetOrderRules();
+
   // must write the targets depend info file
   std::string dir =
     this->LocalGenerator->GetTargetDirectory(this->GeneratorTarget);
@@ -1108,6 +1196,15 @@ void cmMakefileTargetGenerator::WriteTargetDependRules()
     << "\")\n";
   /* clang-format on */
 
+  if (this->GlobalGenerator->UseFlatMakefiles()) {
+    /* clang-format off */
+    *this->InfoFileStream
+      << "\n"
+      << "# Dependencies are updated after the target is built.\n"
+      << "set(CMAKE_DEPENDS_AFTER_BUILD 1)\n";
+    /* clang-format on */
+  }
+
   // and now write the rule to use it
   std::vector<std::string> depends;
   std::vector<std::string> commands;
@@ -1173,8 +1270,14 @@ void cmMakefileTargetGenerator::WriteTargetDependRules()
   }
   commands.push_back(depCmd.str());
 
-  // Make sure all custom command outputs in this target are built.
-  if (this->CustomCommandDriver == OnDepends) {
+  if (this->GlobalGenerator->UseFlatMakefiles()) {
+    // Update the dependencies after building the target, for use by
+    // the next build.  The makefiles have already been read.
+    depends.push_back(cmStrCat(
+      this->LocalGenerator->GetRelativeTargetDirectory(this->GeneratorTarget),
+      "/build"));
+  } else if (this->CustomCommandDriver == OnDepends) {
+    // Make sure all custom command outputs in this target are built.
     this->DriveCustomCommands(depends);
   }
 
@@ -1183,6 +1286,42 @@ void cmMakefileTargetGenerator::WriteTargetDependRules()
                                       depTarget, depends, commands, true);
 }
 
+void cmMakefileTargetGenerator::WriteTargetOrderRules()
+{
+  if (!this->GlobalGenerator->UseFlatMakefiles()) {
+    return;
+  }
+
+  // The rules of the target must not run before the dependencies of the
+  // target are built.  The top-level makefile lists them as prerequisites
+  // of this rule.
+  std::string orderTarget = cmStrCat(
+    this->LocalGenerator->GetRelativeTargetDirectory(this->GeneratorTarget),
+    "/order");
+  std::vector<std::string> no_depends;
+  std::vector<std::string> no_commands;
+  this->LocalGenerator->WriteMakeRule(
+    *this->BuildFileStream, "Rule to order this target after its dependencies.",
+    orderTarget, no_depends, no_commands, true);
+
+  std::vector<std::string> outputs(this->OrderedOutputs.begin(),
+                                   this->OrderedOutputs.end());
+  this->LocalGenerator->WriteOrderOnlyRule(
+    *this->BuildFileStream, "Build the rules of this target in order.",
+    outputs, std::vector<std::string>(1, orderTarget));
+
+  // Objects may include headers generated by custom commands of the
+  // target.  The recursive makefiles build those before any object, so
+  // do the same here.  Dependencies found by scanning are only known
+  // after the first build.
+  std::vector<std::string> customOutputs;
+  this->DriveCustomCommands(customOutputs);
+  this->LocalGenerator->WriteOrderOnlyRule(
+    *this->BuildFileStream,
+    "Build the objects of this target after its custom commands.",
+    this->Objects, customOutputs);
+}
+
 void cmMakefileTargetGenerator::DriveCustomCommands(
   std::vector<std::string>& depends)
 {
@@ -1213,8 +1352,17 @@ void cmMakefileTargetGenerator::WriteObjectDependRules(
 void cmMakefileTargetGenerator::GenerateCustomRuleFile(
   cmCustomCommandGenerator const& ccg)
 {
+  // A custom command used by several targets is written by the first
+  // one.  The rules of all targets are read by the same make process.
+  if (this->GlobalGenerator->UseFlatMakefiles() &&
+      !ccg.GetOutputs().empty() &&
+      !this->GlobalGenerator->ClaimFlatRuleOutput(ccg.GetOutputs()[0])) {
+    return;
+  }
+
   // Collect the commands.
   std::vector<std::string> commands;
+  std::string batchEcho;
   std::string comment = this->LocalGenerator->ConstructComment(ccg);
   if (!comment.empty()) {
     // add in a progress call if needed
@@ -1225,6 +1373,13 @@ void cmMakefileTargetGenerator::GenerateCustomRuleFile(
       this->LocalGenerator->AppendEcho(
         commands, comment, cmLocalUnixMakefileGenerator3::EchoGenerate,
         &progress);
+      // A batch of tool commands can also print the comment.
+      static const std::string echoPrefix = "@$(CMAKE_COMMAND) -E ";
+      if (commands.size() == 1 && ccg.GetNumberOfCommands() > 0 &&
+          ccg.IsBatchCommand(0) && cmHasPrefix(commands[0], echoPrefix)) {
+        batchEcho = commands[0].substr(echoPrefix.size());
+        commands.clear();
+      }
     }
   }
 
@@ -1232,7 +1387,7 @@ void cmMakefileTargetGenerator::GenerateCustomRuleFile(
   std::ostringstream content;
   this->LocalGenerator->AppendCustomCommand(
     commands, ccg, this->GeneratorTarget,
-    this->LocalGenerator->GetBinaryDirectory(), false, &content);
+    this->LocalGenerator->GetBinaryDirectory(), false, &content, batchEcho);
 
   // Collect the dependencies.
   std::vector<std::string> depends;
@@ -1257,13 +1412,26 @@ void cmMakefileTargetGenerator::GenerateCustomRuleFile(
   }
 }
 
+void cmMakefileTargetGenerator::AddBatchFilesToCleanFiles(
+  cmCustomCommandGenerator const& ccg)
+{
+  // A missing batch file makes CMake re-run to write it again.
+  std::string const& currentBinDir =
+    this->LocalGenerator->GetCurrentBinaryDirectory();
+  for (auto const& batchFile : ccg.GetBatchFiles()) {
+    this->CleanFiles.insert(this->LocalGenerator->MaybeConvertToRelativePath(
+      currentBinDir, batchFile.first));
+  }
+}
+
 void cmMakefileTargetGenerator::MakeEchoProgress(
   cmLocalUnixMakefileGenerator3::EchoProgress& progress) const
 {
   progress.Dir =
     cmStrCat(this->LocalGenerator->GetBinaryDirectory(), "/CMakeFiles");
   std::ostringstream progressArg;
-  progressArg << "$(CMAKE_PROGRESS_" << this->NumberOfProgressActions << ")";
+  progressArg << "$(" << this->VariablePrefix << "CMAKE_PROGRESS_"
+              << this->NumberOfProgressActions << ")";
   progress.Arg = progressArg.str();
 }
 
@@ -1273,8 +1441,12 @@ void cmMakefileTargetGenerator::WriteObjectsVariable(
 {
   // Write a make variable assignment that lists all objects for the
   // target.
-  variableName = this->LocalGenerator->CreateMakeVariable(
-    this->GeneratorTarget->GetName(), "_OBJECTS");
+  if (this->VariablePrefix.empty()) {
+    variableName = this->LocalGenerator->CreateMakeVariable(
+      this->GeneratorTarget->GetName(), "_OBJECTS");
+  } else {
+    variableName = cmStrCat(this->VariablePrefix, "OBJECTS");
+  }
   *this->BuildFileStream << "# Object files for target "
                          << this->GeneratorTarget->GetName() << "\n"
                          << variableName << " =";
@@ -1301,8 +1473,12 @@ void cmMakefileTargetGenerator::WriteObjectsVariable(
 
   // Write a make variable assignment that lists all external objects
   // for the target.
-  variableNameExternal = this->LocalGenerator->CreateMakeVariable(
-    this->GeneratorTarget->GetName(), "_EXTERNAL_OBJECTS");
+  if (this->VariablePrefix.empty()) {
+    variableNameExternal = this->LocalGenerator->CreateMakeVariable(
+      this->GeneratorTarget->GetName(), "_EXTERNAL_OBJECTS");
+  } else {
+    variableNameExternal = cmStrCat(this->VariablePrefix, "EXTERNAL_OBJECTS");
+  }
   /* clang-format off */
   *this->BuildFileStream
     << "\n"
@@ -1416,6 +1592,9 @@ void cmMakefileTargetGenerator::WriteTargetDriverRule(
   // Build the list of target outputs to drive.
   std::vector<std::string> depends;
   depends.push_back(main_output);
+  if (this->GlobalGenerator->UseFlatMakefiles()) {
+    this->OrderedOutputs.insert(main_output);
+  }
 
   const char* comment = nullptr;
   if (relink) {
@@ -1426,7 +1605,11 @@ void cmMakefileTargetGenerator::WriteTargetDriverRule(
     comment = "Rule to build all files generated by this target.";
 
     // Make sure all custom command outputs in this target are built.
-    if (this->CustomCommandDriver == OnBuild) {
+    // The flat makefiles update dependencies after the build, so the
+    // build must drive them.
+    if (this->CustomCommandDriver == OnBuild ||
+        (this->CustomCommandDriver == OnDepends &&
+         this->GlobalGenerator->UseFlatMakefiles())) {
       this->DriveCustomCommands(depends);
     }
 
@@ -79,6 +79,9 @@ protected:
   // write the depend rules for this target
   void WriteTargetDependRules();
 
+  // write the rules that order this target after its dependencies
+  void WriteTargetOrderRules();
+
   // write rules for macOS Application Bundle content.
   struct MacOSXContentGeneratorType
     : cmOSXBundleGenerator::MacOSXContentGeneratorType
@@ -106,6 +109,9 @@ protected:
   // write the build rule for a custom command
   void GenerateCustomRuleFile(cmCustomCommandGenerator const& ccg);
 
+  // clean the batch files run by a custom command with this target
+  void AddBatchFilesToCleanFiles(cmCustomCommandGenerator const& ccg);
+
   // write a rule to drive building of more than one output from
   // another rule
   void GenerateExtraOutput(const char* out, const char* in,
@@ -154,6 +160,10 @@ protected:
   std::string CreateResponseFile(const char* name, std::string const& options,
                                  std::vector<std::string>& makefile_depends);
 
+  // Whether the compiler writes the dependencies of objects in the
+  // given language.
+  bool UseCompilerDepfile(std::string const& lang) const;
+
   bool CheckUseResponseFileForObjects(std::string const& l) const;
   bool CheckUseResponseFileForLibraries(std::string const& l) const;
 
@@ -195,6 +205,9 @@ protected:
   unsigned long NumberOfProgressActions;
   bool NoRuleMessages;
 
+  // the prefix of the make variables of this target
+  std::string VariablePrefix;
+
   // the path to the directory the build file is in
   std::string TargetBuildDirectory;
   std::string TargetBuildDirectoryFull;
@@ -227,6 +240,10 @@ protected:
   // Set of extra output files to be driven by the build.
   std::set<std::string> ExtraFiles;
 
+  // Set of rule outputs that must wait for the dependencies of the
+  // target when all targets are built by one make process.
+  std::set<std::string> OrderedOutputs;
+
   using MultipleOutputPairsType = std::map<std::string, std::string>;
   MultipleOutputPairsType MultipleOutputPairs;
   bool WriteMakeRule(std::ostream& os, const char* comment,
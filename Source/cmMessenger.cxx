@@ -151,6 +151,8 @@ void cmMessenger::IssueMessage(MessageType t, const std::string& text,
 void cmMessenger::DisplayMessage(MessageType t, const std::string& text,
                                  const cmListFileBacktrace& backtrace) const
 {
+  ++this->DisplayedMessageCount;
+
   std::ostringstream msg;
   if (!printMessagePreamble(t, msg)) {
     return;
@@ -48,6 +48,12 @@ public:
     return this->DeprecatedWarningsAsErrors;
   }
 
+  /** Get the number of messages displayed so far.  */
+  unsigned long long GetDisplayedMessageCount() const
+  {
+    return this->DisplayedMessageCount;
+  }
+
 private:
   bool IsMessageTypeVisible(MessageType t) const;
   MessageType ConvertMessageType(MessageType t) const;
@@ -56,6 +62,7 @@ private:
   bool SuppressDeprecatedWarnings = false;
   bool DevWarningsAsErrors = false;
   bool DeprecatedWarningsAsErrors = false;
+  mutable unsigned long long DisplayedMessageCount = 0;
 };
 
 #endif
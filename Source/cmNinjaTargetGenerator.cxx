@@ -68,17 +68,69 @@ cmNinjaTargetGenerator::cmNinjaTargetGenerator(cmGeneratorTarget* target)
   }
 }
 
-cmNinjaTargetGenerator::~cmNinjaTargetGenerator() = default;
+cmNinjaTargetGenerator::~cmNinjaTargetGenerator()
+{
+  // Keep the previous fragments if generation failed, as is done for
+  // the global build files.
+  if (cmSystemTools::GetErrorOccuredFlag()) {
+    for (auto& fragment : this->Fragments) {
+      fragment.second->setstate(std::ios::failbit);
+    }
+  }
+}
 
 cmGeneratedFileStream& cmNinjaTargetGenerator::GetImplFileStream(
   const std::string& config) const
 {
-  return *this->GetGlobalGenerator()->GetImplFileStream(config);
+  return this->GetFragmentStream(
+    this->GetGlobalGenerator()->GetImplFileStream(config), config);
 }
 
 cmGeneratedFileStream& cmNinjaTargetGenerator::GetCommonFileStream() const
 {
-  return *this->GetGlobalGenerator()->GetCommonFileStream();
+  return this->GetFragmentStream(
+    this->GetGlobalGenerator()->GetCommonFileStream(), std::string());
+}
+
+cmGeneratedFileStream& cmNinjaTargetGenerator::GetFragmentStream(
+  cmGeneratedFileStream* parent, const std::string& config) const
+{
+  // The few statements of the global targets stay in the global files.
+  if (!this->GetGlobalGenerator()->UseTargetFragments() ||
+      this->GeneratorTarget->GetType() == cmStateEnums::GLOBAL_TARGET) {
+    return *parent;
+  }
+
+  std::unique_ptr<cmGeneratedFileStream>& fragment = this->Fragments[parent];
+  if (fragment) {
+    return *fragment;
+  }
+
+  // The single-configuration generator has one global build file, so the
+  // common and per-configuration statements share one fragment.
+  cmGlobalNinjaGenerator* gg = this->GetGlobalGenerator();
+  std::string name = "build.ninja";
+  if (!config.empty() && parent != gg->GetCommonFileStream()) {
+    name = cmStrCat("build-", config, ".ninja");
+  }
+  std::string const path =
+    cmStrCat(this->LocalGenerator->GetCurrentBinaryDirectory(), '/',
+             this->LocalGenerator->GetTargetDirectory(this->GeneratorTarget),
+             '/', name);
+  if (!gg->OpenFragmentFileStream(fragment, path)) {
+    this->Fragments.erase(parent);
+    return *parent;
+  }
+  *fragment << "# This file contains the build statements of target \""
+            << this->GetTargetName() << "\".\n"
+            << "# It is loaded by the global build files with subninja.\n\n";
+
+  // Load the fragment where its statements would otherwise be written.
+  cmGlobalNinjaGenerator::WriteSubninja(
+    *parent, gg->EncodePath(gg->ConvertToNinjaPath(path)),
+    cmStrCat("Build statements of target \"", this->GetTargetName(), '"'));
+  *parent << '\n';
+  return *fragment;
 }
 
 cmGeneratedFileStream& cmNinjaTargetGenerator::GetRulesFileStream() const
@@ -142,6 +194,21 @@ bool cmNinjaTargetGenerator::NeedDyndep(std::string const& lang) const
   return lang == "Fortran";
 }
 
+std::string cmNinjaTargetGenerator::LanguageScanRule(
+  std::string const& lang, const std::string& config) const
+{
+  return cmStrCat(
+    lang, "_SCAN__",
+    cmGlobalNinjaGenerator::EncodeRuleName(this->GeneratorTarget->GetName()),
+    '_', config);
+}
+
+bool cmNinjaTargetGenerator::NeedBatchScan(std::string const& lang) const
+{
+  return this->NeedExplicitPreprocessing(lang) && this->NeedDyndep(lang) &&
+    this->Makefile->IsOn("CMAKE_NINJA_BATCH_SCAN");
+}
+
 std::string cmNinjaTargetGenerator::OrderDependsTargetForTarget(
   const std::string& config)
 {
@@ -513,6 +580,7 @@ void cmNinjaTargetGenerator::WriteCompileRule(const std::string& lang,
   bool const compilePPWithDefines = this->UsePreprocessedSource(lang) &&
     this->CompilePreprocessedSourceWithDefines(lang);
   bool const needDyndep = this->NeedDyndep(lang);
+  bool const batchScan = this->NeedBatchScan(lang);
 
   std::string flags = "$FLAGS";
 
@@ -606,8 +674,9 @@ void cmNinjaTargetGenerator::WriteCompileRule(const std::string& lang,
                                                    i, ppVars);
     }
 
-    // Run CMake dependency scanner on preprocessed output.
-    {
+    // Run CMake dependency scanner on preprocessed output, unless all
+    // sources are scanned by one build statement.
+    if (!batchScan) {
       std::string ccmd =
         cmStrCat(cmakeCmd, " -E cmake_ninja_depends --tdi=", tdi,
                  " --lang=", lang, " --pp=$out --dep=$DEP_FILE");
@@ -624,6 +693,23 @@ void cmNinjaTargetGenerator::WriteCompileRule(const std::string& lang,
     this->GetGlobalGenerator()->AddRule(rule);
   }
 
+  if (batchScan) {
+    // Write the rule for scanning the preprocessed output of all sources.
+    cmNinjaRule rule(this->LanguageScanRule(lang, config));
+    std::vector<std::string> scanCmds;
+    scanCmds.emplace_back(cmStrCat(cmakeCmd,
+                                   " -E cmake_ninja_depends --tdi=", tdi,
+                                   " --lang=", lang, " --batch"));
+    rule.Command = this->GetLocalGenerator()->BuildCommandLine(scanCmds);
+    // The scanner keeps ddi files whose content did not change.
+    rule.Restat = "1";
+    rule.Comment = cmStrCat("Rule for scanning preprocessed ", lang,
+                            " files in one process.");
+    rule.Description = cmStrCat("Scanning ", lang,
+                                " dependencies of target ", vars.CMTargetName);
+    this->GetGlobalGenerator()->AddRule(rule);
+  }
+
   if (needDyndep) {
     // Write the rule for ninja dyndep file generation.
     cmNinjaRule rule(this->LanguageDyndepRule(lang, config));
@@ -927,6 +1013,18 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatements(
     std::string const& language = langDDIFiles.first;
     cmNinjaDeps const& ddiFiles = langDDIFiles.second;
 
+    auto const scanSources = this->Configs[config].ScanSources.find(language);
+    if (scanSources != this->Configs[config].ScanSources.end()) {
+      // Scan the preprocessed output of all sources in one build statement.
+      cmNinjaBuild scanBuild(this->LanguageScanRule(language, config));
+      scanBuild.Outputs = ddiFiles;
+      for (Json::Value const& source : scanSources->second) {
+        scanBuild.ExplicitDeps.push_back(source["pp"].asString());
+      }
+      this->GetGlobalGenerator()->WriteBuild(
+        this->GetImplFileStream(fileConfig), scanBuild);
+    }
+
     cmNinjaBuild build(this->LanguageDyndepRule(language, config));
     build.Outputs.push_back(this->GetDyndepFilePath(language, config));
     build.ExplicitDeps = ddiFiles;
@@ -1173,14 +1271,28 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
     }
 
     if (needDyndep) {
-      // Tell dependency scanner the object file that will result from
-      // compiling the source.
-      ppBuild.Variables["OBJ_FILE"] = objectFileName;
-
-      // Tell dependency scanner where to store dyndep intermediate results.
       std::string const ddiFile = cmStrCat(objectFileName, ".ddi");
-      ppBuild.Variables["DYNDEP_INTERMEDIATE_FILE"] = ddiFile;
-      ppBuild.ImplicitOuts.push_back(ddiFile);
+      if (this->NeedBatchScan(language)) {
+        // Tell the scanner of all sources what to scan and which files to
+        // write.  It also writes the depfile of the preprocessing.
+        if (firstForConfig) {
+          Json::Value scanSource(Json::objectValue);
+          scanSource["pp"] = ppFileName;
+          scanSource["dep"] = cmStrCat(objectFileName, ".pp.d");
+          scanSource["obj"] = objectFileName;
+          scanSource["ddi"] = ddiFile;
+          this->Configs[config].ScanSources[language].append(scanSource);
+        }
+      } else {
+        // Tell dependency scanner the object file that will result from
+        // compiling the source.
+        ppBuild.Variables["OBJ_FILE"] = objectFileName;
+
+        // Tell dependency scanner where to store dyndep intermediate
+        // results.
+        ppBuild.Variables["DYNDEP_INTERMEDIATE_FILE"] = ddiFile;
+        ppBuild.ImplicitOuts.push_back(ddiFile);
+      }
       if (firstForConfig) {
         this->Configs[config].DDIFiles[language].push_back(ddiFile);
       }
@@ -1189,6 +1301,8 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
     this->addPoolNinjaVariable("JOB_POOL_COMPILE", this->GetGeneratorTarget(),
                                ppBuild.Variables);
 
+    this->UseSharedObjectVariables(ppBuild.Variables, language, config,
+                                   fileConfig);
     this->GetGlobalGenerator()->WriteBuild(this->GetImplFileStream(fileConfig),
                                            ppBuild, commandLineLengthLimit);
   }
@@ -1222,6 +1336,7 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
   if (language == "Swift") {
     this->EmitSwiftDependencyInfo(source, config);
   } else {
+    this->UseSharedObjectVariables(vars, language, config, fileConfig);
     this->GetGlobalGenerator()->WriteBuild(this->GetImplFileStream(fileConfig),
                                            objBuild, commandLineLengthLimit);
   }
@@ -1238,6 +1353,62 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
   }
 }
 
+void cmNinjaTargetGenerator::UseSharedObjectVariables(
+  cmNinjaVars& vars, std::string const& language, const std::string& config,
+  const std::string& fileConfig)
+{
+  // Statements written for other configurations keep their values.
+  if (config != fileConfig) {
+    return;
+  }
+
+  auto& sharedVars = this->Configs[config].SharedObjectVariables;
+  auto shared = sharedVars.find(language);
+  if (shared == sharedVars.end()) {
+    // The values computed for a source file start from those of the
+    // target.  Write them once, as the Makefile generator does in
+    // flags.make.
+    cmNinjaVars values;
+    values["FLAGS"] = cmTrimWhitespace(this->GetFlags(language, config));
+    values["DEFINES"] = cmTrimWhitespace(this->GetDefines(language, config));
+    values["INCLUDES"] =
+      cmTrimWhitespace(this->GetIncludes(language, config));
+
+    std::ostream& os = this->GetImplFileStream(fileConfig);
+    cmGlobalNinjaGenerator::WriteComment(
+      os,
+      cmStrCat("Variables shared by the ", language,
+               " object build statements of target ", this->GetTargetName()));
+    for (auto const& value : values) {
+      cmGlobalNinjaGenerator::WriteVariable(
+        os, cmStrCat(language, '_', value.first), value.second);
+    }
+    os << "\n";
+    shared = sharedVars.emplace(language, std::move(values)).first;
+  }
+
+  for (auto const& value : shared->second) {
+    std::string const& sharedValue = value.second;
+    auto var = vars.find(value.first);
+    if (sharedValue.empty() || var == vars.end()) {
+      continue;
+    }
+    // Refer to the shared value where it is a whole part of the value.
+    std::string const varValue = cmTrimWhitespace(var->second);
+    std::string::size_type pos = varValue.find(sharedValue);
+    while (pos != std::string::npos) {
+      std::string::size_type const end = pos + sharedValue.size();
+      if ((pos == 0 || varValue[pos - 1] == ' ') &&
+          (end == varValue.size() || varValue[end] == ' ')) {
+        var->second = cmStrCat(varValue.substr(0, pos), '$', language, '_',
+                               value.first, varValue.substr(end));
+        break;
+      }
+      pos = varValue.find(sharedValue, pos + 1);
+    }
+  }
+}
+
 void cmNinjaTargetGenerator::WriteTargetDependInfo(std::string const& lang,
                                                    const std::string& config)
 {
@@ -1280,8 +1451,15 @@ void cmNinjaTargetGenerator::WriteTargetDependInfo(std::string const& lang,
     tdi_linked_target_dirs.append(l);
   }
 
+  auto const scanSources = this->Configs[config].ScanSources.find(lang);
+  if (scanSources != this->Configs[config].ScanSources.end()) {
+    tdi["scan-sources"] = scanSources->second;
+  }
+
   std::string const tdin = this->GetTargetDependInfoPath(lang, config);
   cmGeneratedFileStream tdif(tdin);
+  // The batch scanner rescans all sources if this file is newer.
+  tdif.SetCopyIfDifferent(true);
   tdif << tdi;
 }
 
@@ -48,6 +48,9 @@ public:
 protected:
   bool SetMsvcTargetPdbVariable(cmNinjaVars&, const std::string& config) const;
 
+  /// With CMAKE_NINJA_TARGET_FRAGMENTS, the target's build statements go to
+  /// its own build file fragments, which the global build files load with
+  /// subninja.
   cmGeneratedFileStream& GetImplFileStream(const std::string& config) const;
   cmGeneratedFileStream& GetCommonFileStream() const;
   cmGeneratedFileStream& GetRulesFileStream() const;
@@ -74,6 +77,9 @@ protected:
   std::string LanguageDyndepRule(std::string const& lang,
                                  const std::string& config) const;
   bool NeedDyndep(std::string const& lang) const;
+  std::string LanguageScanRule(std::string const& lang,
+                               const std::string& config) const;
+  bool NeedBatchScan(std::string const& lang) const;
   bool UsePreprocessedSource(std::string const& lang) const;
   bool CompilePreprocessedSourceWithDefines(std::string const& lang) const;
 
@@ -154,6 +160,16 @@ protected:
   void WriteTargetDependInfo(std::string const& lang,
                              const std::string& config);
 
+  /**
+   * Replace the parts of the FLAGS, DEFINES and INCLUDES @a vars of an
+   * object build statement that all @a language sources of the target
+   * share with references to variables written once before the first
+   * such statement.
+   */
+  void UseSharedObjectVariables(cmNinjaVars& vars, std::string const& language,
+                                const std::string& config,
+                                const std::string& fileConfig);
+
   void EmitSwiftDependencyInfo(cmSourceFile const* source,
                                const std::string& config);
 
@@ -200,19 +216,34 @@ protected:
   bool ForceResponseFile();
 
 private:
+  cmGeneratedFileStream& GetFragmentStream(cmGeneratedFileStream* parent,
+                                           const std::string& config) const;
+
   cmLocalNinjaGenerator* LocalGenerator;
 
+  /// Build file fragments of this target by the global build file that
+  /// loads them.
+  mutable std::map<cmGeneratedFileStream*,
+                   std::unique_ptr<cmGeneratedFileStream>>
+    Fragments;
+
   struct ByConfig
   {
     /// List of object files for this target.
     cmNinjaDeps Objects;
     // Fortran Support
     std::map<std::string, cmNinjaDeps> DDIFiles;
+    // Sources scanned by one build statement for all sources of the
+    // language.
+    std::map<std::string, Json::Value> ScanSources;
     // Swift Support
     Json::Value SwiftOutputMap;
     std::vector<cmCustomCommand const*> CustomCommands;
     cmNinjaDeps ExtraFiles;
     std::unique_ptr<MacOSXContentGeneratorType> MacOSXContentGenerator;
+    // Object build statement variables shared by the sources of each
+    // language.
+    std::map<std::string, cmNinjaVars> SharedObjectVariables;
   };
 
   std::map<std::string, ByConfig> Configs;
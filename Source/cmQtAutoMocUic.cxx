@@ -5,9 +5,13 @@
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
 #include <map>
 #include <mutex>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -23,13 +27,18 @@
 
 #include "cm_jsoncpp_value.h"
 
+#include "cmBinaryCache.h"
 #include "cmCryptoHash.h"
+#include "cmFileLock.h"
+#include "cmFileLockResult.h"
 #include "cmFileTime.h"
 #include "cmGccDepfileReader.h"
 #include "cmGccDepfileReaderTypes.h"
 #include "cmGeneratedFileStream.h"
+#include "cmMakefileProfilingData.h"
 #include "cmQtAutoGen.h"
 #include "cmQtAutoGenerator.h"
+#include "cmQtAutoMocUicScanner.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmWorkerPool.h"
@@ -43,6 +52,9 @@ namespace {
 constexpr std::size_t MocUnderscoreLength = 4; // Length of "moc_"
 constexpr std::size_t UiUnderscoreLength = 3;  // Length of "ui_"
 
+// Bump the version whenever the layout of the serialized data changes.
+const char SharedParseCacheMagic[] = "CMakeAutogenParseCache\n1\n";
+
 /** \class cmQtAutoMocUicT
  * \brief AUTOMOC and AUTOUIC generator
  */
@@ -126,6 +138,55 @@ public:
     std::unordered_map<std::string, FileHandleT> Map_;
   };
 
+  /** File parsing cache shared by all targets of the build tree.
+   *
+   * The parse results of a file are stored under a key that combines the
+   * file name and the parse settings, together with the file time.  The
+   * cache file is always replaced as a whole, so it is read without a
+   * lock, and only once the first lookup needs it.  Write() merges the
+   * results stored during this run into the current cache file under a
+   * file lock and drops the entries of files that no longer exist.
+   */
+  class SharedParseCacheT
+  {
+  public:
+    SharedParseCacheT();
+    ~SharedParseCacheT();
+
+    SharedParseCacheT(SharedParseCacheT const&) = delete;
+    SharedParseCacheT& operator=(SharedParseCacheT const&) = delete;
+
+    bool Enabled() const { return !FileName_.empty(); }
+    void SetFileName(std::string fileName) { FileName_ = std::move(fileName); }
+    std::string const& FileName() const { return FileName_; }
+
+    bool Write(std::string* error);
+
+    //! Copies the cached results if the file time matches
+    bool Lookup(std::string const& key, cmFileTime const& fileTime,
+                ParseCacheT::FileT& file) const;
+    void Store(std::string const& key, cmFileTime const& fileTime,
+               ParseCacheT::FileT const& file);
+
+  private:
+    struct EntryT
+    {
+      cmFileTime::NSC Time = 0;
+      ParseCacheT::FileT File;
+    };
+    using EntryMapT = std::unordered_map<std::string, EntryT>;
+
+    static void ReadFromFile(std::string const& fileName, EntryMapT& map);
+
+    std::string FileName_;
+    mutable std::mutex Mutex_;
+    //! Whether the cache file was read into Map_
+    mutable bool Loaded_ = false;
+    mutable EntryMapT Map_;
+    //! Results stored during this run
+    EntryMapT Stored_;
+  };
+
   /** Source file data.  */
   class SourceFileT
   {
@@ -181,9 +242,11 @@ public:
     std::string CMakeExecutable;
     cmFileTime CMakeExecutableTime;
     std::string ParseCacheFile;
+    std::string ParseSettingsKey;
     std::string DepFile;
     std::string DepFileRuleName;
     std::vector<std::string> HeaderExtensions;
+    cmQtAutoMocUicScanner Scanner;
   };
 
   /** Shared common variables.  */
@@ -194,6 +257,7 @@ public:
     bool ParseCacheChanged = false;
     cmFileTime ParseCacheTime;
     ParseCacheT ParseCache;
+    SharedParseCacheT SharedParseCache;
 
     // -- Sources
     SourceFileMapT Headers;
@@ -234,7 +298,6 @@ public:
     std::vector<std::string> PredefsCmd;
     std::vector<KeyExpT> DependFilters;
     std::vector<KeyExpT> MacroFilters;
-    cmsys::RegularExpression RegExpInclude;
   };
 
   /** Moc shared variables.  */
@@ -251,6 +314,8 @@ public:
     SourceFileMapT HeadersDiscovered;
     // -- Output directories
     std::unordered_set<std::string> OutputDirs;
+    // -- Compile jobs, pushed when the output directories exist
+    std::vector<cmWorkerPool::JobHandleT> CompileJobs;
     // -- Mocs compilation
     bool CompUpdated = false;
     std::vector<std::string> CompFiles;
@@ -284,7 +349,6 @@ public:
     std::vector<std::string> Options;
     std::unordered_map<std::string, UiFile> UiFiles;
     std::vector<std::string> SearchPaths;
-    cmsys::RegularExpression RegExpInclude;
   };
 
   /** Uic shared variables.  */
@@ -297,6 +361,18 @@ public:
     MappingMapT Includes;
     // -- Output directories
     std::unordered_set<std::string> OutputDirs;
+    // -- Compile jobs, pushed when the output directories exist
+    std::vector<cmWorkerPool::JobHandleT> CompileJobs;
+  };
+
+  /** Job priorities.  Compile jobs are started as early as possible
+      because they take much longer than the other jobs.  */
+  enum JobPriorityT : int
+  {
+    PriorityDefault = 0,
+    PriorityCompileUic = 1,
+    PriorityCompileMoc = 2,
+    PriorityMocPredefs = 3
   };
 
   /** Abstract job class for concurrent job processing.  */
@@ -353,8 +429,9 @@ public:
   };
 
   /** Generate moc_predefs.h.  */
-  class JobMocPredefsT : public JobFenceT
+  class JobMocPredefsT : public JobT
   {
+    std::string Name() const override { return "moc_predefs"; }
     void Process() override;
     bool Update(std::string* reason) const;
   };
@@ -370,6 +447,7 @@ public:
 
   protected:
     bool ReadFile();
+    void Scan(bool mocIncludes);
     void CreateKeys(std::vector<IncludeKeyT>& container,
                     std::set<std::string> const& source,
                     std::size_t basePrefixLength);
@@ -377,10 +455,12 @@ public:
     void MocDependecies();
     void MocIncludes();
     void UicIncludes();
+    void StoreShared() const;
 
   protected:
     SourceFileHandleT FileHandle;
     std::string Content;
+    cmQtAutoMocUicScanner::ResultT Scanned;
   };
 
   /** Header file parse job.  */
@@ -388,6 +468,7 @@ public:
   {
   public:
     using JobParseT::JobParseT;
+    std::string Name() const override;
     void Process() override;
   };
 
@@ -396,6 +477,7 @@ public:
   {
   public:
     using JobParseT::JobParseT;
+    std::string Name() const override;
     void Process() override;
   };
 
@@ -410,6 +492,7 @@ public:
   /** Evaluate cached file parse data - moc.  */
   class JobEvalCacheMocT : public JobEvalCacheT
   {
+    std::string Name() const override { return "eval_moc"; }
     void Process() override;
     bool EvalHeader(SourceFileHandleT source);
     bool EvalSource(SourceFileHandleT const& source);
@@ -426,6 +509,7 @@ public:
   /** Evaluate cached file parse data - uic.  */
   class JobEvalCacheUicT : public JobEvalCacheT
   {
+    std::string Name() const override { return "eval_uic"; }
     void Process() override;
     bool EvalFile(SourceFileHandleT const& sourceFileHandle);
     bool FindIncludedUi(cm::string_view sourceDirPrefix,
@@ -438,8 +522,9 @@ public:
   };
 
   /** Evaluate cached file parse data - finish  */
-  class JobEvalCacheFinishT : public JobFenceT
+  class JobEvalCacheFinishT : public JobT
   {
+    std::string Name() const override { return "eval_finish"; }
     void Process() override;
   };
 
@@ -451,6 +536,7 @@ public:
   /** Probes file dependencies and generates moc compile jobs.  */
   class JobProbeDepsMocT : public JobProbeDepsT
   {
+    std::string Name() const override { return "probe_moc"; }
     void Process() override;
     bool Generate(MappingHandleT const& mapping, bool compFile) const;
     bool Probe(MappingT const& mapping, std::string* reason) const;
@@ -461,13 +547,15 @@ public:
   /** Probes file dependencies and generates uic compile jobs.  */
   class JobProbeDepsUicT : public JobProbeDepsT
   {
+    std::string Name() const override { return "probe_uic"; }
     void Process() override;
     bool Probe(MappingT const& mapping, std::string* reason) const;
   };
 
   /** Dependency probing finish job.  */
-  class JobProbeDepsFinishT : public JobFenceT
+  class JobProbeDepsFinishT : public JobT
   {
+    std::string Name() const override { return "probe_finish"; }
     void Process() override;
   };
 
@@ -497,6 +585,7 @@ public:
       , CacheEntry(std::move(cacheEntry))
     {
     }
+    std::string Name() const override;
     void Process() override;
 
   protected:
@@ -508,19 +597,22 @@ public:
   {
   public:
     using JobCompileT::JobCompileT;
+    std::string Name() const override;
     void Process() override;
   };
 
   /** Generate mocs_compilation.cpp.  */
-  class JobMocsCompilationT : public JobFenceT
+  class JobMocsCompilationT : public JobT
   {
   private:
+    std::string Name() const override { return "mocs_compilation"; }
     void Process() override;
   };
 
-  class JobDepFilesMergeT : public JobFenceT
+  class JobDepFilesMergeT : public JobT
   {
   private:
+    std::string Name() const override { return "depfiles_merge"; }
     void Process() override;
   };
 
@@ -528,6 +620,7 @@ public:
   class JobFinishT : public JobFenceT
   {
   private:
+    std::string Name() const override { return "finish"; }
     void Process() override;
   };
 
@@ -541,6 +634,9 @@ public:
 
   // -- Parallel job processing interface
   cmWorkerPool& WorkerPool() { return WorkerPool_; }
+  void PushJob(cmWorkerPool::JobHandleT job, int priority,
+               std::initializer_list<cmWorkerPool::GroupHandleT> waitFor,
+               cmWorkerPool::GroupHandleT const& group = nullptr);
   void AbortError() { Abort(true); }
   void AbortSuccess() { Abort(false); }
 
@@ -549,6 +645,7 @@ public:
   std::string AbsoluteIncludePath(cm::string_view relativePath) const;
   template <class JOBTYPE>
   void CreateParseJobs(SourceFileMapT const& sourceMap);
+  std::string SharedParseCacheKey(SourceFileT const& source) const;
   std::string CollapseFullPathTS(std::string const& path) const;
 
 private:
@@ -556,6 +653,7 @@ private:
   bool InitFromInfo(InfoT const& info) override;
   void InitJobs();
   bool Process() override;
+  void ProfilingWrite(std::string const& directory) const;
   // -- Settings file
   void SettingsFileRead();
   bool SettingsFileWrite();
@@ -585,6 +683,12 @@ private:
   // -- Worker thread pool
   std::atomic<bool> JobError_ = ATOMIC_VAR_INIT(false);
   cmWorkerPool WorkerPool_;
+  // -- Job groups
+  cmWorkerPool::GroupHandleT PredefsGroup_;
+  cmWorkerPool::GroupHandleT ParseGroup_;
+  cmWorkerPool::GroupHandleT EvalGroup_;
+  cmWorkerPool::GroupHandleT ProbeGroup_;
+  cmWorkerPool::GroupHandleT CompileMocGroup_;
   // -- Concurrent processing
   mutable std::mutex CMakeLibMutex_;
 };
@@ -726,16 +830,143 @@ bool cmQtAutoMocUicT::ParseCacheT::WriteToFile(std::string const& fileName)
   return ofs.Close();
 }
 
-cmQtAutoMocUicT::BaseSettingsT::BaseSettingsT() = default;
-cmQtAutoMocUicT::BaseSettingsT::~BaseSettingsT() = default;
+cmQtAutoMocUicT::SharedParseCacheT::SharedParseCacheT() = default;
+cmQtAutoMocUicT::SharedParseCacheT::~SharedParseCacheT() = default;
+
+void cmQtAutoMocUicT::SharedParseCacheT::ReadFromFile(
+  std::string const& fileName, EntryMapT& map)
+{
+  std::string data;
+  if (!cmBinaryCache::ReadFile(fileName, SharedParseCacheMagic, data)) {
+    return;
+  }
+
+  cmBinaryCache::Reader reader(data);
+  std::uint32_t size;
+  if (!reader.ReadUInt(size)) {
+    return;
+  }
+  std::string key;
+  std::vector<std::string> underscore;
+  std::vector<std::string> dot;
+  std::vector<std::string> uicInclude;
+  for (std::uint32_t ii = 0; ii != size; ++ii) {
+    EntryT entry;
+    ParseCacheT::FileT& file = entry.File;
+    if (!reader.ReadString(key) || !reader.ReadTime(entry.Time) ||
+        !reader.ReadString(file.Moc.Macro) ||
+        !reader.ReadStrings(underscore) || !reader.ReadStrings(dot) ||
+        !reader.ReadStrings(file.Moc.Depends) ||
+        !reader.ReadStrings(uicInclude)) {
+      // The file is truncated or corrupt.  Keep what was read so far.
+      return;
+    }
+    for (std::string const& item : underscore) {
+      file.Moc.Include.Underscore.emplace_back(item, MocUnderscoreLength);
+    }
+    for (std::string const& item : dot) {
+      file.Moc.Include.Dot.emplace_back(item, 0);
+    }
+    for (std::string const& item : uicInclude) {
+      file.Uic.Include.emplace_back(item, UiUnderscoreLength);
+    }
+    map[key] = std::move(entry);
+  }
+}
+
+bool cmQtAutoMocUicT::SharedParseCacheT::Write(std::string* error)
+{
+  std::lock_guard<std::mutex> guard(Mutex_);
+  if (Stored_.empty()) {
+    return true;
+  }
 
-cmQtAutoMocUicT::MocSettingsT::MocSettingsT()
+  // Lock the cache file against other autogen processes
+  std::string const lockFile = cmStrCat(FileName_, ".lock");
+  cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(lockFile));
+  cmSystemTools::Touch(lockFile, true);
+  cmFileLock fileLock;
+  cmFileLockResult lockResult = fileLock.Lock(lockFile, 60);
+  if (!lockResult.IsOk()) {
+    *error = lockResult.GetOutputMessage();
+    return false;
+  }
+
+  // Merge the results of this run into the current cache file content
+  EntryMapT map;
+  ReadFromFile(FileName_, map);
+  for (auto& pair : Stored_) {
+    map[pair.first] = std::move(pair.second);
+  }
+  Stored_.clear();
+  // Drop the entries of removed files.  The key starts with the file name.
+  for (auto it = map.begin(); it != map.end();) {
+    if (cmSystemTools::FileExists(it->first.substr(0, it->first.find('\n')),
+                                  true)) {
+      ++it;
+    } else {
+      it = map.erase(it);
+    }
+  }
+
+  std::string data;
+  cmBinaryCache::WriteUInt(data, static_cast<std::uint32_t>(map.size()));
+  auto writeKeys = [&data](std::vector<IncludeKeyT> const& keys) {
+    cmBinaryCache::WriteUInt(data, static_cast<std::uint32_t>(keys.size()));
+    for (IncludeKeyT const& item : keys) {
+      cmBinaryCache::WriteString(data, item.Key);
+    }
+  };
+  for (auto const& pair : map) {
+    ParseCacheT::FileT const& file = pair.second.File;
+    cmBinaryCache::WriteString(data, pair.first);
+    cmBinaryCache::WriteTime(data, pair.second.Time);
+    cmBinaryCache::WriteString(data, file.Moc.Macro);
+    writeKeys(file.Moc.Include.Underscore);
+    writeKeys(file.Moc.Include.Dot);
+    cmBinaryCache::WriteStrings(data, file.Moc.Depends);
+    writeKeys(file.Uic.Include);
+  }
+
+  if (!cmBinaryCache::WriteFile(FileName_, SharedParseCacheMagic, data)) {
+    *error = "The file could not be written.";
+    return false;
+  }
+  return true;
+}
+
+bool cmQtAutoMocUicT::SharedParseCacheT::Lookup(
+  std::string const& key, cmFileTime const& fileTime,
+  ParseCacheT::FileT& file) const
+{
+  std::lock_guard<std::mutex> guard(Mutex_);
+  if (!Loaded_) {
+    ReadFromFile(FileName_, Map_);
+    Loaded_ = true;
+  }
+  auto it = Map_.find(key);
+  if (it == Map_.end() || it->second.Time != fileTime.GetNS()) {
+    return false;
+  }
+  file = it->second.File;
+  return true;
+}
+
+void cmQtAutoMocUicT::SharedParseCacheT::Store(
+  std::string const& key, cmFileTime const& fileTime,
+  ParseCacheT::FileT const& file)
 {
-  RegExpInclude.compile(
-    "(^|\n)[ \t]*#[ \t]*include[ \t]+"
-    "[\"<](([^ \">]+/)?moc_[^ \">/]+\\.cpp|[^ \">]+\\.moc)[\">]");
+  std::lock_guard<std::mutex> guard(Mutex_);
+  EntryT& entry = Stored_[key];
+  entry.Time = fileTime.GetNS();
+  entry.File = file;
 }
 
+cmQtAutoMocUicT::BaseSettingsT::BaseSettingsT() = default;
+cmQtAutoMocUicT::BaseSettingsT::~BaseSettingsT() = default;
+
+cmQtAutoMocUicT::MocSettingsT::MocSettingsT() = default;
+
 cmQtAutoMocUicT::MocSettingsT::~MocSettingsT() = default;
 
 bool cmQtAutoMocUicT::MocSettingsT::skipped(std::string const& fileName) const
@@ -765,11 +996,7 @@ std::string cmQtAutoMocUicT::MocSettingsT::MacrosString() const
   return res;
 }
 
-cmQtAutoMocUicT::UicSettingsT::UicSettingsT()
-{
-  RegExpInclude.compile("(^|\n)[ \t]*#[ \t]*include[ \t]+"
-                        "[\"<](([^ \">]+/)?ui_[^ \">/]+\\.h)[\">]");
-}
+cmQtAutoMocUicT::UicSettingsT::UicSettingsT() = default;
 
 cmQtAutoMocUicT::UicSettingsT::~UicSettingsT() = default;
 
@@ -942,6 +1169,15 @@ bool cmQtAutoMocUicT::JobParseT::ReadFile()
   return true;
 }
 
+void cmQtAutoMocUicT::JobParseT::Scan(bool mocIncludes)
+{
+  cmQtAutoMocUicScanner::OptionsT options;
+  options.Macros = FileHandle->Moc;
+  options.MocIncludes = FileHandle->Moc && mocIncludes;
+  options.UicIncludes = FileHandle->Uic;
+  BaseConst().Scanner.Scan(Content, options, Scanned);
+}
+
 void cmQtAutoMocUicT::JobParseT::CreateKeys(
   std::vector<IncludeKeyT>& container, std::set<std::string> const& source,
   std::size_t basePrefixLength)
@@ -957,6 +1193,11 @@ void cmQtAutoMocUicT::JobParseT::CreateKeys(
 
 void cmQtAutoMocUicT::JobParseT::MocMacro()
 {
+  if (BaseConst().Scanner.ScansMacros()) {
+    FileHandle->ParseData->Moc.Macro = Scanned.Macro;
+    return;
+  }
+  // Some macro names are not supported by the scanner
   for (KeyExpT const& filter : MocConst().MacroFilters) {
     // Run a simple find string check
     if (Content.find(filter.Key) == std::string::npos) {
@@ -1015,30 +1256,18 @@ void cmQtAutoMocUicT::JobParseT::MocDependecies()
 
 void cmQtAutoMocUicT::JobParseT::MocIncludes()
 {
-  if (Content.find("moc") == std::string::npos) {
-    return;
-  }
-
   std::set<std::string> underscore;
   std::set<std::string> dot;
-  {
-    const char* contentChars = Content.c_str();
-    cmsys::RegularExpression const& regExp = MocConst().RegExpInclude;
-    cmsys::RegularExpressionMatch match;
-    while (regExp.find(contentChars, match)) {
-      std::string incString = match.match(2);
-      std::string const incBase =
-        cmSystemTools::GetFilenameWithoutLastExtension(incString);
-      if (cmHasLiteralPrefix(incBase, "moc_")) {
-        // moc_<BASE>.cpp
-        // Remove the moc_ part from the base name
-        underscore.emplace(std::move(incString));
-      } else {
-        // <BASE>.moc
-        dot.emplace(std::move(incString));
-      }
-      // Forward content pointer
-      contentChars += match.end();
+  for (std::string& incString : Scanned.MocIncludes) {
+    std::string const incBase =
+      cmSystemTools::GetFilenameWithoutLastExtension(incString);
+    if (cmHasLiteralPrefix(incBase, "moc_")) {
+      // moc_<BASE>.cpp
+      // Remove the moc_ part from the base name
+      underscore.emplace(std::move(incString));
+    } else {
+      // <BASE>.moc
+      dot.emplace(std::move(incString));
     }
   }
   auto& Include = FileHandle->ParseData->Moc.Include;
@@ -1048,22 +1277,23 @@ void cmQtAutoMocUicT::JobParseT::MocIncludes()
 
 void cmQtAutoMocUicT::JobParseT::UicIncludes()
 {
-  if (Content.find("ui_") == std::string::npos) {
-    return;
-  }
+  std::set<std::string> includes(Scanned.UicIncludes.begin(),
+                                 Scanned.UicIncludes.end());
+  CreateKeys(FileHandle->ParseData->Uic.Include, includes, UiUnderscoreLength);
+}
 
-  std::set<std::string> includes;
-  {
-    const char* contentChars = Content.c_str();
-    cmsys::RegularExpression const& regExp = UicConst().RegExpInclude;
-    cmsys::RegularExpressionMatch match;
-    while (regExp.find(contentChars, match)) {
-      includes.emplace(match.match(2));
-      // Forward content pointer
-      contentChars += match.end();
-    }
+void cmQtAutoMocUicT::JobParseT::StoreShared() const
+{
+  SharedParseCacheT& sharedCache = BaseEval().SharedParseCache;
+  if (sharedCache.Enabled()) {
+    sharedCache.Store(Gen()->SharedParseCacheKey(*FileHandle),
+                      FileHandle->FileTime, *FileHandle->ParseData);
   }
-  CreateKeys(FileHandle->ParseData->Uic.Include, includes, UiUnderscoreLength);
+}
+
+std::string cmQtAutoMocUicT::JobParseHeaderT::Name() const
+{
+  return cmStrCat("parse ", FileHandle->FileName);
 }
 
 void cmQtAutoMocUicT::JobParseHeaderT::Process()
@@ -1071,6 +1301,7 @@ void cmQtAutoMocUicT::JobParseHeaderT::Process()
   if (!ReadFile()) {
     return;
   }
+  Scan(false);
   // Moc parsing
   if (FileHandle->Moc) {
     MocMacro();
@@ -1080,6 +1311,12 @@ void cmQtAutoMocUicT::JobParseHeaderT::Process()
   if (FileHandle->Uic) {
     UicIncludes();
   }
+  StoreShared();
+}
+
+std::string cmQtAutoMocUicT::JobParseSourceT::Name() const
+{
+  return cmStrCat("parse ", FileHandle->FileName);
 }
 
 void cmQtAutoMocUicT::JobParseSourceT::Process()
@@ -1087,6 +1324,7 @@ void cmQtAutoMocUicT::JobParseSourceT::Process()
   if (!ReadFile()) {
     return;
   }
+  Scan(true);
   // Moc parsing
   if (FileHandle->Moc) {
     MocMacro();
@@ -1097,6 +1335,7 @@ void cmQtAutoMocUicT::JobParseSourceT::Process()
   if (FileHandle->Uic) {
     UicIncludes();
   }
+  StoreShared();
 }
 
 std::string cmQtAutoMocUicT::JobEvalCacheT::MessageSearchLocations() const
@@ -1647,22 +1886,23 @@ bool cmQtAutoMocUicT::JobEvalCacheUicT::RegisterMapping(
 
 void cmQtAutoMocUicT::JobEvalCacheFinishT::Process()
 {
+  cmQtAutoMocUicT* gen = Gen();
+
   // Add discovered header parse jobs
-  Gen()->CreateParseJobs<JobParseHeaderT>(MocEval().HeadersDiscovered);
+  gen->CreateParseJobs<JobParseHeaderT>(MocEval().HeadersDiscovered);
 
-  // Add dependency probing jobs
-  {
-    // Add fence job to ensure all parsing has finished
-    Gen()->WorkerPool().EmplaceJob<JobFenceT>();
-    if (MocConst().Enabled) {
-      Gen()->WorkerPool().EmplaceJob<JobProbeDepsMocT>();
-    }
-    if (UicConst().Enabled) {
-      Gen()->WorkerPool().EmplaceJob<JobProbeDepsUicT>();
-    }
-    // Add probe finish job
-    Gen()->WorkerPool().EmplaceJob<JobProbeDepsFinishT>();
+  // Add dependency probing jobs.  They wait for all parse jobs.
+  if (MocConst().Enabled) {
+    gen->PushJob(cm::make_unique<JobProbeDepsMocT>(), PriorityDefault,
+                 { gen->ParseGroup_, gen->PredefsGroup_ }, gen->ProbeGroup_);
+  }
+  if (UicConst().Enabled) {
+    gen->PushJob(cm::make_unique<JobProbeDepsUicT>(), PriorityDefault,
+                 { gen->ParseGroup_ }, gen->ProbeGroup_);
   }
+  // Add probe finish job
+  gen->PushJob(cm::make_unique<JobProbeDepsFinishT>(), PriorityDefault,
+               { gen->ParseGroup_, gen->ProbeGroup_ });
 }
 
 void cmQtAutoMocUicT::JobProbeDepsMocT::Process()
@@ -1701,9 +1941,9 @@ bool cmQtAutoMocUicT::JobProbeDepsMocT::Generate(MappingHandleT const& mapping,
     std::string const& sourceFile = mapping->SourceFile->FileName;
     ParseCacheT::GetOrInsertT cacheEntry =
       BaseEval().ParseCache.GetOrInsert(sourceFile);
-    // Add moc job
-    Gen()->WorkerPool().EmplaceJob<JobCompileMocT>(
-      mapping, std::move(reason), std::move(cacheEntry.first));
+    // Add moc job.  It is pushed when the output directories exist.
+    MocEval().CompileJobs.emplace_back(cm::make_unique<JobCompileMocT>(
+      mapping, std::move(reason), std::move(cacheEntry.first)));
     // Check if a moc job for a mocs_compilation.cpp entry was generated
     if (compFile) {
       MocEval().CompUpdated = true;
@@ -1847,8 +2087,9 @@ void cmQtAutoMocUicT::JobProbeDepsUicT::Process()
 
     // Register the parent directory for creation
     UicEval().OutputDirs.emplace(cmQtAutoGen::ParentDir(mapping->OutputFile));
-    // Add uic job
-    Gen()->WorkerPool().EmplaceJob<JobCompileUicT>(mapping, std::move(reason));
+    // Add uic job.  It is pushed when the output directories exist.
+    UicEval().CompileJobs.emplace_back(
+      cm::make_unique<JobCompileUicT>(mapping, std::move(reason)));
   }
 }
 
@@ -1929,18 +2170,38 @@ void cmQtAutoMocUicT::JobProbeDepsFinishT::Process()
     }
   }
 
+  cmQtAutoMocUicT* gen = Gen();
+
+  // Add compile jobs
+  for (cmWorkerPool::JobHandleT& job : MocEval().CompileJobs) {
+    gen->PushJob(std::move(job), PriorityCompileMoc, {},
+                 gen->CompileMocGroup_);
+  }
+  MocEval().CompileJobs.clear();
+  for (cmWorkerPool::JobHandleT& job : UicEval().CompileJobs) {
+    gen->PushJob(std::move(job), PriorityCompileUic, {});
+  }
+  UicEval().CompileJobs.clear();
+
   if (MocConst().Enabled) {
     // Add mocs compilations job
-    Gen()->WorkerPool().EmplaceJob<JobMocsCompilationT>();
+    gen->PushJob(cm::make_unique<JobMocsCompilationT>(), PriorityDefault,
+                 { gen->CompileMocGroup_ });
   }
 
   if (!BaseConst().DepFile.empty()) {
     // Add job to merge dep files
-    Gen()->WorkerPool().EmplaceJob<JobDepFilesMergeT>();
+    gen->PushJob(cm::make_unique<JobDepFilesMergeT>(), PriorityDefault,
+                 { gen->CompileMocGroup_ });
   }
 
-  // Add finish job
-  Gen()->WorkerPool().EmplaceJob<JobFinishT>();
+  // Add finish job.  It is a fence and waits for all other jobs.
+  gen->WorkerPool().EmplaceJob<JobFinishT>();
+}
+
+std::string cmQtAutoMocUicT::JobCompileMocT::Name() const
+{
+  return cmStrCat("moc ", Mapping->SourceFile->FileName);
 }
 
 void cmQtAutoMocUicT::JobCompileMocT::Process()
@@ -2040,6 +2301,11 @@ void cmQtAutoMocUicT::JobCompileMocT::Process()
   }
 }
 
+std::string cmQtAutoMocUicT::JobCompileUicT::Name() const
+{
+  return cmStrCat("uic ", Mapping->SourceFile->FileName);
+}
+
 void cmQtAutoMocUicT::JobCompileUicT::Process()
 {
   std::string const& sourceFile = Mapping->SourceFile->FileName;
@@ -2241,6 +2507,8 @@ cmQtAutoMocUicT::~cmQtAutoMocUicT() = default;
 
 bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
 {
+  std::string sharedParseCacheFile;
+
   // -- Required settings
   if (!info.GetBool("MULTI_CONFIG", BaseConst_.MultiConfig, true) ||
       !info.GetUInt("QT_VERSION_MAJOR", BaseConst_.QtVersion.Major, true) ||
@@ -2256,6 +2524,8 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
       !info.GetString("DEP_FILE_RULE_NAME", BaseConst_.DepFileRuleName,
                       false) ||
       !info.GetStringConfig("SETTINGS_FILE", SettingsFile_, true) ||
+      !info.GetString("PARSE_CACHE_SHARED_FILE", sharedParseCacheFile,
+                      false) ||
       !info.GetArray("HEADER_EXTENSIONS", BaseConst_.HeaderExtensions, true) ||
       !info.GetString("QT_MOC_EXECUTABLE", MocConst_.Executable, false) ||
       !info.GetString("QT_UIC_EXECUTABLE", UicConst_.Executable, false)) {
@@ -2272,6 +2542,7 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
   // -- Evaluate values
   BaseConst_.ThreadCount = std::min(BaseConst_.ThreadCount, ParallelMax);
   WorkerPool_.SetThreadCount(BaseConst_.ThreadCount);
+  BaseEval_.SharedParseCache.SetFileName(std::move(sharedParseCacheFile));
 
   // -- Moc
   if (!MocConst_.Executable.empty()) {
@@ -2308,6 +2579,7 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
       MocConst_.MacroFilters.emplace_back(
         item, ("[\n][ \t]*{?[ \t]*" + item).append("[^a-zA-Z0-9_]"));
     }
+    BaseConst_.Scanner.SetMacroNames(tmp.MacroNames);
     // Can moc output dependencies or do we need to setup dependency filters?
     if (BaseConst_.QtVersion >= IntegerVersion(5, 15)) {
       MocConst_.CanOutputDependencies = true;
@@ -2359,6 +2631,20 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
         }
       }
     }
+    // Key of the settings that change the file parse results
+    {
+      cmCryptoHash cryptoHash(cmCryptoHash::AlgoSHA256);
+      cryptoHash.Initialize();
+      for (std::string const& item : tmp.MacroNames) {
+        cryptoHash.Append(item);
+        cryptoHash.Append(";");
+      }
+      if (!MocConst_.CanOutputDependencies) {
+        cryptoHash.Append(
+          info.GetValue("MOC_DEPEND_FILTERS").toStyledString());
+      }
+      BaseConst_.ParseSettingsKey = cryptoHash.FinalizeHex().substr(0, 16);
+    }
     // Check if moc executable exists (by reading the file time)
     if (!MocConst_.ExecutableTime.Load(MocConst_.Executable)) {
       return info.LogError(cmStrCat("The moc executable ",
@@ -2586,6 +2872,7 @@ void cmQtAutoMocUicT::CreateParseJobs(SourceFileMapT const& sourceMap)
 {
   cmFileTime const parseCacheTime = BaseEval().ParseCacheTime;
   ParseCacheT& parseCache = BaseEval().ParseCache;
+  SharedParseCacheT const& sharedCache = BaseEval().SharedParseCache;
   for (auto& src : sourceMap) {
     // Get or create the file parse data reference
     ParseCacheT::GetOrInsertT cacheEntry = parseCache.GetOrInsert(src.first);
@@ -2593,11 +2880,31 @@ void cmQtAutoMocUicT::CreateParseJobs(SourceFileMapT const& sourceMap)
     // Create a parse job if the cache file was missing or is older
     if (cacheEntry.second || src.second->FileTime.Newer(parseCacheTime)) {
       BaseEval().ParseCacheChanged = true;
-      WorkerPool().EmplaceJob<JOBTYPE>(src.second);
+      // Reuse the results of another target that parsed the same file
+      if (sharedCache.Enabled() &&
+          sharedCache.Lookup(SharedParseCacheKey(*src.second),
+                             src.second->FileTime, *src.second->ParseData)) {
+        if (Log().Verbose()) {
+          Log().Info(GenT::GEN,
+                     cmStrCat("Reusing the shared parse results of ",
+                              MessagePath(src.first)));
+        }
+        continue;
+      }
+      PushJob(cm::make_unique<JOBTYPE>(src.second), PriorityDefault, {},
+              ParseGroup_);
     }
   }
 }
 
+std::string cmQtAutoMocUicT::SharedParseCacheKey(
+  SourceFileT const& source) const
+{
+  return cmStrCat(source.FileName, '\n', source.IsHeader ? 'h' : 's',
+                  source.Moc ? 'M' : 'm', source.Uic ? 'U' : 'u',
+                  BaseConst().ParseSettingsKey);
+}
+
 /** Concurrently callable implementation of cmSystemTools::CollapseFullPath */
 std::string cmQtAutoMocUicT::CollapseFullPathTS(std::string const& path) const
 {
@@ -2605,11 +2912,36 @@ std::string cmQtAutoMocUicT::CollapseFullPathTS(std::string const& path) const
   return cmSystemTools::CollapseFullPath(path, ProjectDirs().CurrentSource);
 }
 
+void cmQtAutoMocUicT::PushJob(
+  cmWorkerPool::JobHandleT job, int priority,
+  std::initializer_list<cmWorkerPool::GroupHandleT> waitFor,
+  cmWorkerPool::GroupHandleT const& group)
+{
+  job->SetPriority(priority);
+  for (cmWorkerPool::GroupHandleT const& waitGroup : waitFor) {
+    job->WaitForGroup(waitGroup);
+  }
+  if (group) {
+    job->JoinGroup(group);
+  }
+  WorkerPool().PushJob(std::move(job));
+}
+
 void cmQtAutoMocUicT::InitJobs()
 {
+  // The jobs depend on each other through groups instead of fences.
+  // This lets the moc_predefs.h job run in parallel to the parse jobs
+  // and the moc and uic compile jobs run in parallel to each other.
+  PredefsGroup_ = std::make_shared<cmWorkerPool::GroupT>();
+  ParseGroup_ = std::make_shared<cmWorkerPool::GroupT>();
+  EvalGroup_ = std::make_shared<cmWorkerPool::GroupT>();
+  ProbeGroup_ = std::make_shared<cmWorkerPool::GroupT>();
+  CompileMocGroup_ = std::make_shared<cmWorkerPool::GroupT>();
+
   // Add moc_predefs.h job
   if (MocConst().Enabled && !MocConst().PredefsCmd.empty()) {
-    WorkerPool().EmplaceJob<JobMocPredefsT>();
+    PushJob(cm::make_unique<JobMocPredefsT>(), PriorityMocPredefs, {},
+            PredefsGroup_);
   }
 
   // Add header parse jobs
@@ -2617,19 +2949,18 @@ void cmQtAutoMocUicT::InitJobs()
   // Add source parse jobs
   CreateParseJobs<JobParseSourceT>(BaseEval().Sources);
 
-  // Add parse cache evaluations jobs
-  {
-    // Add a fence job to ensure all parsing has finished
-    WorkerPool().EmplaceJob<JobFenceT>();
-    if (MocConst().Enabled) {
-      WorkerPool().EmplaceJob<JobEvalCacheMocT>();
-    }
-    if (UicConst().Enabled) {
-      WorkerPool().EmplaceJob<JobEvalCacheUicT>();
-    }
-    // Add evaluate job
-    WorkerPool().EmplaceJob<JobEvalCacheFinishT>();
+  // Add parse cache evaluations jobs.  They wait for all parse jobs.
+  if (MocConst().Enabled) {
+    PushJob(cm::make_unique<JobEvalCacheMocT>(), PriorityDefault,
+            { ParseGroup_ }, EvalGroup_);
+  }
+  if (UicConst().Enabled) {
+    PushJob(cm::make_unique<JobEvalCacheUicT>(), PriorityDefault,
+            { ParseGroup_ }, EvalGroup_);
   }
+  // Add evaluate job
+  PushJob(cm::make_unique<JobEvalCacheFinishT>(), PriorityDefault,
+          { ParseGroup_, EvalGroup_ });
 }
 
 bool cmQtAutoMocUicT::Process()
@@ -2639,10 +2970,18 @@ bool cmQtAutoMocUicT::Process()
   if (!CreateDirectories()) {
     return false;
   }
+  std::string profilingDir;
+  bool const profiling =
+    cmSystemTools::GetEnv("CMAKE_AUTOGEN_PROFILING_OUTPUT", profilingDir) &&
+    !profilingDir.empty();
+  WorkerPool_.SetRecordJobTimes(profiling);
   InitJobs();
   if (!WorkerPool_.Process(this)) {
     return false;
   }
+  if (profiling) {
+    ProfilingWrite(profilingDir);
+  }
   if (JobError_) {
     return false;
   }
@@ -2655,6 +2994,32 @@ bool cmQtAutoMocUicT::Process()
   return true;
 }
 
+void cmQtAutoMocUicT::ProfilingWrite(std::string const& directory) const
+{
+  std::string fileName =
+    cmStrCat(directory, '/',
+             cmSystemTools::GetFilenameName(BaseConst().AutogenBuildDir));
+  if (!InfoConfig().empty()) {
+    fileName += cmStrCat('-', InfoConfig());
+  }
+  fileName += ".json";
+  if (!cmSystemTools::MakeDirectory(directory)) {
+    Log().Warning(GenT::GEN,
+                  cmStrCat("Creating directory ", MessagePath(directory),
+                           " for the profiling output failed."));
+    return;
+  }
+  try {
+    cmMakefileProfilingData profilingData(fileName);
+    for (cmWorkerPool::JobTimeT const& jobTime : WorkerPool_.JobTimes()) {
+      profilingData.CompleteEntry(jobTime.Name, "autogen", jobTime.Start,
+                                  jobTime.Duration, jobTime.WorkerIndex);
+    }
+  } catch (std::runtime_error const& e) {
+    Log().Warning(GenT::GEN, e.what());
+  }
+}
+
 void cmQtAutoMocUicT::SettingsFileRead()
 {
   // Compose current settings strings
@@ -2811,6 +3176,18 @@ bool cmQtAutoMocUicT::ParseCacheWrite()
       return false;
     }
   }
+  // The shared parse cache only saves time.  Failing to update it is not
+  // an error.
+  SharedParseCacheT& sharedCache = BaseEval().SharedParseCache;
+  if (sharedCache.Enabled()) {
+    std::string error;
+    if (!sharedCache.Write(&error)) {
+      Log().Warning(GenT::GEN,
+                    cmStrCat("Writing the shared parse cache file ",
+                             MessagePath(sharedCache.FileName()),
+                             " failed.\n", error));
+    }
+  }
   return true;
 }
 
@@ -0,0 +1,212 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmQtAutoMocUicScanner.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "cmStringAlgorithms.h"
+
+namespace {
+
+enum class IncludeKind
+{
+  None,
+  Moc,
+  Uic
+};
+
+bool IsNameChar(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+    (c >= '0' && c <= '9') || c == '_';
+}
+
+char const* SkipBlanks(char const* pos, char const* end)
+{
+  while (pos != end && (*pos == ' ' || *pos == '\t')) {
+    ++pos;
+  }
+  return pos;
+}
+
+/** Match "[ \t]*#[ \t]*include[ \t]+[\"<]<path>[\">]" at pos, where the
+    path is a non-empty sequence of characters other than ' ', '"' and '>'.
+    Returns the end of the match or nullptr.  */
+char const* MatchInclude(char const* pos, char const* end,
+                         cm::string_view& path)
+{
+  pos = SkipBlanks(pos, end);
+  if (pos == end || *pos != '#') {
+    return nullptr;
+  }
+  pos = SkipBlanks(pos + 1, end);
+  cm::string_view const include = "include";
+  if (static_cast<std::size_t>(end - pos) < include.size() ||
+      cm::string_view(pos, include.size()) != include) {
+    return nullptr;
+  }
+  pos += include.size();
+  char const* const blanks = pos;
+  pos = SkipBlanks(pos, end);
+  if (pos == blanks || pos == end || (*pos != '"' && *pos != '<')) {
+    return nullptr;
+  }
+  char const* const pathBegin = ++pos;
+  while (pos != end && *pos != ' ' && *pos != '"' && *pos != '>') {
+    ++pos;
+  }
+  if (pos == end || *pos == ' ' || pos == pathBegin) {
+    return nullptr;
+  }
+  path =
+    cm::string_view(pathBegin, static_cast<std::size_t>(pos - pathBegin));
+  return pos + 1;
+}
+
+/** Whether the path matches "([^ \">]+/)?<prefix>[^ \">/]+<suffix>".  */
+bool MatchPrefixedFile(cm::string_view path, cm::string_view prefix,
+                       cm::string_view suffix)
+{
+  auto const slash = path.rfind('/');
+  if (slash != cm::string_view::npos) {
+    // The directory part must not be empty
+    if (slash == 0) {
+      return false;
+    }
+    path = path.substr(slash + 1);
+  }
+  return path.size() > prefix.size() + suffix.size() &&
+    cmHasPrefix(path, prefix) && cmHasSuffix(path, suffix);
+}
+
+IncludeKind MatchIncludeKind(cm::string_view path,
+                             cmQtAutoMocUicScanner::OptionsT const& options)
+{
+  if (options.MocIncludes &&
+      (MatchPrefixedFile(path, "moc_", ".cpp") ||
+       (path.size() > 4 && cmHasLiteralSuffix(path, ".moc")))) {
+    return IncludeKind::Moc;
+  }
+  if (options.UicIncludes && MatchPrefixedFile(path, "ui_", ".h")) {
+    return IncludeKind::Uic;
+  }
+  return IncludeKind::None;
+}
+}
+
+void cmQtAutoMocUicScanner::ResultT::Clear()
+{
+  this->Macro.clear();
+  this->MocIncludes.clear();
+  this->UicIncludes.clear();
+}
+
+bool cmQtAutoMocUicScanner::SetMacroNames(
+  std::vector<std::string> const& names)
+{
+  this->MacroNames.clear();
+  this->ScanMacros = false;
+  for (std::string const& name : names) {
+    if (name.empty() || !std::all_of(name.begin(), name.end(), IsNameChar)) {
+      return false;
+    }
+  }
+  this->MacroNames = names;
+  this->ScanMacros = true;
+  return true;
+}
+
+void cmQtAutoMocUicScanner::Scan(cm::string_view content,
+                                 OptionsT const& options,
+                                 ResultT& result) const
+{
+  result.Clear();
+  bool const scanMacros = options.Macros && this->ScanMacros;
+  bool const scanIncludes = options.MocIncludes || options.UicIncludes;
+  if (!scanMacros && !scanIncludes) {
+    return;
+  }
+
+  // The regular expressions stopped at the first null character
+  content = content.substr(0, content.find('\0'));
+  char const* const begin = content.data();
+  char const* const end = begin + content.size();
+
+  // Index of the first macro name found so far
+  std::size_t macroIndex = this->MacroNames.size();
+  // An include directive that starts inside of a previous one can not
+  // match, so lines before this position are skipped.
+  char const* includeBegin = begin;
+  char const* line = begin;
+  for (;;) {
+    if (scanIncludes && line >= includeBegin) {
+      // A match is searched for again right at its end, so consecutive
+      // directives of the same kind on one line are all found.
+      IncludeKind previous = IncludeKind::None;
+      char const* pos = line;
+      for (;;) {
+        cm::string_view path;
+        char const* const matchEnd = MatchInclude(pos, end, path);
+        if (!matchEnd) {
+          break;
+        }
+        IncludeKind const kind = MatchIncludeKind(path, options);
+        if (kind == IncludeKind::None ||
+            (previous != IncludeKind::None && kind != previous)) {
+          break;
+        }
+        if (kind == IncludeKind::Moc) {
+          result.MocIncludes.emplace_back(path);
+        } else {
+          result.UicIncludes.emplace_back(path);
+        }
+        previous = kind;
+        pos = matchEnd;
+        includeBegin = matchEnd;
+      }
+    }
+
+    // A macro must follow a new line character
+    if (scanMacros && macroIndex != 0 && line != begin) {
+      char const* pos = SkipBlanks(line, end);
+      if (pos != end && *pos == '{') {
+        pos = SkipBlanks(pos + 1, end);
+      }
+      char const* nameEnd = pos;
+      while (nameEnd != end && IsNameChar(*nameEnd)) {
+        ++nameEnd;
+      }
+      // The name must be followed by another character
+      if (nameEnd != pos && nameEnd != end) {
+        cm::string_view const name(pos,
+                                   static_cast<std::size_t>(nameEnd - pos));
+        for (std::size_t ii = 0; ii != macroIndex; ++ii) {
+          if (this->MacroNames[ii] == name) {
+            macroIndex = ii;
+            break;
+          }
+        }
+      }
+    }
+    if (!scanIncludes && macroIndex == 0) {
+      break;
+    }
+
+    // Go to the next line
+    if (line == end) {
+      break;
+    }
+    void const* newLine =
+      std::memchr(line, '\n', static_cast<std::size_t>(end - line));
+    if (!newLine) {
+      break;
+    }
+    line = static_cast<char const*>(newLine) + 1;
+  }
+
+  if (macroIndex != this->MacroNames.size()) {
+    result.Macro = this->MacroNames[macroIndex];
+  }
+}
@@ -0,0 +1,82 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmQtAutoMocUicScanner_h
+#define cmQtAutoMocUicScanner_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+#include <cm/string_view>
+
+/** \class cmQtAutoMocUicScanner
+ * \brief Finds moc macros and moc/uic include directives in a source file
+ *
+ * The scanner walks the lines of a file once and looks for all of the
+ * following at the same time:
+ *
+ * - a moc macro name at the start of a line, optionally after a '{',
+ *   that is followed by a character that can not be part of a name,
+ * - #include directives of moc_<BASE>.cpp and <BASE>.moc files,
+ * - #include directives of ui_<BASE>.h files.
+ *
+ * It gives the same results as the regular expressions that AUTOMOC and
+ * AUTOUIC used to run over the file content:
+ *
+ *   [\n][ \t]*{?[ \t]*<MACRO>[^a-zA-Z0-9_]
+ *   (^|\n)[ \t]*#[ \t]*include[ \t]+
+ *     [\"<](([^ \">]+/)?moc_[^ \">/]+\.cpp|[^ \">]+\.moc)[\">]
+ *   (^|\n)[ \t]*#[ \t]*include[ \t]+[\"<](([^ \">]+/)?ui_[^ \">/]+\.h)[\">]
+ *
+ * The include expressions were applied repeatedly starting at the end of
+ * the previous match, where '^' matches again.  The scanner reproduces
+ * that, too.  Like the regular expressions it stops at the first null
+ * character.
+ */
+class cmQtAutoMocUicScanner
+{
+public:
+  /** What to scan for.  */
+  struct OptionsT
+  {
+    bool Macros = false;
+    bool MocIncludes = false;
+    bool UicIncludes = false;
+  };
+
+  /** Scan results.  */
+  struct ResultT
+  {
+    void Clear();
+
+    //! The first of the macro names that was found, or empty
+    std::string Macro;
+    //! Included moc files in the order of the directives
+    std::vector<std::string> MocIncludes;
+    //! Included ui header files in the order of the directives
+    std::vector<std::string> UicIncludes;
+  };
+
+  /**
+   * Set the moc macro names in the order of their priority.
+   *
+   * Only names of letters, digits and underscores are supported.  If any
+   * name is not supported, no macros are scanned for and false is
+   * returned.
+   */
+  bool SetMacroNames(std::vector<std::string> const& names);
+
+  /** Whether macro names are scanned for.  */
+  bool ScansMacros() const { return this->ScanMacros; }
+
+  /** Scan the content of a file.  */
+  void Scan(cm::string_view content, OptionsT const& options,
+            ResultT& result) const;
+
+private:
+  std::vector<std::string> MacroNames;
+  bool ScanMacros = false;
+};
+
+#endif
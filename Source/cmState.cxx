@@ -433,6 +433,7 @@ void cmState::AddBuiltinCommand(std::string const& name, Command command)
   assert(name == cmSystemTools::LowerCase(name));
   assert(this->BuiltinCommands.find(name) == this->BuiltinCommands.end());
   this->BuiltinCommands.emplace(name, std::move(command));
+  ++this->CommandsGeneration;
 }
 
 static bool InvokeBuiltinCommand(cmState::BuiltinCommand command,
@@ -513,6 +514,7 @@ void cmState::AddScriptedCommand(std::string const& name, Command command)
   }
 
   this->ScriptedCommands[sName] = std::move(command);
+  ++this->CommandsGeneration;
 }
 
 cmState::Command cmState::GetCommand(std::string const& name) const
@@ -521,14 +523,23 @@ cmState::Command cmState::GetCommand(std::string const& name) const
 }
 
 cmState::Command cmState::GetCommandByExactName(std::string const& name) const
+{
+  if (Command const* command = this->FindCommandByExactName(name)) {
+    return *command;
+  }
+  return nullptr;
+}
+
+cmState::Command const* cmState::FindCommandByExactName(
+  std::string const& name) const
 {
   auto pos = this->ScriptedCommands.find(name);
   if (pos != this->ScriptedCommands.end()) {
-    return pos->second;
+    return &pos->second;
   }
   pos = this->BuiltinCommands.find(name);
   if (pos != this->BuiltinCommands.end()) {
-    return pos->second;
+    return &pos->second;
   }
   return nullptr;
 }
@@ -554,11 +565,13 @@ void cmState::RemoveBuiltinCommand(std::string const& name)
 {
   assert(name == cmSystemTools::LowerCase(name));
   this->BuiltinCommands.erase(name);
+  ++this->CommandsGeneration;
 }
 
 void cmState::RemoveUserDefinedCommands()
 {
   this->ScriptedCommands.clear();
+  ++this->CommandsGeneration;
 }
 
 void cmState::SetGlobalProperty(const std::string& prop, const char* value)
@@ -157,6 +157,9 @@ public:
   Command GetCommand(std::string const& name) const;
   // Returns a command from its name, or nullptr
   Command GetCommandByExactName(std::string const& name) const;
+  // Returns the command owned by the state from its name, or nullptr.
+  // It remains valid while the commands generation is unchanged.
+  Command const* FindCommandByExactName(std::string const& name) const;
 
   void AddBuiltinCommand(std::string const& name,
                          std::unique_ptr<cmCommand> command);
@@ -169,6 +172,12 @@ public:
   void RemoveBuiltinCommand(std::string const& name);
   void RemoveUserDefinedCommands();
   std::vector<std::string> GetCommandNames() const;
+  // Returns a number that changes whenever a command is added or removed.
+  // A command looked up by name remains valid while it is unchanged.
+  unsigned long GetCommandsGeneration() const
+  {
+    return this->CommandsGeneration;
+  }
 
   void SetGlobalProperty(const std::string& prop, const char* value);
   void AppendGlobalProperty(const std::string& prop, const std::string& value,
@@ -228,6 +237,7 @@ private:
   std::vector<std::string> EnabledLanguages;
   std::map<std::string, Command> BuiltinCommands;
   std::map<std::string, Command> ScriptedCommands;
+  unsigned long CommandsGeneration = 1;
   cmPropertyMap GlobalProperties;
   std::unique_ptr<cmCacheManager> CacheManager;
   std::unique_ptr<cmGlobVerificationManager> GlobVerificationManager;
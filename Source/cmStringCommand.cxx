@@ -742,6 +742,7 @@ bool HandleRandomCommand(std::vector<std::string> const& args,
     status.SetError("sub-command RANDOM requires at least one argument.");
     return false;
   }
+  status.GetMakefile().MarkGenerateFingerprintIncomplete();
 
   static bool seeded = false;
   bool force_seed = false;
@@ -810,6 +811,7 @@ bool HandleTimestampCommand(std::vector<std::string> const& args,
     status.SetError("sub-command TIMESTAMP requires at least one argument.");
     return false;
   }
+  status.GetMakefile().MarkGenerateFingerprintIncomplete();
   if (args.size() > 4) {
     status.SetError("sub-command TIMESTAMP takes at most three arguments.");
     return false;
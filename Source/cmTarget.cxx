@@ -1114,6 +1114,7 @@ cmBacktraceRange cmTarget::GetLinkImplementationBacktraces() const
 
 void cmTarget::SetProperty(const std::string& prop, const char* value)
 {
+  impl->Makefile->GetGlobalGenerator()->InvalidateUsageRequirementsCache();
   if (!cmTargetPropertyComputer::PassesWhitelist(
         this->GetType(), prop, impl->Makefile->GetMessenger(),
         impl->Makefile->GetBacktrace())) {
@@ -1311,6 +1312,7 @@ void cmTarget::SetProperty(const std::string& prop, const char* value)
 void cmTarget::AppendProperty(const std::string& prop,
                               const std::string& value, bool asString)
 {
+  impl->Makefile->GetGlobalGenerator()->InvalidateUsageRequirementsCache();
   if (!cmTargetPropertyComputer::PassesWhitelist(
         this->GetType(), prop, impl->Makefile->GetMessenger(),
         impl->Makefile->GetBacktrace())) {
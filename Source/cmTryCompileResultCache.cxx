@@ -0,0 +1,89 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmTryCompileResultCache.h"
+
+#include <cstdlib>
+#include <iterator>
+#include <utility>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+// Bump the version whenever the layout of an entry changes.
+const char entryMagic[] = "CMakeTryCompileResult\n1\n";
+}
+
+cmTryCompileResultCache::cmTryCompileResultCache(std::string directory)
+  : Directory(std::move(directory))
+{
+}
+
+bool cmTryCompileResultCache::Lookup(std::string const& key, int& result,
+                                     std::string& output)
+{
+  std::string data;
+  {
+    cmsys::ifstream fin(this->GetEntryPath(key).c_str(),
+                        std::ios::in | std::ios::binary);
+    if (fin) {
+      data.assign(std::istreambuf_iterator<char>(fin),
+                  std::istreambuf_iterator<char>());
+    }
+  }
+
+  // The magic is followed by the result on a line of its own and then
+  // the output.
+  std::string const magic = entryMagic;
+  std::string::size_type const eol = data.find('\n', magic.size());
+  if (data.compare(0, magic.size(), magic) != 0 || eol == std::string::npos ||
+      eol == magic.size()) {
+    ++this->Misses;
+    return false;
+  }
+  std::string const value = data.substr(magic.size(), eol - magic.size());
+  char* end = nullptr;
+  long const parsed = std::strtol(value.c_str(), &end, 10);
+  if (*end != '\0') {
+    ++this->Misses;
+    return false;
+  }
+
+  ++this->Hits;
+  result = static_cast<int>(parsed);
+  output = data.substr(eol + 1);
+  return true;
+}
+
+void cmTryCompileResultCache::Store(std::string const& key, int result,
+                                    std::string const& output)
+{
+  // Write to a file of our own and move it in place so that concurrent
+  // readers and writers of the same entry never see a partial file.
+  std::string const path = this->GetEntryPath(key);
+  std::string const temp =
+    cmStrCat(path, '.', cmSystemTools::RandomSeed(), ".tmp");
+  cmSystemTools::MakeDirectory(this->Directory);
+  {
+    cmsys::ofstream fout(temp.c_str(), std::ios::out | std::ios::binary);
+    if (!fout) {
+      return;
+    }
+    fout << entryMagic << result << '\n' << output;
+    if (!fout) {
+      fout.close();
+      cmSystemTools::RemoveFile(temp);
+      return;
+    }
+  }
+  if (!cmSystemTools::RenameFile(temp, path)) {
+    cmSystemTools::RemoveFile(temp);
+  }
+}
+
+std::string cmTryCompileResultCache::GetEntryPath(std::string const& key) const
+{
+  return cmStrCat(this->Directory, '/', key, ".txt");
+}
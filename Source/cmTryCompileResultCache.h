@@ -0,0 +1,47 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmTryCompileResultCache_h
+#define cmTryCompileResultCache_h
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+
+/** \class cmTryCompileResultCache
+ * \brief User-level cache of try_compile results.
+ *
+ * A try_compile project with the same content, flags and toolchain has
+ * the same result in every build tree.  cmTryCompileResultCache keeps
+ * the results in a directory shared by all build trees of a user, one
+ * file per key, so that fresh build trees need not build the project
+ * again.  Files are replaced atomically, so concurrent runs of CMake may
+ * share the directory.
+ */
+class cmTryCompileResultCache
+{
+public:
+  cmTryCompileResultCache(std::string directory);
+
+  cmTryCompileResultCache(cmTryCompileResultCache const&) = delete;
+  cmTryCompileResultCache& operator=(cmTryCompileResultCache const&) =
+    delete;
+
+  /** Look up the result and the output of a try_compile and count a hit
+      or a miss.  */
+  bool Lookup(std::string const& key, int& result, std::string& output);
+
+  /** Record the result and the output of a try_compile.  */
+  void Store(std::string const& key, int result, std::string const& output);
+
+  unsigned long long GetHits() const { return this->Hits; }
+  unsigned long long GetMisses() const { return this->Misses; }
+
+private:
+  std::string GetEntryPath(std::string const& key) const;
+
+  std::string Directory;
+  unsigned long long Hits = 0;
+  unsigned long long Misses = 0;
+};
+
+#endif
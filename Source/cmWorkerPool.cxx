@@ -4,12 +4,15 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <deque>
 #include <functional>
+#include <iterator>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 
 #include <cm/memory>
 
@@ -387,6 +390,11 @@ public:
    */
   void SetThread(std::thread&& aThread) { Thread_ = std::move(aThread); }
 
+  /**
+   * Get the id of the internal thread
+   */
+  std::thread::id ThreadId() const { return Thread_.get_id(); }
+
   /**
    * Run an external process
    */
@@ -479,6 +487,81 @@ void cmWorkerPoolWorker::UVProcessFinished()
   Proc_.Condition.notify_one();
 }
 
+/**
+ * @brief Job queue ordered by job priority
+ */
+class cmWorkerPoolQueue
+{
+public:
+  /**
+   * Insert a job behind the queued jobs of the same or higher priority.
+   */
+  void Push(cmWorkerPool::JobHandleT&& jobHandle);
+
+  /**
+   * Take the first job.  Returns false if the queue is empty.
+   */
+  bool Pop(cmWorkerPool::JobHandleT& jobHandle);
+
+  /**
+   * Get the priority of the first job.  Returns false if the queue is empty.
+   */
+  bool FrontPriority(int& priority);
+
+  /**
+   * Remove all jobs and return their number.
+   */
+  std::size_t Clear();
+
+private:
+  std::mutex Mutex_;
+  std::deque<cmWorkerPool::JobHandleT> Jobs_;
+};
+
+void cmWorkerPoolQueue::Push(cmWorkerPool::JobHandleT&& jobHandle)
+{
+  int const priority = jobHandle->Priority();
+  std::lock_guard<std::mutex> lock(Mutex_);
+  // Most jobs have the priority of the last job, so search from the back.
+  auto it = Jobs_.end();
+  while (it != Jobs_.begin() && (*(it - 1))->Priority() < priority) {
+    --it;
+  }
+  Jobs_.insert(it, std::move(jobHandle));
+}
+
+bool cmWorkerPoolQueue::Pop(cmWorkerPool::JobHandleT& jobHandle)
+{
+  std::lock_guard<std::mutex> lock(Mutex_);
+  if (Jobs_.empty()) {
+    return false;
+  }
+  jobHandle = std::move(Jobs_.front());
+  Jobs_.pop_front();
+  return true;
+}
+
+bool cmWorkerPoolQueue::FrontPriority(int& priority)
+{
+  std::lock_guard<std::mutex> lock(Mutex_);
+  if (Jobs_.empty()) {
+    return false;
+  }
+  priority = Jobs_.front()->Priority();
+  return true;
+}
+
+std::size_t cmWorkerPoolQueue::Clear()
+{
+  std::deque<cmWorkerPool::JobHandleT> jobs;
+  {
+    std::lock_guard<std::mutex> lock(Mutex_);
+    jobs.swap(Jobs_);
+  }
+  // Destroy the jobs outside of the lock
+  return jobs.size();
+}
+
 /**
  * @brief Private worker pool internals
  */
@@ -500,7 +583,7 @@ public:
   void Abort();
 
   /**
-   * Push a job to the queue and notify a worker.
+   * Push a job to a queue and notify a worker.
    */
   bool PushJob(cmWorkerPool::JobHandleT&& jobHandle);
 
@@ -513,6 +596,32 @@ public:
   static void UVSlotBegin(uv_async_t* handle);
   static void UVSlotEnd(uv_async_t* handle);
 
+private:
+  /**
+   * Queue of the calling thread.  Requires the Mutex to be locked.
+   */
+  cmWorkerPoolQueue& ThreadQueue();
+
+  /**
+   * Queue a job that does not wait for any group and notify a worker.
+   * Requires the Mutex to be locked.
+   */
+  void QueueJob(cmWorkerPoolQueue& queue,
+                cmWorkerPool::JobHandleT&& jobHandle);
+
+  /**
+   * Take the next job for a worker.  This is the first job of the worker's
+   * queue or, if that is empty, the job with the highest priority at the
+   * front of the queue of another thread.
+   */
+  bool TakeJob(unsigned int workerIndex, cmWorkerPool::JobHandleT& jobHandle);
+
+  /**
+   * Destroy a processed job and queue the jobs waiting for its groups.
+   */
+  void FinishJob(unsigned int workerIndex,
+                 cmWorkerPool::JobHandleT& jobHandle);
+
 public:
   // -- UV loop
 #ifdef CMAKE_UV_SIGNAL_HACK
@@ -522,17 +631,32 @@ public:
   cm::uv_async_ptr UVRequestBegin;
   cm::uv_async_ptr UVRequestEnd;
 
-  // -- Thread pool and job queue
+  // -- Thread pool and job queues
   std::mutex Mutex;
   bool Processing = false;
   bool Aborting = false;
-  bool FenceProcessing = false;
+  bool WorkersStarted = false;
   unsigned int WorkersRunning = 0;
   unsigned int WorkersIdle = 0;
-  unsigned int JobsProcessing = 0;
-  std::deque<cmWorkerPool::JobHandleT> Queue;
+  //! Number of jobs in all queues
+  std::atomic<std::size_t> JobsQueued;
+  //! Jobs pushed since the last fence job
+  cmWorkerPool::GroupHandleT EpochGroup;
+  //! The last fence job
+  cmWorkerPool::GroupHandleT FenceGroup;
+  //! Jobs waiting for groups
+  std::unordered_map<cmWorkerPool::JobT*, cmWorkerPool::JobHandleT>
+    BlockedJobs;
+  //! Queue for jobs pushed from threads other than the workers
+  cmWorkerPoolQueue SharedQueue;
+  //! Queues of the workers
+  std::vector<std::unique_ptr<cmWorkerPoolQueue>> Queues;
+  std::vector<std::thread::id> WorkerThreadIds;
   std::condition_variable Condition;
   std::vector<std::unique_ptr<cmWorkerPoolWorker>> Workers;
+  //! Job times recorded by each worker
+  bool RecordJobTimes = false;
+  std::vector<std::vector<cmWorkerPool::JobTimeT>> JobTimes;
 
   // -- References
   cmWorkerPool* Pool = nullptr;
@@ -557,7 +681,10 @@ void cmWorkerPool::ProcessResultT::reset()
 }
 
 cmWorkerPoolInternal::cmWorkerPoolInternal(cmWorkerPool* pool)
-  : Pool(pool)
+  : JobsQueued(0)
+  , EpochGroup(std::make_shared<cmWorkerPool::GroupT>())
+  , FenceGroup(std::make_shared<cmWorkerPool::GroupT>())
+  , Pool(pool)
 {
   // Initialize libuv loop
   uv_disable_stdio_inheritance();
@@ -575,9 +702,18 @@ cmWorkerPoolInternal::~cmWorkerPoolInternal()
 
 bool cmWorkerPoolInternal::Process()
 {
+  unsigned int const num = Pool->ThreadCount();
   // Reset state flags
   Processing = true;
   Aborting = false;
+  WorkersStarted = false;
+  // Create the worker queues
+  Queues.clear();
+  for (unsigned int ii = 0; ii != num; ++ii) {
+    Queues.emplace_back(cm::make_unique<cmWorkerPoolQueue>());
+  }
+  JobTimes.clear();
+  JobTimes.resize(num);
   // Initialize libuv asynchronous request
   UVRequestBegin.init(*UVLoop, &cmWorkerPoolInternal::UVSlotBegin, this);
   UVRequestEnd.init(*UVLoop, &cmWorkerPoolInternal::UVSlotEnd, this);
@@ -588,19 +724,31 @@ bool cmWorkerPoolInternal::Process()
   // Update state flags
   Processing = false;
   Aborting = false;
+  // Forget the jobs that were not processed
+  JobsQueued -= SharedQueue.Clear();
+  BlockedJobs.clear();
+  Queues.clear();
+  WorkerThreadIds.clear();
+  EpochGroup = std::make_shared<cmWorkerPool::GroupT>();
+  FenceGroup = std::make_shared<cmWorkerPool::GroupT>();
   return success;
 }
 
 void cmWorkerPoolInternal::Abort()
 {
   bool notifyThreads = false;
+  std::unordered_map<cmWorkerPool::JobT*, cmWorkerPool::JobHandleT> blocked;
   // Clear all jobs and set abort flag
   {
     std::lock_guard<std::mutex> guard(Mutex);
     if (Processing && !Aborting) {
-      // Register abort and clear queue
+      // Register abort and clear queues
       Aborting = true;
-      Queue.clear();
+      JobsQueued -= SharedQueue.Clear();
+      for (auto& queue : Queues) {
+        JobsQueued -= queue->Clear();
+      }
+      blocked.swap(BlockedJobs);
       notifyThreads = true;
     }
   }
@@ -610,22 +758,146 @@ void cmWorkerPoolInternal::Abort()
   }
 }
 
-inline bool cmWorkerPoolInternal::PushJob(cmWorkerPool::JobHandleT&& jobHandle)
+cmWorkerPoolQueue& cmWorkerPoolInternal::ThreadQueue()
 {
-  std::lock_guard<std::mutex> guard(Mutex);
-  if (Aborting) {
-    return false;
+  if (WorkersStarted) {
+    std::thread::id const id = std::this_thread::get_id();
+    for (std::size_t ii = 0; ii != WorkerThreadIds.size(); ++ii) {
+      if (WorkerThreadIds[ii] == id) {
+        return *Queues[ii];
+      }
+    }
   }
-  // Append the job to the queue
-  Queue.emplace_back(std::move(jobHandle));
+  return SharedQueue;
+}
+
+void cmWorkerPoolInternal::QueueJob(cmWorkerPoolQueue& queue,
+                                    cmWorkerPool::JobHandleT&& jobHandle)
+{
+  queue.Push(std::move(jobHandle));
+  ++JobsQueued;
   // Notify an idle worker if there's one
   if (WorkersIdle != 0) {
     Condition.notify_one();
   }
-  // Return success
+}
+
+bool cmWorkerPoolInternal::PushJob(cmWorkerPool::JobHandleT&& jobHandle)
+{
+  std::lock_guard<std::mutex> guard(Mutex);
+  if (Aborting) {
+    return false;
+  }
+  cmWorkerPool::JobT& job = *jobHandle;
+
+  // A fence job waits for all jobs pushed before it, and all jobs pushed
+  // after it wait for the fence job.
+  job.WaitGroups_.push_back(FenceGroup);
+  if (job.IsFence()) {
+    job.WaitGroups_.push_back(EpochGroup);
+    FenceGroup = std::make_shared<cmWorkerPool::GroupT>();
+    EpochGroup = std::make_shared<cmWorkerPool::GroupT>();
+    job.Groups_.push_back(FenceGroup);
+  } else {
+    job.Groups_.push_back(EpochGroup);
+  }
+
+  // Register the job with the groups it waits for that have jobs left to
+  // process.  It waits only for the jobs that joined them so far.
+  job.Blockers_ = 0;
+  for (cmWorkerPool::GroupHandleT const& group : job.WaitGroups_) {
+    std::size_t const joined = group->Processed_.size();
+    if (group->ProcessedFront_ != joined) {
+      group->Waiters_.emplace_back(joined, &job);
+      ++job.Blockers_;
+    }
+  }
+  job.WaitGroups_.clear();
+  job.GroupIndices_.clear();
+  for (cmWorkerPool::GroupHandleT const& group : job.Groups_) {
+    job.GroupIndices_.push_back(group->Processed_.size());
+    group->Processed_.push_back(false);
+  }
+
+  if (job.Blockers_ != 0) {
+    BlockedJobs.emplace(&job, std::move(jobHandle));
+  } else {
+    QueueJob(ThreadQueue(), std::move(jobHandle));
+  }
   return true;
 }
 
+bool cmWorkerPoolInternal::TakeJob(unsigned int workerIndex,
+                                   cmWorkerPool::JobHandleT& jobHandle)
+{
+  if (Queues[workerIndex]->Pop(jobHandle)) {
+    return true;
+  }
+  // Steal a job.  Retry if another worker took it first.
+  while (true) {
+    cmWorkerPoolQueue* best = nullptr;
+    int bestPriority = 0;
+    int priority = 0;
+    if (SharedQueue.FrontPriority(priority)) {
+      best = &SharedQueue;
+      bestPriority = priority;
+    }
+    for (auto const& queue : Queues) {
+      if (queue->FrontPriority(priority) &&
+          (best == nullptr || priority > bestPriority)) {
+        best = queue.get();
+        bestPriority = priority;
+      }
+    }
+    if (best == nullptr) {
+      return false;
+    }
+    if (best->Pop(jobHandle)) {
+      return true;
+    }
+  }
+}
+
+void cmWorkerPoolInternal::FinishJob(unsigned int workerIndex,
+                                     cmWorkerPool::JobHandleT& jobHandle)
+{
+  std::vector<cmWorkerPool::GroupHandleT> groups;
+  std::vector<std::size_t> indices;
+  groups.swap(jobHandle->Groups_);
+  indices.swap(jobHandle->GroupIndices_);
+  jobHandle.reset(); // Destroy job
+
+  std::lock_guard<std::mutex> guard(Mutex);
+  if (Aborting) {
+    return;
+  }
+  for (std::size_t ii = 0; ii != groups.size(); ++ii) {
+    cmWorkerPool::GroupT& group = *groups[ii];
+    group.Processed_[indices[ii]] = true;
+    if (indices[ii] != group.ProcessedFront_) {
+      continue;
+    }
+    while (group.ProcessedFront_ != group.Processed_.size() &&
+           group.Processed_[group.ProcessedFront_]) {
+      ++group.ProcessedFront_;
+    }
+    // Queue the jobs that no longer wait for any group.
+    auto const released = std::partition(
+      group.Waiters_.begin(), group.Waiters_.end(),
+      [&group](std::pair<std::size_t, cmWorkerPool::JobT*> const& waiter) {
+        return waiter.first > group.ProcessedFront_;
+      });
+    for (auto it = released; it != group.Waiters_.end(); ++it) {
+      if (--it->second->Blockers_ == 0) {
+        auto blocked = BlockedJobs.find(it->second);
+        QueueJob(*Queues[workerIndex], std::move(blocked->second));
+        BlockedJobs.erase(blocked);
+      }
+    }
+    group.Waiters_.erase(released, group.Waiters_.end());
+  }
+}
+
 void cmWorkerPoolInternal::UVSlotBegin(uv_async_t* handle)
 {
   auto& gint = *reinterpret_cast<cmWorkerPoolInternal*>(handle->data);
@@ -643,6 +915,15 @@ void cmWorkerPoolInternal::UVSlotBegin(uv_async_t* handle)
       gint.Workers[ii]->SetThread(
         std::thread(&cmWorkerPoolInternal::Work, &gint, ii));
     }
+    // Let the workers process jobs once their thread ids are known
+    {
+      std::lock_guard<std::mutex> guard(gint.Mutex);
+      for (auto const& worker : gint.Workers) {
+        gint.WorkerThreadIds.push_back(worker->ThreadId());
+      }
+      gint.WorkersStarted = true;
+    }
+    gint.Condition.notify_all();
   }
   // Destroy begin request
   gint.UVRequestBegin.reset();
@@ -659,56 +940,53 @@ void cmWorkerPoolInternal::UVSlotEnd(uv_async_t* handle)
 
 void cmWorkerPoolInternal::Work(unsigned int workerIndex)
 {
-  cmWorkerPool::JobHandleT jobHandle;
-  std::unique_lock<std::mutex> uLock(Mutex);
-  // Increment running workers count
-  ++WorkersRunning;
+  {
+    std::unique_lock<std::mutex> uLock(Mutex);
+    // Increment running workers count
+    ++WorkersRunning;
+    // Wait until all workers were started
+    while (!WorkersStarted) {
+      Condition.wait(uLock);
+    }
+  }
+
   // Enter worker main loop
+  cmWorkerPool::JobHandleT jobHandle;
+  std::vector<cmWorkerPool::JobTimeT>& jobTimes = JobTimes[workerIndex];
   while (true) {
+    if (TakeJob(workerIndex, jobHandle)) {
+      --JobsQueued;
+      // Process job
+      if (RecordJobTimes) {
+        cmWorkerPool::JobTimeT jobTime;
+        jobTime.Name = jobHandle->Name();
+        jobTime.WorkerIndex = workerIndex;
+        jobTime.Start = std::chrono::steady_clock::now();
+        jobHandle->Work(Pool, workerIndex);
+        jobTime.Duration = std::chrono::steady_clock::now() - jobTime.Start;
+        jobTimes.push_back(std::move(jobTime));
+      } else {
+        jobHandle->Work(Pool, workerIndex);
+      }
+      FinishJob(workerIndex, jobHandle);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> uLock(Mutex);
     // Abort on request
     if (Aborting) {
       break;
     }
     // Wait for new jobs
-    if (Queue.empty()) {
+    if (JobsQueued == 0) {
       ++WorkersIdle;
       Condition.wait(uLock);
       --WorkersIdle;
-      continue;
-    }
-
-    // Check for fence jobs
-    if (FenceProcessing || Queue.front()->IsFence()) {
-      if (JobsProcessing != 0) {
-        Condition.wait(uLock);
-        continue;
-      }
-      // No jobs get processed. Set the fence job processing flag.
-      FenceProcessing = true;
-    }
-
-    // Pop next job from queue
-    jobHandle = std::move(Queue.front());
-    Queue.pop_front();
-
-    // Unlocked scope for job processing
-    ++JobsProcessing;
-    {
-      uLock.unlock();
-      jobHandle->Work(Pool, workerIndex); // Process job
-      jobHandle.reset();                  // Destroy job
-      uLock.lock();
-    }
-    --JobsProcessing;
-
-    // Was this a fence job?
-    if (FenceProcessing) {
-      FenceProcessing = false;
-      Condition.notify_all();
     }
   }
 
   // Decrement running workers count
+  std::lock_guard<std::mutex> guard(Mutex);
   if (--WorkersRunning == 0) {
     // Last worker thread about to finish. Send libuv event.
     UVRequestEnd.send();
@@ -717,6 +995,11 @@ void cmWorkerPoolInternal::Work(unsigned int workerIndex)
 
 cmWorkerPool::JobT::~JobT() = default;
 
+std::string cmWorkerPool::JobT::Name() const
+{
+  return IsFence() ? "fence" : "job";
+}
+
 bool cmWorkerPool::JobT::RunProcess(ProcessResultT& result,
                                     std::vector<std::string> const& command,
                                     std::string const& workingDirectory)
@@ -740,12 +1023,31 @@ void cmWorkerPool::SetThreadCount(unsigned int threadCount)
   }
 }
 
+void cmWorkerPool::SetRecordJobTimes(bool record)
+{
+  if (!Int_->Processing) {
+    RecordJobTimes_ = record;
+  }
+}
+
 bool cmWorkerPool::Process(void* userData)
 {
   // Setup user data
   UserData_ = userData;
+  Int_->RecordJobTimes = RecordJobTimes_;
   // Run libuv loop
   bool success = Int_->Process();
+  // Collect the job times of all workers
+  JobTimes_.clear();
+  for (auto& jobTimes : Int_->JobTimes) {
+    std::move(jobTimes.begin(), jobTimes.end(),
+              std::back_inserter(JobTimes_));
+  }
+  Int_->JobTimes.clear();
+  std::stable_sort(JobTimes_.begin(), JobTimes_.end(),
+            [](JobTimeT const& a, JobTimeT const& b) {
+              return a.Start < b.Start;
+            });
   // Clear user data
   UserData_ = nullptr;
   // Return
@@ -5,7 +5,10 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -16,11 +19,62 @@
 class cmWorkerPoolInternal;
 
 /** @class cmWorkerPool
- * @brief Thread pool with job queue
+ * @brief Thread pool with per worker job queues
+ *
+ * Every worker thread has its own job queue.  Jobs pushed from inside a job
+ * are queued for the worker that processes it.  An idle worker takes jobs
+ * from the queues of other workers.  Queued jobs are processed by priority,
+ * and in queue order for equal priorities.
+ *
+ * The order of jobs can be constrained by fence jobs and by groups.
  */
 class cmWorkerPool
 {
 public:
+  class JobT;
+
+  /**
+   * A set of jobs that other jobs can wait for.
+   *
+   * A job that waits for a group is not processed before all jobs that
+   * joined the group before it was pushed have been processed.  Jobs that
+   * join the group later do not hold it back.
+   */
+  class GroupT
+  {
+  public:
+    GroupT() = default;
+    GroupT(GroupT const&) = delete;
+    GroupT& operator=(GroupT const&) = delete;
+
+  private:
+    //! Needs access to the job counters
+    friend class cmWorkerPoolInternal;
+    //! Whether each pushed job of this group, in push order, was processed
+    std::vector<bool> Processed_;
+    //! Number of leading pushed jobs that were all processed
+    std::size_t ProcessedFront_ = 0;
+    //! Pushed jobs waiting for this group, each with the number of
+    //! leading jobs it waits for
+    std::vector<std::pair<std::size_t, JobT*>> Waiters_;
+  };
+
+  /**
+   * Group handle type
+   */
+  using GroupHandleT = std::shared_ptr<GroupT>;
+
+  /**
+   * Processing time of a job.
+   */
+  struct JobTimeT
+  {
+    std::string Name;
+    unsigned int WorkerIndex = 0;
+    std::chrono::steady_clock::time_point Start;
+    std::chrono::steady_clock::duration Duration;
+  };
+
   /**
    * Return value and output of an external process.
    */
@@ -57,12 +111,41 @@ public:
      * Fence job flag
      *
      * Fence jobs require that:
-     * - all jobs before in the queue have been processed
-     * - no jobs later in the queue will be processed before this job was
+     * - all jobs pushed before have been processed
+     * - no jobs pushed later will be processed before this job was
      *   processed
      */
     bool IsFence() const { return Fence_; }
 
+    /**
+     * Job priority.  Queued jobs with a higher priority are processed first.
+     */
+    int Priority() const { return Priority_; }
+
+    /**
+     * Set the job priority.  Must be called before the job is pushed.
+     */
+    void SetPriority(int priority) { Priority_ = priority; }
+
+    /**
+     * Add the job to a group.  Must be called before the job is pushed.
+     */
+    void JoinGroup(GroupHandleT group) { Groups_.push_back(std::move(group)); }
+
+    /**
+     * Do not process the job before the jobs of a group.  Must be called
+     * before the job is pushed.  A job must not wait for its own group.
+     */
+    void WaitForGroup(GroupHandleT group)
+    {
+      WaitGroups_.push_back(std::move(group));
+    }
+
+    /**
+     * Name of the job in the job times.
+     */
+    virtual std::string Name() const;
+
   protected:
     /**
      * Protected default constructor
@@ -121,6 +204,13 @@ public:
     cmWorkerPool* Pool_ = nullptr;
     unsigned int WorkerIndex_ = 0;
     bool Fence_ = false;
+    int Priority_ = 0;
+    //! Number of groups that must finish before this job can be processed
+    unsigned int Blockers_ = 0;
+    std::vector<GroupHandleT> Groups_;
+    //! Push order of this job in each of its groups
+    std::vector<std::size_t> GroupIndices_;
+    std::vector<GroupHandleT> WaitGroups_;
   };
 
   /**
@@ -171,6 +261,19 @@ public:
    */
   void SetThreadCount(unsigned int threadCount);
 
+  /**
+   * Enable recording the processing time of each job.
+   *
+   * Calling this method during Process() has no effect.
+   */
+  void SetRecordJobTimes(bool record);
+
+  /**
+   * Processing times of the jobs of the last Process() call, ordered by
+   * start time.  Only recorded if enabled by SetRecordJobTimes().
+   */
+  std::vector<JobTimeT> const& JobTimes() const { return JobTimes_; }
+
   /**
    * Blocking function that starts threads to process all Jobs in the queue.
    *
@@ -219,6 +322,8 @@ public:
 private:
   void* UserData_ = nullptr;
   unsigned int ThreadCount_ = 1;
+  bool RecordJobTimes_ = false;
+  std::vector<JobTimeT> JobTimes_;
   std::unique_ptr<cmWorkerPoolInternal> Int_;
 };
 
@@ -7,6 +7,7 @@
 #include "cm_sys_stat.h"
 
 #include "cmExecutionStatus.h"
+#include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
@@ -44,6 +45,8 @@ bool cmWriteFileCommand(std::vector<std::string> const& args,
 
   std::string dir = cmSystemTools::GetFilenamePath(fileName);
   cmSystemTools::MakeDirectory(dir);
+  status.GetMakefile().GetGlobalGenerator()->InvalidateFindDirectoryContent(
+    fileName);
 
   mode_t mode = 0;
   bool writable = false;
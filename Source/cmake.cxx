@@ -10,8 +10,10 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <utility>
 
+#include <cm/algorithm>
 #include <cm/memory>
 #include <cm/string_view>
 #if defined(_WIN32) && !defined(__CYGWIN__) && !defined(CMAKE_BOOT_MINGW)
@@ -28,11 +30,13 @@
 
 #include "cmAlgorithms.h"
 #include "cmCommands.h"
+#include "cmConditionEvaluator.h"
 #include "cmDocumentation.h"
 #include "cmDocumentationEntry.h"
 #include "cmDocumentationFormatter.h"
 #include "cmDuration.h"
 #include "cmExternalMakefileProjectGenerator.h"
+#include "cmFileTime.h"
 #include "cmFileTimeCache.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobalGenerator.h"
@@ -51,6 +55,7 @@
 #include "cmTarget.h"
 #include "cmTargetLinkLibraryType.h"
 #include "cmUtils.hxx"
+#include "cmVersion.h"
 #include "cmVersionConfig.h"
 #include "cmWorkingDirectory.h"
 
@@ -60,7 +65,12 @@
 #  include "cm_jsoncpp_writer.h"
 
 #  include "cmFileAPI.h"
+#  include "cmGenerateFingerprint.h"
+#  include "cmGeneratorExpressionEvaluationFile.h"
 #  include "cmGraphVizWriter.h"
+#  include "cmListFileParseCache.h"
+#  include "cmListFilePrefetcher.h"
+#  include "cmTryCompileResultCache.h"
 #  include "cmVariableWatch.h"
 #endif
 
@@ -148,6 +158,7 @@ static void cmWarnUnusedCliWarning(const std::string& variable, int /*unused*/,
 
 cmake::cmake(Role role, cmState::Mode mode)
   : FileTimeCache(cm::make_unique<cmFileTimeCache>())
+  , ConditionCache(cm::make_unique<cmConditionCache>())
 #ifndef CMAKE_BOOTSTRAP
   , VariableWatch(cm::make_unique<cmVariableWatch>())
 #endif
@@ -861,6 +872,8 @@ void cmake::SetArgs(const std::vector<std::string>& args)
       if (profilingOutput.empty()) {
         cmSystemTools::Error("No path specified for --profiling-output");
       }
+    } else if (arg == "--try-compile-cache-stats") {
+      this->TryCompileCacheStats = true;
 #endif
     }
     // no option assume it is the path to the source or an existing build
@@ -1651,10 +1664,104 @@ int cmake::ActualConfigure()
 #if !defined(CMAKE_BOOTSTRAP)
   this->FileAPI = cm::make_unique<cmFileAPI>(this);
   this->FileAPI->ReadQueries();
+
+  // Reuse the parse results of list files that did not change since
+  // the last configure of this build tree.
+  if (!this->State->GetIsInTryCompile()) {
+    this->ListFileParseCache = cm::make_unique<cmListFileParseCache>(cmStrCat(
+      this->GetHomeOutputDirectory(), "/CMakeFiles/ListFileCache.bin"));
+    this->ListFileParseCache->Load();
+
+    // Parse the list files named by add_subdirectory() and include()
+    // calls ahead of their execution.
+    this->ListFilePrefetcher = cm::make_unique<cmListFilePrefetcher>(
+      this->ListFileParseCache.get(),
+      cm::clamp(std::thread::hardware_concurrency(), 1u, 4u));
+  }
+
+  // Reuse try_compile results of other build trees if the user asked.
+  this->TryCompileResultCache.reset();
+  std::string tryCompileCacheDir;
+  if (!this->State->GetIsInTryCompile() &&
+      cmSystemTools::GetEnv("CMAKE_TRY_COMPILE_CACHE_DIR",
+                            tryCompileCacheDir) &&
+      !tryCompileCacheDir.empty()) {
+    this->TryCompileResultCache =
+      cm::make_unique<cmTryCompileResultCache>(tryCompileCacheDir);
+  }
+
+  // Fingerprint the configured state to know whether the generate step
+  // would produce the same build system as last time.  Only projects
+  // that opted in pay for hashing every command.  The stamp file of the
+  // last generate step records that they did.
+  this->GenerateFingerprint.reset();
+  bool const canSkipGenerate = !this->State->GetIsInTryCompile() &&
+    this->GlobalGenerator->SupportsSkippingGenerate();
+  std::string const fingerprintFile = cmStrCat(
+    this->GetHomeOutputDirectory(), "/CMakeFiles/GenerateFingerprint.txt");
+  std::string const* skipUnchanged =
+    this->State->GetInitializedCacheValue("CMAKE_SKIP_UNCHANGED_GENERATE");
+  if (canSkipGenerate &&
+      (cmSystemTools::FileExists(fingerprintFile, true) ||
+       (skipUnchanged && cmIsOn(*skipUnchanged)))) {
+    this->GenerateFingerprint =
+      cm::make_unique<cmGenerateFingerprint>(fingerprintFile);
+    // Another cmake binary of the same version may generate differently.
+    std::string const& cmakeCommand = cmSystemTools::GetCMakeCommand();
+    cmFileTime cmakeCommandTime;
+    cmakeCommandTime.Load(cmakeCommand);
+    for (std::string const& s :
+         { std::string(cmVersion::GetCMakeVersion()), cmakeCommand,
+           std::to_string(cmakeCommandTime.GetNS()),
+           this->GlobalGenerator->GetName(), this->GeneratorPlatform,
+           this->GeneratorToolset, this->GeneratorInstance,
+           this->GetHomeDirectory(), this->GetHomeOutputDirectory() }) {
+      this->GenerateFingerprint->Append(s);
+    }
+  }
 #endif
 
   // actually do the configure
   this->GlobalGenerator->Configure();
+
+#if !defined(CMAKE_BOOTSTRAP)
+  if (this->ListFilePrefetcher) {
+    if (this->IsProfilingEnabled()) {
+      this->ProfilingOutput->Counter(
+        "ListFilePrefetch",
+        { { "hits", this->ListFilePrefetcher->GetHits() },
+          { "misses", this->ListFilePrefetcher->GetMisses() } });
+    }
+    this->ListFilePrefetcher.reset();
+  }
+  if (this->ListFileParseCache) {
+    if (!cmSystemTools::GetFatalErrorOccured()) {
+      this->ListFileParseCache->Save();
+    }
+    if (this->IsProfilingEnabled()) {
+      this->ProfilingOutput->Counter(
+        "ListFileCache",
+        { { "hits", this->ListFileParseCache->GetHits() },
+          { "misses", this->ListFileParseCache->GetMisses() } });
+    }
+    this->ListFileParseCache.reset();
+  }
+  if (this->TryCompileResultCache) {
+    unsigned long long const hits = this->TryCompileResultCache->GetHits();
+    unsigned long long const misses =
+      this->TryCompileResultCache->GetMisses();
+    if (this->TryCompileCacheStats) {
+      this->UpdateProgress(cmStrCat("try_compile result cache: ", hits,
+                                    " hits, ", misses, " misses"),
+                           -1);
+    }
+    if (this->IsProfilingEnabled()) {
+      this->ProfilingOutput->Counter(
+        "TryCompileResultCache", { { "hits", hits }, { "misses", misses } });
+    }
+    this->TryCompileResultCache.reset();
+  }
+#endif
   // Before saving the cache
   // if the project did not define one of the entries below, add them now
   // so users can edit the values in the cache:
@@ -1692,12 +1799,73 @@ int cmake::ActualConfigure()
 
   this->State->SaveVerificationScript(this->GetHomeOutputDirectory());
   this->SaveCache(this->GetHomeOutputDirectory());
+
+#if !defined(CMAKE_BOOTSTRAP)
+  if (canSkipGenerate && !cmSystemTools::GetErrorOccuredFlag() &&
+      !this->GenerateFingerprint &&
+      this->GlobalGenerator->GetMakefiles()[0]->IsOn(
+        "CMAKE_SKIP_UNCHANGED_GENERATE")) {
+    // The project opted in during a configure step that was not
+    // fingerprinted.  Generate, and record the opt-in for the next one.
+    this->GenerateFingerprint =
+      cm::make_unique<cmGenerateFingerprint>(fingerprintFile);
+    this->GenerateFingerprint->MarkIncomplete();
+  }
+  if (this->GenerateFingerprint) {
+    if (cmSystemTools::GetErrorOccuredFlag()) {
+      this->GenerateFingerprint.reset();
+    } else if (!this->GlobalGenerator->GetMakefiles()[0]->IsOn(
+                 "CMAKE_SKIP_UNCHANGED_GENERATE")) {
+      // Projects opt in to skipping the generate step.
+      this->GenerateFingerprint->Discard();
+      this->GenerateFingerprint.reset();
+    } else {
+      for (std::string const& key : this->State->GetCacheEntryKeys()) {
+        this->GenerateFingerprint->Append(key);
+        this->GenerateFingerprint->Append(cmState::CacheEntryTypeToString(
+          this->State->GetCacheEntryType(key)));
+        this->GenerateFingerprint->Append(
+          *this->State->GetCacheEntryValue(key));
+      }
+      this->GenerateFingerprint->Finalize();
+    }
+  }
+#endif
+
   if (cmSystemTools::GetErrorOccuredFlag()) {
     return -1;
   }
   return 0;
 }
 
+#if !defined(CMAKE_BOOTSTRAP)
+bool cmake::CanSkipGenerate()
+{
+  if (!this->GenerateFingerprint || !this->GraphVizFile.empty() ||
+      this->FileAPI->HasQueries()) {
+    return false;
+  }
+
+  // Some inputs of the generate step are not part of the fingerprint.
+  for (auto const& mf : this->GlobalGenerator->GetMakefiles()) {
+    for (auto const& ef : mf->GetEvaluationFiles()) {
+      if (!ef->GetInputIsContent()) {
+        return false;
+      }
+    }
+    for (auto const& t : mf->GetTargets()) {
+      if (t.second.GetPropertyAsBool("AUTOMOC") ||
+          t.second.GetPropertyAsBool("AUTOUIC") ||
+          t.second.GetPropertyAsBool("AUTORCC")) {
+        return false;
+      }
+    }
+  }
+
+  return this->GenerateFingerprint->Matches();
+}
+#endif
+
 std::unique_ptr<cmGlobalGenerator> cmake::EvaluateDefaultGlobalGenerator()
 {
   if (!this->EnvironmentGenerator.empty()) {
@@ -1903,10 +2071,46 @@ int cmake::Generate()
   if (!this->GlobalGenerator) {
     return -1;
   }
-  if (!this->GlobalGenerator->Compute()) {
-    return -1;
+  bool skipped = false;
+#if !defined(CMAKE_BOOTSTRAP)
+  std::map<std::string, bool> writtenFiles;
+  unsigned long long const messageCount =
+    this->Messenger->GetDisplayedMessageCount();
+  if (this->CanSkipGenerate()) {
+    // The build system would not change.  Only update the files that
+    // the generate step would have rewritten anyway.
+    this->GenerateFingerprint->TouchRewrittenFiles();
+    if (this->GetLogLevel() >= LogLevel::LOG_VERBOSE) {
+      this->UpdateProgress("Build system unchanged, skipping generation", -1);
+    }
+    this->UpdateProgress("Generating done", -1);
+    skipped = true;
+  } else if (this->GenerateFingerprint) {
+    this->GenerateFingerprint->Discard();
+    cmGeneratedFileStream::SetWrittenFiles(&writtenFiles);
+  }
+#endif
+  if (!skipped) {
+    bool const computed = this->GlobalGenerator->Compute();
+    if (computed) {
+      this->GlobalGenerator->Generate();
+#if !defined(CMAKE_BOOTSTRAP)
+      if (this->IsProfilingEnabled()) {
+        auto const& cache =
+          this->GlobalGenerator->GetUsageRequirementsCache();
+        this->ProfilingOutput->Counter(
+          "UsageRequirementsCache",
+          { { "hits", cache.Hits }, { "misses", cache.Misses } });
+      }
+#endif
+    }
+#if !defined(CMAKE_BOOTSTRAP)
+    cmGeneratedFileStream::SetWrittenFiles(nullptr);
+#endif
+    if (!computed) {
+      return -1;
+    }
   }
-  this->GlobalGenerator->Generate();
   if (!this->GraphVizFile.empty()) {
     std::cout << "Generate graphviz: " << this->GraphVizFile << std::endl;
     this->GenerateGraphViz(this->GraphVizFile);
@@ -1924,6 +2128,13 @@ int cmake::Generate()
 
 #if !defined(CMAKE_BOOTSTRAP)
   this->FileAPI->WriteReplies();
+
+  // Generate steps that issued diagnostics are not skipped later so
+  // that the diagnostics are issued again.
+  if (this->GenerateFingerprint && !skipped &&
+      messageCount == this->Messenger->GetDisplayedMessageCount()) {
+    this->GenerateFingerprint->Save(writtenFiles);
+  }
 #endif
 
   return 0;
@@ -28,6 +28,7 @@
 #  include "cm_jsoncpp_value.h"
 #endif
 
+class cmConditionCache;
 class cmExternalMakefileProjectGeneratorFactory;
 class cmFileAPI;
 class cmFileTimeCache;
@@ -35,7 +36,11 @@ class cmGlobalGenerator;
 class cmGlobalGeneratorFactory;
 class cmMakefile;
 #if !defined(CMAKE_BOOTSTRAP)
+class cmGenerateFingerprint;
+class cmListFileParseCache;
+class cmListFilePrefetcher;
 class cmMakefileProfilingData;
+class cmTryCompileResultCache;
 #endif
 class cmMessenger;
 class cmVariableWatch;
@@ -398,6 +403,11 @@ public:
    */
   cmFileTimeCache* GetFileTimeCache() { return this->FileTimeCache.get(); }
 
+  /**
+   * Get the compiled conditions of if() and while() commands
+   */
+  cmConditionCache* GetConditionCache() { return this->ConditionCache.get(); }
+
   bool WasLogLevelSetViaCLI() const { return this->LogLevelWasSetViaCLI; }
 
   //! Get the selected log level for `message()` commands during the cmake run.
@@ -555,6 +565,30 @@ public:
 #if !defined(CMAKE_BOOTSTRAP)
   cmMakefileProfilingData& GetProfilingOutput();
   bool IsProfilingEnabled() const;
+
+  //! Get the persistent cache of parsed list files, if any.
+  cmListFileParseCache* GetListFileParseCache() const
+  {
+    return this->ListFileParseCache.get();
+  }
+
+  //! Get the background parser of list files, if any.
+  cmListFilePrefetcher* GetListFilePrefetcher() const
+  {
+    return this->ListFilePrefetcher.get();
+  }
+
+  //! Get the fingerprint of the configured state, if any.
+  cmGenerateFingerprint* GetGenerateFingerprint() const
+  {
+    return this->GenerateFingerprint.get();
+  }
+
+  //! Get the user-level cache of try_compile results, if any.
+  cmTryCompileResultCache* GetTryCompileResultCache() const
+  {
+    return this->TryCompileResultCache.get();
+  }
 #endif
 
 protected:
@@ -633,6 +667,7 @@ private:
   bool DebugTryCompile = false;
   bool RegenerateDuringBuild = false;
   std::unique_ptr<cmFileTimeCache> FileTimeCache;
+  std::unique_ptr<cmConditionCache> ConditionCache;
   std::string GraphVizFile;
   InstalledFilesMap InstalledFiles;
 
@@ -667,7 +702,14 @@ private:
   void AppendExtraGeneratorsDocumentation(std::vector<cmDocumentationEntry>&);
 
 #if !defined(CMAKE_BOOTSTRAP)
+  bool CanSkipGenerate();
+
   std::unique_ptr<cmMakefileProfilingData> ProfilingOutput;
+  std::unique_ptr<cmListFileParseCache> ListFileParseCache;
+  std::unique_ptr<cmListFilePrefetcher> ListFilePrefetcher;
+  std::unique_ptr<cmGenerateFingerprint> GenerateFingerprint;
+  std::unique_ptr<cmTryCompileResultCache> TryCompileResultCache;
+  bool TryCompileCacheStats = false;
 #endif
 };
 
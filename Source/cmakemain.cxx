@@ -98,6 +98,9 @@ const char* cmDocumentationOptions[][2] = {
   { "--profiling-output=<file>",
     "Select an output path for the profiling data enabled through "
     "--profiling-format." },
+  { "--try-compile-cache-stats",
+    "Report how many try_compile results were reused from "
+    "CMAKE_TRY_COMPILE_CACHE_DIR." },
 #  endif
   { nullptr, nullptr }
 };
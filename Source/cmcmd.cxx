@@ -88,6 +88,8 @@ void CMakeCommandUsage(const char* program)
   errorStream
     << "Usage: " << program << " -E <command> [arguments...]\n"
     << "Available commands: \n"
+    << "  batch file [cmd [args...]] - run command (if given) and then the "
+       "commands listed in file\n"
     << "  capabilities              - Report capabilities built into cmake "
        "in JSON format\n"
     << "  chdir dir cmd [args...]   - run command in a given directory\n"
@@ -1138,6 +1140,11 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string> const& args)
       return cmcmd::RunLLVMRC(args);
     }
 
+    // Run several commands in this process.
+    if (args[1] == "batch" && args.size() > 2) {
+      return cmcmd::ExecuteBatch(args);
+    }
+
     // Internal CMake color makefile support.
     if (args[1] == "cmake_echo_color") {
       return cmcmd::ExecuteEchoColor(args);
@@ -1500,6 +1507,66 @@ static void cmcmdProgressReport(std::string const& dir, std::string const& num)
   }
 }
 
+int cmcmd::ExecuteBatch(std::vector<std::string> const& args)
+{
+  // The arguments are
+  //   args[0] == <cmake-executable>
+  //   args[1] == batch
+  //   args[2] == <batch-file>
+  //   args[3] == optional <command> to run first, followed by its arguments
+  cmsys::ifstream fin(args[2].c_str());
+  if (!fin) {
+    std::cerr << "Error opening batch file \"" << args[2] << "\""
+              << std::endl;
+    return 1;
+  }
+
+  // Run one command at a time and stop at the first failure, as the
+  // build tool does for the commands of a rule.
+  auto runCommand = [&args](std::vector<std::string> const& command) -> int {
+    if (command.size() > 1 && command[1] == "batch") {
+      std::cerr << "Error: batch files cannot run \"batch\"." << std::endl;
+      return 1;
+    }
+    int const ret = cmcmd::ExecuteCMakeCommand(command);
+    // Keep the output of consecutive commands in order.
+    std::cout.flush();
+    if (ret != 0) {
+      std::cerr << "Error running batch command from \"" << args[2]
+                << "\":\n  " << cmJoin(cmMakeRange(command).advance(1), " ")
+                << std::endl;
+    }
+    return ret;
+  };
+
+  std::vector<std::string> command;
+  if (args.size() > 3) {
+    command.push_back(args[0]);
+    cm::append(command, cmMakeRange(args).advance(3));
+    if (int const ret = runCommand(command)) {
+      return ret;
+    }
+  }
+
+  // Each line holds the arguments of one command following "-E".
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    command.clear();
+    command.push_back(args[0]);
+    cmSystemTools::ParseUnixCommandLine(line.c_str(), command);
+    if (command.size() < 2) {
+      continue;
+    }
+    if (int const ret = runCommand(command)) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
 int cmcmd::ExecuteEchoColor(std::vector<std::string> const& args)
 {
   // The arguments are
@@ -0,0 +1,110 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmBinaryCache.h"
+#include "cmSystemTools.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+std::string const cacheFile = "testBinaryCache.bin";
+char const magic[] = "testBinaryCache\n1\n";
+
+bool testValues()
+{
+  std::cout << "testValues()\n";
+
+  std::vector<std::string> const strings = { "", "a", std::string("b\0c", 3),
+                                             std::string(300, 'x') };
+  std::string data;
+  cmBinaryCache::WriteUInt(data, 0);
+  cmBinaryCache::WriteUInt(data, 0xfedcba98);
+  cmBinaryCache::WriteTime(data, -1);
+  cmBinaryCache::WriteTime(data, 1580000000123456789LL);
+  cmBinaryCache::WriteString(data, "value");
+  cmBinaryCache::WriteStrings(data, strings);
+
+  cmBinaryCache::Reader reader(data);
+  std::uint32_t u;
+  long long t;
+  std::string s;
+  std::vector<std::string> v;
+  ASSERT_TRUE(reader.ReadUInt(u) && u == 0);
+  ASSERT_TRUE(reader.ReadUInt(u) && u == 0xfedcba98);
+  ASSERT_TRUE(reader.ReadTime(t) && t == -1);
+  ASSERT_TRUE(reader.ReadTime(t) && t == 1580000000123456789LL);
+  ASSERT_TRUE(reader.ReadString(s) && s == "value");
+  ASSERT_TRUE(reader.ReadStrings(v) && v == strings);
+  // Nothing is left
+  ASSERT_TRUE(!reader.ReadUInt(u));
+  return true;
+}
+
+bool testTruncated()
+{
+  std::cout << "testTruncated()\n";
+
+  std::string data;
+  cmBinaryCache::WriteString(data, "value");
+  data.pop_back();
+  std::string s;
+  cmBinaryCache::Reader reader(data);
+  ASSERT_TRUE(!reader.ReadString(s));
+
+  data = "abc";
+  std::uint32_t u;
+  cmBinaryCache::Reader shortReader(data);
+  ASSERT_TRUE(!shortReader.ReadUInt(u));
+  return true;
+}
+
+bool testFile()
+{
+  std::cout << "testFile()\n";
+
+  cmSystemTools::RemoveFile(cacheFile);
+  std::string data;
+  ASSERT_TRUE(!cmBinaryCache::ReadFile(cacheFile, magic, data));
+
+  std::string written;
+  cmBinaryCache::WriteString(written, "entry");
+  cmBinaryCache::WriteTime(written, 42);
+  ASSERT_TRUE(cmBinaryCache::WriteFile(cacheFile, magic, written));
+  ASSERT_TRUE(cmBinaryCache::ReadFile(cacheFile, magic, data));
+  ASSERT_TRUE(data == written);
+
+  // Another layout version is not read
+  ASSERT_TRUE(
+    !cmBinaryCache::ReadFile(cacheFile, "testBinaryCache\n2\n", data));
+  ASSERT_TRUE(data.empty());
+
+  cmSystemTools::RemoveFile(cacheFile);
+  return true;
+}
+}
+
+int testBinaryCache(int /*unused*/, char* /*unused*/ [])
+{
+  int result = 0;
+  if (!testValues()) {
+    result = 1;
+  }
+  if (!testTruncated()) {
+    result = 1;
+  }
+  if (!testFile()) {
+    result = 1;
+  }
+  return result;
+}
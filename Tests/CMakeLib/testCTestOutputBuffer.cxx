@@ -0,0 +1,187 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <iostream>
+#include <string>
+
+#include "cmCTestOutputBuffer.h"
+#include "cmSystemTools.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+std::string const spillFile = "testCTestOutputBuffer.log";
+
+std::string ReadAll(cmCTestOutputBuffer const& buffer, bool& ok)
+{
+  std::string output;
+  ok = buffer.Read([&output](std::string const& chunk) { output += chunk; });
+  return output;
+}
+
+bool testInMemory()
+{
+  std::cout << "testInMemory()\n";
+
+  cmCTestOutputBuffer buffer;
+  buffer.Reset(spillFile, 4, 4);
+  ASSERT_TRUE(buffer.Append("abc"));
+  ASSERT_TRUE(buffer.Append("defgh"));
+  ASSERT_TRUE(!buffer.IsSpilled());
+  ASSERT_TRUE(buffer.WouldSpill(1));
+  ASSERT_TRUE(buffer.GetSize() == 8);
+  ASSERT_TRUE(buffer.GetHead() == "abcdefgh");
+  ASSERT_TRUE(buffer.GetTail().empty());
+  ASSERT_TRUE(!cmSystemTools::FileExists(spillFile));
+
+  bool ok;
+  ASSERT_TRUE(ReadAll(buffer, ok) == "abcdefgh");
+  ASSERT_TRUE(ok);
+  ASSERT_TRUE(buffer.ReleaseSpillFile().empty());
+  return true;
+}
+
+bool testSpill()
+{
+  std::cout << "testSpill()\n";
+
+  cmCTestOutputBuffer buffer;
+  buffer.Reset(spillFile, 4, 5);
+  ASSERT_TRUE(buffer.Append("0123456"));
+  ASSERT_TRUE(buffer.Append("789"));
+  ASSERT_TRUE(buffer.IsSpilled());
+  ASSERT_TRUE(!buffer.WouldSpill(100));
+  ASSERT_TRUE(buffer.GetHead() == "0123");
+  ASSERT_TRUE(buffer.GetTail() == "56789");
+
+  // The tail wraps around and may be replaced at once
+  ASSERT_TRUE(buffer.Append("ab"));
+  ASSERT_TRUE(buffer.GetTail() == "789ab");
+  ASSERT_TRUE(buffer.Append("cdefghijk"));
+  ASSERT_TRUE(buffer.GetTail() == "ghijk");
+  ASSERT_TRUE(buffer.Append("l"));
+  ASSERT_TRUE(buffer.GetTail() == "hijkl");
+  ASSERT_TRUE(buffer.GetHead() == "0123");
+  ASSERT_TRUE(buffer.GetSize() == 22);
+
+  // The spill file has to be closed before it is read
+  bool ok;
+  ReadAll(buffer, ok);
+  ASSERT_TRUE(!ok);
+  buffer.Close();
+  ASSERT_TRUE(ReadAll(buffer, ok) == "0123456789abcdefghijkl");
+  ASSERT_TRUE(ok);
+
+  buffer.RemoveSpillFile();
+  ASSERT_TRUE(!cmSystemTools::FileExists(spillFile));
+  return true;
+}
+
+bool testRelease()
+{
+  std::cout << "testRelease()\n";
+
+  std::string file;
+  {
+    cmCTestOutputBuffer buffer;
+    buffer.Reset(spillFile, 1, 1);
+    ASSERT_TRUE(buffer.Append("abc"));
+    file = buffer.ReleaseSpillFile();
+    ASSERT_TRUE(file == spillFile);
+    ASSERT_TRUE(buffer.GetSpillFile().empty());
+  }
+  // The buffer does not remove a released file
+  ASSERT_TRUE(cmSystemTools::FileExists(file));
+
+  {
+    cmCTestOutputBuffer buffer;
+    buffer.Reset(spillFile, 1, 1);
+    ASSERT_TRUE(buffer.Append("abc"));
+  }
+  // The buffer removes its own file
+  ASSERT_TRUE(!cmSystemTools::FileExists(file));
+  return true;
+}
+
+bool testNoSpillFile()
+{
+  std::cout << "testNoSpillFile()\n";
+
+  // Without a spill file only the head and the tail are kept
+  cmCTestOutputBuffer buffer;
+  buffer.Reset(std::string(), 2, 2);
+  ASSERT_TRUE(buffer.Append("abcdef"));
+  ASSERT_TRUE(buffer.IsSpilled());
+  ASSERT_TRUE(buffer.GetHead() == "ab");
+  ASSERT_TRUE(buffer.GetTail() == "ef");
+
+  bool ok;
+  ReadAll(buffer, ok);
+  ASSERT_TRUE(!ok);
+
+  // A spill file that can not be written is reported once
+  buffer.Reset("does/not/exist/testCTestOutputBuffer.log", 2, 2);
+  ASSERT_TRUE(!buffer.Append("abcdef"));
+  ASSERT_TRUE(buffer.GetSpillFile().empty());
+  ASSERT_TRUE(buffer.Append("gh"));
+  ASSERT_TRUE(buffer.GetTail() == "gh");
+  return true;
+}
+
+bool testReadUTF8()
+{
+  std::cout << "testReadUTF8()\n";
+
+  // Chunks of the spill file never split a character
+  std::string output;
+  while (output.size() < 200000) {
+    output += "a\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80";
+  }
+  cmCTestOutputBuffer buffer;
+  buffer.Reset(spillFile, 10, 10);
+  ASSERT_TRUE(buffer.Append(output));
+  buffer.Close();
+
+  std::string read;
+  bool chunksComplete = true;
+  ASSERT_TRUE(buffer.Read([&](std::string const& chunk) {
+    unsigned char const first =
+      chunk.empty() ? 0 : static_cast<unsigned char>(chunk.front());
+    if ((first & 0xC0) == 0x80) {
+      chunksComplete = false;
+    }
+    read += chunk;
+  }));
+  ASSERT_TRUE(chunksComplete);
+  ASSERT_TRUE(read == output);
+  return true;
+}
+}
+
+int testCTestOutputBuffer(int /*unused*/, char* /*unused*/ [])
+{
+  int result = 0;
+  if (!testInMemory()) {
+    result = 1;
+  }
+  if (!testSpill()) {
+    result = 1;
+  }
+  if (!testRelease()) {
+    result = 1;
+  }
+  if (!testNoSpillFile()) {
+    result = 1;
+  }
+  if (!testReadUTF8()) {
+    result = 1;
+  }
+  cmSystemTools::RemoveFile(spillFile);
+  return result;
+}
@@ -0,0 +1,343 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCTestScheduler.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+using TestMap = std::map<int, cmCTestSchedulerTest>;
+
+cmCTestSchedulerTest MakeTest(float cost, std::set<int> depends = {},
+                              std::size_t processors = 1,
+                              std::size_t resourceGroups = 0)
+{
+  cmCTestSchedulerTest test;
+  test.Cost = cost;
+  test.Processors = processors;
+  test.ResourceGroups = resourceGroups;
+  test.Depends = std::move(depends);
+  return test;
+}
+
+/** The order that ctest used before: dependency levels, deepest first,
+    sorted by cost within each level.  */
+std::vector<int> SortByLevel(TestMap const& tests)
+{
+  std::vector<std::set<int>> levels(1);
+  for (auto const& t : tests) {
+    levels.back().insert(t.first);
+  }
+  while (!levels.back().empty()) {
+    std::set<int> next;
+    for (int test : levels.back()) {
+      std::set<int> const& depends = tests.at(test).Depends;
+      next.insert(depends.begin(), depends.end());
+    }
+    for (int test : next) {
+      levels.back().erase(test);
+    }
+    levels.push_back(std::move(next));
+  }
+  levels.pop_back();
+
+  std::vector<int> order;
+  std::set<int> sorted;
+  for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+    std::vector<int> sortedLevel(level->begin(), level->end());
+    std::stable_sort(sortedLevel.begin(), sortedLevel.end(),
+                     [&tests](int a, int b) {
+                       return tests.at(a).Cost > tests.at(b).Cost;
+                     });
+    for (int test : sortedLevel) {
+      if (sorted.insert(test).second) {
+        order.push_back(test);
+      }
+    }
+  }
+  return order;
+}
+
+bool testCriticalPath()
+{
+  std::cout << "testCriticalPath()\n";
+
+  // 3 depends on 2 depends on 1; the chain outweighs the expensive 4
+  TestMap tests;
+  tests[1] = MakeTest(1);
+  tests[2] = MakeTest(4, { 1 });
+  tests[3] = MakeTest(4, { 2 });
+  tests[4] = MakeTest(6);
+  tests[5] = MakeTest(2);
+  ASSERT_TRUE(cmCTestSortByCriticalPath(tests) ==
+              (std::vector<int>{ 1, 2, 4, 3, 5 }));
+
+  // The chain finishes together with 4 instead of after it
+  ASSERT_TRUE(cmCTestSimulateSchedule(tests, { 1, 2, 4, 3, 5 }, 2) == 9);
+  ASSERT_TRUE(cmCTestSimulateSchedule(tests, { 4, 5, 1, 2, 3 }, 2) == 11);
+  return true;
+}
+
+bool testTies()
+{
+  std::cout << "testTies()\n";
+
+  TestMap tests;
+  tests[1] = MakeTest(0);
+  tests[2] = MakeTest(0);
+  tests[3] = MakeTest(0);
+  ASSERT_TRUE(cmCTestSortByCriticalPath(tests) ==
+              (std::vector<int>{ 1, 2, 3 }));
+
+  // Among chains of equal cost wide tests go first, then long chains
+  tests[1] = MakeTest(2, {}, 1, 0);
+  tests[2] = MakeTest(2, {}, 2, 0);
+  tests[3] = MakeTest(2, {}, 1, 3);
+  tests[4] = MakeTest(1);
+  tests[5] = MakeTest(1, { 6 });
+  tests[6] = MakeTest(0);
+  tests[7] = MakeTest(-1, { 8 });
+  tests[8] = MakeTest(1);
+  ASSERT_TRUE(cmCTestSortByCriticalPath(tests) ==
+              (std::vector<int>{ 3, 2, 1, 8, 4, 5, 6, 7 }));
+  return true;
+}
+
+bool testCycle()
+{
+  std::cout << "testCycle()\n";
+
+  TestMap tests;
+  tests[1] = MakeTest(1, { 2 });
+  tests[2] = MakeTest(1, { 1 });
+  tests[3] = MakeTest(1, { 4 });
+  ASSERT_TRUE(cmCTestSortByCriticalPath(tests) ==
+              (std::vector<int>{ 3, 1, 2 }));
+  return true;
+}
+
+/** Add tests with the recorded costs and pseudo-random dependencies on
+    earlier tests.  Every 11th test uses two processors and every 13th
+    test has two resource groups.  */
+TestMap MakeReplayTests(std::vector<float> const& costs, unsigned seed)
+{
+  TestMap tests;
+  std::uint64_t x = (seed * 2654435761u) & 0xffffffffu;
+  for (float cost : costs) {
+    int const index = static_cast<int>(tests.size()) + 1;
+    cmCTestSchedulerTest& test = tests[index];
+    test.Cost = cost;
+    x = (x * 1103515245u + 12345u) & 0x7fffffffu;
+    if (index > 1) {
+      std::uint64_t const earlier = static_cast<std::uint64_t>(index - 1);
+      if (x % 3 == 0) {
+        test.Depends.insert(static_cast<int>(1 + (x / 3) % earlier));
+      }
+      if (x % 7 == 0) {
+        test.Depends.insert(static_cast<int>(1 + (x / 7) % earlier));
+      }
+    }
+    if (index % 11 == 0) {
+      test.Processors = 2;
+    }
+    if (index % 13 == 0) {
+      test.ResourceGroups = 2;
+    }
+  }
+  return tests;
+}
+
+bool ReadCostData(std::string const& dataDir, std::vector<float>& costs)
+{
+  std::string const fname = dataDir + "/CTestCostData.txt";
+  cmsys::ifstream fin(fname.c_str());
+  ASSERT_TRUE(fin);
+
+  std::string name;
+  int runs;
+  float cost;
+  while (fin >> name && name != "---" && fin >> runs >> cost) {
+    costs.push_back(cost);
+  }
+  ASSERT_TRUE(costs.size() > 100);
+  return true;
+}
+
+/** Replay recorded test costs and compare the simulated run times of the
+    old and the new order.  */
+bool testReplayCostData(std::string const& dataDir)
+{
+  std::cout << "testReplayCostData()\n";
+
+  std::vector<float> costs;
+  ASSERT_TRUE(ReadCostData(dataDir, costs));
+
+  std::vector<TestMap> graphs;
+  for (unsigned seed = 0; seed < 8; ++seed) {
+    graphs.push_back(MakeReplayTests(costs, seed));
+  }
+
+  double levelTotal = 0;
+  double criticalPathTotal = 0;
+  for (std::size_t parallelLevel : { 2, 4, 8, 16, 32 }) {
+    double levelTime = 0;
+    double criticalPathTime = 0;
+    for (TestMap const& tests : graphs) {
+      std::vector<int> const criticalPathOrder =
+        cmCTestSortByCriticalPath(tests);
+      ASSERT_TRUE(criticalPathOrder.size() == tests.size());
+      levelTime +=
+        cmCTestSimulateSchedule(tests, SortByLevel(tests), parallelLevel);
+      criticalPathTime +=
+        cmCTestSimulateSchedule(tests, criticalPathOrder, parallelLevel);
+    }
+    std::cout << "  -j" << parallelLevel << ": level order " << levelTime
+              << "s, critical path order " << criticalPathTime << "s\n";
+
+    // When the run is bound by the total cost of the tests both orders
+    // are close to the optimum.  Allow for the noise of list scheduling.
+    ASSERT_TRUE(criticalPathTime <= levelTime * 1.01);
+    levelTotal += levelTime;
+    criticalPathTotal += criticalPathTime;
+  }
+  ASSERT_TRUE(criticalPathTotal < levelTotal);
+  return true;
+}
+
+bool testShards()
+{
+  std::cout << "testShards()\n";
+
+  // Connected tests stay together, the most expensive groups go first
+  TestMap tests;
+  tests[1] = MakeTest(1);
+  tests[2] = MakeTest(2, { 1 });
+  tests[3] = MakeTest(3);
+  tests[4] = MakeTest(1, { 3 });
+  tests[5] = MakeTest(1, { 4 });
+  tests[6] = MakeTest(4);
+  tests[7] = MakeTest(-2);
+  tests[8] = MakeTest(1, { 7, 9 });
+  std::map<int, std::size_t> shards = cmCTestAssignShards(tests, 3);
+  ASSERT_TRUE(shards ==
+              (std::map<int, std::size_t>{
+                { 1, 2 },
+                { 2, 2 },
+                { 3, 0 },
+                { 4, 0 },
+                { 5, 0 },
+                { 6, 1 },
+                { 7, 2 },
+                { 8, 2 },
+              }));
+
+  // Shards without tests are fine, a single shard has all tests
+  shards = cmCTestAssignShards(tests, 10);
+  ASSERT_TRUE(shards.at(1) == 2 && shards.at(3) == 0 && shards.at(6) == 1 &&
+              shards.at(7) == 3);
+  shards = cmCTestAssignShards(tests, 1);
+  for (auto const& s : shards) {
+    ASSERT_TRUE(s.second == 0);
+  }
+
+  // Equal costs spread like round-robin
+  tests.clear();
+  for (int i = 1; i <= 6; ++i) {
+    tests[i] = MakeTest(1);
+  }
+  shards = cmCTestAssignShards(tests, 4);
+  ASSERT_TRUE(shards ==
+              (std::map<int, std::size_t>{
+                { 1, 0 },
+                { 2, 1 },
+                { 3, 2 },
+                { 4, 3 },
+                { 5, 0 },
+                { 6, 1 },
+              }));
+  return true;
+}
+
+/** Compare the longest shard of cost-balanced shards of the recorded
+    tests to that of round-robin shards.  */
+bool testReplayShards(std::string const& dataDir)
+{
+  std::cout << "testReplayShards()\n";
+
+  std::vector<float> costs;
+  ASSERT_TRUE(ReadCostData(dataDir, costs));
+  TestMap tests = MakeReplayTests(costs, 0);
+
+  for (std::size_t shardCount : { 2, 5, 20 }) {
+    std::map<int, std::size_t> const shards =
+      cmCTestAssignShards(tests, shardCount);
+    ASSERT_TRUE(shards.size() == tests.size());
+    std::vector<double> balancedCost(shardCount, 0);
+    std::vector<double> roundRobinCost(shardCount, 0);
+    for (auto const& t : tests) {
+      double const cost = std::max(static_cast<double>(t.second.Cost), 0.0);
+      ASSERT_TRUE(shards.at(t.first) < shardCount);
+      balancedCost[shards.at(t.first)] += cost;
+      roundRobinCost[static_cast<std::size_t>(t.first) % shardCount] += cost;
+      for (int dependency : t.second.Depends) {
+        ASSERT_TRUE(shards.at(t.first) == shards.at(dependency));
+      }
+    }
+    double const balanced =
+      *std::max_element(balancedCost.begin(), balancedCost.end());
+    double const roundRobin =
+      *std::max_element(roundRobinCost.begin(), roundRobinCost.end());
+    std::cout << "  " << shardCount << " shards: round-robin " << roundRobin
+              << "s, cost-balanced " << balanced << "s\n";
+    ASSERT_TRUE(balanced <= roundRobin);
+  }
+  return true;
+}
+}
+
+int testCTestScheduler(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cout << "Invalid arguments.\n";
+    return -1;
+  }
+
+  int result = 0;
+  if (!testCriticalPath()) {
+    result = 1;
+  }
+  if (!testTies()) {
+    result = 1;
+  }
+  if (!testCycle()) {
+    result = 1;
+  }
+  if (!testReplayCostData(argv[1])) {
+    result = 1;
+  }
+  if (!testShards()) {
+    result = 1;
+  }
+  if (!testReplayShards(argv[1])) {
+    result = 1;
+  }
+  return result;
+}
@@ -0,0 +1,141 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmDefinitions.h"
+#include "cmLinkedTree.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+using Tree = cmLinkedTree<cmDefinitions>;
+using Iter = Tree::iterator;
+
+bool IsValue(std::string const* value, std::string const& expect)
+{
+  return value && *value == expect;
+}
+
+bool testLookup()
+{
+  std::cout << "testLookup()\n";
+
+  Tree tree;
+  Iter root = tree.Root();
+  Iter dir = tree.Push(root);
+  dir->Set("A", "dir");
+  dir->Set("B", "dir");
+  Iter fn1 = tree.Push(dir);
+  fn1->Set("B", "fn1");
+  Iter fn2 = tree.Push(fn1);
+
+  // Lookups fall through to the nearest scope defining the key.
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("A", fn2, root), "dir"));
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("B", fn2, root), "fn1"));
+  ASSERT_TRUE(cmDefinitions::Get("C", fn2, root) == nullptr);
+
+  // Repeated lookups give the same answers.
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("A", fn2, root), "dir"));
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("B", fn2, root), "fn1"));
+  ASSERT_TRUE(cmDefinitions::Get("C", fn2, root) == nullptr);
+
+  // Local changes take precedence over previous lookups.
+  fn2->Set("A", "fn2");
+  fn2->Set("C", "fn2");
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("A", fn2, root), "fn2"));
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("C", fn2, root), "fn2"));
+  fn2->Unset("A");
+  ASSERT_TRUE(cmDefinitions::Get("A", fn2, root) == nullptr);
+
+  // Cached lookups are not local definitions.
+  ASSERT_TRUE(!cmDefinitions::HasKey("B", fn2, fn1));
+  ASSERT_TRUE(fn2->UnusedKeys().empty());
+  return true;
+}
+
+bool testRaise()
+{
+  std::cout << "testRaise()\n";
+
+  Tree tree;
+  Iter root = tree.Root();
+  Iter dir = tree.Push(root);
+  dir->Set("A", "dir");
+  Iter fn1 = tree.Push(dir);
+  Iter fn2 = tree.Push(fn1);
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("A", fn2, root), "dir"));
+
+  // set(A ... PARENT_SCOPE) from fn2 keeps the local view in fn2.
+  cmDefinitions::Raise("A", fn2, root);
+  fn1->Set("A", "fn1");
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("A", fn2, root), "dir"));
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("A", fn1, root), "fn1"));
+
+  // A new call from fn1 sees the new value.
+  tree.Pop(fn2);
+  Iter fn3 = tree.Push(fn1);
+  ASSERT_TRUE(IsValue(cmDefinitions::Get("A", fn3, root), "fn1"));
+
+  // Closures ignore cached lookups.
+  std::vector<std::string> keys = cmDefinitions::ClosureKeys(fn3, root);
+  ASSERT_TRUE(keys.size() == 1 && keys[0] == "A");
+  return true;
+}
+
+void benchmarkLookup(int depth)
+{
+  Tree tree;
+  Iter root = tree.Root();
+  Iter top = tree.Push(root);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 64; ++i) {
+    keys.push_back("VAR_" + std::to_string(i));
+    top->Set(keys.back(), "value");
+  }
+  for (int i = 0; i < depth; ++i) {
+    top = tree.Push(top);
+    top->Set("LOCAL_" + std::to_string(i), "value");
+  }
+
+  int const rounds = 2000;
+  std::size_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (std::string const& key : keys) {
+      found += cmDefinitions::Get(key, top, root) ? 1 : 0;
+    }
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  double const seconds = std::chrono::duration<double>(stop - start).count();
+  double const lookups = static_cast<double>(found);
+  std::cout << "  depth " << depth << ": " << (lookups / seconds)
+            << " lookups/s\n";
+}
+}
+
+int testDefinitions(int /*unused*/, char* /*unused*/ [])
+{
+  if (!testLookup()) {
+    return 1;
+  }
+  if (!testRaise()) {
+    return 1;
+  }
+
+  std::cout << "benchmarkLookup()\n";
+  for (int depth : { 1, 4, 16, 64, 256 }) {
+    benchmarkLookup(depth);
+  }
+  return 0;
+}
@@ -0,0 +1,91 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <iostream>
+#include <string>
+
+#include "cmListFileArgumentTemplate.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+using SegmentType = cmListFileArgumentTemplate::SegmentType;
+
+bool testLiteral()
+{
+  std::cout << "testLiteral()\n";
+
+  cmListFileArgumentTemplate empty("");
+  ASSERT_TRUE(empty.IsUsable());
+  ASSERT_TRUE(empty.IsLiteral());
+  ASSERT_TRUE(empty.GetSegments().empty());
+
+  // Escapes are processed, but an escaped ';' is left to list expansion.
+  cmListFileArgumentTemplate text("a\\tb\\;c\\$d@e@$<f>$");
+  ASSERT_TRUE(text.IsUsable());
+  ASSERT_TRUE(text.IsLiteral());
+  ASSERT_TRUE(text.GetSegments().size() == 1);
+  ASSERT_TRUE(text.GetSegments()[0].Text == "a\tb\\;c$d@e@$<f>$");
+  return true;
+}
+
+bool testReferences()
+{
+  std::cout << "testReferences()\n";
+
+  cmListFileArgumentTemplate refs("-${a}$ENV{b}x$CACHE{c.d}");
+  ASSERT_TRUE(refs.IsUsable());
+  ASSERT_TRUE(!refs.IsLiteral());
+  auto const& segments = refs.GetSegments();
+  ASSERT_TRUE(segments.size() == 5);
+  ASSERT_TRUE(segments[0].Type == SegmentType::Literal);
+  ASSERT_TRUE(segments[0].Text == "-");
+  ASSERT_TRUE(segments[1].Type == SegmentType::Variable);
+  ASSERT_TRUE(segments[1].Text == "a");
+  ASSERT_TRUE(segments[2].Type == SegmentType::Environment);
+  ASSERT_TRUE(segments[2].Text == "b");
+  ASSERT_TRUE(segments[3].Type == SegmentType::Literal);
+  ASSERT_TRUE(segments[3].Text == "x");
+  ASSERT_TRUE(segments[4].Type == SegmentType::Cache);
+  ASSERT_TRUE(segments[4].Text == "c.d");
+  return true;
+}
+
+bool testUnusable()
+{
+  std::cout << "testUnusable()\n";
+
+  // These are left to the general expansion.
+  char const* values[] = { "${a${b}}",   "${a",   "${a b}",
+                           "$FOO{a}",    "\\q",   "a\\",
+                           "${a\\-b}",   "${CMAKE_CURRENT_LIST_LINE}" };
+  for (char const* value : values) {
+    cmListFileArgumentTemplate t(value);
+    ASSERT_TRUE(!t.IsUsable());
+    ASSERT_TRUE(!t.IsLiteral());
+    ASSERT_TRUE(t.GetSegments().empty());
+  }
+  return true;
+}
+}
+
+int testListFileArgumentTemplate(int /*unused*/, char* /*unused*/ [])
+{
+  int result = 0;
+  if (!testLiteral()) {
+    result = 1;
+  }
+  if (!testReferences()) {
+    result = 1;
+  }
+  if (!testUnusable()) {
+    result = 1;
+  }
+  return result;
+}
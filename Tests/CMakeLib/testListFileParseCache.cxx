@@ -0,0 +1,158 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmListFileCache.h"
+#include "cmListFileParseCache.h"
+#include "cmSystemTools.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+std::string const cacheFile = "testListFileParseCache.bin";
+std::string const listFile = "testListFileParseCache.cmake";
+
+void WriteListFile(std::string const& content)
+{
+  cmsys::ofstream fout(listFile.c_str(), std::ios::out | std::ios::binary);
+  fout << content;
+}
+
+std::vector<cmListFileFunction> MakeFunctions()
+{
+  std::vector<cmListFileFunction> functions(2);
+  functions[0].Name = "Set";
+  functions[0].Line = 1;
+  functions[0].Arguments.emplace_back("a", cmListFileArgument::Unquoted, 1);
+  functions[0].Arguments.emplace_back("b c", cmListFileArgument::Quoted, 2);
+  functions[1].Name = "message";
+  functions[1].Line = 3;
+  functions[1].Arguments.emplace_back(std::string("x\0y", 3),
+                                      cmListFileArgument::Bracket, 3);
+  return functions;
+}
+
+bool SameFunctions(std::vector<cmListFileFunction> const& l,
+                   std::vector<cmListFileFunction> const& r)
+{
+  if (l.size() != r.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < l.size(); ++i) {
+    if (l[i].Name.Original != r[i].Name.Original ||
+        l[i].Name.Lower != r[i].Name.Lower || l[i].Line != r[i].Line ||
+        l[i].Arguments != r[i].Arguments) {
+      return false;
+    }
+    for (std::size_t j = 0; j < l[i].Arguments.size(); ++j) {
+      if (l[i].Arguments[j].Line != r[i].Arguments[j].Line) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool testRoundTrip()
+{
+  std::cout << "testRoundTrip()\n";
+
+  cmSystemTools::RemoveFile(cacheFile);
+  WriteListFile("set(a \"b c\")\n");
+  std::string const key = cmListFileParseCache::ComputeKey(listFile);
+  ASSERT_TRUE(!key.empty());
+
+  std::vector<cmListFileFunction> functions;
+  {
+    cmListFileParseCache cache(cacheFile);
+    cache.Load();
+    ASSERT_TRUE(!cache.Lookup(key, functions));
+    cache.Store(key, MakeFunctions());
+    ASSERT_TRUE(cache.Save());
+    ASSERT_TRUE(cache.GetHits() == 0);
+    ASSERT_TRUE(cache.GetMisses() == 1);
+  }
+  {
+    cmListFileParseCache cache(cacheFile);
+    cache.Load();
+    ASSERT_TRUE(cache.Lookup(key, functions));
+    ASSERT_TRUE(SameFunctions(functions, MakeFunctions()));
+    ASSERT_TRUE(cache.GetHits() == 1);
+    ASSERT_TRUE(cache.GetMisses() == 0);
+  }
+  return true;
+}
+
+bool testParseFile()
+{
+  std::cout << "testParseFile()\n";
+
+  cmSystemTools::RemoveFile(cacheFile);
+  WriteListFile("set(a \"b c\")\nmessage([[x]])\n");
+  std::string const key = cmListFileParseCache::ComputeKey(listFile);
+
+  cmListFileParseCache cache(cacheFile);
+  cache.Load();
+
+  cmListFile parsed;
+  ASSERT_TRUE(parsed.ParseFile(listFile.c_str(), nullptr,
+                               cmListFileBacktrace(), &cache));
+  ASSERT_TRUE(cache.GetMisses() == 1);
+
+  // The parse result was stored, so a second parse is a hit.
+  cmListFile cached;
+  ASSERT_TRUE(cached.ParseFile(listFile.c_str(), nullptr,
+                               cmListFileBacktrace(), &cache));
+  ASSERT_TRUE(cache.GetHits() == 1);
+  ASSERT_TRUE(SameFunctions(parsed.Functions, cached.Functions));
+  ASSERT_TRUE(cached.Functions.size() == 2);
+
+  // Changing the content changes the key.
+  WriteListFile("set(a \"b d\")\n");
+  ASSERT_TRUE(cmListFileParseCache::ComputeKey(listFile) != key);
+  return true;
+}
+
+bool testCorruptFile()
+{
+  std::cout << "testCorruptFile()\n";
+
+  {
+    cmsys::ofstream fout(cacheFile.c_str(), std::ios::out | std::ios::binary);
+    fout << "CMakeListFileParseCache\n1\n\x05";
+  }
+  cmListFileParseCache cache(cacheFile);
+  cache.Load();
+  std::vector<cmListFileFunction> functions;
+  ASSERT_TRUE(!cache.Lookup("0123", functions));
+  return true;
+}
+}
+
+int testListFileParseCache(int /*unused*/, char* /*unused*/ [])
+{
+  int result = 0;
+  if (!testRoundTrip()) {
+    result = 1;
+  }
+  if (!testParseFile()) {
+    result = 1;
+  }
+  if (!testCorruptFile()) {
+    result = 1;
+  }
+  cmSystemTools::RemoveFile(cacheFile);
+  cmSystemTools::RemoveFile(listFile);
+  return result;
+}
@@ -0,0 +1,113 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmListFileCache.h"
+#include "cmListFilePrefetcher.h"
+#include "cmSystemTools.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+std::string const testDir = "testListFilePrefetcher";
+
+void WriteFile(std::string const& name, std::string const& content)
+{
+  std::string const path = testDir + "/" + name;
+  cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(path));
+  cmsys::ofstream fout(path.c_str(), std::ios::out | std::ios::binary);
+  fout << content;
+}
+
+std::vector<cmListFileFunction> ParseString(std::string const& content)
+{
+  cmListFile listFile;
+  listFile.ParseString(content.c_str(), "test", nullptr,
+                       cmListFileBacktrace());
+  return listFile.Functions;
+}
+
+bool testTake()
+{
+  std::cout << "testTake()\n";
+
+  WriteFile("sub/CMakeLists.txt", "include(inc.cmake)\n");
+  WriteFile("sub/inc.cmake", "set(a b)\nset(c d)\n");
+  WriteFile("warn.cmake", "message(\"a\"\"b\")\n");
+
+  std::string const dir = cmSystemTools::CollapseFullPath(testDir);
+  cmListFilePrefetcher prefetcher(nullptr, 2);
+  prefetcher.Scan(ParseString("add_subdirectory(sub)\n"
+                              "include(warn.cmake)\n"
+                              "include(${var}.cmake)\n"
+                              "include(Module)\n"),
+                  dir);
+  prefetcher.Wait();
+
+  // Files named by prefetched files are prefetched too.
+  cmListFile sub;
+  ASSERT_TRUE(prefetcher.Take(dir + "/sub/CMakeLists.txt", sub));
+  ASSERT_TRUE(sub.Functions.size() == 1);
+  cmListFile inc;
+  ASSERT_TRUE(prefetcher.Take(dir + "/sub/inc.cmake", inc));
+  ASSERT_TRUE(inc.Functions.size() == 2);
+
+  // A result is taken only once.
+  ASSERT_TRUE(!prefetcher.Take(dir + "/sub/inc.cmake", inc));
+
+  // Parses with diagnostics are left to the caller.
+  cmListFile warn;
+  ASSERT_TRUE(!prefetcher.Take(dir + "/warn.cmake", warn));
+
+  // Files named by non-literal or module arguments are not prefetched.
+  ASSERT_TRUE(!prefetcher.Take(dir + "/.cmake", warn));
+  ASSERT_TRUE(!prefetcher.Take(dir + "/Module", warn));
+
+  ASSERT_TRUE(prefetcher.GetHits() == 2);
+  ASSERT_TRUE(prefetcher.GetMisses() == 1);
+  return true;
+}
+
+bool testChanged()
+{
+  std::cout << "testChanged()\n";
+
+  WriteFile("changed.cmake", "set(a b)\n");
+
+  std::string const dir = cmSystemTools::CollapseFullPath(testDir);
+  cmListFilePrefetcher prefetcher(nullptr, 1);
+  prefetcher.Scan(ParseString("include(changed.cmake)\n"), dir);
+  prefetcher.Wait();
+
+  // A file written after it was read is not taken.
+  WriteFile("changed.cmake", "set(a b)\nset(c d)\n");
+  cmListFile changed;
+  ASSERT_TRUE(!prefetcher.Take(dir + "/changed.cmake", changed));
+  ASSERT_TRUE(prefetcher.GetMisses() == 1);
+  return true;
+}
+}
+
+int testListFilePrefetcher(int /*unused*/, char* /*unused*/ [])
+{
+  int result = 0;
+  if (!testTake()) {
+    result = 1;
+  }
+  if (!testChanged()) {
+    result = 1;
+  }
+  cmSystemTools::RemoveADirectory(testDir);
+  return result;
+}
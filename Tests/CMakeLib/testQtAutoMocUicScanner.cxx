@@ -0,0 +1,207 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+#include "cmsys/Glob.hxx"
+#include "cmsys/RegularExpression.hxx"
+
+#include "cmQtAutoMocUicScanner.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+std::vector<std::string> const macroNames = { "Q_OBJECT", "Q_GADGET",
+                                              "Q_NAMESPACE",
+                                              "Q_NAMESPACE_EXPORT",
+                                              "CUSTOM_MACRO" };
+
+/** The regular expressions that AUTOMOC and AUTOUIC used before.  */
+class ReferenceT
+{
+public:
+  ReferenceT()
+    : MocInclude("(^|\n)[ \t]*#[ \t]*include[ \t]+"
+                 "[\"<](([^ \">]+/)?moc_[^ \">/]+\\.cpp|[^ \">]+\\.moc)[\">]")
+    , UicInclude("(^|\n)[ \t]*#[ \t]*include[ \t]+"
+                 "[\"<](([^ \">]+/)?ui_[^ \">/]+\\.h)[\">]")
+  {
+    for (std::string const& name : macroNames) {
+      Macros.emplace_back("[\n][ \t]*{?[ \t]*" + name + "[^a-zA-Z0-9_]");
+    }
+  }
+
+  void Scan(std::string const& content, cmQtAutoMocUicScanner::ResultT& result)
+  {
+    result.Clear();
+    for (std::size_t ii = 0; ii != macroNames.size(); ++ii) {
+      if (Macros[ii].find(content)) {
+        result.Macro = macroNames[ii];
+        break;
+      }
+    }
+    FindAll(MocInclude, content, result.MocIncludes);
+    FindAll(UicInclude, content, result.UicIncludes);
+  }
+
+private:
+  static void FindAll(cmsys::RegularExpression const& regExp,
+                      std::string const& content,
+                      std::vector<std::string>& matches)
+  {
+    const char* contentChars = content.c_str();
+    cmsys::RegularExpressionMatch match;
+    while (regExp.find(contentChars, match)) {
+      matches.emplace_back(match.match(2));
+      contentChars += match.end();
+    }
+  }
+
+  cmsys::RegularExpression MocInclude;
+  cmsys::RegularExpression UicInclude;
+  std::vector<cmsys::RegularExpression> Macros;
+};
+
+bool compare(std::string const& content, std::string const& what)
+{
+  cmQtAutoMocUicScanner scanner;
+  ASSERT_TRUE(scanner.SetMacroNames(macroNames));
+  cmQtAutoMocUicScanner::OptionsT options;
+  options.Macros = true;
+  options.MocIncludes = true;
+  options.UicIncludes = true;
+  cmQtAutoMocUicScanner::ResultT result;
+  scanner.Scan(content, options, result);
+
+  ReferenceT reference;
+  cmQtAutoMocUicScanner::ResultT expected;
+  reference.Scan(content, expected);
+
+  if (result.Macro != expected.Macro ||
+      result.MocIncludes != expected.MocIncludes ||
+      result.UicIncludes != expected.UicIncludes) {
+    std::cout << "Scan results differ for " << what << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool testCases()
+{
+  std::cout << "testCases()\n";
+
+  char const* cases[] = {
+    "",
+    "Q_OBJECT\n",
+    "\nQ_OBJECT",
+    "\nQ_OBJECT\n",
+    "class A {\n  Q_GADGET\n  Q_OBJECT\n};\n",
+    "class A\n{ Q_OBJECT\n};\n",
+    "class A\n{{Q_OBJECT\n};\n",
+    "\n\t{\tQ_NAMESPACE_EXPORT(X)\n",
+    "\nQ_NAMESPACE_EXPORT\n",
+    "\nQ_OBJECTS\n\nQ_OBJECT_X\n\nQ_OBJ\n",
+    "\nCUSTOM_MACRO()\n",
+    "#include \"moc_a.cpp\"\n",
+    "#include <moc_a.cpp>\n#include \"a.moc\"\n",
+    "  #  include\t\"dir/moc_a.cpp\"\n",
+    "#include \"/moc_a.cpp\"\n#include \"d//moc_a.cpp\"\n",
+    "#include \"moc_.cpp\"\n#include \".moc\"\n#include \"x.moc\"\n",
+    "#include \"a.moc\" #include \"b.moc\"\n",
+    "#include \"a.moc\"#include \"b.moc\"#include <ui_c.h>\n",
+    "#include <ui_a.h>#include \"b.moc\"\n#include <ui_d.h>\n",
+    "#include \"a.moc\n#include \"b.moc\"\n",
+    "#include \"a\n#include\t<b.moc\"\n",
+    "#include \"a.moc \"\n#include\"b.moc\"\n#include \"c.moc\n",
+    "#include \"ui_a.h\"\n#include \"ui_.h\"\n#include \"x/ui_b.h>\n",
+    "#include \"ui_a.hpp\"\n#include \"moc_a.cxx\"\n#include \"a.moc.h\"\n",
+    "#include \"a.moc\"\n",
+    "#include \"a.moc",
+    "#include \"a.moc\"",
+    "#includ \"a.moc\"\n# include \"b.moc\"\n#\tinclude\t\"c.moc\"\n",
+    "x#include \"a.moc\"\n",
+    "\r\n#include \"a.moc\"\r\nQ_OBJECT\r\n",
+  };
+  bool result = true;
+  for (char const* content : cases) {
+    if (!compare(content, std::string("\"") + content + "\"")) {
+      result = false;
+    }
+  }
+
+  // The scan stops at the first null character
+  std::string withNull("#include \"a.moc\"\nQ_OBJECT\n", 26);
+  withNull.insert(17, 1, '\0');
+  if (!compare(withNull, "content with a null character")) {
+    result = false;
+  }
+  return result;
+}
+
+bool testSources(std::string const& sourceDir)
+{
+  std::cout << "testSources()\n";
+
+  cmsys::Glob glob;
+  glob.RecurseOn();
+  ASSERT_TRUE(glob.FindFiles(sourceDir + "/*"));
+  std::vector<std::string> const& files = glob.GetFiles();
+  ASSERT_TRUE(!files.empty());
+
+  bool result = true;
+  for (std::string const& file : files) {
+    cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+    ASSERT_TRUE(fin);
+    std::string content((std::istreambuf_iterator<char>(fin)),
+                        std::istreambuf_iterator<char>());
+    if (!compare(content, file)) {
+      result = false;
+    }
+  }
+  return result;
+}
+
+bool testUnsupportedMacroNames()
+{
+  std::cout << "testUnsupportedMacroNames()\n";
+
+  cmQtAutoMocUicScanner scanner;
+  ASSERT_TRUE(!scanner.ScansMacros());
+  ASSERT_TRUE(!scanner.SetMacroNames({ "Q_OBJECT", "MACRO(X)" }));
+  ASSERT_TRUE(!scanner.ScansMacros());
+  ASSERT_TRUE(!scanner.SetMacroNames({ "" }));
+  ASSERT_TRUE(scanner.SetMacroNames({ "Q_OBJECT" }));
+  ASSERT_TRUE(scanner.ScansMacros());
+  return true;
+}
+}
+
+int testQtAutoMocUicScanner(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cout << "Invalid arguments.\n";
+    return -1;
+  }
+
+  int result = 0;
+  if (!testCases()) {
+    result = 1;
+  }
+  if (!testSources(argv[1])) {
+    result = 1;
+  }
+  if (!testUnsupportedMacroNames()) {
+    result = 1;
+  }
+  return result;
+}
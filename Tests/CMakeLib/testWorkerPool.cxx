@@ -0,0 +1,236 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cm/memory>
+
+#include "cmWorkerPool.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+namespace {
+
+/** Order in which the jobs were processed.  */
+struct LogT
+{
+  std::mutex Mutex;
+  std::vector<std::string> Names;
+
+  std::size_t Index(std::string const& name) const
+  {
+    return static_cast<std::size_t>(
+      std::find(Names.begin(), Names.end(), name) - Names.begin());
+  }
+};
+
+class LogJobT : public cmWorkerPool::JobT
+{
+public:
+  LogJobT(std::string name, bool fence = false)
+    : cmWorkerPool::JobT(fence)
+    , Name_(std::move(name))
+  {
+  }
+
+  std::string Name() const override { return Name_; }
+
+  void Process() override
+  {
+    auto* log = static_cast<LogT*>(UserData());
+    std::lock_guard<std::mutex> lock(log->Mutex);
+    log->Names.push_back(Name_);
+  }
+
+private:
+  std::string Name_;
+};
+
+class EndJobT : public cmWorkerPool::JobT
+{
+public:
+  EndJobT()
+    : cmWorkerPool::JobT(true)
+  {
+  }
+
+  void Process() override { Pool()->Abort(); }
+};
+
+bool testFences()
+{
+  std::cout << "testFences()\n";
+
+  LogT log;
+  cmWorkerPool pool;
+  pool.SetThreadCount(4);
+  for (int i = 0; i != 20; ++i) {
+    pool.EmplaceJob<LogJobT>("a" + std::to_string(i));
+  }
+  pool.EmplaceJob<LogJobT>("fence", true);
+  for (int i = 0; i != 20; ++i) {
+    pool.EmplaceJob<LogJobT>("b" + std::to_string(i));
+  }
+  pool.EmplaceJob<EndJobT>();
+  ASSERT_TRUE(pool.Process(&log));
+
+  ASSERT_TRUE(log.Names.size() == 41);
+  std::size_t const fence = log.Index("fence");
+  ASSERT_TRUE(fence == 20);
+  for (int i = 0; i != 20; ++i) {
+    ASSERT_TRUE(log.Index("a" + std::to_string(i)) < fence);
+    ASSERT_TRUE(log.Index("b" + std::to_string(i)) > fence);
+  }
+  return true;
+}
+
+bool testGroups()
+{
+  std::cout << "testGroups()\n";
+
+  LogT log;
+  cmWorkerPool pool;
+  pool.SetThreadCount(4);
+  auto first = std::make_shared<cmWorkerPool::GroupT>();
+  auto second = std::make_shared<cmWorkerPool::GroupT>();
+  for (int i = 0; i != 20; ++i) {
+    auto job = cm::make_unique<LogJobT>("a" + std::to_string(i));
+    job->JoinGroup(first);
+    pool.PushJob(std::move(job));
+  }
+  {
+    auto job = cm::make_unique<LogJobT>("b");
+    job->WaitForGroup(first);
+    job->JoinGroup(second);
+    pool.PushJob(std::move(job));
+  }
+  {
+    auto job = cm::make_unique<LogJobT>("c");
+    job->WaitForGroup(first);
+    job->WaitForGroup(second);
+    pool.PushJob(std::move(job));
+  }
+  // Waiting for a group without jobs does not block
+  {
+    auto job = cm::make_unique<LogJobT>("d");
+    job->WaitForGroup(std::make_shared<cmWorkerPool::GroupT>());
+    pool.PushJob(std::move(job));
+  }
+  pool.EmplaceJob<EndJobT>();
+  ASSERT_TRUE(pool.Process(&log));
+
+  ASSERT_TRUE(log.Names.size() == 23);
+  std::size_t const b = log.Index("b");
+  for (int i = 0; i != 20; ++i) {
+    ASSERT_TRUE(log.Index("a" + std::to_string(i)) < b);
+  }
+  ASSERT_TRUE(b < log.Index("c"));
+  ASSERT_TRUE(log.Index("d") < log.Names.size());
+  return true;
+}
+
+bool testGroupJoinedLater()
+{
+  std::cout << "testGroupJoinedLater()\n";
+
+  LogT log;
+  cmWorkerPool pool;
+  pool.SetThreadCount(2);
+  auto group = std::make_shared<cmWorkerPool::GroupT>();
+  auto waiter = std::make_shared<cmWorkerPool::GroupT>();
+  {
+    auto job = cm::make_unique<LogJobT>("a");
+    job->JoinGroup(group);
+    pool.PushJob(std::move(job));
+  }
+  // Waits for "a" only
+  {
+    auto job = cm::make_unique<LogJobT>("w");
+    job->WaitForGroup(group);
+    job->JoinGroup(waiter);
+    pool.PushJob(std::move(job));
+  }
+  // Joins the group after "w" was pushed and waits for "w"
+  {
+    auto job = cm::make_unique<LogJobT>("l");
+    job->WaitForGroup(waiter);
+    job->JoinGroup(group);
+    pool.PushJob(std::move(job));
+  }
+  // Waits for "a" and "l"
+  {
+    auto job = cm::make_unique<LogJobT>("z");
+    job->WaitForGroup(group);
+    pool.PushJob(std::move(job));
+  }
+  pool.EmplaceJob<EndJobT>();
+  ASSERT_TRUE(pool.Process(&log));
+
+  std::vector<std::string> const expected = { "a", "w", "l", "z" };
+  ASSERT_TRUE(log.Names == expected);
+  return true;
+}
+
+bool testPriorities()
+{
+  std::cout << "testPriorities()\n";
+
+  LogT log;
+  cmWorkerPool pool;
+  pool.SetThreadCount(1);
+  pool.SetRecordJobTimes(true);
+  int const priorities[] = { 0, 2, 1, 2, 0 };
+  int index = 0;
+  for (int priority : priorities) {
+    auto job = cm::make_unique<LogJobT>("p" + std::to_string(priority) +
+                                        "-" + std::to_string(index++));
+    job->SetPriority(priority);
+    pool.PushJob(std::move(job));
+  }
+  pool.EmplaceJob<EndJobT>();
+  ASSERT_TRUE(pool.Process(&log));
+
+  std::vector<std::string> const expected = { "p2-1", "p2-3", "p1-2", "p0-0",
+                                              "p0-4" };
+  ASSERT_TRUE(log.Names == expected);
+
+  // The job times are ordered by start time
+  std::vector<cmWorkerPool::JobTimeT> const& times = pool.JobTimes();
+  ASSERT_TRUE(times.size() == 6);
+  for (std::size_t i = 0; i != expected.size(); ++i) {
+    ASSERT_TRUE(times[i].Name == expected[i]);
+    ASSERT_TRUE(times[i].WorkerIndex == 0);
+  }
+  ASSERT_TRUE(times.back().Name == "fence");
+  return true;
+}
+}
+
+int testWorkerPool(int /*unused*/, char* /*unused*/ [])
+{
+  int result = 0;
+  if (!testFences()) {
+    result = 1;
+  }
+  if (!testGroups()) {
+    result = 1;
+  }
+  if (!testGroupJoinedLater()) {
+    result = 1;
+  }
+  if (!testPriorities()) {
+    result = 1;
+  }
+  return result;
+}
@@ -0,0 +1,23 @@
+# Evaluate if() and while() conditions in a hot loop.  Run this script
+# with "cmake -P" under a timer to measure the cost of conditions:
+#
+#   time cmake -DN=200000 -P Tests/ConditionBenchmark.cmake
+
+cmake_policy(VERSION 3.4)
+
+if(NOT DEFINED N)
+  set(N 100000)
+endif()
+
+set(list "a;b;c;d")
+set(i 0)
+set(evens 0)
+while(i LESS N AND NOT (i EQUAL -1 OR DEFINED ENV{CMAKE_BENCHMARK_STOP}))
+  if(i MATCHES "[02468]$" AND "b" IN_LIST list)
+    math(EXPR evens "${evens} + 1")
+  elseif(NOT i STREQUAL "x" AND (i GREATER 10 OR i VERSION_LESS 1.0))
+  endif()
+  math(EXPR i "${i} + 1")
+endwhile()
+
+message(STATUS "Evaluated ${N} iterations, ${evens} even")
@@ -6,3 +6,57 @@ if (with_qt5)
   run_cmake(QtInFunctionNested)
   run_cmake(QtInFunctionProperty)
 endif ()
+
+# The shared parse cache does not need Qt.  Run the AUTOMOC step of
+# targets directly with hand-written info files.  Nothing is moc'ed, so
+# the moc executable is never run.
+set(dir "${RunCMake_BINARY_DIR}/SharedParseCache-build")
+file(REMOVE_RECURSE "${dir}")
+file(MAKE_DIRECTORY "${dir}")
+set(RunCMake_TEST_BINARY_DIR "${dir}")
+set(RunCMake_TEST_NO_CLEAN 1)
+
+function(run_shared_parse_cache target)
+  set(sources "")
+  foreach(src IN LISTS ARGN)
+    if(NOT EXISTS "${dir}/${src}")
+      file(WRITE "${dir}/${src}" "int ${src}_value;\n")
+    endif()
+    list(APPEND sources "[ \"${dir}/${src}\", \"Mu\" ]")
+  endforeach()
+  string(REPLACE ";" ", " sources "${sources}")
+  set(build "${dir}/${target}_autogen")
+  file(WRITE "${dir}/${target}.json" "{
+  \"MULTI_CONFIG\": false,
+  \"PARALLEL\": 1,
+  \"VERBOSITY\": 1,
+  \"CMAKE_SOURCE_DIR\": \"${dir}\",
+  \"CMAKE_BINARY_DIR\": \"${dir}\",
+  \"CMAKE_CURRENT_SOURCE_DIR\": \"${dir}\",
+  \"CMAKE_CURRENT_BINARY_DIR\": \"${dir}\",
+  \"BUILD_DIR\": \"${build}\",
+  \"INCLUDE_DIR\": \"${build}/include\",
+  \"QT_VERSION_MAJOR\": 5,
+  \"QT_VERSION_MINOR\": 15,
+  \"QT_MOC_EXECUTABLE\": \"${CMAKE_COMMAND}\",
+  \"CMAKE_EXECUTABLE\": \"${CMAKE_COMMAND}\",
+  \"SETTINGS_FILE\": \"${build}/AutogenUsed.txt\",
+  \"PARSE_CACHE_FILE\": \"${build}/ParseCache.txt\",
+  \"PARSE_CACHE_SHARED_FILE\": \"${dir}/CMakeFiles/AutogenParseCache.bin\",
+  \"HEADER_EXTENSIONS\": [ \"h\" ],
+  \"HEADERS\": [],
+  \"SOURCES\": [ ${sources} ],
+  \"MOC_PATH_PREFIX\": false,
+  \"MOC_MACRO_NAMES\": [ \"Q_OBJECT\" ],
+  \"MOC_COMPILATION_FILE\": \"${build}/mocs_compilation.cpp\"
+}
+")
+  run_cmake_command(SharedParseCache-${target}
+    ${CMAKE_COMMAND} -E cmake_autogen "${dir}/${target}.json" Release)
+endfunction()
+
+run_shared_parse_cache(first x.cpp y.cpp)
+# The second target reuses the results for x.cpp, and writing the
+# results for z.cpp drops those of the removed y.cpp.
+file(REMOVE "${dir}/y.cpp")
+run_shared_parse_cache(second x.cpp z.cpp)
@@ -0,0 +1,11 @@
+set(cache "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/AutogenParseCache.bin")
+file(STRINGS "${cache}" entries REGEX "\\.cpp")
+set(RunCMake_TEST_FAILED "")
+foreach(expect IN ITEMS x z)
+  if(NOT entries MATCHES "/${expect}\\.cpp")
+    string(APPEND RunCMake_TEST_FAILED "No entry for ${expect}.cpp.\n")
+  endif()
+endforeach()
+if(entries MATCHES "/y\\.cpp")
+  string(APPEND RunCMake_TEST_FAILED "The entry for y.cpp was kept.\n")
+endif()
@@ -0,0 +1,8 @@
+#ifdef INCLUDE_HEADER
+#  include "MakeCompilerDepends.h"
+#endif
+
+int main(void)
+{
+  return MakeCompilerDepends();
+}
@@ -0,0 +1,20 @@
+enable_language(C)
+set(CMAKE_DEPENDS_USE_COMPILER 1)
+add_executable(MakeCompilerDepends MakeCompilerDepends.c)
+if(CMAKE_C_DEPFILE_FORMAT STREQUAL "gcc")
+  # Only the compiler knows about a header included from its command line.
+  target_compile_options(MakeCompilerDepends PRIVATE
+    -include ${CMAKE_CURRENT_BINARY_DIR}/MakeCompilerDepends.h)
+else()
+  target_compile_definitions(MakeCompilerDepends PRIVATE INCLUDE_HEADER)
+  target_include_directories(MakeCompilerDepends PRIVATE
+    ${CMAKE_CURRENT_BINARY_DIR})
+endif()
+file(GENERATE OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/check-$<LOWER_CASE:$<CONFIG>>.cmake CONTENT "
+set(check_pairs
+  \"$<TARGET_FILE:MakeCompilerDepends>|${CMAKE_CURRENT_BINARY_DIR}/MakeCompilerDepends.h\"
+  )
+set(check_exes
+  \"$<TARGET_FILE:MakeCompilerDepends>\"
+  )
+")
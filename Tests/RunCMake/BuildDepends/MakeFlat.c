@@ -0,0 +1,9 @@
+#include "MakeFlatExe.h"
+#include "MakeFlatGen.h"
+
+int MakeFlatLib(void);
+
+int main(void)
+{
+  return MakeFlatLib() + MAKE_FLAT_EXE + MAKE_FLAT_GEN;
+}
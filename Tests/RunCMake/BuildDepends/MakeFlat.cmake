@@ -0,0 +1,42 @@
+enable_language(C)
+set(CMAKE_FLAT_MAKEFILES 1)
+
+# The library must be compiled after the header is generated by another
+# target, even though no rule of the library names the header yet.
+add_custom_command(OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/MakeFlat.h
+  COMMAND ${CMAKE_COMMAND} -E copy ${CMAKE_CURRENT_BINARY_DIR}/MakeFlat.h.in
+                                   ${CMAKE_CURRENT_BINARY_DIR}/MakeFlat.h
+  DEPENDS ${CMAKE_CURRENT_BINARY_DIR}/MakeFlat.h.in
+  )
+add_custom_target(MakeFlatHeader DEPENDS ${CMAKE_CURRENT_BINARY_DIR}/MakeFlat.h)
+add_library(MakeFlatLib STATIC MakeFlatLib.c)
+add_dependencies(MakeFlatLib MakeFlatHeader)
+target_include_directories(MakeFlatLib PUBLIC ${CMAKE_CURRENT_BINARY_DIR})
+
+# The executable must be compiled after a header generated by one of its
+# own custom commands, even though no rule names the header before the
+# dependencies are scanned.
+add_custom_command(OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/MakeFlatGen.h
+  COMMAND ${CMAKE_COMMAND} -E sleep 1
+  COMMAND ${CMAKE_COMMAND} -E copy ${CMAKE_CURRENT_BINARY_DIR}/MakeFlatGen.h.in
+                                   ${CMAKE_CURRENT_BINARY_DIR}/MakeFlatGen.h
+  DEPENDS ${CMAKE_CURRENT_BINARY_DIR}/MakeFlatGen.h.in
+  )
+add_executable(MakeFlat MakeFlat.c ${CMAKE_CURRENT_BINARY_DIR}/MakeFlatGen.h)
+target_link_libraries(MakeFlat PRIVATE MakeFlatLib)
+
+file(GENERATE OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/check-$<LOWER_CASE:$<CONFIG>>.cmake CONTENT "
+set(check_pairs
+  \"$<TARGET_FILE:MakeFlat>|${CMAKE_CURRENT_BINARY_DIR}/MakeFlat.h.in\"
+  \"$<TARGET_FILE:MakeFlat>|${CMAKE_CURRENT_BINARY_DIR}/MakeFlatExe.h\"
+  \"$<TARGET_FILE:MakeFlat>|${CMAKE_CURRENT_BINARY_DIR}/MakeFlatGen.h.in\"
+  )
+set(check_exes
+  \"$<TARGET_FILE:MakeFlat>\"
+  )
+file(STRINGS \"${CMAKE_BINARY_DIR}/CMakeFiles/Makefile2\" includes
+  REGEX \"^include .*/build.make$\")
+if(NOT includes)
+  string(APPEND RunCMake_TEST_FAILED \"Makefile2 does not include the target rules.\\n\")
+endif()
+")
@@ -0,0 +1,9 @@
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeFlat.h.in" [[
+#define MAKE_FLAT_LIB 0
+]])
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeFlatExe.h" [[
+#define MAKE_FLAT_EXE 2
+]])
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeFlatGen.h.in" [[
+#define MAKE_FLAT_GEN 0
+]])
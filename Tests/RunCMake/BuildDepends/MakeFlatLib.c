@@ -0,0 +1,6 @@
+#include "MakeFlat.h"
+
+int MakeFlatLib(void)
+{
+  return MAKE_FLAT_LIB;
+}
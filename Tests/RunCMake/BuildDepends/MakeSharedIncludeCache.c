@@ -0,0 +1,6 @@
+#include <MakeSharedIncludeCache1.h>
+
+int main(void)
+{
+  return MakeSharedIncludeCache();
+}
@@ -0,0 +1,30 @@
+enable_language(C)
+add_executable(MakeSharedIncludeCache1 MakeSharedIncludeCache.c)
+add_executable(MakeSharedIncludeCache2 MakeSharedIncludeCache.c)
+foreach(t MakeSharedIncludeCache1 MakeSharedIncludeCache2)
+  target_include_directories(${t} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endforeach()
+file(GENERATE OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/check-$<LOWER_CASE:$<CONFIG>>.cmake CONTENT "
+set(check_pairs
+  \"$<TARGET_FILE:MakeSharedIncludeCache1>|${CMAKE_CURRENT_BINARY_DIR}/MakeSharedIncludeCache2.h\"
+  \"$<TARGET_FILE:MakeSharedIncludeCache2>|${CMAKE_CURRENT_BINARY_DIR}/MakeSharedIncludeCache2.h\"
+  )
+set(check_exes
+  \"$<TARGET_FILE:MakeSharedIncludeCache1>\"
+  \"$<TARGET_FILE:MakeSharedIncludeCache2>\"
+  )
+file(GLOB caches \"${CMAKE_BINARY_DIR}/CMakeFiles/CMakeIncludeCache/C-*.includecache\")
+list(LENGTH caches num_caches)
+if(NOT num_caches EQUAL 1)
+  string(APPEND RunCMake_TEST_FAILED \"Expected one shared include cache, found:\\n \${caches}\\n\")
+endif()
+if(check_step EQUAL 2 AND num_caches EQUAL 1)
+  file(READ \"\${caches}\" cache)
+  if(cache MATCHES \"MakeSharedIncludeCacheOld\\\\.h\\n\")
+    string(APPEND RunCMake_TEST_FAILED \"The include cache still has an entry for a removed header.\\n\")
+  endif()
+  if(NOT cache MATCHES \"MakeSharedIncludeCacheNew\\\\.h\\n\")
+    string(APPEND RunCMake_TEST_FAILED \"The include cache has no entry for the new header.\\n\")
+  endif()
+endif()
+")
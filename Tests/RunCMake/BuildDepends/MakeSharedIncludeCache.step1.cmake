@@ -0,0 +1,9 @@
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeSharedIncludeCache1.h" [[
+#include "MakeSharedIncludeCacheOld.h"
+]])
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeSharedIncludeCacheOld.h" [[
+#include "MakeSharedIncludeCache2.h"
+]])
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeSharedIncludeCache2.h" [[
+static int MakeSharedIncludeCache(void) { return 1; }
+]])
@@ -0,0 +1,11 @@
+# Rename a header so that its cache entry is stale.
+file(REMOVE "${RunCMake_TEST_BINARY_DIR}/MakeSharedIncludeCacheOld.h")
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeSharedIncludeCacheNew.h" [[
+#include "MakeSharedIncludeCache2.h"
+]])
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeSharedIncludeCache1.h" [[
+#include "MakeSharedIncludeCacheNew.h"
+]])
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/MakeSharedIncludeCache2.h" [[
+static int MakeSharedIncludeCache(void) { return 2; }
+]])
@@ -60,6 +60,11 @@ unset(RunCMake_TEST_SOURCE_DIR)
 
 if(RunCMake_GENERATOR MATCHES "Make")
   run_BuildDepends(MakeCustomIncludes)
+  run_BuildDepends(MakeCompilerDepends)
+  run_BuildDepends(MakeSharedIncludeCache)
+  if(NOT RunCMake_GENERATOR MATCHES "^(Borland|NMake|Watcom)")
+    run_BuildDepends(MakeFlat)
+  endif()
   if(NOT "${RunCMake_BINARY_DIR}" STREQUAL "${RunCMake_SOURCE_DIR}")
     run_BuildDepends(MakeInProjectOnly)
   endif()
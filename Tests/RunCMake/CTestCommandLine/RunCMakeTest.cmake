@@ -242,6 +242,85 @@ function(run_TestOutputSize)
 endfunction()
 run_TestOutputSize()
 
+function(run_TestOutputSpill name)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/${name})
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/output.cmake" [[
+foreach(i RANGE 1 1000)
+  message("Line ${i} of the test output")
+  if(i EQUAL 500 AND FULL)
+    message("CTEST_FULL_OUTPUT")
+  endif()
+endforeach()
+]])
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(FullOutput \"${CMAKE_COMMAND}\" -DFULL=1 -P output.cmake)
+  set_tests_properties(FullOutput PROPERTIES
+    PASS_REGULAR_EXPRESSION \"Line 500 of the test output\\nCTEST_FULL_OUTPUT\")
+  add_test(TruncatedOutput \"${CMAKE_COMMAND}\" -P output.cmake)
+  set_tests_properties(TruncatedOutput PROPERTIES
+    FAIL_REGULAR_EXPRESSION \"Line 700 of\")
+  add_test(SpanningOutput \"${CMAKE_COMMAND}\" -P output.cmake)
+  set_tests_properties(SpanningOutput PROPERTIES
+    PASS_REGULAR_EXPRESSION \"Line 998 of the test output\\nLine 999 of the test output\\nLine 1000 of\")
+")
+  # The output of all tests exceeds what is kept in memory.
+  run_cmake_command(${name}
+    ${CMAKE_CTEST_COMMAND} -M Experimental -T Test
+                           ${ARGN}
+                           --test-output-size-passed 10
+                           --test-output-size-failed 12
+    )
+endfunction()
+run_TestOutputSpill(TestOutputSpill --no-compress-output)
+run_TestOutputSpill(TestOutputSpillCompressed)
+
+function(run_Shards)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Shards)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(Expensive \"${CMAKE_COMMAND}\" -E echo)
+add_test(Dependency \"${CMAKE_COMMAND}\" -E echo)
+add_test(Dependent \"${CMAKE_COMMAND}\" -E echo)
+set_tests_properties(Dependent PROPERTIES DEPENDS Dependency)
+add_test(Setup \"${CMAKE_COMMAND}\" -E echo)
+set_tests_properties(Setup PROPERTIES FIXTURES_SETUP Fixture)
+add_test(Required \"${CMAKE_COMMAND}\" -E echo)
+set_tests_properties(Required PROPERTIES FIXTURES_REQUIRED Fixture)
+add_test(Cleanup \"${CMAKE_COMMAND}\" -E echo)
+set_tests_properties(Cleanup PROPERTIES FIXTURES_CLEANUP Fixture)
+add_test(Unrecorded \"${CMAKE_COMMAND}\" -E echo)
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt" "\
+Expensive 1 10
+Dependency 1 1
+Dependent 1 1
+Setup 1 2
+Required 1 2
+Cleanup 1 1
+---
+")
+  run_cmake_command(Shards-0 ${CMAKE_CTEST_COMMAND} -N
+    --shard-index 0 --shard-count 3)
+  run_cmake_command(Shards-1 ${CMAKE_CTEST_COMMAND} -N
+    --shard-index 1 --shard-count 3)
+  run_cmake_command(Shards-2 ${CMAKE_CTEST_COMMAND} -N
+    --shard-index 2 --shard-count 3)
+  run_cmake_command(Shards-fixture ${CMAKE_CTEST_COMMAND} -N
+    --shard-index 0 --shard-count 3 -R Required)
+  run_cmake_command(Shards-bad-index ${CMAKE_CTEST_COMMAND} -N
+    --shard-index 2 --shard-count 2)
+  run_cmake_command(Shards-no-count ${CMAKE_CTEST_COMMAND} -N
+    --shard-index 0)
+  run_cmake_command(Shards-bad-count ${CMAKE_CTEST_COMMAND} -N
+    --shard-index 0 --shard-count 0)
+endfunction()
+run_Shards()
+
 function(run_TestAffinity)
   set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestAffinity)
   set(RunCMake_TEST_NO_CLEAN 1)
@@ -0,0 +1,31 @@
+file(GLOB test_xml_file "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+if(test_xml_file)
+  file(READ "${test_xml_file}" test_xml)
+  if("${test_xml}" MATCHES [[(<Test Status="passed">.*</Test>).*(<Test Status="failed">.*</Test>)]])
+    set(test_passed "${CMAKE_MATCH_1}")
+    set(test_failed "${CMAKE_MATCH_2}")
+  else()
+    set(RunCMake_TEST_FAILED "Test.xml does not contain a passed then failed test:\n ${test_xml}")
+  endif()
+  if(NOT "${test_passed}" MATCHES [[<Value>Line 1 of.*Line 1000 of the test output]])
+    set(RunCMake_TEST_FAILED "Test.xml passed test output not complete:\n ${test_passed}")
+  elseif(NOT "${test_failed}" MATCHES [[<Value>Line 1 of th\.\.\..*12 bytes]])
+    set(RunCMake_TEST_FAILED "Test.xml failed test output not truncated at 12 bytes:\n ${test_failed}")
+  elseif(NOT "${test_xml}" MATCHES [[<Test Status="passed">[^<]*<Name>SpanningOutput</Name>]])
+    set(RunCMake_TEST_FAILED "Test.xml does not contain the passed SpanningOutput test:\n ${test_xml}")
+  endif()
+else()
+  set(RunCMake_TEST_FAILED "Test.xml not found")
+endif()
+
+file(GLOB spill_files "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/TestOutput_*")
+if(spill_files)
+  string(APPEND RunCMake_TEST_FAILED "Test output files not removed:\n ${spill_files}\n")
+endif()
+
+file(GLOB log_file "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/LastTest_*.log")
+file(STRINGS "${log_file}" log_lines REGEX "^Line 1000 of the test output$")
+list(LENGTH log_lines log_count)
+if(NOT log_count EQUAL 3)
+  string(APPEND RunCMake_TEST_FAILED "LastTest.log does not contain the complete output of all tests\n")
+endif()
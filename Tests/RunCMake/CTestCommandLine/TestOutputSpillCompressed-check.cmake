@@ -0,0 +1,16 @@
+file(GLOB test_xml_file "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+if(test_xml_file)
+  file(READ "${test_xml_file}" test_xml)
+  if(NOT "${test_xml}" MATCHES [[<Name>FullOutput</Name>.*<Value encoding="base64" compression="gzip">[A-Za-z0-9+/]+=*</Value>.*<Name>TruncatedOutput</Name>]])
+    set(RunCMake_TEST_FAILED "Test.xml passed test output not compressed:\n ${test_xml}")
+  elseif(NOT "${test_xml}" MATCHES [[<Test Status="passed">[^<]*<Name>SpanningOutput</Name>]])
+    set(RunCMake_TEST_FAILED "Test.xml does not contain the passed SpanningOutput test:\n ${test_xml}")
+  endif()
+else()
+  set(RunCMake_TEST_FAILED "Test.xml not found")
+endif()
+
+file(GLOB spill_files "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/TestOutput_*")
+if(spill_files)
+  string(APPEND RunCMake_TEST_FAILED "Test output files not removed:\n ${spill_files}\n")
+endif()
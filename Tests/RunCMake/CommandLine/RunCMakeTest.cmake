@@ -23,6 +23,9 @@ run_cmake_command(E_compare_files-ignore-eol-same ${CMAKE_COMMAND} -E compare_fi
 run_cmake_command(E_compare_files-ignore-eol-empty ${CMAKE_COMMAND} -E compare_files --ignore-eol ${RunCMake_SOURCE_DIR}/compare_files/empty1 ${RunCMake_SOURCE_DIR}/compare_files/empty2)
 run_cmake_command(E_compare_files-ignore-eol-nonexistent ${CMAKE_COMMAND} -E compare_files --ignore-eol nonexistent_a nonexistent_b)
 run_cmake_command(E_echo_append ${CMAKE_COMMAND} -E echo_append)
+run_cmake_command(E_batch ${CMAKE_COMMAND} -E batch ${RunCMake_SOURCE_DIR}/batch/commands.txt echo first)
+run_cmake_command(E_batch-fail ${CMAKE_COMMAND} -E batch ${RunCMake_SOURCE_DIR}/batch/fail.txt)
+run_cmake_command(E_batch-no-file ${CMAKE_COMMAND} -E batch ${RunCMake_SOURCE_DIR}/batch/nonexistent.txt)
 run_cmake_command(E_rename-no-arg ${CMAKE_COMMAND} -E rename)
 run_cmake_command(E_server-arg ${CMAKE_COMMAND} -E server --extra-arg)
 run_cmake_command(E_server-pipe ${CMAKE_COMMAND} -E server --pipe=)
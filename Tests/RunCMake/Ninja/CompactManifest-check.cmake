@@ -0,0 +1,27 @@
+set(fragment "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/many.dir/build.ninja")
+file(READ "${fragment}" content)
+string(LENGTH "${content}" size)
+
+# Compute the size the fragment would have with the shared values
+# repeated in every object build statement.
+set(expanded_size ${size})
+foreach(var IN ITEMS FLAGS DEFINES INCLUDES)
+  if(NOT content MATCHES "\nC_${var} = ([^\n]*)\n")
+    set(RunCMake_TEST_FAILED "Shared variable C_${var} not written to:\n  ${fragment}")
+    return()
+  endif()
+  string(LENGTH "${CMAKE_MATCH_1}" value_size)
+  string(LENGTH "$C_${var}" ref_size)
+  string(REGEX MATCHALL "\n  ${var} = [^\n]*\\$C_${var}" refs "${content}")
+  list(LENGTH refs count)
+  if(NOT count EQUAL 100)
+    set(RunCMake_TEST_FAILED "${count} object build statements refer to C_${var}, expected 100.")
+    return()
+  endif()
+  math(EXPR expanded_size "${expanded_size} + ${count} * (${value_size} - ${ref_size})")
+endforeach()
+
+math(EXPR max_size "${expanded_size} / 3")
+if(size GREATER max_size)
+  set(RunCMake_TEST_FAILED "The fragment is not at least 3 times smaller than with repeated values:\n  ${size} bytes written\n  ${expanded_size} bytes without shared variables")
+endif()
@@ -0,0 +1,22 @@
+set(CMAKE_NINJA_TARGET_FRAGMENTS ON)
+
+enable_language(C)
+
+# A synthetic target with many sources that share long compile options.
+set(sources "")
+foreach(i RANGE 1 100)
+  list(APPEND sources "${CMAKE_CURRENT_BINARY_DIR}/src/source${i}.c")
+endforeach()
+set_source_files_properties(${sources} PROPERTIES GENERATED 1)
+add_library(many STATIC ${sources})
+
+foreach(i RANGE 1 30)
+  target_include_directories(many PRIVATE
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/component${i}/public")
+  target_compile_definitions(many PRIVATE COMPONENT${i}_ENABLED=1)
+endforeach()
+target_compile_options(many PRIVATE -Wall -Wextra -Wshadow -Wconversion)
+
+# A source with its own options refers to the shared values.
+set_property(SOURCE "${CMAKE_CURRENT_BINARY_DIR}/src/source1.c"
+  PROPERTY COMPILE_DEFINITIONS SOURCE_ONLY=1)
@@ -1,5 +1,11 @@
 set(log "${RunCMake_BINARY_DIR}/CustomCommandJobPool-build/build.ninja")
 file(READ "${log}" build_file)
+# The build statements of targets are in per-target fragments.
+file(GLOB fragments "${RunCMake_BINARY_DIR}/CustomCommandJobPool-build/CMakeFiles/*.dir/build.ninja")
+foreach(fragment IN LISTS fragments)
+  file(READ "${fragment}" fragment_file)
+  string(APPEND build_file "${fragment_file}")
+endforeach()
 if(NOT "${build_file}" MATCHES "pool = custom_command_pool")
   set(RunCMake_TEST_FAILED "Log file:\n ${log}\ndoes not have expected line: pool = custom_command_pool")
 endif()
@@ -0,0 +1,17 @@
+set(fragment "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/batch.dir/build.ninja")
+file(READ "${fragment}" content)
+if(NOT content MATCHES "\nbuild [^\n]*batch_use\\.f90\\.o\\.ddi [^\n]*batch_mod\\.f90\\.o\\.ddi: Fortran_SCAN__batch_ ")
+  set(RunCMake_TEST_FAILED "The sources are not scanned by one build statement in:\n  ${fragment}")
+  return()
+endif()
+if(content MATCHES "DYNDEP_INTERMEDIATE_FILE")
+  set(RunCMake_TEST_FAILED "The preprocessing build statements still scan in:\n  ${fragment}")
+  return()
+endif()
+
+set(tdi "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/batch.dir/FortranDependInfo.json")
+file(READ "${tdi}" tdi_content)
+if(NOT tdi_content MATCHES "\"scan-sources\"" OR
+   NOT tdi_content MATCHES "\"ddi\" : \"CMakeFiles/batch.dir/batch_mod.f90.o.ddi\"")
+  set(RunCMake_TEST_FAILED "The scanned sources are not listed in:\n  ${tdi}")
+endif()
@@ -0,0 +1,3 @@
+enable_language(Fortran)
+set(CMAKE_NINJA_BATCH_SCAN ON)
+add_library(batch STATIC batch_use.f90 batch_mod.f90)
@@ -280,6 +280,54 @@ build build.ninja: RERUN ${escaped_build_ninja_dep} || ${escaped_ninja_output_pa
 
 endfunction(run_sub_cmake)
 
+function(run_TargetFragments)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TargetFragments-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_NINJA_TARGET_FRAGMENTS=ON)
+  run_cmake(TargetFragments)
+  unset(RunCMake_TEST_OPTIONS)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  # The first configuration may generate a few variables differently.
+  run_cmake_command(TargetFragments-regenerate ${CMAKE_COMMAND} .)
+  set(fragment "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/hello.dir/build.ninja")
+  file(TIMESTAMP "${fragment}" mtime_before UTC)
+  sleep(3) # We assume the system as 1 sec timestamp resolution.
+  run_cmake_command(TargetFragments-unchanged ${CMAKE_COMMAND} .)
+  file(TIMESTAMP "${fragment}" mtime_after UTC)
+  # A fragment whose content did not change is not rewritten.
+  if(NOT mtime_after STREQUAL mtime_before)
+    message(FATAL_ERROR
+      "unchanged fragment was rewritten:
+  before = ${mtime_before}
+  after  = ${mtime_after}")
+  endif()
+  run_ninja("${RunCMake_TEST_BINARY_DIR}")
+
+  # The fragments of removed targets are deleted.
+  set(greeting "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/greeting.dir/build.ninja")
+  run_cmake_command(TargetFragments-removed ${CMAKE_COMMAND} -DNO_GREETING=1 .)
+  if(EXISTS "${greeting}" OR NOT EXISTS "${fragment}")
+    message(FATAL_ERROR "only the fragment of the removed target is deleted")
+  endif()
+  run_cmake_command(TargetFragments-disabled ${CMAKE_COMMAND}
+    -DCMAKE_NINJA_TARGET_FRAGMENTS=OFF .)
+  if(EXISTS "${fragment}")
+    message(FATAL_ERROR "fragment not deleted after opting out:\n  ${fragment}")
+  endif()
+endfunction()
+run_TargetFragments()
+
+run_cmake(CompactManifest)
+
+function(run_FortranBatchScan)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/FortranBatchScan-build)
+  run_cmake(FortranBatchScan)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  run_ninja("${RunCMake_TEST_BINARY_DIR}")
+endfunction()
+if(TEST_Fortran)
+  run_FortranBatchScan()
+endif()
+
 if("${ninja_version}" VERSION_LESS 1.6)
   message(WARNING "Ninja is too old; skipping rest of test.")
   return()
@@ -0,0 +1,16 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/build.ninja" build_file)
+foreach(target IN ITEMS hello greeting)
+  set(fragment "CMakeFiles/${target}.dir/build.ninja")
+  if(NOT build_file MATCHES "\nsubninja ${fragment}\n")
+    set(RunCMake_TEST_FAILED "build.ninja does not load ${fragment}")
+    return()
+  endif()
+  if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/${fragment}")
+    set(RunCMake_TEST_FAILED "${fragment} was not generated")
+    return()
+  endif()
+  if(NOT build_file MATCHES "\nbuild build\\.ninja [^\n]*${fragment}[^\n]*: RERUN_CMAKE")
+    set(RunCMake_TEST_FAILED "${fragment} is not an output of the RERUN_CMAKE edge")
+    return()
+  endif()
+endforeach()
@@ -0,0 +1,5 @@
+enable_language(C)
+add_executable(hello hello.c)
+if(NOT NO_GREETING)
+  add_library(greeting STATIC greeting.c)
+endif()
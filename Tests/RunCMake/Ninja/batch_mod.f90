@@ -0,0 +1,3 @@
+module batch_mod
+  integer :: batch_value = 1
+end module batch_mod
@@ -0,0 +1,4 @@
+subroutine batch_use
+  use batch_mod
+  batch_value = 2
+end subroutine batch_use
@@ -0,0 +1,6 @@
+foreach(i RANGE 1 8)
+  add_custom_command(OUTPUT out${i}.txt
+    COMMAND ${CMAKE_COMMAND} -E touch out${i}.txt)
+  add_custom_target(top${i} ALL DEPENDS out${i}.txt)
+endforeach()
+add_subdirectory(sub)
@@ -0,0 +1,58 @@
+include(RunCMake)
+
+set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Project-build)
+set(RunCMake_TEST_NO_CLEAN 1)
+file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+run_cmake(Project)
+
+# Files written by the generate step.
+function(get_build_files var)
+  file(GLOB_RECURSE files RELATIVE "${RunCMake_TEST_BINARY_DIR}"
+    "${RunCMake_TEST_BINARY_DIR}/*")
+  list(FILTER files EXCLUDE REGEX "^CMakeCache.txt$")
+  list(FILTER files EXCLUDE REGEX "^CMakeFiles/[0-9][^/]*/")
+  list(FILTER files EXCLUDE REGEX
+    "^CMakeFiles/(CMakeOutput.log|CMakeError.log|ListFileCache.bin)$")
+  list(SORT files)
+  set(${var} "${files}" PARENT_SCOPE)
+endfunction()
+
+function(read_build_files var)
+  get_build_files(files)
+  set(content "")
+  foreach(f IN LISTS files)
+    file(READ "${RunCMake_TEST_BINARY_DIR}/${f}" c)
+    string(APPEND content "--- ${f}\n${c}")
+  endforeach()
+  set(${var} "${content}" PARENT_SCOPE)
+endfunction()
+
+function(remove_build_files)
+  get_build_files(files)
+  foreach(f IN LISTS files)
+    file(REMOVE "${RunCMake_TEST_BINARY_DIR}/${f}")
+  endforeach()
+endfunction()
+
+remove_build_files()
+run_cmake_command(Project-serial ${CMAKE_COMMAND} .)
+read_build_files(serial)
+
+remove_build_files()
+set(ENV{CMAKE_GENERATE_PARALLEL_LEVEL} 4)
+run_cmake_command(Project-parallel ${CMAKE_COMMAND} .)
+read_build_files(parallel)
+if(NOT parallel STREQUAL serial)
+  message(SEND_ERROR "Files generated in parallel differ from serial ones.")
+endif()
+
+# Nothing changed, so nothing is replaced.
+run_cmake_command(Project-parallel-rerun ${CMAKE_COMMAND} .)
+read_build_files(rerun)
+if(NOT rerun STREQUAL serial)
+  message(SEND_ERROR "Files regenerated in parallel differ.")
+endif()
+
+set(ENV{CMAKE_GENERATE_PARALLEL_LEVEL} invalid)
+run_cmake_command(Project-invalid ${CMAKE_COMMAND} .)
+unset(ENV{CMAKE_GENERATE_PARALLEL_LEVEL})
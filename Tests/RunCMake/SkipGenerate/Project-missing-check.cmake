@@ -0,0 +1,3 @@
+if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/cmake_install.cmake")
+  set(RunCMake_TEST_FAILED "cmake_install.cmake was not generated again.")
+endif()
@@ -0,0 +1,4 @@
+# Projects that did not opt in are not fingerprinted.
+if(EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/GenerateFingerprint.txt")
+  set(RunCMake_TEST_FAILED "The configure step was fingerprinted.")
+endif()
@@ -0,0 +1,11 @@
+if(NOT DEFINED CMAKE_SKIP_UNCHANGED_GENERATE)
+  set(CMAKE_SKIP_UNCHANGED_GENERATE ON)
+endif()
+
+# The test writes this file to change the project between runs.
+include(${CMAKE_CURRENT_BINARY_DIR}/input.cmake)
+
+add_custom_command(OUTPUT out.txt
+  COMMAND ${CMAKE_COMMAND} -E echo "${MESSAGE}" "${SUFFIX}"
+  COMMAND ${CMAKE_COMMAND} -E touch out.txt)
+add_custom_target(top ALL DEPENDS out.txt)
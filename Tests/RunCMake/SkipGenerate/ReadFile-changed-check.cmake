@@ -0,0 +1,14 @@
+file(GLOB_RECURSE build_files
+  "${RunCMake_TEST_BINARY_DIR}/*.make"
+  "${RunCMake_TEST_BINARY_DIR}/*.ninja"
+  )
+set(found 0)
+foreach(f IN LISTS build_files)
+  file(STRINGS "${f}" lines REGEX "SECOND_FLAGS")
+  if(lines)
+    set(found 1)
+  endif()
+endforeach()
+if(NOT found)
+  set(RunCMake_TEST_FAILED "The build system does not use the new flags.")
+endif()
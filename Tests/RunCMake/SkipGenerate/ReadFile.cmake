@@ -0,0 +1,6 @@
+set(CMAKE_SKIP_UNCHANGED_GENERATE ON)
+enable_language(C)
+
+# The flags do not show up in the arguments of any command.
+file(READ ${CMAKE_CURRENT_BINARY_DIR}/flags.txt CMAKE_C_FLAGS)
+add_executable(main main.c)
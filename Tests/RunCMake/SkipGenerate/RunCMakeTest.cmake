@@ -0,0 +1,56 @@
+include(RunCMake)
+
+set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Project-build)
+set(RunCMake_TEST_NO_CLEAN 1)
+file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+set(input "${RunCMake_TEST_BINARY_DIR}/input.cmake")
+set(cmake ${CMAKE_COMMAND} --log-level=VERBOSE)
+
+file(WRITE "${input}" "set(MESSAGE first)\n")
+set(RunCMake_TEST_OPTIONS --log-level=VERBOSE)
+run_cmake(Project)
+unset(RunCMake_TEST_OPTIONS)
+
+# The first run checks the platform and later runs load the results,
+# so the second run executes different commands.
+run_cmake_command(Project-second ${cmake} .)
+
+# Nothing changed.
+run_cmake_command(Project-unchanged ${cmake} .)
+
+# Only a comment changed.
+file(APPEND "${input}" "# comment\n")
+run_cmake_command(Project-comment ${cmake} .)
+
+# The commands executed changed.
+file(WRITE "${input}" "set(MESSAGE second)\n")
+run_cmake_command(Project-changed ${cmake} .)
+
+# The cache changed.
+run_cmake_command(Project-cache ${cmake} -DSUFFIX=suffix .)
+
+# A file written by the generate step is missing.
+file(REMOVE "${RunCMake_TEST_BINARY_DIR}/cmake_install.cmake")
+run_cmake_command(Project-missing ${cmake} .)
+
+run_cmake_command(Project-unchanged-again ${cmake} .)
+
+# Skipping is opt-in.
+run_cmake_command(Project-opt-out ${cmake} -DCMAKE_SKIP_UNCHANGED_GENERATE=OFF .)
+run_cmake_command(Project-opt-out-again ${cmake} .)
+
+# Values read from files are not part of the fingerprint, so a project
+# reading them is generated every time.
+set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ReadFile-build)
+file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+set(flags "${RunCMake_TEST_BINARY_DIR}/flags.txt")
+file(WRITE "${flags}" "-DFIRST_FLAGS")
+set(RunCMake_TEST_OPTIONS --log-level=VERBOSE)
+run_cmake(ReadFile)
+unset(RunCMake_TEST_OPTIONS)
+run_cmake_command(ReadFile-second ${cmake} .)
+run_cmake_command(ReadFile-unchanged ${cmake} .)
+file(WRITE "${flags}" "-DSECOND_FLAGS")
+run_cmake_command(ReadFile-changed ${cmake} .)
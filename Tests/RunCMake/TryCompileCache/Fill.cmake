@@ -0,0 +1,6 @@
+enable_language(C)
+include(CheckCSourceCompiles)
+
+check_c_source_compiles("int main(void) { return 0; }" HAVE_GOOD)
+check_c_source_compiles("int main(void) { return undeclared; }" HAVE_BAD)
+message(STATUS "HAVE_GOOD='${HAVE_GOOD}' HAVE_BAD='${HAVE_BAD}'")
@@ -0,0 +1,15 @@
+include(RunCMake)
+
+set(cache_dir "${RunCMake_BINARY_DIR}/cache")
+file(REMOVE_RECURSE "${cache_dir}")
+set(ENV{CMAKE_TRY_COMPILE_CACHE_DIR} "${cache_dir}")
+set(RunCMake_TEST_OPTIONS --try-compile-cache-stats)
+
+# A fresh build tree fills the cache.
+run_cmake(Fill)
+
+# Another fresh build tree reuses every result.
+run_cmake(Reuse)
+
+unset(RunCMake_TEST_OPTIONS)
+unset(ENV{CMAKE_TRY_COMPILE_CACHE_DIR})
@@ -0,0 +1,3 @@
+if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/out.txt")
+  set(RunCMake_TEST_FAILED "Batch commands did not create:\n  ${RunCMake_TEST_BINARY_DIR}/out.txt")
+endif()
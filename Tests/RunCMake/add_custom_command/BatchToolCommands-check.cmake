@@ -0,0 +1,16 @@
+file(GLOB batchFiles "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/batch/*.txt")
+list(LENGTH batchFiles count)
+if(NOT count EQUAL 1)
+  set(RunCMake_TEST_FAILED "Expected one batch file, found:\n  ${batchFiles}")
+  return()
+endif()
+file(READ "${batchFiles}" actual)
+set(expect [[# Commands run by "cmake -E batch".
+"make_directory" "dir"
+"echo" "batch: a \"b\" c\\d"
+"touch" "dir/stamp"
+"copy" "dir/stamp" "out.txt"
+]])
+if(NOT actual STREQUAL expect)
+  set(RunCMake_TEST_FAILED "Batch file contains:\n${actual}\nnot:\n${expect}")
+endif()
@@ -0,0 +1,4 @@
+file(GLOB batchFiles "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/batch/*.txt")
+if(batchFiles)
+  set(RunCMake_TEST_FAILED "Batch files not cleaned:\n  ${batchFiles}")
+endif()
@@ -0,0 +1,5 @@
+if(EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/batch/stale.txt")
+  set(RunCMake_TEST_FAILED "Unused batch file not removed:\n  ${RunCMake_TEST_BINARY_DIR}/CMakeFiles/batch/stale.txt")
+  return()
+endif()
+include(${CMAKE_CURRENT_LIST_DIR}/BatchToolCommands-check.cmake)
@@ -0,0 +1,8 @@
+set(CMAKE_BATCH_TOOL_COMMANDS 1)
+add_custom_command(OUTPUT out.txt
+  COMMAND ${CMAKE_COMMAND} -E make_directory dir
+  COMMAND ${CMAKE_COMMAND} -E echo "batch: a \"b\" c\\d"
+  COMMAND ${CMAKE_COMMAND} -E touch dir/stamp
+  COMMAND ${CMAKE_COMMAND} -E copy dir/stamp out.txt
+  VERBATIM)
+add_custom_target(batch ALL DEPENDS out.txt)
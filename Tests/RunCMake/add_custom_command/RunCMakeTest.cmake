@@ -27,3 +27,16 @@ set(RunCMake_TEST_NO_CLEAN 1)
 run_cmake_command(AssigningMultipleTargets-build ${CMAKE_COMMAND} --build .)
 unset(RunCMake_TEST_BINARY_DIR)
 unset(RunCMake_TEST_NO_CLEAN)
+
+run_cmake(BatchToolCommands)
+set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/BatchToolCommands-build)
+set(RunCMake_TEST_NO_CLEAN 1)
+run_cmake_command(BatchToolCommands-build ${CMAKE_COMMAND} --build .)
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/batch/stale.txt" "")
+run_cmake_command(BatchToolCommands-regenerate ${CMAKE_COMMAND} .)
+if(RunCMake_GENERATOR MATCHES "Make|Ninja")
+  run_cmake_command(BatchToolCommands-clean ${CMAKE_COMMAND} --build . --target clean)
+  run_cmake_command(BatchToolCommands-rebuild ${CMAKE_COMMAND} --build .)
+endif()
+unset(RunCMake_TEST_BINARY_DIR)
+unset(RunCMake_TEST_NO_CLEAN)
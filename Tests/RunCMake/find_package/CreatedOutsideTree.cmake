@@ -0,0 +1,24 @@
+# Use a prefix outside the source and build trees, where the find
+# commands may reuse directory listings between calls.
+get_filename_component(prefix
+  "${CMAKE_CURRENT_BINARY_DIR}/../CreatedOutsideTree-prefix" ABSOLUTE)
+file(REMOVE_RECURSE "${prefix}")
+file(MAKE_DIRECTORY "${prefix}")
+set(CMAKE_PREFIX_PATH "${prefix}")
+
+find_package(Created QUIET)
+message(STATUS "Created_FOUND='${Created_FOUND}'")
+file(WRITE "${prefix}/lib/cmake/Created/CreatedConfig.cmake" "")
+find_package(Created QUIET)
+message(STATUS "Created_FOUND='${Created_FOUND}'")
+
+find_package(Spawned QUIET)
+message(STATUS "Spawned_FOUND='${Spawned_FOUND}'")
+execute_process(COMMAND ${CMAKE_COMMAND} -E make_directory
+  "${prefix}/share/spawned")
+execute_process(COMMAND ${CMAKE_COMMAND} -E touch
+  "${prefix}/share/spawned/spawned-config.cmake")
+find_package(Spawned QUIET)
+message(STATUS "Spawned_FOUND='${Spawned_FOUND}'")
+
+file(REMOVE_RECURSE "${prefix}")
@@ -0,0 +1,56 @@
+macro(check actual expected)
+  if(NOT "${actual}" STREQUAL "${expected}")
+    message(SEND_ERROR "Expected \"${expected}\", got \"${actual}\"")
+  endif()
+endmacro()
+
+macro(args a b)
+  check("${a}-${b}" "x-y")
+  check("${ARGC}:${ARGV}:${ARGN}" "3:x;y;z:z")
+  # References past the last argument are left to variable expansion.
+  check("${ARGV0}${ARGV2}${ARGV3}" "xz")
+  check("${ARGV01}" "")
+endmacro()
+args(x y z)
+
+# Values substituted for one parameter are searched for later ones.
+macro(nested a b)
+  check("${${a}}" "value")
+endmacro()
+nested(b value)
+macro(reference a b)
+  check("${a}" "value")
+endmacro()
+reference([[${b}]] value)
+
+# Formal parameters take precedence over the automatic ones.
+macro(formal ARGN ARGV1)
+  check("${ARGN}-${ARGV1}-${ARGV}" "a-b-a;b;c")
+endmacro()
+formal(a b c)
+
+# A macro body is compiled once and reused by every call.
+macro(count)
+  math(EXPR count_calls "${count_calls} + 1")
+endmacro()
+set(count_calls 0)
+foreach(i RANGE 1 10)
+  count()
+endforeach()
+check("${count_calls}" "10")
+
+# A redefinition of a command is seen by bodies that called it before.
+function(callee)
+  set(callee_result old PARENT_SCOPE)
+endfunction()
+function(caller)
+  callee()
+  set(callee_result "${callee_result}" PARENT_SCOPE)
+endfunction()
+caller()
+check("${callee_result}" "old")
+function(callee)
+  set(callee_result new PARENT_SCOPE)
+endfunction()
+caller()
+check("${callee_result}" "new")
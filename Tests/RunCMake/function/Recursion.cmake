@@ -0,0 +1,33 @@
+# Functions and macros that call themselves or each other.
+function(count_down n)
+  if(n GREATER 0)
+    math(EXPR n "${n} - 1")
+    count_down(${n})
+  else()
+    message(STATUS "count_down done")
+  endif()
+endfunction()
+count_down(3)
+
+macro(ping n)
+  if(${n} GREATER 0)
+    math(EXPR next "${n} - 1")
+    pong(${next})
+  endif()
+endmacro()
+function(pong n)
+  message(STATUS "pong ${n}")
+  ping(${n})
+endfunction()
+ping(3)
+
+# A function that replaces itself while it runs.
+function(redefine)
+  function(redefine)
+    message(STATUS "redefined")
+  endfunction()
+  redefine()
+  message(STATUS "original still running")
+endfunction()
+redefine()
+redefine()
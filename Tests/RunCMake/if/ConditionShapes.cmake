@@ -0,0 +1,62 @@
+cmake_policy(VERSION 3.4)
+
+# Conditions of the same shape share their compiled form.  Evaluate each
+# condition with several values to check that the replay reads them.
+function(check expected)
+  if(${ARGN})
+    set(actual 1)
+  else()
+    set(actual 0)
+  endif()
+  if(NOT actual EQUAL expected)
+    string(REPLACE ";" " " condition "${ARGN}")
+    message(SEND_ERROR "if(${condition}) is ${actual}, not ${expected}")
+  endif()
+endfunction()
+
+set(on 1)
+set(off 0)
+set(name "abc")
+set(list "a;b;c")
+
+foreach(value IN ITEMS on off)
+  if(value STREQUAL "on")
+    set(t 1)
+    set(f 0)
+  else()
+    set(t 0)
+    set(f 1)
+  endif()
+  check(${t} ${value})
+  check(${f} NOT ${value})
+  check(${t} ${value} AND on)
+  check(0 ${value} AND off)
+  check(1 ${value} OR on)
+  check(${t} ${value} OR off)
+  check(${f} NOT ${value} AND NOT off)
+  check(${t} off OR ${value} AND on)
+  check(${t} (${value}))
+  check(${f} NOT (${value} OR off))
+  check(${t} ((${value}) AND (NOT off)) OR (off AND on))
+  check(${t} DEFINED ${value} AND ${value})
+  check(${t} "${${value}}" EQUAL 1)
+  check(${f} 1.${${value}} VERSION_LESS 1.1 OR ${value} GREATER 1)
+  check(${t} ${value} STREQUAL "on" AND "x" MATCHES "x")
+endforeach()
+
+foreach(s IN ITEMS b d)
+  if(s STREQUAL "b")
+    set(t 1)
+  else()
+    set(t 0)
+  endif()
+  check(${t} ${s} IN_LIST list)
+  check(${t} name MATCHES "^a${s}" AND CMAKE_MATCH_0 STREQUAL "a${s}")
+  check(1 NOT ${s} MATCHES "^$" OR 0)
+  check(${t} ${s} STRLESS c AND NOT ${s} STRGREATER_EQUAL c)
+endforeach()
+
+# Empty conditions and groups.
+check(0)
+check(0 ())
+check(1 NOT ())